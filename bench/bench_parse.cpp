@@ -0,0 +1,232 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+
+/*
+ * Measures the time taken by parser::parse on a long command-line
+ * string, a stream, and a large response file, by
+ * parser::parse_batch on many short command lines, by
+ * parser::print_help with and without a cached rendering, by the
+ * man page, Markdown and JSON exporters, by the suggestions given for
+ * misspelled options, and by shell completion. Also reports the memory
+ * used for option text.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <optionpp/parser.hpp>
+
+using namespace optionpp;
+
+namespace {
+
+  // Prevents the compiler from discarding a computed result
+  volatile std::size_t sink;
+
+  // Run a function repeatedly and report the best time
+  template <typename F>
+  void run(const std::string& name, std::size_t arg_count, F fn) {
+    using clock = std::chrono::steady_clock;
+    const int iterations = 10;
+
+    fn(); // Warm up
+    auto best = clock::duration::max();
+    for (int i = 0; i < iterations; ++i) {
+      auto start = clock::now();
+      fn();
+      best = std::min(best, clock::now() - start);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(best).count();
+    std::cout << std::left << std::setw(40) << name
+              << std::right << std::setw(10) << std::fixed
+              << std::setprecision(2) << ms << " ms ("
+              << arg_count << " items)\n";
+  }
+
+  // Build a command line from a repeating pattern of arguments
+  std::string make_args(std::size_t count, char delim) {
+    const char* pattern[] = {
+      "-v", "--include=src/module", "-I", "\"dir with spaces\"",
+      "file.cpp", "--level", "3", "escaped\\ name.o"
+    };
+    const std::size_t pattern_size = sizeof(pattern) / sizeof(pattern[0]);
+
+    std::string str;
+    for (std::size_t i = 0; i < count; ++i) {
+      str += pattern[i % pattern_size];
+      str.push_back(delim);
+    }
+    return str;
+  }
+
+} // End namespace
+
+int main() {
+  const std::size_t arg_count = 500000;
+  const std::string path{"optionpp_bench_args.txt"};
+
+  bool verbose{};
+  unsigned level{};
+  std::string include;
+  parser opt_parser;
+  opt_parser.add_option().short_name('v').bind_bool(&verbose);
+  opt_parser.add_option().long_name("include").short_name('I')
+    .argument("DIR").bind_string(&include);
+  opt_parser.add_option().long_name("level").argument("N")
+    .bind_uint(&level);
+  opt_parser.set_response_files(true);
+
+  const std::string cmd_line = make_args(arg_count, ' ');
+  std::ofstream{path, std::ios::binary} << make_args(arg_count, '\n');
+
+  run("parse (string)", arg_count, [&] {
+    sink = opt_parser.parse(cmd_line).size();
+  });
+  run("parse (stream)", arg_count, [&] {
+    std::istringstream in{cmd_line};
+    sink = opt_parser.parse(in).size();
+  });
+  run("parse (response file)", arg_count, [&] {
+    sink = opt_parser.parse("@" + path).size();
+  });
+
+  // Many short command lines, parsed with increasing thread counts
+  const std::size_t line_count = 100000;
+  std::vector<std::string> lines;
+  for (std::size_t i = 0; i < line_count; ++i)
+    lines.push_back(make_args(8 + i % 8, ' '));
+  unsigned max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    run("parse_batch (" + std::to_string(threads) + " threads)",
+        line_count, [&] {
+          sink = opt_parser.parse_batch(lines.begin(), lines.end(),
+                                        threads).size();
+        });
+  }
+
+  // Help text for a parser with many options
+  parser help_parser;
+  const std::size_t option_count = 500;
+  for (std::size_t i = 0; i < option_count; ++i) {
+    help_parser.group("Group " + std::to_string(i / 50))
+      .add_option("option-" + std::to_string(i))
+      .argument("VALUE", i % 2 == 0)
+      .description("Set the value used by the component with number "
+                   + std::to_string(i) + ", which is described at length"
+                   " so that the description wraps over several lines");
+  }
+  const std::size_t renders = 100;
+  run("print_help (uncached)", renders, [&] {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < renders; ++i) {
+      help_parser.sort_options(); // Invalidates the cache
+      std::ostringstream oss;
+      help_parser.print_help(oss);
+      total += oss.str().size();
+    }
+    sink = total;
+  });
+  run("print_help (cached)", renders, [&] {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < renders; ++i) {
+      std::ostringstream oss;
+      help_parser.print_help(oss);
+      total += oss.str().size();
+    }
+    sink = total;
+  });
+
+  // Exporters for a parser with many options, whose descriptions are
+  // kept in a string pool
+  utility::string_pool text_pool;
+  parser export_parser;
+  const std::size_t export_count = 2000;
+  for (std::size_t i = 0; i < export_count; ++i) {
+    export_parser.group("Group " + std::to_string(i / 100))
+      .add_option("option-" + std::to_string(i))
+      .argument("VALUE", i % 2 == 0)
+      .description(text_pool.intern(
+                     "Set the value used by the component with number "
+                     + std::to_string(i % 100) + ", which is described at"
+                     " length so that the description wraps over several"
+                     " lines"));
+  }
+  auto pool = text_pool.stats();
+  std::cout << std::left << std::setw(40) << "option text (string pool)"
+            << std::right << std::setw(10) << pool.allocated_bytes / 1024
+            << " KiB (" << pool.strings << " strings, "
+            << pool.saved_bytes() / 1024 << " KiB saved)\n";
+
+  parser::man_page_info info;
+  info.name = "bench";
+  run("print_man_page", export_count, [&] {
+    std::ostringstream oss;
+    export_parser.print_man_page(oss, info);
+    sink = oss.str().size();
+  });
+  run("print_markdown", export_count, [&] {
+    std::ostringstream oss;
+    export_parser.print_markdown(oss);
+    sink = oss.str().size();
+  });
+  run("print_json", export_count, [&] {
+    std::ostringstream oss;
+    export_parser.print_json(oss);
+    sink = oss.str().size();
+  });
+
+  // Suggestions for misspelled options among many options
+  const std::size_t misspelling_count = 1000;
+  std::vector<std::string> misspellings;
+  for (std::size_t i = 0; i < misspelling_count; ++i)
+    misspellings.push_back("--optoin-" + std::to_string(i * 2));
+  run("unknown option (suggestions)", misspelling_count, [&] {
+    std::size_t total = 0;
+    for (const auto& arg : misspellings) {
+      try {
+        export_parser.parse(arg);
+      } catch (const parse_error& e) {
+        total += e.suggestions().size();
+      }
+    }
+    sink = total;
+  });
+
+  // Completion among many options, building the index once
+  const std::size_t completion_count = 1000;
+  run("complete", completion_count, [&] {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < completion_count; ++i)
+      total += export_parser.complete("--option-" + std::to_string(i)).size();
+    sink = total;
+  });
+
+  std::remove(path.c_str());
+  return 0;
+}
@@ -0,0 +1,203 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+/*
+ * Measures the throughput of utility::split, utility::split_view,
+ * utility::tokenizer (in each shell dialect), utility::find_first_of,
+ * utility::wrap_text, utility::write_wrapped and utility::display_width
+ * on long inputs.
+ *
+ * Character sets with more than char_class::max_listed members are
+ * always scanned with the scalar bitmap loop. Configure with
+ * -DOPTIONPP_SIMD=OFF to measure the scalar path for the small sets
+ * as well.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <optionpp/utility.hpp>
+
+using namespace optionpp::utility;
+
+namespace {
+
+  // Prevents the compiler from discarding a computed result
+  volatile std::size_t sink;
+
+  // Run a function repeatedly and report the throughput
+  template <typename F>
+  void run(const std::string& name, std::size_t bytes, F fn) {
+    using clock = std::chrono::steady_clock;
+    const int iterations = 50;
+
+    fn(); // Warm up
+    auto best = clock::duration::max();
+    for (int i = 0; i < iterations; ++i) {
+      auto start = clock::now();
+      fn();
+      best = std::min(best, clock::now() - start);
+    }
+
+    double seconds = std::chrono::duration<double>(best).count();
+    std::cout << std::left << std::setw(40) << name
+              << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1)
+              << bytes / seconds / (1024 * 1024) << " MiB/s\n";
+  }
+
+  // Build a command line made of words of random length
+  std::string make_input(std::size_t size, std::size_t max_word_len) {
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<std::size_t> word_len{1, max_word_len};
+    std::uniform_int_distribution<int> letter{'a', 'z'};
+
+    std::string str;
+    while (str.size() < size) {
+      auto len = word_len(rng);
+      for (std::size_t i = 0; i < len; ++i)
+        str.push_back(static_cast<char>(letter(rng)));
+      str.push_back(rng() % 8 == 0 ? '\t' : ' ');
+      if (rng() % 16 == 0)
+        str += "\"quoted \\\" text\" ";
+    }
+    return str;
+  }
+
+} // End namespace
+
+int main() {
+  const std::size_t size = 8 * 1024 * 1024;
+  const std::string short_words = make_input(size, 8);
+  const std::string long_words = make_input(size, 120);
+
+  // More delimiters than can be searched with SIMD instructions
+  const std::string many_delims = " \t\n\r,;:|!#$%&*+-/<=>?";
+  const char_class many_delims_class{many_delims};
+
+  std::vector<std::string> tokens;
+  tokens.reserve(size / 2);
+
+  run("split (short words)", size, [&] {
+    tokens.clear();
+    split(short_words, std::back_inserter(tokens));
+    sink = tokens.size();
+  });
+  run("split (long words)", size, [&] {
+    tokens.clear();
+    split(long_words, std::back_inserter(tokens));
+    sink = tokens.size();
+  });
+  std::vector<token_view> views;
+  views.reserve(size / 2);
+  token_arena arena;
+  run("split_view (short words)", size, [&] {
+    views.clear();
+    arena.clear();
+    split_view(short_words, std::back_inserter(views), arena);
+    sink = views.size();
+  });
+  run("split_view (long words)", size, [&] {
+    views.clear();
+    arena.clear();
+    split_view(long_words, std::back_inserter(views), arena);
+    sink = views.size();
+  });
+  run("split (long words, scalar bitmap)", size, [&] {
+    tokens.clear();
+    split(long_words, std::back_inserter(tokens), many_delims_class);
+    sink = tokens.size();
+  });
+
+  // Every dialect accepts the double-quoted text in the input
+  const std::pair<const char*, shell_dialect> dialects[] = {
+    {"generic", shell_dialect::generic},
+    {"posix", shell_dialect::posix},
+    {"windows", shell_dialect::windows}
+  };
+  for (const auto& d : dialects) {
+    tokenizer tok{d.second};
+    for (const auto* input : {&short_words, &long_words}) {
+      std::string name = std::string{"tokenizer ("} + d.first
+        + (input == &short_words ? ", short words)" : ", long words)");
+      run(name, size, [&] {
+        tokens.clear();
+        tok.finish(tok.feed(*input, std::back_inserter(tokens)));
+        sink = tokens.size();
+      });
+    }
+  }
+
+  const char* first = long_words.data();
+  const char* last = first + long_words.size();
+  run("find_first_of (bitmap)", size, [&] {
+    std::size_t count = 0;
+    for (const char* pos = first; pos != last; ++count) {
+      pos = find_first_of(pos, last, many_delims_class);
+      if (pos != last)
+        ++pos;
+    }
+    sink = count;
+  });
+  run("std::find_first_of", size, [&] {
+    std::size_t count = 0;
+    for (const char* pos = first; pos != last; ++count) {
+      pos = std::find_first_of(pos, last, many_delims.begin(),
+                               many_delims.end());
+      if (pos != last)
+        ++pos;
+    }
+    sink = count;
+  });
+
+  run("wrap_text", size, [&] {
+    sink = wrap_text(short_words, 79, 2).size();
+  });
+  std::vector<char> wrapped(size * 2);
+  run("write_wrapped (buffer)", size, [&] {
+    sink = write_wrapped(wrapped.data(), wrapped.size(), short_words,
+                         79, 2, 2);
+  });
+
+  // The same text with an accented letter in most words
+  std::string accented;
+  for (char c : short_words) {
+    if (c == 'e')
+      accented += "\xc3\xa9";
+    else
+      accented.push_back(c);
+  }
+  wrapped.resize(accented.size() * 2);
+  run("write_wrapped (buffer, UTF-8)", accented.size(), [&] {
+    sink = write_wrapped(wrapped.data(), wrapped.size(), accented,
+                         79, 2, 2);
+  });
+  run("display_width (UTF-8)", accented.size(), [&] {
+    sink = display_width(accented);
+  });
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+# Option++ -- read command-line program options
+# Copyright (C) 2017-2020 Greg Kikola.
+#
+# This file is part of Option++.
+#
+# Option++ is free software: you can redistribute it and/or modify
+# it under the terms of the Boost Software License version 1.0.
+#
+# Option++ is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Boost Software License for more details.
+#
+# You should have received a copy of the Boost Software License
+# along with Option++.  If not, see
+# <https://www.boost.org/LICENSE_1_0.txt>.
+
+# Written by Greg Kikola <gkikola@gmail.com>.
+
+# Pre-render a program's help text at build time.
+#
+#   optionpp_add_static_help (<target>
+#     DEFINITION <source>
+#     FUNCTION <function>
+#     NAME <identifier>
+#     [WIDTH <n>] [GROUP_INDENT <n>] [OPTION_INDENT <n>]
+#     [DESC_INDENT <n>] [DESC_MULTILINE_INDENT <n>]
+#     [SOURCES <source>...])
+#
+# <source> must define `void <function>(optionpp::parser&)`, which adds
+# the program's options to the given parser. A generator program is
+# built from <source> (plus any SOURCES it depends on) and run to write
+# <identifier>.hpp into the current binary directory. The header
+# defines `constexpr char <identifier>[]` holding the text printed by
+# `parser::print_help` with the given layout, and
+# `constexpr std::size_t <identifier>_length`. The header is added to
+# <target>, which can then include it and print its help with a single
+# write.
+#
+# The layout parameters default to those of `parser::print_help`.
+
+set (OPTIONPP_HELP_GENERATOR_SOURCE
+  "${CMAKE_CURRENT_LIST_DIR}/../tools/optionpp_gen_help.cpp"
+  CACHE INTERNAL "Source of the help text generator")
+
+if (EXISTS "${CMAKE_CURRENT_LIST_DIR}/../include/optionpp")
+  set (_optionpp_include_dir "${CMAKE_CURRENT_LIST_DIR}/../include")
+else ()
+  # Installed under share/optionpp/cmake
+  set (_optionpp_include_dir "${CMAKE_CURRENT_LIST_DIR}/../../../include")
+endif ()
+get_filename_component (_optionpp_include_dir
+  "${_optionpp_include_dir}" ABSOLUTE)
+set (OPTIONPP_HELP_INCLUDE_DIR "${_optionpp_include_dir}"
+  CACHE INTERNAL "Include directory used by the help text generator")
+unset (_optionpp_include_dir)
+
+function (optionpp_add_static_help target)
+  cmake_parse_arguments (HELP
+    ""
+    "DEFINITION;FUNCTION;NAME;WIDTH;GROUP_INDENT;OPTION_INDENT;DESC_INDENT;DESC_MULTILINE_INDENT"
+    "SOURCES"
+    ${ARGN}
+    )
+
+  foreach (required IN ITEMS DEFINITION FUNCTION NAME)
+    if (NOT HELP_${required})
+      message (FATAL_ERROR
+        "optionpp_add_static_help: ${required} is required")
+    endif ()
+  endforeach ()
+
+  if (NOT TARGET optionpp)
+    message (FATAL_ERROR
+      "optionpp_add_static_help: the optionpp target is not defined")
+  endif ()
+
+  set (generator "optionpp_gen_help_${HELP_NAME}")
+  set (header "${CMAKE_CURRENT_BINARY_DIR}/${HELP_NAME}.hpp")
+
+  add_executable (${generator}
+    "${OPTIONPP_HELP_GENERATOR_SOURCE}"
+    "${HELP_DEFINITION}"
+    ${HELP_SOURCES}
+    )
+  target_compile_definitions (${generator}
+    PRIVATE OPTIONPP_HELP_DEFINITION=${HELP_FUNCTION})
+  target_include_directories (${generator}
+    PRIVATE "${OPTIONPP_HELP_INCLUDE_DIR}")
+  target_link_libraries (${generator} PRIVATE optionpp)
+
+  set (layout)
+  foreach (param IN ITEMS WIDTH GROUP_INDENT OPTION_INDENT
+      DESC_INDENT DESC_MULTILINE_INDENT)
+    if (DEFINED HELP_${param})
+      string (TOLOWER "${param}" flag)
+      string (REPLACE "_" "-" flag "${flag}")
+      list (APPEND layout "--${flag}=${HELP_${param}}")
+    endif ()
+  endforeach ()
+
+  add_custom_command (
+    OUTPUT "${header}"
+    COMMAND ${generator} --output "${header}" --name ${HELP_NAME} ${layout}
+    DEPENDS ${generator}
+    COMMENT "Rendering help text ${HELP_NAME}"
+    VERBATIM
+    )
+  add_custom_target (${generator}_header DEPENDS "${header}")
+
+  add_dependencies (${target} ${generator}_header)
+  target_sources (${target} PRIVATE "${header}")
+  target_include_directories (${target}
+    PRIVATE "${CMAKE_CURRENT_BINARY_DIR}")
+endfunction ()
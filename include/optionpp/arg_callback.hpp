@@ -0,0 +1,354 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+/**
+ * @file
+ * @brief Header file for `arg_callback` class.
+ */
+
+#ifndef OPTIONPP_ARG_CALLBACK_HPP
+#define OPTIONPP_ARG_CALLBACK_HPP
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace optionpp {
+
+  /**
+   * @brief Holds a user-supplied function that processes an option
+   *        argument.
+   *
+   * An `arg_callback` wraps any callable object (a function pointer,
+   * a lambda, or a function object) that can be called with a
+   * `const std::string&` and returns a value convertible to
+   * `bool`. The return value indicates whether the argument was
+   * accepted.
+   *
+   * Small callables, such as lambdas capturing a few pointers or
+   * references, are stored inside the `arg_callback` itself, so
+   * that registering a callback does not allocate memory. Larger
+   * callables are stored on the heap.
+   *
+   * Example:
+   * ```
+   * int value{};
+   * arg_callback even{[&](const std::string& arg) {
+   *   value = std::stoi(arg);
+   *   return value % 2 == 0;
+   * }};
+   * ```
+   */
+  class arg_callback {
+  public:
+    /**
+     * @brief Size in bytes of the internal buffer used to store
+     *        small callables.
+     */
+    static constexpr std::size_t buffer_size = 4 * sizeof(void*);
+
+    /**
+     * @brief Default constructor.
+     *
+     * Constructs an empty `arg_callback`.
+     */
+    arg_callback() noexcept {}
+    /**
+     * @brief Construct an empty `arg_callback` from `nullptr`.
+     */
+    arg_callback(std::nullptr_t) noexcept {}
+    /**
+     * @brief Construct from a callable object.
+     *
+     * A null function pointer or an empty `std::function` gives an
+     * empty `arg_callback`.
+     *
+     * @tparam F Type of the callable (usually deduced).
+     * @param fn The callable to store.
+     */
+    template <typename F,
+              typename = typename std::enable_if<
+                !std::is_same<typename std::decay<F>::type,
+                              arg_callback>::value>::type>
+    arg_callback(F&& fn);
+    /**
+     * @brief Copy constructor.
+     * @param other The `arg_callback` to copy.
+     */
+    arg_callback(const arg_callback& other);
+    /**
+     * @brief Move constructor.
+     * @param other The `arg_callback` to move from.
+     */
+    arg_callback(arg_callback&& other) noexcept;
+    /**
+     * @brief Assignment operator.
+     * @param other The `arg_callback` to assign from.
+     * @return Reference to the current instance.
+     */
+    arg_callback& operator=(arg_callback other) noexcept {
+      swap(other);
+      return *this;
+    }
+    /**
+     * @brief Destructor.
+     */
+    ~arg_callback() { reset(); }
+
+    /**
+     * @brief Exchange contents with another `arg_callback`.
+     * @param other The `arg_callback` to swap with.
+     */
+    void swap(arg_callback& other) noexcept;
+
+    /**
+     * @brief Destroy the stored callable, if any.
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief Return true if the callable is stored in the internal
+     *        buffer rather than on the heap.
+     * @return True if no heap memory is used.
+     */
+    bool is_inline() const noexcept { return m_ops && m_ops->is_inline; }
+
+    /**
+     * @brief Return true if a callable is stored.
+     * @return True if nonempty, false otherwise.
+     */
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    /**
+     * @brief Return a pointer to the stored callable.
+     * @tparam F Type of the callable.
+     * @return Pointer to the callable, or `nullptr` if the
+     *         `arg_callback` is empty or holds a callable of another
+     *         type.
+     */
+    template <typename F>
+    const F* target() const noexcept;
+
+    /**
+     * @brief Invoke the stored callable.
+     *
+     * Calling an empty `arg_callback` is a no-op that accepts the
+     * argument.
+     *
+     * @param arg Option argument to pass to the callable.
+     * @return Result of the callable.
+     */
+    bool operator()(const std::string& arg) const {
+      return m_ops ? m_ops->invoke(m_storage, arg) : true;
+    }
+
+  private:
+    /**
+     * @brief Type of buffer used to hold a small callable or a
+     *        pointer to a large one.
+     */
+    using storage_type
+    = typename std::aligned_storage<buffer_size,
+                                    alignof(std::max_align_t)>::type;
+
+    /**
+     * @brief Table of functions used to manage a particular callable
+     *        type.
+     */
+    struct operations {
+      bool (*invoke)(const storage_type&, const std::string&); //< Call the callable.
+      void (*copy)(storage_type&, const storage_type&); //< Copy-construct into empty storage.
+      void (*move)(storage_type&, storage_type&) noexcept; //< Move-construct into empty storage and destroy the source.
+      void (*destroy)(storage_type&) noexcept; //< Destroy the callable.
+      bool is_inline; //< True if the callable is stored in the buffer.
+    };
+
+    /**
+     * @brief Determines whether a callable type can be stored in the
+     *        internal buffer.
+     * @tparam F Type of the callable.
+     */
+    template <typename F>
+    struct fits_inline
+      : std::integral_constant<bool,
+                               sizeof(F) <= buffer_size
+                               && alignof(F) <= alignof(std::max_align_t)
+                               && std::is_nothrow_move_constructible<F>::value> {};
+
+    template <typename F, bool Inline = fits_inline<F>::value>
+    struct manager;
+
+    /**
+     * @brief Check whether a callable compares equal to `nullptr`.
+     *
+     * This catches null function pointers and empty function
+     * wrappers, which could not be called.
+     *
+     * @param fn The callable to check.
+     * @return True if `fn` is null.
+     */
+    template <typename F>
+    static auto is_null(const F& fn, int)
+      -> decltype(static_cast<bool>(fn == nullptr)) {
+      return fn == nullptr;
+    }
+    /**
+     * @brief Overload for callables that cannot be null.
+     * @return False.
+     */
+    template <typename F>
+    static bool is_null(const F&, long) { return false; }
+
+    storage_type m_storage; //< Buffer holding the callable.
+    const operations* m_ops{nullptr}; //< Functions for the stored type, or `nullptr` if empty.
+  };
+
+} // End namespace
+
+
+/* Implementation */
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+// Manages a callable stored in the internal buffer
+template <typename F>
+struct optionpp::arg_callback::manager<F, true> {
+  static F& get(const storage_type& s) {
+    return *const_cast<F*>(reinterpret_cast<const F*>(&s));
+  }
+  static bool invoke(const storage_type& s, const std::string& arg) {
+    return static_cast<bool>(get(s)(arg));
+  }
+  template <typename G>
+  static void create(storage_type& dest, G&& fn) {
+    ::new (static_cast<void*>(&dest)) F(std::forward<G>(fn));
+  }
+  static void copy(storage_type& dest, const storage_type& src) {
+    ::new (static_cast<void*>(&dest)) F(get(src));
+  }
+  static void move(storage_type& dest, storage_type& src) noexcept {
+    ::new (static_cast<void*>(&dest)) F(std::move(get(src)));
+    get(src).~F();
+  }
+  static void destroy(storage_type& s) noexcept { get(s).~F(); }
+  static const F* target(const storage_type& s) noexcept { return &get(s); }
+
+  static const operations ops;
+};
+
+template <typename F>
+const optionpp::arg_callback::operations
+optionpp::arg_callback::manager<F, true>::ops = {
+  &invoke, &copy, &move, &destroy, true
+};
+
+// Manages a callable stored on the heap
+template <typename F>
+struct optionpp::arg_callback::manager<F, false> {
+  static F*& get(storage_type& s) {
+    return *reinterpret_cast<F**>(&s);
+  }
+  static F* get(const storage_type& s) {
+    return *reinterpret_cast<F* const*>(&s);
+  }
+  static bool invoke(const storage_type& s, const std::string& arg) {
+    return static_cast<bool>((*get(s))(arg));
+  }
+  template <typename G>
+  static void create(storage_type& dest, G&& fn) {
+    get(dest) = new F(std::forward<G>(fn));
+  }
+  static void copy(storage_type& dest, const storage_type& src) {
+    get(dest) = new F(*get(src));
+  }
+  static void move(storage_type& dest, storage_type& src) noexcept {
+    get(dest) = get(src);
+  }
+  static void destroy(storage_type& s) noexcept { delete get(s); }
+  static const F* target(const storage_type& s) noexcept { return get(s); }
+
+  static const operations ops;
+};
+
+template <typename F>
+const optionpp::arg_callback::operations
+optionpp::arg_callback::manager<F, false>::ops = {
+  &invoke, &copy, &move, &destroy, false
+};
+
+template <typename F, typename>
+optionpp::arg_callback::arg_callback(F&& fn) {
+  using type = typename std::decay<F>::type;
+  if (is_null(static_cast<const type&>(fn), 0))
+    return;
+  manager<type>::create(m_storage, std::forward<F>(fn));
+  m_ops = &manager<type>::ops;
+}
+
+template <typename F>
+const F* optionpp::arg_callback::target() const noexcept {
+  if (m_ops != &manager<F>::ops)
+    return nullptr;
+  return manager<F>::target(m_storage);
+}
+
+inline optionpp::arg_callback::arg_callback(const arg_callback& other) {
+  if (other.m_ops) {
+    other.m_ops->copy(m_storage, other.m_storage);
+    m_ops = other.m_ops;
+  }
+}
+
+inline optionpp::arg_callback::arg_callback(arg_callback&& other) noexcept {
+  if (other.m_ops) {
+    other.m_ops->move(m_storage, other.m_storage);
+    m_ops = other.m_ops;
+    other.m_ops = nullptr;
+  }
+}
+
+inline void optionpp::arg_callback::swap(arg_callback& other) noexcept {
+  if (this == &other)
+    return;
+
+  arg_callback temp{std::move(other)};
+  if (m_ops) {
+    m_ops->move(other.m_storage, m_storage);
+    other.m_ops = m_ops;
+    m_ops = nullptr;
+  }
+  if (temp.m_ops) {
+    temp.m_ops->move(m_storage, temp.m_storage);
+    m_ops = temp.m_ops;
+    temp.m_ops = nullptr;
+  }
+}
+
+inline void optionpp::arg_callback::reset() noexcept {
+  if (m_ops) {
+    m_ops->destroy(m_storage);
+    m_ops = nullptr;
+  }
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
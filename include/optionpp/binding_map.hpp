@@ -0,0 +1,546 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+/**
+ * @file
+ * @brief Header file for `binding_map` class.
+ */
+
+#ifndef OPTIONPP_BINDING_MAP_HPP
+#define OPTIONPP_BINDING_MAP_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optionpp/error.hpp>
+#include <optionpp/option.hpp>
+#include <optionpp/utility.hpp>
+#include <optionpp/write_log.hpp>
+
+namespace optionpp {
+
+  /**
+   * @brief Maps options to members of a destination structure.
+   *
+   * Variables bound with `option::bind_bool` and friends belong to
+   * the option, so a `parser` using them cannot be shared between
+   * threads. A `binding_map` instead records, for each option, a
+   * member of `Target` that should receive its value. The options
+   * themselves then only describe the command-line syntax, and the
+   * destination is supplied separately for each call to
+   * `parser::parse`:
+   * ```
+   * struct request { bool verbose = false; unsigned jobs = 1; };
+   *
+   * parser opt_parser;
+   * opt_parser["verbose"].short_name('v');
+   * opt_parser["jobs"].short_name('j').argument("N").bind_uint(nullptr);
+   *
+   * binding_map<request> bindings;
+   * bindings.bind_bool(opt_parser["verbose"], &request::verbose)
+   *   .bind_uint(opt_parser["jobs"], &request::jobs);
+   *
+   * // Any number of threads can now do this concurrently
+   * request req;
+   * opt_parser.parse(line, bindings, req);
+   * ```
+   *
+   * The argument type of an option is still taken from the option,
+   * so it should be declared by passing a null pointer to the
+   * appropriate `bind_*` function, as shown above. Options that are
+   * not in the map are parsed normally but their values are not
+   * stored. Members of `Target` are only written when the
+   * corresponding option is present; flags are not reset to false.
+   *
+   * Options are identified by their long and short names rather than
+   * by address, so the map stays valid when options or groups are
+   * added to the parser, when it is sorted, and when it is copied. An
+   * option that is renamed after being bound is no longer matched.
+   *
+   * Once built, a `binding_map` is not modified by parsing, so it may
+   * be shared freely between threads.
+   *
+   * @tparam Target Structure type receiving the parsed values.
+   */
+  template <typename Target>
+  class binding_map {
+  public:
+
+    /**
+     * @brief Set a member to true if the option is present.
+     * @param opt The option.
+     * @param member Member to set.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    binding_map& bind_bool(const option& opt, bool Target::* member);
+    /**
+     * @brief Store the option's argument in a string member.
+     *
+     * The option may take a string argument, a custom argument
+     * without a converter (the unconverted argument is stored), or an
+     * enumeration argument (the name of the choice is stored).
+     *
+     * @param opt The option.
+     * @param member Member to receive the argument.
+     * @return Reference to the current instance (for chaining calls).
+     * @throw type_error If the option takes another type of argument,
+     *                   or has a converter set with
+     *                   `option::bind_custom`, which stores its result
+     *                   itself and so cannot write to `member`.
+     */
+    binding_map& bind_string(const option& opt,
+                             std::string Target::* member);
+    /**
+     * @brief Store the option's argument in an integer member.
+     *
+     * The option may take an integer argument or an enumeration
+     * argument (the value of the choice is stored).
+     *
+     * @param opt The option.
+     * @param member Member to receive the argument.
+     * @return Reference to the current instance (for chaining calls).
+     * @throw type_error If the option takes another type of argument.
+     */
+    binding_map& bind_int(const option& opt, int Target::* member);
+    /**
+     * @brief Store the option's argument in an unsigned integer
+     *        member.
+     * @param opt The option.
+     * @param member Member to receive the argument.
+     * @return Reference to the current instance (for chaining calls).
+     * @throw type_error If the option does not take an unsigned
+     *                   integer argument.
+     */
+    binding_map& bind_uint(const option& opt,
+                           unsigned int Target::* member);
+    /**
+     * @brief Store the option's argument in a floating-point member.
+     * @param opt The option.
+     * @param member Member to receive the argument.
+     * @return Reference to the current instance (for chaining calls).
+     * @throw type_error If the option does not take a floating-point
+     *                   argument.
+     */
+    binding_map& bind_double(const option& opt, double Target::* member);
+    /**
+     * @brief Store the option's argument in a duration member.
+     *
+     * If the member has a coarser resolution than the argument, the
+     * value is truncated.
+     *
+     * @tparam Rep Arithmetic type used by the duration (usually
+     *             deduced).
+     * @tparam Period Tick period of the duration (usually deduced).
+     * @param opt The option.
+     * @param member Member to receive the argument.
+     * @return Reference to the current instance (for chaining calls).
+     * @throw type_error If the option does not take a duration
+     *                   argument.
+     */
+    template <typename Rep, typename Period>
+    binding_map& bind_duration(const option& opt,
+                               std::chrono::duration<Rep, Period> Target::* member);
+    /**
+     * @brief Store the option's argument in a byte-size member.
+     * @param opt The option.
+     * @param member Member to receive the number of bytes.
+     * @return Reference to the current instance (for chaining calls).
+     * @throw type_error If the option does not take a size argument.
+     */
+    binding_map& bind_size(const option& opt,
+                           std::uint64_t Target::* member);
+
+    /**
+     * @brief Return whether the map is empty.
+     * @return True if no members have been bound.
+     */
+    bool empty() const noexcept { return m_bindings.empty(); }
+
+    /**
+     * @brief Store the writes recorded in a log into a destination.
+     *
+     * This is called by `parser::parse` when a `binding_map` is
+     * given. It can also be used directly with the log of a
+     * transactional parse. Writes to options that are not in the map
+     * are ignored, and the log is left unchanged.
+     *
+     * @param writes Log of recorded writes.
+     * @param target Structure to receive the values.
+     */
+    void apply(const write_log& writes, Target& target) const;
+
+  private:
+
+    /**
+     * @brief Kind of member that is bound.
+     */
+    enum class member_type : unsigned char {
+      bool_member, //< Flag set when the option is present.
+      string_member, //< String argument.
+      int_member, //< Integer argument.
+      uint_member, //< Unsigned integer argument.
+      double_member, //< Floating-point argument.
+      duration_member, //< Duration argument.
+      size_member //< Byte-size argument.
+    };
+
+    /**
+     * @brief Type of member pointer used to store duration members of
+     *        any resolution.
+     */
+    using erased_member = char Target::*;
+
+    /**
+     * @brief A single bound member.
+     */
+    struct binding {
+      std::string long_name; //< Long name of the option providing the value.
+      char short_name; //< Short name of the option providing the value.
+      member_type type; //< Kind of member.
+      union {
+        bool Target::* bool_ptr; //< Flag member.
+        std::string Target::* string_ptr; //< String member.
+        int Target::* int_ptr; //< Integer member.
+        unsigned int Target::* uint_ptr; //< Unsigned integer member.
+        double Target::* double_ptr; //< Floating-point member.
+        erased_member duration_ptr; //< Duration member, with its type erased.
+        std::uint64_t Target::* size_ptr; //< Byte-size member.
+      };
+      void (*duration_writer)(Target&, erased_member,
+                              std::chrono::nanoseconds) = nullptr; //< Stores a value in a duration member.
+    };
+
+    /**
+     * @brief Passes recorded writes to the bound members.
+     */
+    class writer;
+
+    /**
+     * @brief Check that an option takes an argument of a given type.
+     * @param opt The option.
+     * @param type Expected argument type.
+     * @param alt_type Another accepted argument type.
+     * @param fn_name Name of the calling function.
+     * @throw type_error If the option takes another type of argument.
+     */
+    static void check_type(const option& opt, option::arg_type type,
+                           option::arg_type alt_type,
+                           const std::string& fn_name);
+
+    /**
+     * @brief Construct a binding for an option.
+     * @param opt The option.
+     * @param type Kind of member.
+     * @return Binding identifying `opt` by name, with no member set.
+     */
+    static binding make_binding(const option& opt, member_type type);
+
+    /**
+     * @brief Add a binding, replacing any existing binding of the
+     *        same kind for the same option.
+     * @param b The binding to add.
+     */
+    void insert(const binding& b);
+
+    /**
+     * @brief Find the binding for an option.
+     * @param opt The option.
+     * @param flag True to find the flag binding, false for the
+     *             argument binding.
+     * @return Pointer to the binding, or `nullptr` if there is none.
+     */
+    const binding* find(const option& opt, bool flag) const noexcept;
+
+    /**
+     * @brief Compare the option of a binding with an option name.
+     * @param b The binding.
+     * @param long_name Long name of the option.
+     * @param short_name Short name of the option.
+     * @return Negative, zero or positive if the option of `b` comes
+     *         before, is the same as, or comes after the given one.
+     */
+    static int compare(const binding& b, utility::token_view long_name,
+                       char short_name) noexcept {
+      int result = b.long_name.compare(0, std::string::npos,
+                                       long_name.data(), long_name.size());
+      if (result != 0)
+        return result;
+      return static_cast<unsigned char>(b.short_name)
+        - static_cast<unsigned char>(short_name);
+    }
+
+    /**
+     * @brief Order bindings by option name, with flags first.
+     * @param a First binding.
+     * @param b Second binding.
+     * @return True if `a` should come before `b`.
+     */
+    static bool before(const binding& a, const binding& b) noexcept {
+      int result = compare(a, b.long_name, b.short_name);
+      if (result != 0)
+        return result < 0;
+      return a.type == member_type::bool_member
+        && b.type != member_type::bool_member;
+    }
+
+    std::vector<binding> m_bindings; //< Bound members, sorted by option.
+  };
+
+} // End namespace
+
+
+/* Implementation */
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+template <typename Target>
+class optionpp::binding_map<Target>::writer {
+public:
+  writer(const binding_map& map, Target& target) noexcept
+    : m_map{map}, m_target{target} {}
+
+  void write_bool(const option& opt, bool value) const {
+    if (auto b = m_map.find(opt, true))
+      m_target.*(b->bool_ptr) = value;
+  }
+
+  void write_string(const option& opt, const std::string& value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::string_member)
+      m_target.*(b->string_ptr) = value;
+  }
+
+  void write_int(const option& opt, int value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::int_member)
+      m_target.*(b->int_ptr) = value;
+  }
+
+  void write_uint(const option& opt, unsigned int value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::uint_member)
+      m_target.*(b->uint_ptr) = value;
+  }
+
+  void write_double(const option& opt, double value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::double_member)
+      m_target.*(b->double_ptr) = value;
+  }
+
+  void write_duration(const option& opt,
+                      std::chrono::nanoseconds value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::duration_member)
+      b->duration_writer(m_target, b->duration_ptr, value);
+  }
+
+  void write_size(const option& opt, std::uint64_t value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::size_member)
+      m_target.*(b->size_ptr) = value;
+  }
+
+  void write_enum(const option& opt, choice_table::size_type index) const {
+    auto b = m_map.find(opt, false);
+    if (!b)
+      return;
+    if (b->type == member_type::string_member)
+      m_target.*(b->string_ptr) = opt.choices().name(index);
+    else if (b->type == member_type::int_member)
+      m_target.*(b->int_ptr) = static_cast<int>(opt.choices().value(index));
+  }
+
+  void write_custom(const option& opt, const std::string& value) const {
+    write_string(opt, value);
+  }
+
+private:
+  const binding_map& m_map;
+  Target& m_target;
+};
+
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_bool(const option& opt,
+                                         bool Target::* member) {
+  binding b = make_binding(opt, member_type::bool_member);
+  b.bool_ptr = member;
+  insert(b);
+  return *this;
+}
+
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_string(const option& opt,
+                                           std::string Target::* member) {
+  if (opt.argument_type() != option::custom_arg)
+    check_type(opt, option::string_arg, option::enum_arg,
+               "optionpp::binding_map::bind_string");
+  else if (opt.has_bound_argument_variable())
+    throw type_error{"option '" + opt.name()
+        + "' has a converter, which cannot write to a member",
+        "optionpp::binding_map::bind_string"};
+
+  binding b = make_binding(opt, member_type::string_member);
+  b.string_ptr = member;
+  insert(b);
+  return *this;
+}
+
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_int(const option& opt,
+                                        int Target::* member) {
+  check_type(opt, option::int_arg, option::enum_arg,
+             "optionpp::binding_map::bind_int");
+
+  binding b = make_binding(opt, member_type::int_member);
+  b.int_ptr = member;
+  insert(b);
+  return *this;
+}
+
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_uint(const option& opt,
+                                         unsigned int Target::* member) {
+  check_type(opt, option::uint_arg, option::uint_arg,
+             "optionpp::binding_map::bind_uint");
+
+  binding b = make_binding(opt, member_type::uint_member);
+  b.uint_ptr = member;
+  insert(b);
+  return *this;
+}
+
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_double(const option& opt,
+                                           double Target::* member) {
+  check_type(opt, option::double_arg, option::double_arg,
+             "optionpp::binding_map::bind_double");
+
+  binding b = make_binding(opt, member_type::double_member);
+  b.double_ptr = member;
+  insert(b);
+  return *this;
+}
+
+template <typename Target>
+template <typename Rep, typename Period>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_duration(const option& opt,
+                                             std::chrono::duration<Rep, Period> Target::* member) {
+  using duration = std::chrono::duration<Rep, Period>;
+
+  check_type(opt, option::duration_arg, option::duration_arg,
+             "optionpp::binding_map::bind_duration");
+
+  // A pointer to a member can be converted to another member type
+  // and back, so the binding does not depend on the duration type
+  binding b = make_binding(opt, member_type::duration_member);
+  b.duration_ptr = reinterpret_cast<erased_member>(member);
+  b.duration_writer = [](Target& target, erased_member ptr,
+                         std::chrono::nanoseconds value) {
+    target.*reinterpret_cast<duration Target::*>(ptr)
+      = std::chrono::duration_cast<duration>(value);
+  };
+  insert(b);
+  return *this;
+}
+
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_size(const option& opt,
+                                         std::uint64_t Target::* member) {
+  check_type(opt, option::size_arg, option::size_arg,
+             "optionpp::binding_map::bind_size");
+
+  binding b = make_binding(opt, member_type::size_member);
+  b.size_ptr = member;
+  insert(b);
+  return *this;
+}
+
+template <typename Target>
+void optionpp::binding_map<Target>::apply(const write_log& writes,
+                                          Target& target) const {
+  writer w{*this, target};
+  writes.replay(w);
+}
+
+template <typename Target>
+void optionpp::binding_map<Target>::check_type(const option& opt,
+                                               option::arg_type type,
+                                               option::arg_type alt_type,
+                                               const std::string& fn_name) {
+  if (opt.argument_type() != type && opt.argument_type() != alt_type)
+    throw type_error{"option '" + opt.name()
+        + "' does not accept this type of argument", fn_name};
+}
+
+template <typename Target>
+typename optionpp::binding_map<Target>::binding
+optionpp::binding_map<Target>::make_binding(const option& opt,
+                                            member_type type) {
+  binding b;
+  b.long_name = opt.long_name();
+  b.short_name = opt.short_name();
+  b.type = type;
+  return b;
+}
+
+template <typename Target>
+void optionpp::binding_map<Target>::insert(const binding& b) {
+  auto it = std::lower_bound(m_bindings.begin(), m_bindings.end(), b,
+                             before);
+  if (it != m_bindings.end() && !before(b, *it))
+    *it = b;
+  else
+    m_bindings.insert(it, b);
+}
+
+template <typename Target>
+const typename optionpp::binding_map<Target>::binding*
+optionpp::binding_map<Target>::find(const option& opt,
+                                    bool flag) const noexcept {
+  utility::token_view long_name = opt.long_name_view();
+  char short_name = opt.short_name();
+
+  // Flag bindings come before argument bindings for the same option
+  auto it = std::lower_bound(m_bindings.begin(), m_bindings.end(), flag,
+                             [&](const binding& b, bool find_flag) {
+                               int result = compare(b, long_name, short_name);
+                               if (result != 0)
+                                 return result < 0;
+                               return !find_flag
+                                 && b.type == member_type::bool_member;
+                             });
+  if (it == m_bindings.end()
+      || compare(*it, long_name, short_name) != 0
+      || flag != (it->type == member_type::bool_member))
+    return nullptr;
+  return &*it;
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
@@ -0,0 +1,168 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+/**
+ * @file
+ * @brief Header file for `choice_table` class.
+ */
+
+#ifndef OPTIONPP_CHOICE_TABLE_HPP
+#define OPTIONPP_CHOICE_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace optionpp {
+
+  /**
+   * @brief Holds the set of values accepted by an option.
+   *
+   * A `choice_table` maps each allowed argument string to an integer
+   * value. It is used by `option::choices` and `option::bind_enum`
+   * to restrict an option's argument to a fixed set of words.
+   *
+   * When the table is built, a perfect hash is computed for the
+   * choices: they are divided into small buckets and each bucket is
+   * given its own hash seed, chosen so that no two choices share a
+   * slot. Looking up an argument therefore takes two hash
+   * computations and at most one string comparison, regardless of
+   * the number of choices.
+   */
+  class choice_table {
+  public:
+
+    /**
+     * @brief Type used to hold the value associated with a choice.
+     */
+    using value_type = long long;
+    /**
+     * @brief Type used to represent the size of the table.
+     */
+    using size_type = std::size_t;
+
+    /**
+     * @brief Index returned by `find` if no choice matches.
+     */
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    /**
+     * @brief Default constructor.
+     *
+     * Constructs an empty table.
+     */
+    choice_table() noexcept {}
+    /**
+     * @brief Construct from a list of names.
+     *
+     * Each choice is assigned its index in the list as its value.
+     * If a name appears more than once, only the first occurrence is
+     * used.
+     *
+     * @param names The allowed argument strings.
+     */
+    explicit choice_table(const std::vector<std::string>& names);
+    /**
+     * @brief Construct from a list of names and values.
+     *
+     * If a name appears more than once, only the first occurrence is
+     * used.
+     *
+     * @param choices Pairs of allowed argument strings and their
+     *                associated values.
+     */
+    explicit choice_table(const std::vector<std::pair<std::string,
+                                                      value_type>>& choices);
+
+    /**
+     * @brief Return the number of choices.
+     * @return Number of choices in the table.
+     */
+    size_type size() const noexcept { return m_names.size(); }
+    /**
+     * @brief Return whether the table is empty.
+     * @return True if there are no choices, false otherwise.
+     */
+    bool empty() const noexcept { return m_names.empty(); }
+
+    /**
+     * @brief Look up an argument string.
+     * @param name Argument string to search for.
+     * @return Index of the matching choice, or `npos` if not found.
+     */
+    size_type find(const std::string& name) const noexcept;
+
+    /**
+     * @brief Return the name of a choice.
+     * @param index Index of the choice.
+     * @return The argument string for the choice.
+     */
+    const std::string& name(size_type index) const { return m_names[index]; }
+    /**
+     * @brief Return the value of a choice.
+     * @param index Index of the choice.
+     * @return The value associated with the choice.
+     */
+    value_type value(size_type index) const { return m_values[index]; }
+
+    /**
+     * @brief Return all choice names joined by a separator.
+     *
+     * Names are listed in the order in which they were given.
+     *
+     * @param separator String to insert between names.
+     * @return String listing the choices.
+     */
+    std::string to_string(const std::string& separator = ", ") const;
+
+  private:
+
+    /**
+     * @brief Remove duplicate names and build the hash slots.
+     */
+    void build();
+
+    /**
+     * @brief Try to find a seed for each bucket so that every choice
+     *        hashes to a distinct slot.
+     * @param slot_count Number of slots to use (a power of two).
+     * @return True on success, false if no perfect mapping was found.
+     */
+    bool try_build(size_type slot_count);
+
+    /**
+     * @brief Hash a string.
+     * @param str String to hash.
+     * @param seed Hash seed.
+     * @return The hash value.
+     */
+    static std::uint32_t hash(const std::string& str,
+                              std::uint32_t seed) noexcept;
+
+    std::vector<std::string> m_names; //< Choice names, in order.
+    std::vector<value_type> m_values; //< Value for each choice.
+    std::vector<std::uint32_t> m_bucket_seeds; //< Slot hash seed for each bucket.
+    std::vector<std::uint32_t> m_slots; //< Hash slots holding index + 1, or 0 if unused.
+  };
+
+} // End namespace
+
+#endif
@@ -27,11 +27,17 @@
 
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace optionpp {
 
   /**
    * @brief Base class for library exceptions.
+   *
+   * The constructors of this class and its subclasses take their
+   * strings by value, so a temporary string is moved into the
+   * exception rather than copied.
    */
   class error : public std::logic_error {
   public:
@@ -40,8 +46,8 @@ namespace optionpp {
      * @param msg Description of the error.
      * @param fn_name Name of the function in which error occurred.
      */
-    error(const std::string& msg, const std::string& fn_name)
-      : logic_error(msg), m_function{fn_name} {}
+    error(std::string msg, std::string fn_name)
+      : logic_error(msg), m_function{std::move(fn_name)} {}
 
     /**
      * @brief Return the name of function that threw the exception.
@@ -63,8 +69,8 @@ namespace optionpp {
      * @param msg Description of the error.
      * @param fn_name Name of the function in which error occurred.
      */
-    out_of_range(const std::string& msg, const std::string& fn_name)
-      : error(msg, fn_name) {}
+    out_of_range(std::string msg, std::string fn_name)
+      : error(std::move(msg), std::move(fn_name)) {}
   };
 
   /**
@@ -77,9 +83,8 @@ namespace optionpp {
      * @param msg Description of the error.
      * @param fn_name Name of the function in which error occurred.
      */
-    bad_dereference(const std::string& msg,
-                    const std::string& fn_name)
-      : error(msg, fn_name) {}
+    bad_dereference(std::string msg, std::string fn_name)
+      : error(std::move(msg), std::move(fn_name)) {}
   };
 
   /**
@@ -92,8 +97,78 @@ namespace optionpp {
      * @param msg Description of the error.
      * @param fn_name Name of the function in which error occurred.
      */
-    type_error(const std::string& msg, const std::string& fn_name)
-      : error(msg, fn_name) {}
+    type_error(std::string msg, std::string fn_name)
+      : error(std::move(msg), std::move(fn_name)) {}
+  };
+
+  /**
+   * @brief Exception class indicating an invalid option.
+   */
+  class parse_error : public error {
+  public:
+    /**
+     * @brief Constructor.
+     * @param msg String describing the error.
+     * @param fn_name Name of the function that threw the exception.
+     * @param option Name of the option that triggered the error (if
+     *               any).
+     * @param suggestions Valid options similar to `option`, if it
+     *                    was not recognized.
+     */
+    parse_error(std::string msg, std::string fn_name,
+                std::string option = "",
+                std::vector<std::string> suggestions = {})
+      : error(std::move(msg), std::move(fn_name)),
+        m_option{std::move(option)},
+        m_suggestions{std::move(suggestions)} {}
+
+    /**
+     * @brief Return option name.
+     * @return Option that triggered the error, if any.
+     */
+    const std::string& option() const noexcept { return m_option; }
+
+    /**
+     * @brief Return suggested replacements for the option.
+     *
+     * When an unknown long option is given, these are the known
+     * options with the most similar names, closest first. They are
+     * also listed in the error message.
+     *
+     * @return Suggested option names, with their prefixes.
+     */
+    const std::vector<std::string>& suggestions() const noexcept {
+      return m_suggestions;
+    }
+
+  private:
+    std::string m_option; //< Option that triggered the error.
+    std::vector<std::string> m_suggestions; //< Similar valid options.
+  };
+
+  /**
+   * @brief Exception class indicating that a file could not be read.
+   */
+  class file_error : public error {
+  public:
+    /**
+     * @brief Constructor.
+     * @param msg String describing the error.
+     * @param fn_name Name of the function that threw the exception.
+     * @param path Path of the file that could not be read.
+     */
+    file_error(std::string msg, std::string fn_name, std::string path)
+      : error(std::move(msg), std::move(fn_name)),
+        m_path{std::move(path)} {}
+
+    /**
+     * @brief Return the file path.
+     * @return Path of the file that could not be read.
+     */
+    const std::string& path() const noexcept { return m_path; }
+
+  private:
+    std::string m_path; //< Path of the file.
   };
 
 } // End namespace
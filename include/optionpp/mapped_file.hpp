@@ -0,0 +1,149 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+
+/**
+ * @file
+ * @brief Header file for `mapped_file` class.
+ */
+
+#ifndef OPTIONPP_MAPPED_FILE_HPP
+#define OPTIONPP_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace optionpp {
+
+  /**
+   * @brief Provides read-only access to the contents of a file.
+   *
+   * The file is mapped into memory where the operating system
+   * supports it (using `mmap` on POSIX systems and file mappings on
+   * Windows), so its contents can be read without being copied.
+   * On other systems, the file is read into a buffer.
+   *
+   * A `mapped_file` can be moved but not copied. The mapping is
+   * released when the object is destroyed.
+   */
+  class mapped_file {
+  public:
+
+    /**
+     * @brief Uniquely identifies a file on the system.
+     *
+     * Two paths that refer to the same file (through links, for
+     * example) have the same identifier.
+     */
+    struct file_id {
+      std::uint64_t device{0}; //< Device or volume containing the file.
+      std::uint64_t index{0}; //< File number within the device.
+
+      /**
+       * @brief Compare two identifiers for equality.
+       * @param other Identifier to compare with.
+       * @return True if both identify the same file.
+       */
+      bool operator==(const file_id& other) const noexcept {
+        return device == other.device && index == other.index;
+      }
+      /**
+       * @brief Compare two identifiers for inequality.
+       * @param other Identifier to compare with.
+       * @return True if the identifiers refer to different files.
+       */
+      bool operator!=(const file_id& other) const noexcept {
+        return !(*this == other);
+      }
+    };
+
+    /**
+     * @brief Default constructor.
+     *
+     * Constructs an object that does not refer to any file.
+     */
+    mapped_file() noexcept {}
+    /**
+     * @brief Open and map a file.
+     * @param path Path of the file to open.
+     * @throw file_error If the file cannot be opened or read.
+     */
+    explicit mapped_file(const std::string& path);
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    /**
+     * @brief Move constructor.
+     * @param other The `mapped_file` to move from.
+     */
+    mapped_file(mapped_file&& other) noexcept { swap(other); }
+    /**
+     * @brief Move assignment operator.
+     * @param other The `mapped_file` to move from.
+     * @return Reference to the current instance.
+     */
+    mapped_file& operator=(mapped_file&& other) noexcept {
+      mapped_file temp{std::move(other)};
+      swap(temp);
+      return *this;
+    }
+    /**
+     * @brief Destructor.
+     */
+    ~mapped_file() { close(); }
+
+    /**
+     * @brief Exchange contents with another `mapped_file`.
+     * @param other The `mapped_file` to swap with.
+     */
+    void swap(mapped_file& other) noexcept;
+
+    /**
+     * @brief Release the file.
+     */
+    void close() noexcept;
+
+    /**
+     * @brief Return a pointer to the contents of the file.
+     * @return Pointer to the first byte of the file.
+     */
+    const char* data() const noexcept { return m_data; }
+    /**
+     * @brief Return the size of the file.
+     * @return Number of bytes in the file.
+     */
+    std::size_t size() const noexcept { return m_size; }
+    /**
+     * @brief Return the identifier of the file.
+     * @return Identifier of the file.
+     */
+    const file_id& id() const noexcept { return m_id; }
+
+  private:
+    const char* m_data{""}; //< Contents of the file.
+    std::size_t m_size{0}; //< Size of the file in bytes.
+    file_id m_id; //< Identifier of the file.
+    bool m_mapped{false}; //< True if `m_data` must be unmapped.
+    bool m_allocated{false}; //< True if `m_data` must be deleted.
+  };
+
+} // End namespace
+
+#endif
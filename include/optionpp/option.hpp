@@ -25,7 +25,18 @@
 #ifndef OPTIONPP_OPTION_HPP
 #define OPTIONPP_OPTION_HPP
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <new>
 #include <string>
+#include <utility>
+#include <vector>
+#include <optionpp/arg_callback.hpp>
+#include <optionpp/choice_table.hpp>
+#include <optionpp/utility.hpp>
 
 namespace optionpp {
 
@@ -55,6 +66,14 @@ namespace optionpp {
    * A description and a group name can be set as well. These are used
    * in generating the program help text.
    *
+   * The long name, argument name and description are normally copied
+   * into the option. They may instead be given as a
+   * `utility::static_string`, such as a string literal with the
+   * `_static` suffix from `optionpp::literals` or a string from a
+   * `utility::string_pool`, in which case the option keeps only a
+   * view of the text, and copying the option copies no text. The
+   * text must then outlive the option.
+   *
    * Note that many of the methods in the class return a reference to
    * the current instance. This allows for convenient chaining. For
    * example, to create an option with a long name of `help`, a short
@@ -73,7 +92,11 @@ namespace optionpp {
     enum arg_type { string_arg, //< Indicates a string argument.
                     int_arg, //< Indicates an integer argument.
                     uint_arg, //< Indicates an unsigned int argument.
-                    double_arg //< Indicates a floating-point argument.
+                    double_arg, //< Indicates a floating-point argument.
+                    custom_arg, //< Indicates an argument handled by a user callback.
+                    enum_arg, //< Indicates an argument from a fixed set of enumeration values.
+                    duration_arg, //< Indicates a time duration argument.
+                    size_arg //< Indicates a byte-size argument.
     };
 
     /**
@@ -119,6 +142,22 @@ namespace optionpp {
       m_short_name = short_name;
       return *this;
     }
+    /**
+     * @brief Sets the long and short name for the option.
+     *
+     * The option refers to the text of `long_name` instead of copying
+     * it.
+     *
+     * @param long_name Long name form for the option.
+     * @param short_name Single-character short option name.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& name(utility::static_string long_name,
+                 char short_name = '\0') noexcept {
+      m_long_name = long_name;
+      m_short_name = short_name;
+      return *this;
+    }
 
     /**
      * @brief Returns a name for the option.
@@ -130,7 +169,7 @@ namespace optionpp {
      */
     std::string name() const noexcept {
       if (!m_long_name.empty())
-        return m_long_name;
+        return m_long_name.view();
       else if (m_short_name != '\0')
         return std::string{m_short_name};
       else
@@ -147,10 +186,30 @@ namespace optionpp {
       return *this;
     }
     /**
-     * @brief Retrieve the option's long name.
+     * @brief Set the option's long name without copying it.
+     *
+     * The option refers to the text of `name` instead of copying it.
+     *
+     * @param name The long name to use.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& long_name(utility::static_string name) noexcept {
+      m_long_name = name;
+      return *this;
+    }
+    /**
+     * @brief Retrieve a copy of the option's long name.
      * @return The long name for the option.
      */
-    const std::string& long_name() const noexcept { return m_long_name; }
+    std::string long_name() const { return m_long_name.str(); }
+    /**
+     * @brief Retrieve the option's long name without copying it.
+     * @return View of the long name, valid while the option is
+     *         unchanged.
+     */
+    utility::token_view long_name_view() const noexcept {
+      return m_long_name.view();
+    }
 
     /**
      * @brief Set the option's short name.
@@ -179,14 +238,38 @@ namespace optionpp {
      */
     option& argument(const std::string& name,
                      bool required = true);
+    /**
+     * @brief Set the option's argument information.
+     *
+     * The option refers to the text of `name` instead of copying it.
+     *
+     * @param name Name of the argument (usually all uppercase).
+     * @param required True if the option is mandatory, false if it
+     *                 is optional.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& argument(utility::static_string name,
+                     bool required = true) noexcept {
+      m_arg_name = name;
+      m_arg_required = required;
+      return *this;
+    }
     /**
      * @brief Retrieve the option's argument name.
      *
      * This is the name that is used in the help text.
      *
-     * @return The name of the argument.
+     * @return A copy of the name of the argument.
+     */
+    std::string argument_name() const { return m_arg_name.str(); }
+    /**
+     * @brief Retrieve the option's argument name without copying it.
+     * @return View of the argument name, valid while the option is
+     *         unchanged.
      */
-    const std::string& argument_name() const noexcept { return m_arg_name; }
+    utility::token_view argument_name_view() const noexcept {
+      return m_arg_name.view();
+    }
     /**
      * @brief Return true if the argument is mandatory.
      * @return True if the argument is required and false if it is optional.
@@ -251,16 +334,169 @@ namespace optionpp {
      * @return Reference to the current instance (for chaining calls).
      */
     option& bind_double(double* var) noexcept;
+    /**
+     * @brief Designates that the option should take a time duration
+     * argument which should be stored in `*var`.
+     *
+     * The argument consists of numbers with unit suffixes, such as
+     * `250ms` or `1h30m`; see `utility::parse_duration` for the
+     * accepted syntax. If `var` has a coarser resolution than the
+     * argument, the value is truncated.
+     *
+     * If an invalid duration is given, then the `parser` will throw a
+     * `parse_error` exception.
+     *
+     * @tparam Rep Arithmetic type used by the duration (usually
+     *             deduced).
+     * @tparam Period Tick period of the duration (usually deduced).
+     * @param var Address of duration to receive argument value.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    template <typename Rep, typename Period>
+    option& bind_duration(std::chrono::duration<Rep, Period>* var) noexcept;
+    /**
+     * @brief Designates that the option should take a byte-size
+     * argument which should be stored in `*var`.
+     *
+     * The argument consists of a number with an optional unit
+     * suffix, such as `512k` or `4GiB`; see `utility::parse_size` for
+     * the accepted syntax.
+     *
+     * If an invalid size is given, then the `parser` will throw a
+     * `parse_error` exception.
+     *
+     * @param var Address of integer to receive the number of bytes.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& bind_size(std::uint64_t* var) noexcept;
+    /**
+     * @brief Designates that the option's argument should be passed
+     *        to a user-supplied converter.
+     *
+     * The converter is called by the `parser` with the argument
+     * string, and is responsible for converting and storing the
+     * value. It should return false (or throw a `parse_error`) if the
+     * argument is invalid, in which case the `parser` will throw a
+     * `parse_error` exception. For example:
+     * ```
+     * std::vector<std::string> includes;
+     * opt.bind_custom([&](const std::string& arg) {
+     *   includes.push_back(arg);
+     *   return true;
+     * });
+     * ```
+     *
+     * Small callables are stored without allocating memory; see
+     * `arg_callback`.
+     *
+     * In a transactional parse (see `parser::set_transactional`),
+     * the converter is not called until the writes are committed, and
+     * its result is then ignored. Use the overload that takes a
+     * variable when arguments should be rejected while parsing.
+     *
+     * @param converter Callable taking the argument string and
+     *                  returning true if it was accepted.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& bind_custom(arg_callback converter) noexcept;
+    /**
+     * @brief Designates that the option's argument should be
+     *        converted by a user-supplied converter and stored in
+     *        `*var`.
+     *
+     * The converter is called by the `parser` as
+     * `converter(arg, value)`, where `value` is a value-initialized
+     * `T`, and should return false (or throw a `parse_error`) if the
+     * argument is invalid. Otherwise `value` is moved into `*var`.
+     * For example:
+     * ```
+     * std::pair<int, int> size;
+     * opt.bind_custom(&size, [](const std::string& arg,
+     *                           std::pair<int, int>& value) {
+     *   return std::sscanf(arg.c_str(), "%dx%d",
+     *                      &value.first, &value.second) == 2;
+     * });
+     * ```
+     *
+     * Unlike a converter that stores the value itself, this can take
+     * part in a transactional parse (see
+     * `parser::set_transactional`): the argument is converted while
+     * parsing, and `*var` is only assigned when the writes are
+     * committed.
+     *
+     * @tparam T Type of the variable (usually deduced). It must be
+     *           default constructible and move assignable.
+     * @tparam Converter Type of the converter (usually deduced).
+     * @param var Address of variable to receive argument value.
+     * @param converter Callable taking the argument string and a
+     *                  `T&`, and returning true if the argument was
+     *                  accepted.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    template <typename T, typename Converter>
+    option& bind_custom(T* var, Converter converter);
+    /**
+     * @brief Designates that the option should take one of a fixed
+     *        set of words as its argument, and store the
+     *        corresponding enumeration value in `*var`.
+     *
+     * For example:
+     * ```
+     * enum class mode { fast, safe, paranoid };
+     * mode m{mode::safe};
+     * opt.bind_enum(&m, {{"fast", mode::fast},
+     *                    {"safe", mode::safe},
+     *                    {"paranoid", mode::paranoid}});
+     * ```
+     *
+     * If any other argument is given, then the `parser` will throw a
+     * `parse_error` exception listing the valid choices. The choices
+     * are also listed in the help text.
+     *
+     * @tparam E Enumeration (or integer) type (usually deduced).
+     * @param var Address of the variable to receive the value.
+     * @param values Pairs of allowed arguments and their values.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    template <typename E>
+    option& bind_enum(E* var,
+                      std::initializer_list<std::pair<std::string, E>> values);
+    /**
+     * @brief Restrict the option's argument to a fixed set of words.
+     *
+     * If any other argument is given, then the `parser` will throw a
+     * `parse_error` exception listing the valid choices. The choices
+     * are also listed in the help text.
+     *
+     * This may be combined with `bind_string` to store the chosen
+     * word.
+     *
+     * @param values The allowed arguments.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& choices(const std::vector<std::string>& values);
+    /**
+     * @brief Retrieve the set of allowed arguments.
+     * @return The `choice_table` holding the allowed arguments (empty
+     *         if any argument is allowed).
+     */
+    const choice_table& choices() const noexcept { return m_choices; }
     /**
      * @brief Returns true if a variable has been bound to the
      *        option's argument.
      *
      * Note that binding a boolean value to the option does not affect
-     * the return value of this method.
+     * the return value of this method. A converter set with
+     * `bind_custom` counts as a bound variable.
      *
      * @return True if a variable is bound, false otherwise.
      */
-    bool has_bound_argument_variable() const noexcept { return m_bound_variable; }
+    bool has_bound_argument_variable() const noexcept {
+      if (m_arg_type == custom_arg)
+        return static_cast<bool>(m_converter);
+      else
+        return m_bound_variable;
+    }
     /**
      * @brief Writes to the bound boolean variable that was specified
      * in `bind_bool`.
@@ -283,6 +519,15 @@ namespace optionpp {
      * @param value Value to write to the bound string variable.
      */
     void write_string(const std::string& value) const;
+    /**
+     * @brief Writes to the bound string variable that was specified
+     * in `bind_string`.
+     *
+     * @throw type_error If no string variable was bound.
+     * @param value Characters to write to the bound string variable.
+     * @param size Number of characters.
+     */
+    void write_string(const char* value, std::size_t size) const;
     /**
      * @brief Writes to the bound integer variable that was specified
      * in `bind_int`.
@@ -319,6 +564,190 @@ namespace optionpp {
      * @param value Value to write to the bound double variable.
      */
     void write_double(double value) const;
+    /**
+     * @brief Writes to the bound duration variable that was specified
+     * in `bind_duration`.
+     *
+     * This method should not be called unless a duration variable was
+     * previously bound. You can use the `argument_type` method to
+     * check what type of argument the option expects.
+     *
+     * @throw type_error If no duration variable was bound.
+     * @param value Value to write to the bound duration variable.
+     */
+    void write_duration(std::chrono::nanoseconds value) const;
+    /**
+     * @brief Writes to the bound byte-size variable that was
+     * specified in `bind_size`.
+     *
+     * This method should not be called unless a byte-size variable
+     * was previously bound. You can use the `argument_type` method to
+     * check what type of argument the option expects.
+     *
+     * @throw type_error If no byte-size variable was bound.
+     * @param value Value to write to the bound variable.
+     */
+    void write_size(std::uint64_t value) const;
+    /**
+     * @brief Passes an argument to the converter that was specified
+     * in `bind_custom`.
+     *
+     * This method should not be called unless a converter was
+     * previously bound. You can use the `argument_type` method to
+     * check what type of argument the option expects.
+     *
+     * @throw type_error If no converter was bound.
+     * @param value Argument to pass to the converter.
+     * @return The result of the converter: true if the argument was
+     *         accepted and false otherwise.
+     */
+    bool write_custom(const std::string& value) const;
+    /**
+     * @brief Converts an argument with the converter that was
+     * specified in `bind_custom`, without storing it yet.
+     *
+     * If a variable was bound together with the converter, the
+     * converted value is placed in `commit`, a callback that moves
+     * it into the variable when called (with any argument).
+     * Otherwise the converter stores its result itself, so it cannot
+     * be called without storing: it is not called, `commit` is left
+     * unchanged, and the argument should later be passed to
+     * `write_custom`.
+     *
+     * @throw type_error If no converter was bound.
+     * @param value Argument to convert.
+     * @param commit Receives the callback that stores the value.
+     * @return True if the argument was accepted and false otherwise.
+     */
+    bool stage_custom(const std::string& value, arg_callback& commit) const;
+    /**
+     * @brief Writes to the bound enumeration variable that was
+     * specified in `bind_enum`.
+     *
+     * This method should not be called unless an enumeration variable
+     * was previously bound. You can use the `argument_type` method to
+     * check what type of argument the option expects.
+     *
+     * @throw type_error If no enumeration variable was bound.
+     * @throw out_of_range If `index` is not a valid choice index.
+     * @param index Index of the choice (as returned by
+     *              `choice_table::find`) whose value should be
+     *              written.
+     */
+    void write_enum(choice_table::size_type index) const;
+
+    /**
+     * @brief Set the smallest value allowed for a numeric argument.
+     *
+     * The bound is checked by the `parser` when it converts an
+     * integer, unsigned integer, floating-point, byte-size, or
+     * duration argument. If the argument is smaller, then the
+     * `parser` will throw a `parse_error` exception. The bound is
+     * also shown in the help text. Bounds on durations are given in
+     * seconds.
+     *
+     * @param value Minimum value.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& min_value(double value) noexcept {
+      m_min_value = value;
+      return *this;
+    }
+    /**
+     * @brief Retrieve the smallest value allowed for the argument.
+     * @return Minimum value, or negative infinity if there is none.
+     */
+    double min_value() const noexcept { return m_min_value; }
+
+    /**
+     * @brief Set the largest value allowed for a numeric argument.
+     *
+     * The bound is checked by the `parser` when it converts an
+     * integer, unsigned integer, floating-point, byte-size, or
+     * duration argument. If the argument is larger, then the
+     * `parser` will throw a `parse_error` exception. The bound is
+     * also shown in the help text. Bounds on durations are given in
+     * seconds.
+     *
+     * @param value Maximum value.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& max_value(double value) noexcept {
+      m_max_value = value;
+      return *this;
+    }
+    /**
+     * @brief Retrieve the largest value allowed for the argument.
+     * @return Maximum value, or infinity if there is none.
+     */
+    double max_value() const noexcept { return m_max_value; }
+
+    /**
+     * @brief Set the smallest and largest values allowed for a
+     *        numeric argument.
+     *
+     * This is equivalent to calling `min_value` and `max_value`.
+     *
+     * @param min Minimum value.
+     * @param max Maximum value.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& range(double min, double max) noexcept {
+      return min_value(min).max_value(max);
+    }
+
+    /**
+     * @brief Set the step between allowed values for a numeric
+     *        argument.
+     *
+     * If a step is set, the argument must be equal to the minimum
+     * value (or to zero, if there is no minimum) plus a whole
+     * multiple of the step. Otherwise, the `parser` will throw a
+     * `parse_error` exception. The step is also shown in the help
+     * text. Steps between durations are given in seconds.
+     *
+     * @param value Step between allowed values, or zero for no step.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& step(double value) noexcept {
+      m_step = value;
+      return *this;
+    }
+    /**
+     * @brief Retrieve the step between allowed values.
+     * @return The step, or zero if there is none.
+     */
+    double step() const noexcept { return m_step; }
+
+    /**
+     * @brief Set a validator for the option's argument.
+     *
+     * Before an argument is converted and written to a bound
+     * variable, the `parser` will pass it to the validator. If the
+     * validator returns false, the `parser` throws a `parse_error`
+     * exception. The validator may also throw a `parse_error` itself
+     * to provide a more specific message.
+     *
+     * Small callables are stored without allocating memory; see
+     * `arg_callback`.
+     *
+     * @param fn Callable taking the argument string and returning
+     *           true if it is valid.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& validator(arg_callback fn) noexcept {
+      m_validator = std::move(fn);
+      return *this;
+    }
+    /**
+     * @brief Check an argument against the option's validator.
+     *
+     * If no validator was set, every argument is considered valid.
+     *
+     * @param value Argument to check.
+     * @return True if the argument is valid, false otherwise.
+     */
+    bool validate(const std::string& value) const { return m_validator(value); }
 
     /**
      * @brief Set the option description.
@@ -333,23 +762,237 @@ namespace optionpp {
       return *this;
     }
     /**
-     * @brief Retrieve the option description.
+     * @brief Set the option description without copying it.
+     *
+     * The option refers to the text of `desc` instead of copying it.
+     *
+     * @param desc Description of the option.
+     * @return Reference to the current instance (for chaining calls).
+     */
+    option& description(utility::static_string desc) noexcept {
+      m_desc = desc;
+      return *this;
+    }
+    /**
+     * @brief Retrieve a copy of the option description.
      * @return Option description, used in generating program help text.
      */
-    const std::string& description() const noexcept { return m_desc; }
+    std::string description() const { return m_desc.str(); }
+    /**
+     * @brief Retrieve the option description without copying it.
+     * @return View of the description, valid while the option is
+     *         unchanged.
+     */
+    utility::token_view description_view() const noexcept {
+      return m_desc.view();
+    }
 
   private:
-    std::string m_long_name; //< The long name.
+    /**
+     * @brief Text held by an option.
+     *
+     * The text is either owned by the option, or borrowed from a
+     * `utility::static_string`.
+     */
+    class text {
+    public:
+      text() noexcept : m_owned{} {}
+      text(std::string str) noexcept : m_owned{std::move(str)} {}
+      text(utility::static_string str) noexcept
+        : m_borrowed{str}, m_is_borrowed{true} {}
+      text(const text& other) : m_is_borrowed{other.m_is_borrowed} {
+        if (m_is_borrowed)
+          new (&m_borrowed) utility::static_string{other.m_borrowed};
+        else
+          new (&m_owned) std::string{other.m_owned};
+      }
+      text(text&& other) noexcept : m_is_borrowed{other.m_is_borrowed} {
+        if (m_is_borrowed)
+          new (&m_borrowed) utility::static_string{other.m_borrowed};
+        else
+          new (&m_owned) std::string{std::move(other.m_owned)};
+      }
+      ~text() { destroy(); }
+
+      text& operator=(text other) noexcept {
+        destroy();
+        m_is_borrowed = other.m_is_borrowed;
+        if (m_is_borrowed)
+          new (&m_borrowed) utility::static_string{other.m_borrowed};
+        else
+          new (&m_owned) std::string{std::move(other.m_owned)};
+        return *this;
+      }
+
+      /**
+       * @brief Return a view of the text.
+       * @return View of the owned or borrowed text.
+       */
+      utility::token_view view() const noexcept {
+        if (m_is_borrowed)
+          return m_borrowed;
+        return m_owned;
+      }
+      /**
+       * @brief Return whether the text is empty.
+       * @return True if there is no text.
+       */
+      bool empty() const noexcept { return view().empty(); }
+      /**
+       * @brief Return a copy of the text.
+       * @return The text as a `std::string`.
+       */
+      std::string str() const { return view(); }
+
+    private:
+      /**
+       * @brief Destroy whichever member is active.
+       */
+      void destroy() noexcept {
+        if (!m_is_borrowed)
+          m_owned.~basic_string();
+      }
+
+      union {
+        std::string m_owned; //< Owned text.
+        utility::static_string m_borrowed; //< Borrowed text.
+      };
+      bool m_is_borrowed{false}; //< True if `m_borrowed` is active.
+    };
+
+    /**
+     * @brief Converter for a variable bound in `bind_custom`.
+     * @tparam T Type of the variable.
+     * @tparam Converter Type of the user's converter.
+     */
+    template <typename T, typename Converter>
+    struct typed_converter {
+      T* var; //< Variable to receive the value.
+      Converter convert; //< The user's converter.
+
+      bool operator()(const std::string& arg) const {
+        T value{};
+        if (!convert(arg, value))
+          return false;
+        *var = std::move(value);
+        return true;
+      }
+    };
+
+    /**
+     * @brief Converted value waiting to be stored.
+     * @tparam T Type of the variable.
+     */
+    template <typename T>
+    struct staged_value {
+      T* var; //< Variable to receive the value.
+      T value; //< The converted value.
+
+      bool operator()(const std::string&) {
+        *var = std::move(value);
+        return true;
+      }
+    };
+
+    /**
+     * @brief Convert an argument for `stage_custom`.
+     * @tparam T Type of the variable.
+     * @tparam Converter Type of the user's converter.
+     * @param converter Callback holding a `typed_converter`.
+     * @param arg Argument to convert.
+     * @param commit Receives a `staged_value` holding the result.
+     * @return True if the argument was accepted.
+     */
+    template <typename T, typename Converter>
+    static bool stage(const arg_callback& converter, const std::string& arg,
+                      arg_callback& commit);
+
+    text m_long_name; //< The long name.
     char m_short_name{'\0'}; //< The short name.
-    std::string m_desc; //< Description of option (for help text).
+    text m_desc; //< Description of option (for help text).
 
-    std::string m_arg_name; //< The name of the argument (for help text).
+    text m_arg_name; //< The name of the argument (for help text).
     bool m_arg_required{false}; //< True if argument is mandatory, false if optional.
     arg_type m_arg_type{string_arg}; //< Type of argument that is expected.
     bool* m_is_option_set = nullptr; //< Pointer to value to hold whether the option was set.
     void* m_bound_variable = nullptr; //< Pointer to hold argument value.
+    arg_callback m_converter; //< Converter for `custom_arg` arguments.
+    arg_callback m_validator; //< Validator for arguments.
+    choice_table m_choices; //< Allowed arguments, if restricted.
+    double m_min_value{-std::numeric_limits<double>::infinity()}; //< Smallest allowed numeric argument.
+    double m_max_value{std::numeric_limits<double>::infinity()}; //< Largest allowed numeric argument.
+    double m_step{0.0}; //< Step between allowed numeric arguments, or zero.
+    void (*m_value_writer)(void*, long long) = nullptr; //< Stores a value in a bound enumeration or duration variable.
+    bool (*m_stager)(const arg_callback&, const std::string&,
+                     arg_callback&) = nullptr; //< Converts a custom argument without storing it, if a variable is bound.
   };
 
 } // End namespace
 
+
+/* Implementation */
+
+template <typename E>
+optionpp::option&
+optionpp::option::bind_enum(E* var,
+                            std::initializer_list<std::pair<std::string, E>> values) {
+  std::vector<std::pair<std::string, choice_table::value_type>> table;
+  table.reserve(values.size());
+  for (const auto& v : values)
+    table.emplace_back(v.first, static_cast<choice_table::value_type>(v.second));
+
+  if (var && m_arg_name.empty()) {
+    m_arg_name = std::string{"CHOICE"};
+    m_arg_required = true;
+  }
+  m_arg_type = enum_arg;
+  m_bound_variable = var;
+  m_choices = choice_table{table};
+  m_value_writer = [](void* dest, long long value) {
+    *static_cast<E*>(dest) = static_cast<E>(value);
+  };
+  return *this;
+}
+
+template <typename Rep, typename Period>
+optionpp::option&
+optionpp::option::bind_duration(std::chrono::duration<Rep, Period>* var) noexcept {
+  using duration = std::chrono::duration<Rep, Period>;
+
+  if (var && m_arg_name.empty()) {
+    m_arg_name = std::string{"DURATION"};
+    m_arg_required = true;
+  }
+  m_arg_type = duration_arg;
+  m_bound_variable = var;
+  m_value_writer = [](void* dest, long long value) {
+    *static_cast<duration*>(dest)
+      = std::chrono::duration_cast<duration>(std::chrono::nanoseconds{value});
+  };
+  return *this;
+}
+
+template <typename T, typename Converter>
+optionpp::option&
+optionpp::option::bind_custom(T* var, Converter converter) {
+  if (!var)
+    return bind_custom(arg_callback{});
+
+  using converter_type = typed_converter<T, Converter>;
+  bind_custom(arg_callback{converter_type{var, std::move(converter)}});
+  m_stager = &stage<T, Converter>;
+  return *this;
+}
+
+template <typename T, typename Converter>
+bool optionpp::option::stage(const arg_callback& converter,
+                             const std::string& arg, arg_callback& commit) {
+  const auto* conv = converter.target<typed_converter<T, Converter>>();
+  T value{};
+  if (!conv->convert(arg, value))
+    return false;
+  commit = arg_callback{staged_value<T>{conv->var, std::move(value)}};
+  return true;
+}
+
 #endif
@@ -25,10 +25,12 @@
 #ifndef OPTIONPP_OPTION_GROUP_HPP
 #define OPTIONPP_OPTION_GROUP_HPP
 
+#include <cstddef>
 #include <string>
 #include <utility>
 #include <vector>
 #include <optionpp/option.hpp>
+#include <optionpp/utility.hpp>
 
 namespace optionpp {
 
@@ -78,7 +80,7 @@ namespace optionpp {
      * @brief Construct empty named group.
      * @param name Name of the group.
      */
-    option_group(const std::string& name) : m_name{name} {}
+    option_group(std::string name) : m_name{std::move(name)} {}
     /**
      * @brief Construct from a sequence.
      *
@@ -93,9 +95,8 @@ namespace optionpp {
      *             sequence.
      */
     template <typename InputIt>
-    option_group(const std::string& name,
-                 InputIt first, InputIt last)
-      : m_name{name}, m_options{first, last} {}
+    option_group(std::string name, InputIt first, InputIt last)
+      : m_name{std::move(name)}, m_options{first, last} {}
 
     /**
      * @brief Returns the name of the group.
@@ -122,6 +123,37 @@ namespace optionpp {
       m_options.push_back(opt);
       return m_options.back();
     }
+    /**
+     * @brief Add a program option to the group.
+     *
+     * The `option` is moved into the group, so callbacks and choices
+     * it holds are not copied.
+     *
+     * @param opt The `option` to add.
+     * @return Reference to the inserted `option`, for chaining.
+     */
+    option& add_option(option&& opt) {
+      m_options.push_back(std::move(opt));
+      return m_options.back();
+    }
+    /**
+     * @brief Construct a program option in place in the group.
+     *
+     * The arguments are passed to an `option` constructor. For
+     * example:
+     * ```
+     * group.emplace_option("verbose", 'v', "Show verbose output.");
+     * ```
+     *
+     * @tparam Args Constructor argument types (usually deduced).
+     * @param args Arguments for the `option` constructor.
+     * @return Reference to the inserted `option`, for chaining.
+     */
+    template <typename... Args>
+    option& emplace_option(Args&&... args) {
+      m_options.emplace_back(std::forward<Args>(args)...);
+      return m_options.back();
+    }
     /**
      * @brief Construct and add a program option to the group.
      * @param long_name Long name for the option.
@@ -149,6 +181,16 @@ namespace optionpp {
      */
     bool empty() const noexcept { return m_options.empty(); }
 
+    /**
+     * @brief Reserve room for a number of options.
+     *
+     * Adding options up to the reserved count will not reallocate the
+     * `option` container.
+     *
+     * @param count Number of options to make room for.
+     */
+    void reserve(size_type count) { m_options.reserve(count); }
+
     /**
      * @brief Return an `iterator` to the first option in the group.
      * @return An `iterator` pointing to the first `option`.
@@ -224,7 +266,7 @@ namespace optionpp {
      * @param long_name Long name of the option.
      * @return Iterator pointing to the option or `end` if not found.
      */
-    iterator find(const std::string& long_name);
+    iterator find(utility::token_view long_name);
 
     /**
      * @brief Search for an option in the group.
@@ -235,7 +277,7 @@ namespace optionpp {
      * @param long_name Long name of the option.
      * @return Iterator pointing to the option or `end` if not found.
      */
-    const_iterator find(const std::string& long_name) const;
+    const_iterator find(utility::token_view long_name) const;
 
     /**
      * @brief Search for an option in the group.
@@ -278,7 +320,19 @@ namespace optionpp {
      * @return The matching `option`, or a newly created one if it
      *         didn't already exist.
      */
-    option& operator[](const std::string long_name);
+    option& operator[](const std::string& long_name);
+    /**
+     * @brief Subscript operator.
+     *
+     * Returns the specified option or creates it if it doesn't exist.
+     * A newly created option refers to the text of `long_name` rather
+     * than a copy (see `option::long_name`).
+     *
+     * @param long_name Long name for the option.
+     * @return The matching `option`, or a newly created one if it
+     *         didn't already exist.
+     */
+    option& operator[](utility::static_string long_name);
     /**
      * @brief Subscript operator.
      *
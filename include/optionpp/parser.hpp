@@ -25,12 +25,21 @@
 #ifndef OPTIONPP_PARSER_HPP
 #define OPTIONPP_PARSER_HPP
 
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <functional>
 #include <initializer_list>
 #include <iosfwd>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
+#include <optionpp/binding_map.hpp>
+#include <optionpp/error.hpp>
+#include <optionpp/mapped_file.hpp>
 #include <optionpp/option_group.hpp>
 #include <optionpp/parser_result.hpp>
 #include <optionpp/utility.hpp>
@@ -42,32 +51,6 @@
  */
 namespace optionpp {
 
-  /**
-   * @brief Exception class indicating an invalid option.
-   */
-  class parse_error : public error {
-  public:
-    /**
-     * @brief Constructor.
-     * @param msg String describing the error.
-     * @param fn_name Name of the function that threw the exception.
-     * @param option Name of the option that triggered the error (if
-     *               any).
-     */
-    parse_error(const std::string msg, const std::string fn_name,
-                const std::string option = "")
-      : error(msg, fn_name), m_option{option} {}
-
-    /**
-     * @brief Return option name.
-     * @return Option that triggered the error, if any.
-     */
-    const std::string& option() const noexcept { return m_option; }
-
-  private:
-    std::string m_option; //< Option that triggered the error.
-  };
-
   /**
    * @brief Parses program options.
    *
@@ -157,6 +140,34 @@ namespace optionpp {
      * @return Reference to the inserted `option`, for chaining.
      */
     option& add_option(const option& opt = option{});
+    /**
+     * @brief Add a program option.
+     *
+     * The `option` is moved into the parser, so callbacks and
+     * choices it holds are not copied.
+     *
+     * @param opt The `option` to add.
+     * @return Reference to the inserted `option`, for chaining.
+     */
+    option& add_option(option&& opt);
+
+    /**
+     * @brief Construct a program option in place.
+     *
+     * The arguments are passed to an `option` constructor, and the
+     * option is added to the nameless default group. For example:
+     * ```
+     * opt_parser.emplace_option("verbose", 'v', "Show verbose output.");
+     * ```
+     *
+     * @tparam Args Constructor argument types (usually deduced).
+     * @param args Arguments for the `option` constructor.
+     * @return Reference to the inserted `option`, for chaining.
+     */
+    template <typename... Args>
+    option& emplace_option(Args&&... args) {
+      return group("").emplace_option(std::forward<Args>(args)...);
+    }
 
     /**
      * @brief Add a program option.
@@ -209,6 +220,10 @@ namespace optionpp {
      * often used as a way to specify standard input instead of a
      * filename).
      *
+     * If an unknown long option is given, the `parse_error` lists
+     * known options with similar names (see
+     * `parse_error::suggestions`).
+     *
      * @param first An iterator pointing to the first argument.
      * @param last An iterator pointing to one past the last argument.
      * @param ignore_first If true, the first argument (typically the
@@ -258,6 +273,159 @@ namespace optionpp {
      */
     parser_result parse(const std::string& cmd_line, bool ignore_first = false) const;
 
+    /**
+     * @brief Parse command-line arguments from a sequence of strings,
+     *        storing option values in a per-call destination.
+     *
+     * Works like `parse(InputIt, InputIt, bool)`, except that values
+     * are stored in the members of `target` given by `bindings`
+     * instead of in the variables bound to the options. Variables
+     * bound to the options are never written, and converters set with
+     * `option::bind_custom` are never called: custom arguments reach
+     * `target` as unconverted strings.
+     *
+     * Parsing does not modify the parser or the `binding_map`, so a
+     * single parser and map may be used by many threads at once as
+     * long as each thread has its own `target`. Validators set on the
+     * options must then be safe to call concurrently.
+     *
+     * @tparam InputIt Input iterator type.
+     * @tparam Target Structure type receiving the parsed values.
+     * @param first An iterator pointing to the first argument.
+     * @param last An iterator pointing to one past the last argument.
+     * @param bindings Map from options to members of `target`.
+     * @param target Structure to receive the values.
+     * @param ignore_first If true, the first argument (typically the
+     *                     program filename) is ignored.
+     * @return `parser_result` containing the parsed data.
+     * @throw parse_error If an invalid option is entered or a
+     *                    mandatory argument is missing. In that case
+     *                    `target` is left unchanged.
+     * @see binding_map
+     */
+    template <typename InputIt, typename Target>
+    parser_result parse(InputIt first, InputIt last,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first = true) const;
+
+    /**
+     * @brief Parse command-line arguments from a string, storing
+     *        option values in a per-call destination.
+     *
+     * Works like `parse(const std::string&, bool)`, except that
+     * values are stored in the members of `target` given by
+     * `bindings`. See
+     * `parse(InputIt, InputIt, const binding_map<Target>&, Target&, bool)`
+     * for details.
+     *
+     * @tparam Target Structure type receiving the parsed values.
+     * @param cmd_line The command-line arguments to parse.
+     * @param bindings Map from options to members of `target`.
+     * @param target Structure to receive the values.
+     * @param ignore_first If true, the first argument is ignored.
+     * @return `parser_result` containing the parsed data.
+     * @throw parse_error If an invalid option is entered or a
+     *                    mandatory argument is missing. In that case
+     *                    `target` is left unchanged.
+     * @see binding_map
+     */
+    template <typename Target>
+    parser_result parse(const std::string& cmd_line,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first = false) const;
+
+    /**
+     * @brief Parse command-line arguments read from a stream.
+     *
+     * This behaves like `parse(const std::string&, bool)`, but the
+     * text is read from the stream in fixed-size chunks and each
+     * argument is parsed as soon as it has been read. The whole input
+     * is never held in memory at once, so very large argument lists
+     * can be read from files or pipes.
+     *
+     * @param in The stream to read from.
+     * @param ignore_first If true, the first argument is ignored.
+     * @return `parser_result` containing the parsed data.
+     * @throw parse_error If an invalid option is entered or a
+     *                    mandatory argument is missing.
+     * @throw file_error If the stream reports a read error.
+     * @see parser_result
+     * @see utility::tokenizer
+     */
+    parser_result parse(std::istream& in, bool ignore_first = false) const;
+
+    /**
+     * @brief Parse command-line arguments read from a file
+     *        descriptor.
+     *
+     * This behaves like `parse(std::istream&, bool)`, but reads from
+     * a file descriptor (such as a pipe or standard input) until the
+     * end of the input. The descriptor is not closed.
+     *
+     * @param fd The file descriptor to read from.
+     * @param ignore_first If true, the first argument is ignored.
+     * @return `parser_result` containing the parsed data.
+     * @throw parse_error If an invalid option is entered or a
+     *                    mandatory argument is missing.
+     * @throw file_error If reading fails.
+     * @see parser_result
+     */
+    parser_result parse_fd(int fd, bool ignore_first = false) const;
+
+    /**
+     * @brief Parse many independent command lines in parallel.
+     *
+     * Each element of the range is parsed as a separate command line,
+     * as if by `parse(const std::string&, bool)`. The lines are
+     * divided among a pool of threads: each thread repeatedly claims
+     * the next small block of lines that has not yet been taken, so
+     * that threads which finish early keep working until every line
+     * has been parsed.
+     *
+     * No bound variables are written. Instead, every line is parsed
+     * in transactional mode, so the writes for each line are recorded
+     * in its own `parser_result` (see `parser_result::pending_writes`)
+     * and can be applied later with `parser_result::commit`.
+     *
+     * The returned entries are in the same order as the input lines,
+     * regardless of the number of threads. An exception thrown while
+     * parsing a line does not stop the batch; it is stored in the
+     * corresponding `batch_entry`. For example:
+     * ```
+     * auto entries = opt_parser.parse_batch(lines.begin(), lines.end());
+     * for (std::size_t i = 0; i < entries.size(); ++i) {
+     *   if (!entries[i].ok())
+     *     std::cerr << "error on line " << i + 1 << '\n';
+     * }
+     * ```
+     *
+     * The parser must not be modified while the batch is running.
+     * Validators, and converters set with `option::bind_custom`
+     * together with a variable, may be called from several threads
+     * at once; the converted values are held in the entries until
+     * committed. A converter without a variable stores its result
+     * itself, so it is not called while parsing: the argument is
+     * recorded in the line's `parser_result`, and the converter is
+     * called when that result is committed.
+     *
+     * @tparam ForwardIt The iterator type (usually deduced). The
+     *                   elements should be convertible to
+     *                   `std::string`.
+     * @param first An iterator pointing to the first line.
+     * @param last An iterator pointing to one past the last line.
+     * @param thread_count Number of threads to use, including the
+     *                     calling thread. If zero, the number of
+     *                     hardware threads is used.
+     * @param ignore_first If true, the first argument of each line is
+     *                     ignored.
+     * @return A `batch_entry` for each line.
+     * @see parser_result
+     */
+    template <typename ForwardIt>
+    std::vector<batch_entry> parse_batch(ForwardIt first, ForwardIt last,
+                                         unsigned thread_count = 0,
+                                         bool ignore_first = false) const;
+
     /**
      * @brief Change special strings used by the parser.
      *
@@ -281,6 +449,108 @@ namespace optionpp {
                             const std::string& end_indicator = "",
                             const std::string& equals = "");
 
+    /**
+     * @brief Enable or disable transactional parsing.
+     *
+     * Normally, the `parse` methods write to bound variables as soon
+     * as each option is parsed, so if a `parse_error` is thrown
+     * partway through, some variables will already have been
+     * modified.
+     *
+     * In transactional mode, no bound variables are written, and no
+     * converter that stores its own result is called, during parsing.
+     * Instead, the writes are recorded in the returned
+     * `parser_result` (see `parser_result::pending_writes`), and are
+     * only applied when `parser_result::commit` is called. If parsing
+     * fails, nothing is written.
+     *
+     * Arguments are converted and checked while parsing, so the
+     * commit itself cannot fail. A converter set with
+     * `option::bind_custom` together with a variable converts during
+     * parsing and only assigns the variable on commit. A converter
+     * without a variable stores its result itself, so it is not
+     * called until the commit, and its result is then ignored; use a
+     * validator (`option::validator`) to reject such arguments while
+     * parsing. For example:
+     * ```
+     * opt_parser.set_transactional(true);
+     * auto result = opt_parser.parse(cmd_line); // May throw
+     * std::lock_guard<std::mutex> lock{config_mutex};
+     * result.commit();
+     * ```
+     *
+     * @param enabled True to enable transactional mode.
+     */
+    void set_transactional(bool enabled) noexcept { m_transactional = enabled; }
+
+    /**
+     * @brief Return whether transactional parsing is enabled.
+     * @return True if bound variables are only written on commit.
+     * @see set_transactional
+     */
+    bool is_transactional() const noexcept { return m_transactional; }
+
+    /**
+     * @brief Enable or disable response files.
+     *
+     * When response files are enabled, a command-line argument of
+     * the form `@file` is replaced by the arguments contained in the
+     * named file. Arguments in the file are separated by whitespace
+     * and may be quoted or escaped in the same way as for
+     * `utility::split`. A response file may itself contain `@file`
+     * arguments; relative paths are interpreted relative to the
+     * current working directory. Arguments that follow the
+     * end-of-options indicator (`--` by default) are not expanded.
+     *
+     * The file is mapped into memory and tokenized in place. Tokens
+     * are passed to the parser as they are found. For example:
+     * ```
+     * opt_parser.set_response_files(true);
+     * auto result = opt_parser.parse(argc, argv); // Expands @args.txt
+     * ```
+     *
+     * If a response file cannot be read or includes itself, directly
+     * or indirectly, a `parse_error` is thrown.
+     *
+     * @param enabled True to expand response files.
+     */
+    void set_response_files(bool enabled) noexcept { m_response_files = enabled; }
+
+    /**
+     * @brief Return whether response files are enabled.
+     * @return True if `@file` arguments are expanded.
+     * @see set_response_files
+     */
+    bool has_response_files() const noexcept { return m_response_files; }
+
+    /**
+     * @brief Set the quoting rules used to split strings and streams
+     *        into arguments.
+     *
+     * This affects `parse(const std::string&, bool)`,
+     * `parse(std::istream&, bool)`, `parse_fd`, and response files.
+     * By default (`utility::shell_dialect::generic`), arguments are
+     * split at the delimiters given to `set_custom_strings`, and
+     * either kind of quote may be used, with backslash escapes. The
+     * other dialects follow the rules of a POSIX shell or of
+     * `CommandLineToArgvW` on Windows, and always split at spaces and
+     * tabs (and newlines for POSIX); see `utility::tokenizer` for
+     * details. Arguments given as a sequence are not affected.
+     *
+     * @param dialect The quoting rules to use.
+     */
+    void set_dialect(utility::shell_dialect dialect) noexcept {
+      m_dialect = dialect;
+    }
+
+    /**
+     * @brief Return the quoting rules used to split strings and
+     *        streams into arguments.
+     * @return The current dialect.
+     * @see set_dialect
+     */
+    utility::shell_dialect dialect() const noexcept { return m_dialect; }
+
     /**
      * @brief Sorts the groups by name.
      *
@@ -310,6 +580,21 @@ namespace optionpp {
      */
     option& operator[](const std::string& long_name);
 
+    /**
+     * @brief Subscript operator.
+     *
+     * Returns the specified option or creates it if it doesn't exist.
+     * A newly created option refers to the text of `long_name` rather
+     * than a copy (see `option::long_name`). Looking up or creating
+     * an option this way allocates no memory unless the option
+     * container has to grow (see `option_group::reserve`).
+     *
+     * @param long_name Long name for the option.
+     * @return Matching option or newly created one if it didn't
+     *         already exist.
+     */
+    option& operator[](utility::static_string long_name);
+
     /**
      * @brief Subscript operator.
      *
@@ -342,6 +627,15 @@ namespace optionpp {
      * the total level of indentation, counted from the leftmost
      * character of the line.
      *
+     * The rendered text is cached for each set of layout parameters,
+     * so printing the same help again only writes a stored string.
+     * The cache is cleared by `add_option`, `group`, `operator[]`,
+     * `sort_groups`, `sort_options` and `set_custom_strings`. An
+     * option changed through a reference that was obtained before
+     * the help was printed is not noticed; call one of these
+     * functions again (for example `operator[]`) before printing.
+     * Printing is safe to do from several threads at once.
+     *
      * @param os Output stream.
      * @param max_line_length Text will be wrapped so that each line
      *                        is at most this many characters.
@@ -360,6 +654,193 @@ namespace optionpp {
                              int desc_first_line_indent = 30,
                              int desc_multiline_indent = 32) const;
 
+    /**
+     * @brief Information for the header and leading sections of a man
+     *        page.
+     *
+     * Only `name` is required. Empty strings are left out of the
+     * page.
+     */
+    struct man_page_info {
+      std::string name; //< Program name, as in the NAME section.
+      int section{1}; //< Manual section number.
+      std::string date; //< Date of the last change to the page.
+      std::string source; //< Program source, such as "MyProgram 1.0".
+      std::string manual; //< Title of the manual.
+      std::string summary; //< One-line description for the NAME section.
+      std::string synopsis; //< Arguments following the name in SYNOPSIS.
+      std::string description; //< Text of the DESCRIPTION section.
+    };
+
+    /**
+     * @brief Write a man page for the program.
+     *
+     * The page is written in `roff` with the `man` macros. It has
+     * NAME, SYNOPSIS and DESCRIPTION sections filled in from `info`,
+     * and an OPTIONS section listing each option, with a subsection
+     * for each named group. Option names, arguments and constraints
+     * appear as they do in `print_help`. If `info.synopsis` is empty,
+     * it defaults to `[OPTION]...`.
+     *
+     * A blank line in a description starts a new paragraph; other
+     * line breaks are kept. Characters that are special to `roff`
+     * are escaped.
+     *
+     * The page is written as the options are visited, without being
+     * rendered to a string first.
+     *
+     * @param os Output stream.
+     * @param info Text for the header and leading sections.
+     * @return The output stream that was initially given.
+     */
+    std::ostream& print_man_page(std::ostream& os,
+                                 const man_page_info& info) const;
+
+    /**
+     * @brief Write a Markdown list of the program options.
+     *
+     * Each option becomes a list item with its names in code spans,
+     * followed by its description. Named groups get a heading of the
+     * given level. Characters that Markdown would treat as formatting
+     * are escaped in names and descriptions.
+     *
+     * @param os Output stream.
+     * @param heading_level Level of group headings, from 1 to 6.
+     * @return The output stream that was initially given.
+     */
+    std::ostream& print_markdown(std::ostream& os,
+                                 int heading_level = 2) const;
+
+    /**
+     * @brief Write a JSON description of the program options.
+     *
+     * The output is a JSON object holding the parser's option
+     * prefixes, end-of-options marker and argument separator, and an
+     * array of groups. Each group has a name and an array of options.
+     * An option object has `long_name`, `short_name` and
+     * `description` members when these are set, and an `argument`
+     * object if it takes an argument. The argument object gives the
+     * argument's `name`, whether it is `required`, its `type` (one of
+     * `string`, `int`, `uint`, `double`, `custom`, `enum`,
+     * `duration` and `size`), and any `choices`, `minimum`,
+     * `maximum` and `step`.
+     *
+     * This is enough to check a command line without the program
+     * itself, for example from a script that launches it. Strings
+     * are written as they are stored, so they should be valid UTF-8.
+     *
+     * @param os Output stream.
+     * @return The output stream that was initially given.
+     */
+    std::ostream& print_json(std::ostream& os) const;
+
+    /**
+     * @brief Find the completions of a partly typed argument.
+     *
+     * If `previous` is an option that takes an argument which was
+     * not attached to it, the completions are the option's choices
+     * (see `option::choices`) that begin with `prefix`. An option
+     * whose argument is optional is completed instead if `prefix`
+     * starts with an option prefix.
+     *
+     * Otherwise, a `prefix` beginning with the long option prefix is
+     * completed to the long options that begin with it, or, if it
+     * contains an argument separator, to the option's choices, with
+     * the option and separator in front. A `prefix` that is the
+     * short option prefix, or any nonempty beginning of the long
+     * option prefix, is completed to every option. Anything else has
+     * no completions, and is probably best completed as a file name.
+     *
+     * Long option names are found in a sorted index that is built
+     * the first time it is needed, so the time taken depends on the
+     * length of `prefix` and the number of matches rather than on the
+     * number of options.
+     *
+     * @param prefix Argument being typed.
+     * @param previous Argument before it, if any.
+     * @return Complete arguments beginning with `prefix`. Long
+     *         options come in sorted order; choices come in the order
+     *         they were given.
+     */
+    std::vector<std::string> complete(const std::string& prefix,
+                                      const std::string& previous = "") const;
+
+    /**
+     * @brief Shells for which completion scripts can be written.
+     */
+    enum class completion_shell {
+      bash, //< GNU Bash.
+      zsh, //< Z shell.
+      fish //< Friendly interactive shell.
+    };
+
+    /**
+     * @brief Write a shell completion script for a program.
+     *
+     * The script completes the program's arguments by running the
+     * program again with `--__complete`, followed by the previous
+     * argument and the argument being completed. The program should
+     * pass its command line to `run_completion` as early as possible
+     * to answer. If there are no completions, the shell completes
+     * file names instead.
+     *
+     * Since the options are not written into the script, it does not
+     * need to be regenerated when they change. For Bash, source the
+     * script from `~/.bashrc` or install it in the `bash-completion`
+     * directory. For Zsh, install it as `_program` in a directory on
+     * `$fpath`. For Fish, install it as `program.fish` in
+     * `~/.config/fish/completions`.
+     *
+     * @param os Output stream.
+     * @param shell Shell that will run the script.
+     * @param program Name of the program's command.
+     * @return The output stream that was initially given.
+     */
+    static std::ostream& print_completion_script(std::ostream& os,
+                                                 completion_shell shell,
+                                                 const std::string& program);
+
+    /**
+     * @brief Answer a completion request from a shell script.
+     *
+     * If the first argument after the program name is `--__complete`,
+     * the results of `complete`, given the argument after that as
+     * `previous` and the next one as `prefix`, are written to
+     * standard output, one per line, and true is returned. The
+     * program should then exit without doing anything else.
+     * Otherwise, nothing is written and false is returned.
+     *
+     * Since this runs each time a completion is requested, call it
+     * right after the options are added, before any other startup
+     * work:
+     * ```
+     * parser p;
+     * // ...add options...
+     * if (p.run_completion(argc, argv))
+     *   return 0;
+     * ```
+     *
+     * @param argc Number of command-line arguments.
+     * @param argv Command-line arguments, starting with the program
+     *             name.
+     * @return True if a completion request was answered.
+     * @see print_completion_script
+     */
+    bool run_completion(int argc, char* argv[]) const;
+    /**
+     * @brief Answer a completion request from a shell script.
+     *
+     * As `run_completion(int, char*[])`, but writes the completions
+     * to the given stream.
+     *
+     * @param argc Number of command-line arguments.
+     * @param argv Command-line arguments, starting with the program
+     *             name.
+     * @param os Output stream.
+     * @return True if a completion request was answered.
+     */
+    bool run_completion(int argc, char* argv[], std::ostream& os) const;
+
 
   private:
 
@@ -401,11 +882,11 @@ namespace optionpp {
      * @param long_name Long name for the option.
      * @return Pointer to the option, or `nullptr` if not found.
      */
-    option* find_option(const std::string& long_name);
+    option* find_option(utility::token_view long_name);
     /**
      * @copydoc find_option
      */
-    const option* find_option(const std::string& long_name) const;
+    const option* find_option(utility::token_view long_name) const;
 
     /**
      * @brief Search for an option by short name.
@@ -461,17 +942,41 @@ namespace optionpp {
         && !is_short_option_group(argument);
     }
 
+    /**
+     * @brief Find the option waiting for an argument after a given
+     *        argument.
+     * @param argument Argument to check.
+     * @return The option whose argument should follow `argument`, or
+     *         `nullptr` if there is none.
+     */
+    const option* option_awaiting_argument(const std::string& argument) const;
+
     /**
      * @brief Write to an option's bound argument variable.
      *
-     * The argument will be converted to the appropriate type. If it
-     * cannot be converted, an exception is raised. If no variable was
-     * bound to the option, then nothing is done.
+     * The argument is first checked by the option's validator, if
+     * any. It will then be converted to the appropriate type. If it
+     * is invalid or cannot be converted, an exception is raised. If
+     * no variable was bound to the option, then nothing is written.
      *
      * @param entry Object holding parsed result information for the
      *              option, including the argument to assign.
+     * @param writes Log through which the value should be written.
      */
-    void write_option_argument(const parsed_entry& entry) const;
+    void write_option_argument(const parsed_entry& entry,
+                               write_log& writes) const;
+
+    /**
+     * @brief Check a converted numeric argument against the range
+     *        constraints of its option.
+     * @param opt The option the argument was given to.
+     * @param value The converted argument.
+     * @param opt_name Option name as it was given on the command line.
+     * @throw parse_error If the value is outside the allowed range or
+     *                    is not a valid step.
+     */
+    void check_range(const option& opt, double value,
+                     const std::string& opt_name) const;
 
     /**
      * @brief Represents the type of a command-line argument.
@@ -513,13 +1018,428 @@ namespace optionpp {
                                   const std::string& argument, bool has_arg,
                                   parser_result& result, cl_arg_type& type) const;
 
+    /**
+     * @brief Process a single command-line token.
+     *
+     * This is the body of the parsing loop: the token is either
+     * taken as the argument to the preceding option, or parsed as a
+     * new option or non-option argument.
+     *
+     * @param token Token to process.
+     * @param result Current `parser_result`. New entries will be added
+     *               to the end.
+     * @param type Type of the previous token on input; set to the
+     *             type of `token` on output.
+     * @throw parse_error Thrown if option is invalid or missing a
+     *                    required argument.
+     * @see cl_arg_type
+     */
+    void parse_token(const std::string& token, parser_result& result,
+                     cl_arg_type& type) const;
+    /**
+     * @copybrief parse_token
+     *
+     * This version keeps track of the response files currently being
+     * read, in order to detect cycles.
+     *
+     * @param token Token to process.
+     * @param result Current `parser_result`. New entries will be added
+     *               to the end.
+     * @param type Type of the previous token on input; set to the
+     *             type of the last token processed on output.
+     * @param includes Identifiers of the response files being read.
+     * @throw parse_error Thrown if option is invalid or missing a
+     *                    required argument, or if a response file
+     *                    cannot be read.
+     */
+    void parse_token(const std::string& token, parser_result& result,
+                     cl_arg_type& type,
+                     std::vector<mapped_file::file_id>& includes) const;
+
+    /**
+     * @brief Parse the arguments contained in a response file.
+     * @param path Path to the response file.
+     * @param result Current `parser_result`. New entries will be added
+     *               to the end.
+     * @param type Type of the previous token on input; set to the
+     *             type of the last token in the file on output.
+     * @param includes Identifiers of the response files being read.
+     * @throw parse_error Thrown if the file cannot be read, includes
+     *                    itself, or contains invalid options.
+     */
+    void parse_response_file(const std::string& path, parser_result& result,
+                             cl_arg_type& type,
+                             std::vector<mapped_file::file_id>& includes) const;
+
+    /**
+     * @brief Check that the last option was not left without its
+     *        mandatory argument.
+     * @param result Current `parser_result`.
+     * @param type Type of the last token.
+     * @throw parse_error Thrown if an argument is missing.
+     */
+    void finish_parse(const parser_result& result, cl_arg_type type) const;
+
+    /**
+     * @brief Parse command-line arguments from a sequence of strings.
+     *
+     * This implements the `parse(InputIt, InputIt, ...)` overloads.
+     *
+     * @param first An iterator pointing to the first argument.
+     * @param last An iterator pointing to one past the last argument.
+     * @param ignore_first If true, the first argument is ignored.
+     * @param result Result to add the parsed data to. Its write log
+     *               should already be set up.
+     * @throw parse_error If an invalid option is entered or a
+     *                    mandatory argument is missing.
+     */
+    template <typename InputIt>
+    void parse_range(InputIt first, InputIt last, bool ignore_first,
+                     parser_result& result) const;
+
+    /**
+     * @brief Parse command-line arguments from a string.
+     *
+     * This implements the `parse(const std::string&, ...)` overloads.
+     *
+     * @param cmd_line The command-line arguments to parse.
+     * @param ignore_first If true, the first argument is ignored.
+     * @param result Result to add the parsed data to. Its write log
+     *               should already be set up.
+     * @throw parse_error If an invalid option is entered or a
+     *                    mandatory argument is missing.
+     */
+    void parse_string(const std::string& cmd_line, bool ignore_first,
+                      parser_result& result) const;
+
+    /**
+     * @brief Run a task over a range of indices on a pool of threads.
+     *
+     * The range `[0, count)` is divided into small blocks, which the
+     * threads claim one at a time until none are left. Returns once
+     * every block has been processed.
+     *
+     * @param count Number of indices.
+     * @param thread_count Number of threads to use, or zero to use the
+     *                     number of hardware threads.
+     * @param task Function called with the beginning and end of each
+     *             block. It must not throw.
+     */
+    static void run_batch(std::size_t count, unsigned thread_count,
+                          const std::function<void(std::size_t,
+                                                   std::size_t)>& task);
+
+    /**
+     * @brief Write the help text without using the cache.
+     *
+     * This implements `print_help`, and takes the same parameters.
+     *
+     * @param os Output stream.
+     * @param max_line_length Maximum line length.
+     * @param group_indent Indentation of group names.
+     * @param option_indent Indentation of option names.
+     * @param desc_first_line_indent Indentation of the first line of
+     *                               each description.
+     * @param desc_multiline_indent Indentation of descriptions after
+     *                              the first line.
+     */
+    void render_help(std::ostream& os, int max_line_length,
+                     int group_indent, int option_indent,
+                     int desc_first_line_indent,
+                     int desc_multiline_indent) const;
+
+    /**
+     * @brief Rendered help text, stored by layout parameters.
+     *
+     * Entries are shared pointers so that a thread can keep writing
+     * a text after another thread has replaced it. Copying a parser
+     * does not copy its cache.
+     */
+    class help_cache {
+    public:
+      /**
+       * @brief Layout parameters given to `print_help`.
+       */
+      using key_type = std::array<int, 5>;
+
+      /**
+       * @brief Default constructor.
+       */
+      help_cache() noexcept {}
+      /**
+       * @brief Copy constructor. The new cache is empty.
+       */
+      help_cache(const help_cache&) noexcept {}
+      /**
+       * @brief Copy assignment. Clears the cache.
+       * @return Reference to the current instance.
+       */
+      help_cache& operator=(const help_cache&) noexcept {
+        clear();
+        return *this;
+      }
+
+      /**
+       * @brief Look up the text for a layout.
+       * @param key Layout parameters.
+       * @return The text, or `nullptr` if it is not cached.
+       */
+      std::shared_ptr<const std::string> find(const key_type& key) const;
+      /**
+       * @brief Store the text for a layout.
+       *
+       * If the cache is full, the oldest entry is replaced.
+       *
+       * @param key Layout parameters.
+       * @param text Rendered text.
+       */
+      void insert(const key_type& key,
+                  std::shared_ptr<const std::string> text);
+      /**
+       * @brief Remove all entries.
+       */
+      void clear() noexcept;
+
+    private:
+      /**
+       * @brief Maximum number of layouts that are remembered.
+       */
+      static constexpr std::size_t max_entries = 4;
+
+      mutable std::mutex m_mutex; //< Guards the entries.
+      std::vector<std::pair<key_type,
+                            std::shared_ptr<const std::string>>> m_entries; //< Cached text, oldest first.
+    };
+
+    /**
+     * @brief Index of option names for suggestions and completion.
+     *
+     * When an unknown long option is found, `suggest` looks for known
+     * names within a small edit distance. These names are kept in a
+     * BK-tree, which is only built the first time a suggestion is
+     * needed, so successful parses do not pay for it. `complete`
+     * uses a separate sorted list of the names, built the first time
+     * it is called. Both are discarded whenever the help cache is,
+     * and rebuilt when next needed.
+     *
+     * The index may be used by several threads at once. Copying a
+     * parser does not copy its index.
+     */
+    class name_index {
+    public:
+      /**
+       * @brief Default constructor.
+       */
+      name_index() noexcept {}
+      /**
+       * @brief Copy constructor. The new index is empty.
+       */
+      name_index(const name_index&) noexcept {}
+      /**
+       * @brief Copy assignment. Clears the index.
+       * @return Reference to the current instance.
+       */
+      name_index& operator=(const name_index&) noexcept {
+        clear();
+        return *this;
+      }
+
+      /**
+       * @brief Find the long option names closest to a given name.
+       *
+       * Names are compared with `utility::edit_distance`. The
+       * distance allowed grows with the length of `name`, from one
+       * edit for names of up to four characters to three edits for
+       * names of nine or more, and must be less than the length of
+       * `name`.
+       *
+       * @param groups Option groups from which to build the index if
+       *               it has not been built yet.
+       * @param name Unknown option name, without a prefix.
+       * @return At most `max_suggestions` names, closest first, and
+       *         in alphabetical order among those at the same
+       *         distance.
+       */
+      std::vector<std::string> suggest(const group_container& groups,
+                                       const std::string& name) const;
+      /**
+       * @brief Find the long option names that begin with a prefix.
+       *
+       * The names are found by binary search, so the time taken
+       * depends only on the length of `prefix` and the number of
+       * matches, apart from a logarithmic factor.
+       *
+       * @param groups Option groups from which to build the index if
+       *               it has not been built yet.
+       * @param prefix Beginning of the name, without an option prefix.
+       * @return The matching names, in sorted order.
+       */
+      std::vector<std::string> complete(const group_container& groups,
+                                        const std::string& prefix) const;
+      /**
+       * @brief Return the short option names.
+       * @param groups Option groups from which to build the index if
+       *               it has not been built yet.
+       * @return Each short option name, in sorted order.
+       */
+      std::string short_names(const group_container& groups) const;
+      /**
+       * @brief Discard the index.
+       */
+      void clear() noexcept;
+
+    private:
+      /**
+       * @brief Maximum number of names returned by `suggest`.
+       */
+      static constexpr std::size_t max_suggestions = 3;
+
+      /**
+       * @brief BK-tree of long option names.
+       */
+      struct tree;
+      /**
+       * @brief Sorted long and short option names.
+       */
+      struct sorted_names;
+
+      /**
+       * @brief Return the sorted names, building them if needed.
+       * @param groups Option groups from which to build the names.
+       * @return The sorted names.
+       */
+      std::shared_ptr<const sorted_names>
+      get_sorted(const group_container& groups) const;
+
+      mutable std::mutex m_mutex; //< Guards the pointers.
+      mutable std::shared_ptr<const tree> m_tree; //< BK-tree, or `nullptr` if not built.
+      mutable std::shared_ptr<const sorted_names> m_sorted; //< Sorted names, or `nullptr` if not built.
+    };
+
+    /**
+     * @brief Output iterator that parses each token written to it.
+     *
+     * Used by `parse(const std::string&, bool)` to feed tokens from
+     * `utility::split_view` directly to `parse_token`.
+     */
+    class token_sink;
+
+    /**
+     * @brief Return a tokenizer for the current delimiters and
+     *        dialect.
+     * @return A new tokenizer.
+     */
+    utility::tokenizer make_tokenizer() const;
+
+    friend class incremental_parser;
+
     group_container m_groups; //< The container of option groups.
 
-    std::string m_delims{" \t\n\r"}; //< Delimiters used to separate command-line arguments.
+    utility::char_class m_delims{" \t\n\r"}; //< Delimiters used to separate command-line arguments.
     std::string m_short_option_prefix{"-"}; //< String that indicates a group of short option names.
     std::string m_long_option_prefix{"--"}; //< String that indicates a long option name.
     std::string m_end_of_options{"--"}; //< String that marks the end of the program options.
     std::string m_equals{"="}; //< String used to specify an explicit argument to an option.
+    bool m_transactional{false}; //< True if bound variables are only written on commit.
+    bool m_response_files{false}; //< True if `@file` arguments are expanded.
+    utility::shell_dialect m_dialect{utility::shell_dialect::generic}; //< Quoting rules for strings and streams.
+    mutable help_cache m_help_cache; //< Help text rendered by `print_help`.
+    name_index m_names; //< Option names for suggestions and completion.
+  };
+
+  /**
+   * @brief Parses command-line arguments supplied one at a time.
+   *
+   * `parser::parse` needs the whole command line up front. An
+   * `incremental_parser` instead keeps the parsing state between
+   * calls, so tokens can be pushed as they arrive, for example from a
+   * socket or an interactive prompt:
+   * ```
+   * incremental_parser inc{opt_parser};
+   * std::string token;
+   * while (read_token(token))
+   *   inc.feed(token);
+   * parser_result result = inc.finish();
+   * ```
+   *
+   * Each token is processed once, when it is fed, so the cost of
+   * `feed` does not depend on how much input came before. The result
+   * is the same as calling `parser::parse(InputIt, InputIt, bool)` on
+   * the whole sequence, and bound variables are written in the same
+   * way (deferred if the parser is transactional).
+   *
+   * The `parser` must outlive the `incremental_parser` and must not be
+   * modified while it is in use.
+   */
+  class incremental_parser {
+  public:
+    /**
+     * @brief Constructor.
+     * @param parser Parser holding the program options.
+     * @param ignore_first If true, the first token (typically the
+     *                     program filename) is ignored.
+     */
+    explicit incremental_parser(const parser& parser,
+                                bool ignore_first = false);
+
+    /**
+     * @brief Parse the next command-line token.
+     *
+     * If an exception is thrown, the partial result is left as it
+     * was when the error was found; call `reset` before reusing the
+     * object.
+     *
+     * @param token The token to parse.
+     * @throw parse_error If the token is an invalid option or has an
+     *                    invalid argument.
+     */
+    void feed(const std::string& token);
+
+    /**
+     * @brief Finish parsing and return the result.
+     *
+     * The object is then reset, so that it can be used to parse
+     * another command line.
+     *
+     * @return `parser_result` containing the parsed data.
+     * @throw parse_error If the last option is missing a mandatory
+     *                    argument.
+     */
+    parser_result finish();
+
+    /**
+     * @brief Discard the input so far and start again.
+     * @param ignore_first If true, the next token is ignored.
+     */
+    void reset(bool ignore_first = false);
+
+    /**
+     * @brief Return the data parsed so far.
+     *
+     * The last entry may still be waiting for its argument; see
+     * `awaiting_argument`.
+     *
+     * @return `parser_result` containing the data parsed so far.
+     */
+    const parser_result& result() const noexcept { return m_result; }
+
+    /**
+     * @brief Return whether the last option is waiting for an
+     *        argument.
+     * @return True if the next token may be taken as the argument of
+     *         the last option.
+     */
+    bool awaiting_argument() const noexcept {
+      return m_type == parser::cl_arg_type::arg_required
+        || m_type == parser::cl_arg_type::arg_optional;
+    }
+
+  private:
+    const parser* m_parser; //< Parser holding the program options.
+    parser_result m_result; //< Data parsed so far.
+    parser::cl_arg_type m_type{parser::cl_arg_type::non_option}; //< Type of the previous token.
+    bool m_skip_next; //< True if the next token should be ignored.
+    std::vector<mapped_file::file_id> m_includes; //< Response files being read.
   };
 
   /**
@@ -550,54 +1470,83 @@ namespace optionpp {
 template <typename InputIt>
 optionpp::parser_result
 optionpp::parser::parse(InputIt first, InputIt last, bool ignore_first) const {
+  parser_result result{};
+  result.pending_writes().set_deferred(m_transactional);
+  parse_range(first, last, ignore_first, result);
+
+  return result;
+}
+
+template <typename InputIt, typename Target>
+optionpp::parser_result
+optionpp::parser::parse(InputIt first, InputIt last,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first) const {
+  // Record every write, then store the ones that are bound in target
+  parser_result result{};
+  result.pending_writes().set_deferred(true);
+  result.pending_writes().set_record_unbound(true);
+  parse_range(first, last, ignore_first, result);
+  bindings.apply(result.pending_writes(), target);
+  result.pending_writes().clear();
+
+  return result;
+}
+
+template <typename Target>
+optionpp::parser_result
+optionpp::parser::parse(const std::string& cmd_line,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first) const {
+  parser_result result{};
+  result.pending_writes().set_deferred(true);
+  result.pending_writes().set_record_unbound(true);
+  parse_string(cmd_line, ignore_first, result);
+  bindings.apply(result.pending_writes(), target);
+  result.pending_writes().clear();
+
+  return result;
+}
+
+template <typename InputIt>
+void optionpp::parser::parse_range(InputIt first, InputIt last,
+                                   bool ignore_first,
+                                   parser_result& result) const {
   if (ignore_first && first != last)
     ++first;
 
   InputIt it{first};
 
-  parser_result result{};
   cl_arg_type prev_type{cl_arg_type::non_option};
-  while (it != last) {
-    const std::string& arg{*it};
-
-    // If we are expecting a standalone option argument...
-    if (prev_type == cl_arg_type::arg_required
-        || prev_type == cl_arg_type::arg_optional) {
-      // ...then this token should be a non-option; but if the
-      // argument is required we'll interpret it that way regardless
-      if (is_non_option(arg)
-          || prev_type == cl_arg_type::arg_required) {
-        auto& arg_info = result.back();
-        arg_info.argument = arg;
-        arg_info.original_text.push_back(' ');
-        arg_info.original_text += arg;
-        prev_type = cl_arg_type::non_option;
-        if (arg_info.opt_info)
-          write_option_argument(arg_info);
-      } else { // Found an option, reset type and continue
-        prev_type = cl_arg_type::non_option;
-        continue; // Continue without incrementing 'it' in order to reevaluate current token
-      }
-    } else if (prev_type == cl_arg_type::end_indicator) { // Ignore options
-      parsed_entry arg_info;
-      arg_info.original_text = arg;
-      arg_info.is_option = false;
-      result.push_back(std::move(arg_info));
-    } else { // Regular argument
-      parse_argument(arg, result, prev_type);
-    }
+  for (; it != last; ++it)
+    parse_token(*it, result, prev_type);
+  finish_parse(result, prev_type);
+}
 
-    ++it;
-  }
+template <typename ForwardIt>
+std::vector<optionpp::batch_entry>
+optionpp::parser::parse_batch(ForwardIt first, ForwardIt last,
+                              unsigned thread_count, bool ignore_first) const {
+  std::vector<ForwardIt> lines;
+  for (; first != last; ++first)
+    lines.push_back(first);
 
-  // Make sure we don't still need a mandatory argument
-  if (prev_type == cl_arg_type::arg_required) {
-    const auto& opt_name = result.back().original_text;
-    throw parse_error{"option '" + opt_name + "' requires an argument",
-        "optionpp::parser::parse", opt_name};
-  }
+  std::vector<batch_entry> entries(lines.size());
+  run_batch(lines.size(), thread_count,
+            [&](std::size_t begin, std::size_t end) {
+              for (std::size_t i = begin; i != end; ++i) {
+                try {
+                  parser_result result{};
+                  result.pending_writes().set_deferred(true);
+                  parse_string(*lines[i], ignore_first, result);
+                  entries[i].result = std::move(result);
+                } catch (...) {
+                  entries[i].error = std::current_exception();
+                }
+              }
+            });
 
-  return result;
+  return entries;
 }
 
 #endif // DOXYGEN_SHOULD_SKIP_THIS
@@ -26,6 +26,7 @@
 #define OPTIONPP_PARSER_RESULT_HPP
 
 #include <cstddef>
+#include <exception>
 #include <initializer_list>
 #include <iterator>
 #include <string>
@@ -33,6 +34,7 @@
 #include <vector>
 #include <optionpp/error.hpp>
 #include <optionpp/option.hpp>
+#include <optionpp/write_log.hpp>
 
 namespace optionpp {
 
@@ -214,9 +216,13 @@ namespace optionpp {
     void push_back(value_type&& entry) { m_entries.push_back(std::move(entry)); }
 
     /**
-     * @brief Erase all data entries currently stored.
+     * @brief Erase all data entries and pending writes currently
+     *        stored.
      */
-    void clear() noexcept { m_entries.clear(); }
+    void clear() noexcept {
+      m_entries.clear();
+      m_writes.clear();
+    }
 
     /**
      * @brief Return the number of data entries.
@@ -391,8 +397,55 @@ namespace optionpp {
      */
     std::string get_argument(char short_name) const noexcept;
 
+    /**
+     * @brief Return the log of writes to bound variables.
+     *
+     * If the result was produced by a transactional `parser`, this
+     * holds the writes that have not yet been committed. Otherwise,
+     * it is empty.
+     *
+     * @return Reference to the `write_log`.
+     * @see parser::set_transactional
+     */
+    write_log& pending_writes() noexcept { return m_writes; }
+    /**
+     * @copydoc pending_writes
+     */
+    const write_log& pending_writes() const noexcept { return m_writes; }
+
+    /**
+     * @brief Write all pending values to their bound variables.
+     *
+     * This is only needed for results produced by a transactional
+     * `parser`. All arguments were checked while parsing, so this
+     * cannot fail; converters without a variable of their own are
+     * called here. See `write_log::commit` for details.
+     */
+    void commit() { m_writes.commit(); }
+
   private:
     container_type m_entries; //< The internal container of `parsed_entry` instances.
+    write_log m_writes; //< Writes to bound variables that have not been committed.
+  };
+
+  /**
+   * @brief Holds the outcome of parsing one line with
+   *        `parser::parse_batch`.
+   *
+   * If the line was parsed successfully, `result` holds the parsed
+   * data and `error` is null. Otherwise, `error` holds the exception
+   * that was thrown (usually a `parse_error`), which can be examined
+   * by passing it to `std::rethrow_exception`.
+   */
+  struct batch_entry {
+    parser_result result; //< Parsed data for the line.
+    std::exception_ptr error; //< Exception thrown while parsing, if any.
+
+    /**
+     * @brief Return whether the line was parsed successfully.
+     * @return True if no exception was thrown.
+     */
+    bool ok() const noexcept { return !error; }
   };
 
 } // End namespace
@@ -25,8 +25,17 @@
 #ifndef OPTIONPP_UTILITY_HPP
 #define OPTIONPP_UTILITY_HPP
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace optionpp {
 
@@ -35,6 +44,471 @@ namespace optionpp {
    */
   namespace utility {
 
+    /**
+     * @brief A set of characters.
+     *
+     * A `char_class` stores one bit for each of the 256 possible
+     * byte values, so testing whether a character belongs to the set
+     * takes constant time and does not depend on the current locale.
+     * It is used by `split` and `wrap_text` to classify delimiters,
+     * quotes, escape characters, and whitespace.
+     *
+     * Building a `char_class` does not allocate memory, so one can be
+     * computed once and reused for many calls to `split`.
+     */
+    class char_class {
+    public:
+      /**
+       * @brief Maximum number of characters that `find_first_of` can
+       *        search for several bytes at a time.
+       */
+      static constexpr std::size_t max_listed = 16;
+
+      /**
+       * @brief Default constructor.
+       *
+       * Constructs an empty set.
+       */
+      char_class() noexcept {}
+      /**
+       * @brief Construct from a string of characters.
+       * @param chars String containing the characters in the set.
+       */
+      explicit char_class(const std::string& chars) noexcept {
+        add(chars);
+      }
+      /**
+       * @brief Construct from an array of characters.
+       * @param chars Pointer to the characters in the set.
+       * @param count Number of characters.
+       */
+      char_class(const char* chars, std::size_t count) noexcept {
+        add(chars, count);
+      }
+
+      /**
+       * @brief Add a character to the set.
+       * @param c Character to add.
+       * @return Reference to the current instance.
+       */
+      char_class& add(char c) noexcept;
+      /**
+       * @brief Add each character of a string to the set.
+       * @param chars String containing the characters to add.
+       * @return Reference to the current instance.
+       */
+      char_class& add(const std::string& chars) noexcept {
+        return add(chars.data(), chars.size());
+      }
+      /**
+       * @brief Add an array of characters to the set.
+       * @param chars Pointer to the characters to add.
+       * @param count Number of characters.
+       * @return Reference to the current instance.
+       */
+      char_class& add(const char* chars, std::size_t count) noexcept {
+        for (std::size_t i = 0; i != count; ++i)
+          add(chars[i]);
+        return *this;
+      }
+
+      /**
+       * @brief Determine whether a character is in the set.
+       * @param c Character to check.
+       * @return True if `c` belongs to the set, false otherwise.
+       */
+      bool contains(char c) const noexcept {
+        auto byte = static_cast<unsigned char>(c);
+        return (m_bits[byte >> 6] >> (byte & 63)) & 1;
+      }
+
+      /**
+       * @brief Return the number of distinct characters in the set.
+       * @return Number of characters.
+       */
+      std::size_t size() const noexcept { return m_size; }
+      /**
+       * @brief Return whether the set is empty.
+       * @return True if the set has no characters, false otherwise.
+       */
+      bool empty() const noexcept { return m_size == 0; }
+
+    private:
+      friend const char* find_first_of(const char* first, const char* last,
+                                       const char_class& chars) noexcept;
+
+      std::uint64_t m_bits[4]{}; //< One bit per byte value.
+      char m_listed[max_listed]{}; //< The first characters added, in order.
+      std::size_t m_size{0}; //< Number of distinct characters.
+    };
+
+    /**
+     * @brief A read-only reference to a sequence of characters.
+     *
+     * A `token_view` holds a pointer and a length, and does not own
+     * the characters it refers to. It is produced by `split_view` to
+     * refer to tokens without copying them, and can be converted to
+     * a `std::string` when a copy is needed.
+     */
+    class token_view {
+    public:
+      /**
+       * @brief Type used to represent the length of the view.
+       */
+      using size_type = std::size_t;
+      /**
+       * @brief Iterator type.
+       */
+      using const_iterator = const char*;
+
+      /**
+       * @brief Default constructor.
+       *
+       * Constructs an empty view.
+       */
+      token_view() noexcept {}
+      /**
+       * @brief Construct from a pointer and a length.
+       * @param data Pointer to the first character.
+       * @param size Number of characters.
+       */
+      token_view(const char* data, size_type size) noexcept
+        : m_data{data}, m_size{size} {}
+      /**
+       * @brief Construct a view of a null-terminated string.
+       * @param str Pointer to the string.
+       */
+      token_view(const char* str) noexcept
+        : m_data{str}, m_size{std::char_traits<char>::length(str)} {}
+      /**
+       * @brief Construct a view of a `std::string`.
+       * @param str The string to refer to. It must outlive the view.
+       */
+      token_view(const std::string& str) noexcept
+        : m_data{str.data()}, m_size{str.size()} {}
+
+      /**
+       * @brief Return a pointer to the first character.
+       * @return Pointer to the characters of the view.
+       */
+      const char* data() const noexcept { return m_data; }
+      /**
+       * @brief Return the number of characters.
+       * @return Length of the view.
+       */
+      size_type size() const noexcept { return m_size; }
+      /**
+       * @brief Return whether the view is empty.
+       * @return True if the view has no characters, false otherwise.
+       */
+      bool empty() const noexcept { return m_size == 0; }
+
+      /**
+       * @brief Return an iterator to the first character.
+       * @return Iterator to the beginning of the view.
+       */
+      const_iterator begin() const noexcept { return m_data; }
+      /**
+       * @brief Return an iterator to one past the last character.
+       * @return Iterator to the end of the view.
+       */
+      const_iterator end() const noexcept { return m_data + m_size; }
+
+      /**
+       * @brief Access a character.
+       * @param index Index of the character.
+       * @return The character at the given index.
+       */
+      char operator[](size_type index) const noexcept { return m_data[index]; }
+
+      /**
+       * @brief Copy the characters into a `std::string`.
+       * @return String holding a copy of the view.
+       */
+      std::string str() const { return std::string(m_data, m_size); }
+      /**
+       * @brief Convert to a `std::string`.
+       * @return String holding a copy of the view.
+       */
+      operator std::string() const { return str(); }
+
+    private:
+      const char* m_data{""}; //< Pointer to the first character.
+      size_type m_size{0}; //< Number of characters.
+    };
+
+    /**
+     * @brief Compare two `token_view` objects for equality.
+     * @param lhs Left-hand side.
+     * @param rhs Right-hand side.
+     * @return True if both views contain the same characters.
+     */
+    inline bool operator==(token_view lhs, token_view rhs) noexcept {
+      return lhs.size() == rhs.size()
+        && std::char_traits<char>::compare(lhs.data(), rhs.data(),
+                                           lhs.size()) == 0;
+    }
+    /**
+     * @brief Compare two `token_view` objects for inequality.
+     * @param lhs Left-hand side.
+     * @param rhs Right-hand side.
+     * @return True if the views contain different characters.
+     */
+    inline bool operator!=(token_view lhs, token_view rhs) noexcept {
+      return !(lhs == rhs);
+    }
+
+    /**
+     * @brief Text that outlives the objects that refer to it.
+     *
+     * An `option` given a `static_string` as its long name, argument
+     * name or description keeps a view of the text instead of a copy,
+     * so string literals and strings held by a `string_pool` can be
+     * used by many options without allocating any memory. A
+     * `static_string` is never created implicitly: constructing one
+     * states that the text stays valid for as long as it is used.
+     */
+    class static_string {
+    public:
+      /**
+       * @brief Type used to represent the length of the string.
+       */
+      using size_type = std::size_t;
+
+      /**
+       * @brief Default constructor.
+       *
+       * Constructs an empty string.
+       */
+      constexpr static_string() noexcept {}
+      /**
+       * @brief Construct from a pointer and a length.
+       * @param data Pointer to the first character.
+       * @param size Number of characters.
+       */
+      constexpr static_string(const char* data, size_type size) noexcept
+        : m_data{data}, m_size{size} {}
+      /**
+       * @brief Construct from a null-terminated string.
+       * @param str Pointer to the string.
+       */
+      explicit static_string(const char* str) noexcept
+        : m_data{str}, m_size{std::char_traits<char>::length(str)} {}
+
+      /**
+       * @brief Return a pointer to the first character.
+       * @return Pointer to the characters, or a null pointer for a
+       *         default-constructed string.
+       */
+      constexpr const char* data() const noexcept { return m_data; }
+      /**
+       * @brief Return the number of characters.
+       * @return Length of the string.
+       */
+      constexpr size_type size() const noexcept { return m_size; }
+      /**
+       * @brief Return whether the string is empty.
+       * @return True if the string has no characters, false otherwise.
+       */
+      constexpr bool empty() const noexcept { return m_size == 0; }
+
+      /**
+       * @brief Convert to a `token_view`.
+       * @return View of the string.
+       */
+      operator token_view() const noexcept {
+        return m_data ? token_view{m_data, m_size} : token_view{};
+      }
+
+    private:
+      const char* m_data{nullptr}; //< Pointer to the first character.
+      size_type m_size{0}; //< Number of characters.
+    };
+
+    /**
+     * @brief Write a `token_view` to an output stream.
+     * @param os The output stream.
+     * @param view The view to write.
+     * @return Reference to the output stream.
+     */
+    std::ostream& operator<<(std::ostream& os, token_view view);
+
+    /**
+     * @brief Storage for tokens produced by `split_view`.
+     *
+     * Tokens that contain quotes or escape characters cannot refer
+     * directly to the string being split, so `split_view` copies
+     * their unescaped contents into a `token_arena`. Memory is
+     * allocated in large blocks, and all the tokens stored in the
+     * arena remain valid until it is cleared or destroyed.
+     */
+    class token_arena {
+    public:
+      /**
+       * @brief Minimum size in bytes of each allocated block.
+       */
+      static constexpr std::size_t block_size = 4096;
+
+      /**
+       * @brief Default constructor.
+       *
+       * Constructs an empty arena. No memory is allocated until the
+       * first call to `store`.
+       */
+      token_arena() noexcept {}
+      token_arena(const token_arena&) = delete;
+      token_arena& operator=(const token_arena&) = delete;
+      /**
+       * @brief Move constructor.
+       * @param other The arena to move from.
+       */
+      token_arena(token_arena&& other) noexcept = default;
+      /**
+       * @brief Move assignment operator.
+       * @param other The arena to move from.
+       * @return Reference to the current instance.
+       */
+      token_arena& operator=(token_arena&& other) noexcept = default;
+
+      /**
+       * @brief Copy characters into the arena.
+       * @param data Pointer to the characters to copy.
+       * @param size Number of characters.
+       * @return A view of the stored copy.
+       */
+      token_view store(const char* data, std::size_t size);
+      /**
+       * @brief Copy a string into the arena.
+       * @param str The string to copy.
+       * @return A view of the stored copy.
+       */
+      token_view store(const std::string& str) {
+        return store(str.data(), str.size());
+      }
+
+      /**
+       * @brief Invalidate all stored tokens.
+       *
+       * The allocated blocks are kept so that they can be reused.
+       */
+      void clear() noexcept {
+        m_current = 0;
+        m_used = 0;
+      }
+
+      /**
+       * @brief Return the total size of the allocated blocks.
+       * @return Number of bytes allocated by the arena.
+       */
+      std::size_t capacity() const noexcept;
+
+    private:
+      /**
+       * @brief A block of memory owned by the arena.
+       */
+      struct block {
+        std::unique_ptr<char[]> data; //< The allocated memory.
+        std::size_t size; //< Size of the block in bytes.
+      };
+
+      std::vector<block> m_blocks; //< Allocated blocks.
+      std::size_t m_current{0}; //< Index of the block being filled.
+      std::size_t m_used{0}; //< Bytes used in the current block.
+    };
+
+    /**
+     * @brief Stores one copy of each distinct string.
+     *
+     * `intern` returns a stored copy of a string, so equal strings
+     * share their storage. The text is kept in a `token_arena`, so a
+     * string does not need an allocation of its own, and it remains
+     * valid for the lifetime of the pool. Nothing is removed from a
+     * pool before it is destroyed.
+     *
+     * Options only use a pool when given its strings, as in
+     * `opt.description(pool.intern(text))`; the pool must then
+     * outlive the options. A pool may be used by several threads at
+     * once.
+     */
+    class string_pool {
+    public:
+      /**
+       * @brief Counts describing the contents of a pool.
+       */
+      struct statistics {
+        std::size_t strings{0}; //< Number of distinct strings stored.
+        std::size_t bytes{0}; //< Bytes of text stored.
+        std::size_t references{0}; //< Number of nonempty strings given to `intern`.
+        std::size_t referenced_bytes{0}; //< Total length of those strings.
+        std::size_t allocated_bytes{0}; //< Memory allocated for text and lookup.
+        std::size_t string_bytes{0}; //< Estimated heap memory the strings would take as separate `std::string` objects.
+
+        /**
+         * @brief Estimate the memory saved by the pool.
+         *
+         * This is `string_bytes`, less the memory allocated by the
+         * pool. The estimate of `string_bytes` assumes that strings
+         * of up to 15 characters are stored inside a `std::string`
+         * object, and that longer ones need an allocation of their
+         * length plus one.
+         *
+         * @return Estimated number of bytes saved, or zero if the
+         *         pool uses more memory than it saves.
+         */
+        std::size_t saved_bytes() const noexcept;
+      };
+
+      /**
+       * @brief Default constructor.
+       *
+       * Constructs an empty pool. No memory is allocated until the
+       * first string is stored.
+       */
+      string_pool() noexcept {}
+      string_pool(const string_pool&) = delete;
+      string_pool& operator=(const string_pool&) = delete;
+
+      /**
+       * @brief Return a stored copy of a string.
+       *
+       * If an equal string is already in the pool, a view of it is
+       * returned; otherwise the string is copied into the pool. An
+       * empty string is not stored.
+       *
+       * The result may be given to an `option` in place of a
+       * `std::string`, so that the option refers to the pool's copy.
+       *
+       * @param str String to look up.
+       * @return The stored string, equal to `str`, which remains
+       *         valid for the lifetime of the pool.
+       */
+      static_string intern(token_view str);
+
+      /**
+       * @brief Return counts describing the pool's contents.
+       * @return Statistics for the pool.
+       */
+      statistics stats() const;
+
+    private:
+      /**
+       * @brief Compute the hash of a string.
+       * @param str String to hash.
+       * @return Hash value.
+       */
+      static std::uint64_t hash(token_view str) noexcept;
+
+      /**
+       * @brief Double the number of lookup slots.
+       */
+      void grow();
+
+      mutable std::mutex m_mutex; //< Guards the pool.
+      token_arena m_arena; //< Text of the stored strings.
+      std::vector<token_view> m_slots; //< Open-addressed lookup table; empty views are free.
+      statistics m_stats; //< Counts, apart from `allocated_bytes`.
+    };
+
     /**
      * @brief Split a string over delimiters into substrings.
      *
@@ -64,6 +538,399 @@ namespace optionpp {
                char escape_char = '\\',
                bool allow_empty = false);
 
+    /**
+     * @brief Split a string over delimiters into substrings.
+     *
+     * This behaves like the other overload of `split`, but takes the
+     * delimiters as a precomputed `char_class`.
+     *
+     * @tparam OutputIt Type of output iterator (typically deduced).
+     * @param str The string to split.
+     * @param dest An output iterator specifying where the tokens
+     *             should be written.
+     * @param delims The set of delimiter characters.
+     * @param quotes String containing the allowed quote characters.
+     * @param escape_char Character to use as escape character.
+     * @param allow_empty If true, consecutive delimiters will
+     *                    produce empty substrings.
+     */
+    template <typename OutputIt>
+    void split(const std::string& str, OutputIt dest,
+               const char_class& delims,
+               const std::string& quotes = "\"\'",
+               char escape_char = '\\',
+               bool allow_empty = false);
+
+    /**
+     * @brief Split a string into views over delimiters.
+     *
+     * This behaves like `split`, except that the tokens are written
+     * as `token_view` objects instead of strings. A token that does
+     * not contain any quote or escape characters refers directly to
+     * the characters of `str`, so no memory is allocated for it. The
+     * unescaped contents of the remaining tokens are stored in
+     * `arena`.
+     *
+     * The resulting views are valid only as long as the characters
+     * viewed by `str` and the contents of `arena` are alive and
+     * unmodified.
+     *
+     * @tparam OutputIt Type of output iterator (typically deduced).
+     * @param str View of the characters to split.
+     * @param dest An output iterator specifying where the tokens
+     *             should be written.
+     * @param arena Storage for tokens that need to be unescaped.
+     * @param delims String containing the characters to be used as
+     *               delimiters.
+     * @param quotes String containing the allowed quote characters.
+     * @param escape_char Character to use as escape character.
+     * @param allow_empty If true, consecutive delimiters will
+     *                    produce empty substrings.
+     */
+    template <typename OutputIt>
+    void split_view(token_view str, OutputIt dest,
+                    token_arena& arena,
+                    const std::string& delims = " \t\n\r",
+                    const std::string& quotes = "\"\'",
+                    char escape_char = '\\',
+                    bool allow_empty = false);
+
+    /**
+     * @brief Split a string into views over delimiters.
+     *
+     * This behaves like the other overload of `split_view`, but takes
+     * the delimiters as a precomputed `char_class`.
+     *
+     * @tparam OutputIt Type of output iterator (typically deduced).
+     * @param str View of the characters to split.
+     * @param dest An output iterator specifying where the tokens
+     *             should be written.
+     * @param arena Storage for tokens that need to be unescaped.
+     * @param delims The set of delimiter characters.
+     * @param quotes String containing the allowed quote characters.
+     * @param escape_char Character to use as escape character.
+     * @param allow_empty If true, consecutive delimiters will
+     *                    produce empty substrings.
+     */
+    template <typename OutputIt>
+    void split_view(token_view str, OutputIt dest,
+                    token_arena& arena,
+                    const char_class& delims,
+                    const std::string& quotes = "\"\'",
+                    char escape_char = '\\',
+                    bool allow_empty = false);
+
+    /**
+     * @brief Quoting rules used to split a command line into
+     *        arguments.
+     */
+    enum class shell_dialect {
+      generic, //< The rules of `split`: `"` and `'` quotes, with `\` escapes everywhere.
+      posix, //< POSIX `sh` word splitting and quote removal.
+      windows //< The backslash and quote rules of `CommandLineToArgvW`.
+    };
+
+    /**
+     * @brief Splits text into tokens one chunk at a time.
+     *
+     * A `tokenizer` follows the same rules as `split`, but the input
+     * can be given in pieces of any size by calling `feed` repeatedly
+     * and then `finish`. Quote and escape state is kept between
+     * chunks, so a token may be split across any number of them.
+     * The tokenizer only stores the part of the current token that
+     * has been seen so far, so the memory it needs is bounded by the
+     * length of the longest token rather than the size of the input.
+     *
+     * Tokens are written to an output iterator as `token_view`
+     * objects. A view is only valid until the next call to `feed` or
+     * `finish`, so it should be copied or consumed immediately.
+     *
+     * Example:
+     * ```
+     * std::vector<std::string> tokens;
+     * utility::tokenizer tok;
+     * tok.feed("first 'second ", std::back_inserter(tokens));
+     * tok.feed("token' third", std::back_inserter(tokens));
+     * tok.finish(std::back_inserter(tokens));
+     * // tokens == {"first", "second token", "third"}
+     * ```
+     *
+     * A tokenizer can instead follow the quoting rules of a shell;
+     * see `shell_dialect`. These rules are implemented as a state
+     * machine driven by a fixed transition table, which is advanced
+     * one character at a time in a tight loop:
+     *   - `shell_dialect::posix` splits on spaces, tabs and newlines.
+     *     Text in single quotes is taken literally. In double quotes,
+     *     a backslash only escapes `$`, `` ` ``, `"`, `\` and a
+     *     newline; elsewhere it escapes any character. A backslash
+     *     followed by a newline is removed. Quotes produce a token
+     *     even if empty, so `''` is an empty argument. No expansions
+     *     are performed.
+     *   - `shell_dialect::windows` splits on spaces and tabs. A run
+     *     of 2n backslashes followed by `"` produces n backslashes
+     *     and toggles quoting, and 2n+1 backslashes followed by `"`
+     *     produce n backslashes and a literal `"`. Other backslashes
+     *     are literal. Inside quotes, `""` produces a literal `"` and
+     *     ends the quoted text. The special rules for the program
+     *     name in the first argument are not applied.
+     *
+     * In both dialects, unterminated quotes are closed at the end of
+     * the input.
+     */
+    class tokenizer {
+    public:
+      /**
+       * @brief Size of the buffer used by `read` and `read_fd`.
+       */
+      static constexpr std::size_t buffer_size = 65536;
+
+      /**
+       * @brief Constructor.
+       * @param delims String containing the characters to be used as
+       *               delimiters.
+       * @param quotes String containing the allowed quote characters.
+       * @param escape_char Character to use as escape character.
+       * @param allow_empty If true, consecutive delimiters will
+       *                    produce empty tokens.
+       */
+      explicit tokenizer(const std::string& delims = " \t\n\r",
+                         const std::string& quotes = "\"\'",
+                         char escape_char = '\\',
+                         bool allow_empty = false)
+        : tokenizer{char_class{delims}, quotes, escape_char, allow_empty} {}
+      /**
+       * @brief Constructor.
+       * @param delims The set of delimiter characters.
+       * @param quotes String containing the allowed quote characters.
+       * @param escape_char Character to use as escape character.
+       * @param allow_empty If true, consecutive delimiters will
+       *                    produce empty tokens.
+       */
+      tokenizer(const char_class& delims, const std::string& quotes,
+                char escape_char = '\\', bool allow_empty = false);
+      /**
+       * @brief Construct a tokenizer that follows the quoting rules of
+       *        a shell.
+       * @param dialect The quoting rules to follow.
+       */
+      explicit tokenizer(shell_dialect dialect);
+
+      /**
+       * @brief Process the next chunk of input.
+       *
+       * Every token that is completed within the chunk is written to
+       * `dest`. A token that is still incomplete at the end of the
+       * chunk is saved until more input is given.
+       *
+       * @tparam OutputIt Type of output iterator (typically deduced).
+       * @param chunk The characters to process.
+       * @param dest An output iterator specifying where the tokens
+       *             should be written.
+       * @return Iterator one past the last token written.
+       */
+      template <typename OutputIt>
+      OutputIt feed(token_view chunk, OutputIt dest);
+
+      /**
+       * @brief Signal the end of the input.
+       *
+       * Writes the last token, if any, and resets the tokenizer so
+       * that it can be used for new input.
+       *
+       * @tparam OutputIt Type of output iterator (typically deduced).
+       * @param dest An output iterator specifying where the token
+       *             should be written.
+       * @return Iterator one past the last token written.
+       */
+      template <typename OutputIt>
+      OutputIt finish(OutputIt dest);
+
+      /**
+       * @brief Discard any partial token and reset the quote and
+       *        escape state.
+       */
+      void reset() noexcept;
+
+      /**
+       * @brief Tokenize everything that can be read from a stream.
+       *
+       * The stream is read in chunks of `buffer_size` bytes until the
+       * end of the input is reached, and then `finish` is called.
+       *
+       * @tparam OutputIt Type of output iterator (typically deduced).
+       * @param in The stream to read from.
+       * @param dest An output iterator specifying where the tokens
+       *             should be written.
+       * @return Iterator one past the last token written.
+       * @throw file_error If the stream reports a read error.
+       */
+      template <typename OutputIt>
+      OutputIt read(std::istream& in, OutputIt dest);
+
+      /**
+       * @brief Tokenize everything that can be read from a file
+       *        descriptor.
+       *
+       * The descriptor is read in chunks of `buffer_size` bytes until
+       * the end of the input is reached, and then `finish` is called.
+       * The descriptor is not closed.
+       *
+       * @tparam OutputIt Type of output iterator (typically deduced).
+       * @param fd The file descriptor to read from.
+       * @param dest An output iterator specifying where the tokens
+       *             should be written.
+       * @return Iterator one past the last token written.
+       * @throw file_error If reading fails.
+       */
+      template <typename OutputIt>
+      OutputIt read_fd(int fd, OutputIt dest);
+
+    private:
+      /**
+       * @brief Read from a stream into a buffer.
+       * @param in The stream to read from.
+       * @param buffer Buffer to fill.
+       * @param size Size of the buffer.
+       * @return Number of characters read, or zero at the end of the
+       *         input.
+       * @throw file_error If the stream reports a read error.
+       */
+      static std::size_t read_chunk(std::istream& in, char* buffer,
+                                    std::size_t size);
+      /**
+       * @brief Read from a file descriptor into a buffer.
+       * @param fd The file descriptor to read from.
+       * @param buffer Buffer to fill.
+       * @param size Size of the buffer.
+       * @return Number of characters read, or zero at the end of the
+       *         input.
+       * @throw file_error If reading fails.
+       */
+      static std::size_t read_chunk(int fd, char* buffer, std::size_t size);
+
+      /**
+       * @brief Transition table for a shell dialect.
+       */
+      struct shell_table;
+
+      /**
+       * @brief Return the transition table for a shell dialect.
+       * @param dialect The dialect (other than `generic`).
+       * @return Reference to the table.
+       */
+      static const shell_table& table(shell_dialect dialect);
+
+      /**
+       * @brief Run the shell state machine until a token is complete.
+       * @param pos Position of the next character. Updated to point
+       *            past the characters that were processed.
+       * @param end Pointer to one past the last character.
+       * @return True if a token was completed and stored in
+       *         `m_token`; false if the input ran out first.
+       */
+      bool scan(const char*& pos, const char* end);
+
+      /**
+       * @brief Complete the last token of the input for a shell
+       *        dialect.
+       * @return True if there was a token, which is stored in
+       *         `m_token`.
+       */
+      bool scan_end();
+
+      char_class m_delims; //< Delimiter characters.
+      char_class m_specials; //< Characters that end a run outside quotes.
+      char_class m_quote_specials; //< Characters that end a run inside quotes.
+      char m_escape_char; //< Escape character.
+      bool m_allow_empty; //< True if empty tokens are written.
+
+      std::string m_token; //< Saved part of the current token.
+      bool m_buffered{false}; //< True if the current token is being built in `m_token`.
+      bool m_escape_next{false}; //< True if the next character is escaped.
+      bool m_in_quotes{false}; //< True if inside quotes.
+      char m_closing_quote{'\0'}; //< Quote character that ends the quoted text.
+
+      const shell_table* m_table{nullptr}; //< Transition table, or `nullptr` for the generic rules.
+      unsigned char m_state{0}; //< Current state of the shell state machine.
+      std::size_t m_backslashes{0}; //< Number of pending backslashes.
+      bool m_started{false}; //< True if the current shell token has begun.
+    };
+
+    /**
+     * @brief Find the first occurrence of any of a set of characters.
+     *
+     * This behaves like `std::find_first_of`, but is optimized for
+     * long ranges and small character sets. When the library is
+     * compiled with SSE2 or AVX2 support (and `OPTIONPP_NO_SIMD` is
+     * not defined), up to 16 or 32 characters are checked at once,
+     * as long as the set has at most 16 characters.
+     *
+     * @param first Pointer to the start of the range to search.
+     * @param last Pointer to one past the end of the range.
+     * @param chars Pointer to the set of characters to search for.
+     * @param count Number of characters in the set.
+     * @return Pointer to the first matching character, or `last` if
+     *         there is none.
+     */
+    const char* find_first_of(const char* first, const char* last,
+                              const char* chars, std::size_t count) noexcept;
+
+    /**
+     * @brief Find the first character belonging to a `char_class`.
+     *
+     * If the set has at most `char_class::max_listed` characters and
+     * SIMD instructions are available, several bytes are checked at
+     * once. Otherwise each byte is looked up in the set's bitmap.
+     *
+     * @param first Pointer to the start of the range to search.
+     * @param last Pointer to one past the end of the range.
+     * @param chars The set of characters to search for.
+     * @return Pointer to the first matching character, or `last` if
+     *         there is none.
+     */
+    const char* find_first_of(const char* first, const char* last,
+                              const char_class& chars) noexcept;
+
+    /**
+     * @brief Check whether a range contains only ASCII characters.
+     *
+     * When the library is compiled with SSE2 or AVX2 support (and
+     * `OPTIONPP_NO_SIMD` is not defined), 16 or 32 bytes are checked
+     * at once.
+     *
+     * @param first Pointer to the start of the range.
+     * @param last Pointer to one past the end of the range.
+     * @return True if no byte in the range has its high bit set.
+     */
+    bool is_ascii(const char* first, const char* last) noexcept;
+
+    /**
+     * @brief Return the number of terminal columns taken by a
+     *        character.
+     *
+     * Characters whose East Asian width is Wide or Fullwidth take two
+     * columns. Combining marks, zero-width spaces and joiners, and
+     * other format characters take none. Every other character,
+     * including ASCII control characters, takes one.
+     *
+     * @param code_point Unicode code point.
+     * @return Number of columns: 0, 1 or 2.
+     */
+    int char_width(char32_t code_point) noexcept;
+
+    /**
+     * @brief Return the number of terminal columns taken by a
+     *        UTF-8 string.
+     *
+     * This is the sum of `char_width` over the string's code points.
+     * A byte that does not begin a valid UTF-8 sequence counts as one
+     * column, so text in other encodings is measured in bytes.
+     *
+     * @param str UTF-8 string to measure.
+     * @return Display width of the string.
+     */
+    std::size_t display_width(token_view str) noexcept;
+
     /**
      * @brief Perform word-wrapping on a string.
      *
@@ -77,6 +944,12 @@ namespace optionpp {
      * The text can also be indented a certain number of spaces. The
      * total line length includes the indentation.
      *
+     * The text is taken to be UTF-8, and line lengths are measured in
+     * terminal columns as given by `display_width`, so wide and
+     * combining characters are accounted for. Lines are never split
+     * inside a multibyte character. Lines of plain ASCII are measured
+     * in bytes without decoding.
+     *
      * @param str Text to wrap.
      * @param line_len Maximum desired line length, if any.
      * @param indent Number of spaces to indent each line.
@@ -99,6 +972,12 @@ namespace optionpp {
      * The text can also be indented a certain number of spaces. The
      * total line length includes the indentation.
      *
+     * The text is taken to be UTF-8, and line lengths are measured in
+     * terminal columns as given by `display_width`, so wide and
+     * combining characters are accounted for. Lines are never split
+     * inside a multibyte character. Lines of plain ASCII are measured
+     * in bytes without decoding.
+     *
      * @param str Text to wrap.
      * @param line_len Maximum desired line length, if any.
      * @param indent Number of spaces to indent each line after the
@@ -112,6 +991,86 @@ namespace optionpp {
                           int indent,
                           int first_line_indent);
 
+    /**
+     * @brief Write word-wrapped text to a stream.
+     *
+     * The output is the same as that of
+     * `wrap_text(const std::string&, int, int)`, but it is written
+     * directly to the stream as each line is found. No memory is
+     * allocated, apart from any that the stream itself uses.
+     *
+     * @param os Output stream.
+     * @param str Text to wrap.
+     * @param line_len Maximum desired line length, if any.
+     * @param indent Number of spaces to indent each line.
+     * @return The given output stream.
+     */
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len = 79, int indent = 0);
+
+    /**
+     * @brief Write word-wrapped text to a stream.
+     *
+     * The output is the same as that of
+     * `wrap_text(const std::string&, int, int, int)`, but it is
+     * written directly to the stream as each line is found. No memory
+     * is allocated, apart from any that the stream itself uses.
+     *
+     * @param os Output stream.
+     * @param str Text to wrap.
+     * @param line_len Maximum desired line length, if any.
+     * @param indent Number of spaces to indent each line after the
+     *               first one.
+     * @param first_line_indent Number of spaces to indent the first
+     *                          line.
+     * @return The given output stream.
+     */
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len, int indent,
+                                int first_line_indent);
+
+    /**
+     * @brief Write word-wrapped text to a C file.
+     *
+     * The output is the same as that of
+     * `wrap_text(const std::string&, int, int, int)`. Errors can be
+     * checked afterwards with `std::ferror`.
+     *
+     * @param file File to write to.
+     * @param str Text to wrap.
+     * @param line_len Maximum desired line length, if any.
+     * @param indent Number of spaces to indent each line after the
+     *               first one.
+     * @param first_line_indent Number of spaces to indent the first
+     *                          line.
+     */
+    void write_wrapped(std::FILE* file, token_view str,
+                       int line_len, int indent, int first_line_indent);
+
+    /**
+     * @brief Write word-wrapped text to a character buffer.
+     *
+     * The output is the same as that of
+     * `wrap_text(const std::string&, int, int, int)`. At most `size`
+     * characters are written, and no null terminator is added. The
+     * return value is the full length of the wrapped text, so if it
+     * is greater than `size`, the output was truncated and the call
+     * can be repeated with a larger buffer.
+     *
+     * @param buffer Buffer to write to.
+     * @param size Size of the buffer.
+     * @param str Text to wrap.
+     * @param line_len Maximum desired line length, if any.
+     * @param indent Number of spaces to indent each line after the
+     *               first one.
+     * @param first_line_indent Number of spaces to indent the first
+     *                          line.
+     * @return Length of the complete wrapped text.
+     */
+    std::size_t write_wrapped(char* buffer, std::size_t size, token_view str,
+                              int line_len, int indent,
+                              int first_line_indent) noexcept;
+
     /**
      * @brief Determine if a string occurs within another string at a
      * particular position.
@@ -134,6 +1093,109 @@ namespace optionpp {
     bool is_substr_at_pos(const std::string& str, const std::string& substr,
                           std::string::size_type pos = 0) noexcept;
 
+    /**
+     * @brief Compute the Damerau-Levenshtein distance between two
+     *        strings.
+     *
+     * This is the least number of single-character insertions,
+     * deletions, substitutions and transpositions of adjacent
+     * characters needed to turn one string into the other. Unlike the
+     * restricted variant, a substring may be edited again after a
+     * transposition, so the distance satisfies the triangle
+     * inequality. Characters are compared byte by byte.
+     *
+     * Distances greater than `max_distance` are reported as
+     * `max_distance + 1`. If the lengths of the strings differ by more
+     * than `max_distance`, this is returned without comparing them.
+     *
+     * Strings of up to 30 characters are compared without allocating
+     * memory.
+     *
+     * @param a First string.
+     * @param b Second string.
+     * @param max_distance Largest distance of interest.
+     * @return The distance, or `max_distance + 1` if it is greater
+     *         than `max_distance`.
+     */
+    std::size_t edit_distance(token_view a, token_view b,
+                              std::size_t max_distance
+                              = std::numeric_limits<std::size_t>::max() - 1);
+
+    /**
+     * @brief Convert a string to a time duration.
+     *
+     * The string should consist of one or more components, each
+     * made of a non-negative number (which may have a fractional
+     * part) followed by a unit: `ns` (nanoseconds), `us`
+     * (microseconds), `ms` (milliseconds), `s` (seconds), `m` or
+     * `min` (minutes), `h` (hours), or `d` (days). For example,
+     * `"250ms"`, `"1.5s"`, and `"1h30m"` are all valid. A single
+     * number without a unit is interpreted as seconds.
+     *
+     * The string is parsed in a single pass without allocating
+     * memory. Digits after the ninth decimal place are ignored, and
+     * fractions of a nanosecond are truncated.
+     *
+     * @param str String to convert.
+     * @return The duration, in nanoseconds.
+     * @throw std::invalid_argument If the string is not a valid
+     *                              duration.
+     * @throw std::out_of_range If the duration is too large to be
+     *                          represented.
+     */
+    std::chrono::nanoseconds parse_duration(const std::string& str);
+
+    /**
+     * @brief Convert a string to a number of bytes.
+     *
+     * The string should consist of a non-negative number (which may
+     * have a fractional part) followed by an optional unit. The
+     * units `B`, `KB`, `MB`, `GB`, `TB`, `PB`, and `EB` are powers of
+     * 1000, while `K`, `M`, `G`, `T`, `P`, and `E` as well as `KiB`,
+     * `MiB`, `GiB`, `TiB`, `PiB`, and `EiB` are powers of 1024. The
+     * case of the prefix letter is ignored. A number without a unit
+     * is a number of bytes. For example, `"4GiB"`, `"512k"`, and
+     * `"1.5MB"` are all valid.
+     *
+     * The string is parsed in a single pass without allocating
+     * memory. Digits after the ninth decimal place are ignored, and
+     * fractions of a byte are truncated.
+     *
+     * @param str String to convert.
+     * @return The number of bytes.
+     * @throw std::invalid_argument If the string is not a valid
+     *                              size.
+     * @throw std::out_of_range If the size is too large to be
+     *                          represented.
+     */
+    std::uint64_t parse_size(const std::string& str);
+
+  } // End namespace
+
+  /**
+   * @brief Literal operators.
+   *
+   * These may be brought into scope with
+   * `using namespace optionpp::literals;`.
+   */
+  namespace literals {
+
+    /**
+     * @brief Make a `utility::static_string` from a string literal.
+     *
+     * An option named or described with such a string refers to the
+     * literal instead of copying it, as in
+     * `parser["verbose"_static].description("Show more output"_static)`.
+     *
+     * @param str The string literal.
+     * @param size Length of the literal.
+     * @return String referring to the literal.
+     */
+    constexpr utility::static_string operator"" _static(const char* str,
+                                                        std::size_t size) noexcept {
+      return utility::static_string{str, size};
+    }
+
   } // End namespace
 
 } // End namespace
@@ -141,51 +1203,87 @@ namespace optionpp {
 
 /* Implementation */
 
+inline optionpp::utility::char_class&
+optionpp::utility::char_class::add(char c) noexcept {
+  if (!contains(c)) {
+    auto byte = static_cast<unsigned char>(c);
+    m_bits[byte >> 6] |= std::uint64_t{1} << (byte & 63);
+    if (m_size < max_listed)
+      m_listed[m_size] = c;
+    ++m_size;
+  }
+  return *this;
+}
+
 template <typename OutputIt>
 void optionpp::utility::split(const std::string& str, OutputIt dest,
                               const std::string& delims,
                               const std::string& quotes,
                               char escape_char,
                               bool allow_empty) {
-  using size_type = decltype(str.size());
-  size_type pos{0};
+  split(str, dest, char_class{delims}, quotes, escape_char, allow_empty);
+}
+
+template <typename OutputIt>
+void optionpp::utility::split(const std::string& str, OutputIt dest,
+                              const char_class& delims,
+                              const std::string& quotes,
+                              char escape_char,
+                              bool allow_empty) {
+  // Characters that end a run of ordinary characters outside of
+  // quotes
+  char_class specials{delims};
+  specials.add(escape_char).add(quotes);
+
+  // Characters that end a run inside quotes: the closing quote
+  // (filled in when the quote is opened) and the escape character
+  char_class quote_specials;
+  char closing_quote{'\0'};
+
+  const char* data = str.data();
+  const char* end = data + str.size();
+  const char* pos = data;
   bool escape_next{false};
   bool in_quotes{false};
-  size_type quote_index{0};
   std::string cur_token;
-  while (pos < str.size()) {
+  while (pos != end) {
+    if (escape_next) {
+      cur_token.push_back(*pos++);
+      escape_next = false;
+      continue;
+    }
+
     if (in_quotes) {
-      // Look for closing quote, unless we are escaping
-      if (escape_next || str[pos] != quotes[quote_index]) {
-        if (!escape_next && str[pos] == escape_char)
-          escape_next = true;
-        else {
-          cur_token.push_back(str[pos]);
-          escape_next = false;
-        }
-      } else { // Found closing quote
+      // Copy everything up to the closing quote or an escape
+      const char* stop = find_first_of(pos, end, quote_specials);
+      cur_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+
+      if (*pos == closing_quote)
         in_quotes = false;
-      }
+      else
+        escape_next = true;
     } else {
-      // Look for delimiter
-      if (escape_next || delims.find(str[pos]) == std::string::npos) {
-        if (!escape_next && str[pos] == escape_char)
-          escape_next = true;
-        else if (escape_next) {
-          cur_token.push_back(str[pos]);
-          escape_next = false;
-        } else {
-          // Look for quote
-          quote_index = quotes.find(str[pos]);
-          if (quote_index != std::string::npos)
-            in_quotes = true;
-          else
-            cur_token.push_back(str[pos]);
-        }
-      } else { // We hit a delimiter
+      // Copy everything up to the next delimiter, escape, or quote
+      const char* stop = find_first_of(pos, end, specials);
+      cur_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+
+      if (delims.contains(*pos)) { // We hit a delimiter
         if (!cur_token.empty() || allow_empty)
           *dest++ = cur_token;
         cur_token.clear();
+      } else if (*pos == escape_char) {
+        escape_next = true;
+      } else { // Found opening quote
+        in_quotes = true;
+        closing_quote = *pos;
+        quote_specials = char_class{};
+        quote_specials.add(closing_quote).add(escape_char);
       }
     }
 
@@ -197,4 +1295,208 @@ void optionpp::utility::split(const std::string& str, OutputIt dest,
     *dest++ = cur_token;
 }
 
+template <typename OutputIt>
+void optionpp::utility::split_view(token_view str, OutputIt dest,
+                                   token_arena& arena,
+                                   const std::string& delims,
+                                   const std::string& quotes,
+                                   char escape_char,
+                                   bool allow_empty) {
+  split_view(str, dest, arena, char_class{delims}, quotes, escape_char,
+             allow_empty);
+}
+
+template <typename OutputIt>
+void optionpp::utility::split_view(token_view str, OutputIt dest,
+                                   token_arena& arena,
+                                   const char_class& delims,
+                                   const std::string& quotes,
+                                   char escape_char,
+                                   bool allow_empty) {
+  char_class specials{delims};
+  specials.add(escape_char).add(quotes);
+  char_class quote_specials;
+  char closing_quote{'\0'};
+
+  const char* data = str.data();
+  const char* end = data + str.size();
+  const char* pos = data;
+  const char* token_start = pos;
+
+  // Once a quote or escape is found, the rest of the token is
+  // unescaped into 'unescaped' and later moved into the arena
+  bool needs_copy{false};
+  std::string unescaped;
+
+  bool escape_next{false};
+  bool in_quotes{false};
+  while (true) {
+    if (pos != end && escape_next) {
+      unescaped.push_back(*pos++);
+      escape_next = false;
+      continue;
+    }
+
+    if (pos != end && in_quotes) {
+      const char* stop = find_first_of(pos, end, quote_specials);
+      unescaped.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        continue;
+
+      if (*pos == closing_quote)
+        in_quotes = false;
+      else
+        escape_next = true;
+    } else {
+      const char* stop = pos == end ? end : find_first_of(pos, end, specials);
+      if (needs_copy)
+        unescaped.append(pos, stop);
+      pos = stop;
+
+      if (pos == end || delims.contains(*pos)) { // End of token
+        if (needs_copy) {
+          if (!unescaped.empty() || allow_empty)
+            *dest++ = arena.store(unescaped);
+        } else if (pos != token_start || allow_empty) {
+          *dest++ = token_view{token_start,
+                               static_cast<std::size_t>(pos - token_start)};
+        }
+        if (pos == end)
+          break;
+
+        needs_copy = false;
+        unescaped.clear();
+        token_start = pos + 1;
+      } else {
+        if (!needs_copy) {
+          needs_copy = true;
+          unescaped.assign(token_start, pos);
+        }
+
+        if (*pos == escape_char) {
+          escape_next = true;
+        } else { // Found opening quote
+          in_quotes = true;
+          closing_quote = *pos;
+          quote_specials = char_class{};
+          quote_specials.add(closing_quote).add(escape_char);
+        }
+      }
+    }
+
+    ++pos;
+  }
+}
+
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::feed(token_view chunk, OutputIt dest) {
+  const char* pos = chunk.data();
+  const char* end = pos + chunk.size();
+
+  if (m_table) {
+    while (scan(pos, end)) {
+      *dest++ = token_view{m_token};
+      m_token.clear();
+    }
+    return dest;
+  }
+
+  // Unless the current token is being built in m_token, it starts at
+  // token_start and has no quotes or escapes so far
+  const char* token_start = pos;
+  while (pos != end) {
+    if (m_escape_next) {
+      m_token.push_back(*pos++);
+      m_escape_next = false;
+      continue;
+    }
+
+    if (m_in_quotes) {
+      // Copy everything up to the closing quote or an escape
+      const char* stop = find_first_of(pos, end, m_quote_specials);
+      m_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+
+      if (*pos == m_closing_quote)
+        m_in_quotes = false;
+      else
+        m_escape_next = true;
+    } else {
+      // Find the next delimiter, escape, or quote
+      const char* stop = find_first_of(pos, end, m_specials);
+      if (m_buffered)
+        m_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+
+      if (m_delims.contains(*pos)) { // End of token
+        if (m_buffered) {
+          if (!m_token.empty() || m_allow_empty)
+            *dest++ = token_view{m_token};
+          m_token.clear();
+          m_buffered = false;
+        } else if (pos != token_start || m_allow_empty) {
+          *dest++ = token_view{token_start,
+                               static_cast<std::size_t>(pos - token_start)};
+        }
+        token_start = pos + 1;
+      } else {
+        if (!m_buffered) {
+          m_buffered = true;
+          m_token.assign(token_start, pos);
+        }
+
+        if (*pos == m_escape_char) {
+          m_escape_next = true;
+        } else { // Found opening quote
+          m_in_quotes = true;
+          m_closing_quote = *pos;
+          m_quote_specials = char_class{};
+          m_quote_specials.add(m_closing_quote).add(m_escape_char);
+        }
+      }
+    }
+
+    ++pos;
+  }
+
+  // Save the beginning of a token that continues into the next chunk
+  if (!m_buffered && token_start != end) {
+    m_token.assign(token_start, end);
+    m_buffered = true;
+  }
+
+  return dest;
+}
+
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::finish(OutputIt dest) {
+  if (m_table ? scan_end() : (!m_token.empty() || m_allow_empty))
+    *dest++ = token_view{m_token};
+  reset();
+  return dest;
+}
+
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::read(std::istream& in, OutputIt dest) {
+  std::unique_ptr<char[]> buffer{new char[buffer_size]};
+  std::size_t count;
+  while ((count = read_chunk(in, buffer.get(), buffer_size)) != 0)
+    dest = feed(token_view{buffer.get(), count}, dest);
+  return finish(dest);
+}
+
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::read_fd(int fd, OutputIt dest) {
+  std::unique_ptr<char[]> buffer{new char[buffer_size]};
+  std::size_t count;
+  while ((count = read_chunk(fd, buffer.get(), buffer_size)) != 0)
+    dest = feed(token_view{buffer.get(), count}, dest);
+  return finish(dest);
+}
+
 #endif
@@ -0,0 +1,333 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+/**
+ * @file
+ * @brief Header file for `write_log` class.
+ */
+
+#ifndef OPTIONPP_WRITE_LOG_HPP
+#define OPTIONPP_WRITE_LOG_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optionpp/option.hpp>
+
+namespace optionpp {
+
+  /**
+   * @brief Records writes to variables bound to options.
+   *
+   * The `parser` sends every write to a bound variable through a
+   * `write_log`. By default, writes are passed straight through to
+   * the `option`. If the log is deferred, writes are instead
+   * recorded, and nothing is modified until `commit` is called.
+   *
+   * Deferred writes are stored compactly: each write takes a single
+   * fixed-size record, and all string arguments share one buffer.
+   * Arguments are converted before they are recorded, so committing
+   * the log mostly just stores values. It is a simple loop over the
+   * records, cheap enough to do while holding a lock. The exception
+   * is a converter set with `option::bind_custom` without a variable:
+   * since it stores its result itself, it is only called by `commit`,
+   * with the recorded argument.
+   *
+   * @see parser::set_transactional
+   */
+  class write_log {
+  public:
+
+    /**
+     * @brief Type used to represent the number of recorded writes.
+     */
+    using size_type = std::vector<int>::size_type;
+
+    /**
+     * @brief Default constructor.
+     *
+     * Constructs a log that passes writes through immediately.
+     */
+    write_log() noexcept {}
+    /**
+     * @brief Construct a log.
+     * @param deferred If true, writes are recorded until `commit` is
+     *                 called; otherwise they are passed through
+     *                 immediately.
+     */
+    explicit write_log(bool deferred) noexcept : m_deferred{deferred} {}
+
+    /**
+     * @brief Return whether writes are being deferred.
+     * @return True if writes are recorded until `commit` is called.
+     */
+    bool is_deferred() const noexcept { return m_deferred; }
+    /**
+     * @brief Set whether writes should be deferred.
+     * @param deferred If true, writes are recorded until `commit` is
+     *                 called; otherwise they are passed through
+     *                 immediately.
+     */
+    void set_deferred(bool deferred) noexcept { m_deferred = deferred; }
+
+    /**
+     * @brief Return whether arguments of options without bound
+     *        variables are recorded.
+     * @return True if the `parser` converts and records arguments
+     *         even for options that have no bound variable.
+     */
+    bool records_unbound() const noexcept { return m_record_unbound; }
+    /**
+     * @brief Set whether arguments of options without bound variables
+     *        should be recorded.
+     *
+     * This is used when the destinations are supplied separately for
+     * each parse, as with `binding_map`. Such writes are skipped by
+     * `commit`, but are passed to the visitor in `replay`. Custom
+     * arguments are then recorded as they are, without calling the
+     * options' converters.
+     *
+     * @param record If true, the `parser` converts and records the
+     *               arguments of every option, whether or not it has
+     *               a bound variable.
+     */
+    void set_record_unbound(bool record) noexcept { m_record_unbound = record; }
+
+    /**
+     * @brief Return the number of pending writes.
+     * @return Number of writes that have been recorded but not yet
+     *         committed.
+     */
+    size_type size() const noexcept { return m_records.size(); }
+    /**
+     * @brief Return whether there are no pending writes.
+     * @return True if no writes are waiting to be committed.
+     */
+    bool empty() const noexcept { return m_records.empty(); }
+
+    /**
+     * @brief Discard all pending writes.
+     */
+    void clear() noexcept {
+      m_records.clear();
+      m_strings.clear();
+      m_staged.clear();
+    }
+
+    /**
+     * @brief Apply all pending writes, in the order in which they
+     *        were made, and clear the log.
+     *
+     * Every argument was converted when its write was recorded, so
+     * this only stores values, except that converters set with
+     * `option::bind_custom` without a variable are called here, in
+     * order, with their recorded arguments. Such a converter cannot
+     * reject its argument at this point: its result is ignored. (A
+     * validator, or a converter given a variable to convert into,
+     * checks the argument while parsing instead.)
+     */
+    void commit();
+
+    /**
+     * @brief Pass each pending write to a visitor, in the order in
+     *        which they were made.
+     *
+     * The log is left unchanged. For each write, the visitor's member
+     * function with the same name as the corresponding `write_log`
+     * function is called with the same arguments. For example,
+     * `write_int(opt, 5)` is replayed as `visitor.write_int(opt, 5)`.
+     *
+     * @tparam Visitor Type with member functions `write_bool`,
+     *                 `write_string`, `write_int`, `write_uint`,
+     *                 `write_double`, `write_duration`, `write_size`,
+     *                 `write_enum`, and `write_custom`.
+     * @param visitor Visitor to receive the writes.
+     */
+    template <typename Visitor>
+    void replay(Visitor& visitor) const;
+
+    /**
+     * @brief Write or record a value for `option::write_bool`.
+     * @param opt The option to write to.
+     * @param value Value to write.
+     */
+    void write_bool(const option& opt, bool value);
+    /**
+     * @brief Write or record a value for `option::write_string`.
+     * @param opt The option to write to.
+     * @param value Value to write.
+     */
+    void write_string(const option& opt, const std::string& value);
+    /**
+     * @brief Write or record a value for `option::write_int`.
+     * @param opt The option to write to.
+     * @param value Value to write.
+     */
+    void write_int(const option& opt, int value);
+    /**
+     * @brief Write or record a value for `option::write_uint`.
+     * @param opt The option to write to.
+     * @param value Value to write.
+     */
+    void write_uint(const option& opt, unsigned int value);
+    /**
+     * @brief Write or record a value for `option::write_double`.
+     * @param opt The option to write to.
+     * @param value Value to write.
+     */
+    void write_double(const option& opt, double value);
+    /**
+     * @brief Write or record a value for `option::write_duration`.
+     * @param opt The option to write to.
+     * @param value Value to write.
+     */
+    void write_duration(const option& opt, std::chrono::nanoseconds value);
+    /**
+     * @brief Write or record a value for `option::write_size`.
+     * @param opt The option to write to.
+     * @param value Value to write.
+     */
+    void write_size(const option& opt, std::uint64_t value);
+    /**
+     * @brief Write or record a value for `option::write_enum`.
+     * @param opt The option to write to.
+     * @param index Index of the choice to write.
+     */
+    void write_enum(const option& opt, choice_table::size_type index);
+    /**
+     * @brief Pass or record an argument for `option::write_custom`.
+     *
+     * If the log is not deferred, the converter is called right
+     * away. Otherwise, if a variable was bound together with the
+     * converter (see `option::bind_custom`), the argument is
+     * converted now, so that a rejected argument is reported while
+     * parsing, and the value is held until `commit`. A converter
+     * without a variable stores its result itself, so the argument is
+     * only recorded, and the converter is called by `commit`. If
+     * `records_unbound` is true, the argument is only recorded, for
+     * a `binding_map`, and no converter is called at all.
+     *
+     * @param opt The option whose converter should be called.
+     * @param value Argument to pass to the converter.
+     * @return The result of the converter, or true if the argument
+     *         was only recorded.
+     */
+    bool write_custom(const option& opt, const std::string& value);
+
+  private:
+
+    /**
+     * @brief Kind of write that was recorded.
+     */
+    enum class write_type : unsigned char {
+      bool_write, //< Call to `option::write_bool`.
+      string_write, //< Call to `option::write_string`.
+      int_write, //< Call to `option::write_int`.
+      uint_write, //< Call to `option::write_uint`.
+      double_write, //< Call to `option::write_double`.
+      duration_write, //< Call to `option::write_duration`.
+      size_write, //< Call to `option::write_size`.
+      enum_write, //< Call to `option::write_enum`.
+      custom_write //< Call to `option::write_custom`.
+    };
+
+    /**
+     * @brief Location of a string value in the buffer.
+     */
+    struct string_ref {
+      std::uint32_t pos; //< Position of the string in the buffer.
+      std::uint32_t len; //< Length of the string.
+    };
+
+    /**
+     * @brief A single recorded write.
+     */
+    struct record {
+      const option* opt; //< Option to write to.
+      write_type type; //< Kind of write.
+      union {
+        long long int_value; //< Value for integer, duration, and enumeration writes.
+        unsigned long long uint_value; //< Value for unsigned and size writes.
+        double double_value; //< Value for floating-point writes.
+        string_ref str; //< Location of a string value.
+      };
+    };
+
+    /**
+     * @brief Record a string write.
+     * @param opt The option to write to.
+     * @param type Kind of write.
+     * @param value String to record.
+     */
+    void record_string(const option& opt, write_type type,
+                       const std::string& value);
+
+    bool m_deferred{false}; //< True if writes are recorded rather than applied.
+    bool m_record_unbound{false}; //< True if writes to options without bound variables are recorded.
+    std::vector<record> m_records; //< Pending writes.
+    std::string m_strings; //< Buffer holding all pending string values.
+    std::vector<arg_callback> m_staged; //< Callbacks storing converted custom values, one per custom write (empty if the converter runs on commit).
+  };
+
+} // End namespace
+
+
+/* Implementation */
+
+template <typename Visitor>
+void optionpp::write_log::replay(Visitor& visitor) const {
+  std::string value;
+  for (const auto& r : m_records) {
+    const option& opt = *r.opt;
+    switch (r.type) {
+    case write_type::bool_write:
+      visitor.write_bool(opt, r.int_value != 0);
+      break;
+    case write_type::string_write:
+      value.assign(m_strings, r.str.pos, r.str.len);
+      visitor.write_string(opt, value);
+      break;
+    case write_type::int_write:
+      visitor.write_int(opt, static_cast<int>(r.int_value));
+      break;
+    case write_type::uint_write:
+      visitor.write_uint(opt, static_cast<unsigned int>(r.uint_value));
+      break;
+    case write_type::double_write:
+      visitor.write_double(opt, r.double_value);
+      break;
+    case write_type::duration_write:
+      visitor.write_duration(opt, std::chrono::nanoseconds{r.int_value});
+      break;
+    case write_type::size_write:
+      visitor.write_size(opt, r.uint_value);
+      break;
+    case write_type::enum_write:
+      visitor.write_enum(opt, static_cast<choice_table::size_type>(r.uint_value));
+      break;
+    case write_type::custom_write:
+      value.assign(m_strings, r.str.pos, r.str.len);
+      visitor.write_custom(opt, value);
+      break;
+    }
+  }
+}
+
+#endif
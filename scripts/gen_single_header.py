@@ -43,8 +43,10 @@ _start_comment = """\
 
 """
 
-_transl_units = ['error', 'utility', 'option', 'option_group', 'parser_result',\
-                 'result_iterator', 'parser']
+_transl_units = ['error', 'utility', 'mapped_file', 'arg_callback',\
+                 'choice_table', 'option', 'write_log', 'binding_map',\
+                 'option_group', 'parser_result', 'result_iterator',\
+                 'parser']
 
 def generate():
     single_header_dir = Path('..') / Path('single_header')
@@ -85,15 +87,21 @@ def _parse_files(header=False):
         ext = 'cpp'
 
     includes = ''
+    cond_blocks = []
     content = ''
     for filename in _add_extension(_transl_units, ext):
-        i, c = _parse_file(incl / Path(filename), header)
+        if not (incl / Path(filename)).exists():
+            continue # Header-only unit
+        i, b, c = _parse_file(incl / Path(filename), header)
         includes += i + '\n'
+        cond_blocks += [block for block in b if block not in cond_blocks]
         content += c + '\n'
-    return (_remove_dupes(includes), content)
+    return (_remove_dupes(includes) + '\n' + ''.join(cond_blocks), content)
 
 def _parse_file(filename, header=False):
     includes = ''
+    cond_blocks = []
+    cond_depth = 0
     content = ''
     in_comment = False
     found_content = False
@@ -111,6 +119,18 @@ def _parse_file(filename, header=False):
                 found_content = True
                 continue
 
+            # Keep conditional blocks before the content (such as
+            # platform-specific includes) together, verbatim
+            if not found_content and (cond_depth > 0 or sline.startswith('#if')):
+                if sline.startswith('#if'):
+                    if cond_depth == 0:
+                        cond_blocks.append('')
+                    cond_depth += 1
+                elif sline.startswith('#endif'):
+                    cond_depth -= 1
+                cond_blocks[-1] += line
+                continue
+
             if not header and sline.startswith('using namespace optionpp'):
                 found_content = True
             elif not header and sline.startswith('namespace'):
@@ -126,7 +146,7 @@ def _parse_file(filename, header=False):
                 content += line.partition('//')[0].rstrip()
                 if not content.endswith('\n'):
                     content += '\n'
-    return (includes, content)
+    return (includes, cond_blocks, content)
 
 def _remove_dupes(string):
     unique = set(string.splitlines())
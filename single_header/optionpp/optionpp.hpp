@@ -17,54 +17,298 @@
  */
 /* Written by Greg Kikola <gkikola@gmail.com>. */
 
-// Single-header generated 2020-06-07T22:52:55Z
+// Single-header generated 2026-10-16T20:28:51Z
 
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
 #include <initializer_list>
 #include <iosfwd>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+
 namespace optionpp {
   class error : public std::logic_error {
   public:
-    error(const std::string& msg, const std::string& fn_name)
-      : logic_error(msg), m_function{fn_name} {}
+    error(std::string msg, std::string fn_name)
+      : logic_error(msg), m_function{std::move(fn_name)} {}
     const std::string& function() const { return m_function; }
   private:
     std::string m_function;
   };
   class out_of_range : public error {
   public:
-    out_of_range(const std::string& msg, const std::string& fn_name)
-      : error(msg, fn_name) {}
+    out_of_range(std::string msg, std::string fn_name)
+      : error(std::move(msg), std::move(fn_name)) {}
   };
   class bad_dereference : public error {
   public:
-    bad_dereference(const std::string& msg,
-                    const std::string& fn_name)
-      : error(msg, fn_name) {}
+    bad_dereference(std::string msg, std::string fn_name)
+      : error(std::move(msg), std::move(fn_name)) {}
   };
   class type_error : public error {
   public:
-    type_error(const std::string& msg, const std::string& fn_name)
-      : error(msg, fn_name) {}
+    type_error(std::string msg, std::string fn_name)
+      : error(std::move(msg), std::move(fn_name)) {}
+  };
+  class parse_error : public error {
+  public:
+    parse_error(std::string msg, std::string fn_name,
+                std::string option = "",
+                std::vector<std::string> suggestions = {})
+      : error(std::move(msg), std::move(fn_name)),
+        m_option{std::move(option)},
+        m_suggestions{std::move(suggestions)} {}
+    const std::string& option() const noexcept { return m_option; }
+    const std::vector<std::string>& suggestions() const noexcept {
+      return m_suggestions;
+    }
+  private:
+    std::string m_option;
+    std::vector<std::string> m_suggestions;
+  };
+  class file_error : public error {
+  public:
+    file_error(std::string msg, std::string fn_name, std::string path)
+      : error(std::move(msg), std::move(fn_name)),
+        m_path{std::move(path)} {}
+    const std::string& path() const noexcept { return m_path; }
+  private:
+    std::string m_path;
   };
 }
 
 
 namespace optionpp {
   namespace utility {
+    class char_class {
+    public:
+      static constexpr std::size_t max_listed = 16;
+      char_class() noexcept {}
+      explicit char_class(const std::string& chars) noexcept {
+        add(chars);
+      }
+      char_class(const char* chars, std::size_t count) noexcept {
+        add(chars, count);
+      }
+      char_class& add(char c) noexcept;
+      char_class& add(const std::string& chars) noexcept {
+        return add(chars.data(), chars.size());
+      }
+      char_class& add(const char* chars, std::size_t count) noexcept {
+        for (std::size_t i = 0; i != count; ++i)
+          add(chars[i]);
+        return *this;
+      }
+      bool contains(char c) const noexcept {
+        auto byte = static_cast<unsigned char>(c);
+        return (m_bits[byte >> 6] >> (byte & 63)) & 1;
+      }
+      std::size_t size() const noexcept { return m_size; }
+      bool empty() const noexcept { return m_size == 0; }
+    private:
+      friend const char* find_first_of(const char* first, const char* last,
+                                       const char_class& chars) noexcept;
+      std::uint64_t m_bits[4]{};
+      char m_listed[max_listed]{};
+      std::size_t m_size{0};
+    };
+    class token_view {
+    public:
+      using size_type = std::size_t;
+      using const_iterator = const char*;
+      token_view() noexcept {}
+      token_view(const char* data, size_type size) noexcept
+        : m_data{data}, m_size{size} {}
+      token_view(const char* str) noexcept
+        : m_data{str}, m_size{std::char_traits<char>::length(str)} {}
+      token_view(const std::string& str) noexcept
+        : m_data{str.data()}, m_size{str.size()} {}
+      const char* data() const noexcept { return m_data; }
+      size_type size() const noexcept { return m_size; }
+      bool empty() const noexcept { return m_size == 0; }
+      const_iterator begin() const noexcept { return m_data; }
+      const_iterator end() const noexcept { return m_data + m_size; }
+      char operator[](size_type index) const noexcept { return m_data[index]; }
+      std::string str() const { return std::string(m_data, m_size); }
+      operator std::string() const { return str(); }
+    private:
+      const char* m_data{""};
+      size_type m_size{0};
+    };
+    inline bool operator==(token_view lhs, token_view rhs) noexcept {
+      return lhs.size() == rhs.size()
+        && std::char_traits<char>::compare(lhs.data(), rhs.data(),
+                                           lhs.size()) == 0;
+    }
+    inline bool operator!=(token_view lhs, token_view rhs) noexcept {
+      return !(lhs == rhs);
+    }
+    class static_string {
+    public:
+      using size_type = std::size_t;
+      constexpr static_string() noexcept {}
+      constexpr static_string(const char* data, size_type size) noexcept
+        : m_data{data}, m_size{size} {}
+      explicit static_string(const char* str) noexcept
+        : m_data{str}, m_size{std::char_traits<char>::length(str)} {}
+      constexpr const char* data() const noexcept { return m_data; }
+      constexpr size_type size() const noexcept { return m_size; }
+      constexpr bool empty() const noexcept { return m_size == 0; }
+      operator token_view() const noexcept {
+        return m_data ? token_view{m_data, m_size} : token_view{};
+      }
+    private:
+      const char* m_data{nullptr};
+      size_type m_size{0};
+    };
+    std::ostream& operator<<(std::ostream& os, token_view view);
+    class token_arena {
+    public:
+      static constexpr std::size_t block_size = 4096;
+      token_arena() noexcept {}
+      token_arena(const token_arena&) = delete;
+      token_arena& operator=(const token_arena&) = delete;
+      token_arena(token_arena&& other) noexcept = default;
+      token_arena& operator=(token_arena&& other) noexcept = default;
+      token_view store(const char* data, std::size_t size);
+      token_view store(const std::string& str) {
+        return store(str.data(), str.size());
+      }
+      void clear() noexcept {
+        m_current = 0;
+        m_used = 0;
+      }
+      std::size_t capacity() const noexcept;
+    private:
+      struct block {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+      };
+      std::vector<block> m_blocks;
+      std::size_t m_current{0};
+      std::size_t m_used{0};
+    };
+    class string_pool {
+    public:
+      struct statistics {
+        std::size_t strings{0};
+        std::size_t bytes{0};
+        std::size_t references{0};
+        std::size_t referenced_bytes{0};
+        std::size_t allocated_bytes{0};
+        std::size_t string_bytes{0};
+        std::size_t saved_bytes() const noexcept;
+      };
+      string_pool() noexcept {}
+      string_pool(const string_pool&) = delete;
+      string_pool& operator=(const string_pool&) = delete;
+      static_string intern(token_view str);
+      statistics stats() const;
+    private:
+      static std::uint64_t hash(token_view str) noexcept;
+      void grow();
+      mutable std::mutex m_mutex;
+      token_arena m_arena;
+      std::vector<token_view> m_slots;
+      statistics m_stats;
+    };
     template <typename OutputIt>
     void split(const std::string& str, OutputIt dest,
                const std::string& delims = " \t\n\r",
                const std::string& quotes = "\"\'",
                char escape_char = '\\',
                bool allow_empty = false);
+    template <typename OutputIt>
+    void split(const std::string& str, OutputIt dest,
+               const char_class& delims,
+               const std::string& quotes = "\"\'",
+               char escape_char = '\\',
+               bool allow_empty = false);
+    template <typename OutputIt>
+    void split_view(token_view str, OutputIt dest,
+                    token_arena& arena,
+                    const std::string& delims = " \t\n\r",
+                    const std::string& quotes = "\"\'",
+                    char escape_char = '\\',
+                    bool allow_empty = false);
+    template <typename OutputIt>
+    void split_view(token_view str, OutputIt dest,
+                    token_arena& arena,
+                    const char_class& delims,
+                    const std::string& quotes = "\"\'",
+                    char escape_char = '\\',
+                    bool allow_empty = false);
+    enum class shell_dialect {
+      generic,
+      posix,
+      windows
+    };
+    class tokenizer {
+    public:
+      static constexpr std::size_t buffer_size = 65536;
+      explicit tokenizer(const std::string& delims = " \t\n\r",
+                         const std::string& quotes = "\"\'",
+                         char escape_char = '\\',
+                         bool allow_empty = false)
+        : tokenizer{char_class{delims}, quotes, escape_char, allow_empty} {}
+      tokenizer(const char_class& delims, const std::string& quotes,
+                char escape_char = '\\', bool allow_empty = false);
+      explicit tokenizer(shell_dialect dialect);
+      template <typename OutputIt>
+      OutputIt feed(token_view chunk, OutputIt dest);
+      template <typename OutputIt>
+      OutputIt finish(OutputIt dest);
+      void reset() noexcept;
+      template <typename OutputIt>
+      OutputIt read(std::istream& in, OutputIt dest);
+      template <typename OutputIt>
+      OutputIt read_fd(int fd, OutputIt dest);
+    private:
+      static std::size_t read_chunk(std::istream& in, char* buffer,
+                                    std::size_t size);
+      static std::size_t read_chunk(int fd, char* buffer, std::size_t size);
+      struct shell_table;
+      static const shell_table& table(shell_dialect dialect);
+      bool scan(const char*& pos, const char* end);
+      bool scan_end();
+      char_class m_delims;
+      char_class m_specials;
+      char_class m_quote_specials;
+      char m_escape_char;
+      bool m_allow_empty;
+      std::string m_token;
+      bool m_buffered{false};
+      bool m_escape_next{false};
+      bool m_in_quotes{false};
+      char m_closing_quote{'\0'};
+      const shell_table* m_table{nullptr};
+      unsigned char m_state{0};
+      std::size_t m_backslashes{0};
+      bool m_started{false};
+    };
+    const char* find_first_of(const char* first, const char* last,
+                              const char* chars, std::size_t count) noexcept;
+    const char* find_first_of(const char* first, const char* last,
+                              const char_class& chars) noexcept;
+    bool is_ascii(const char* first, const char* last) noexcept;
+    int char_width(char32_t code_point) noexcept;
+    std::size_t display_width(token_view str) noexcept;
     std::string wrap_text(const std::string& str,
                           int line_len = 79,
                           int indent = 0);
@@ -72,9 +316,41 @@ namespace optionpp {
                           int line_len,
                           int indent,
                           int first_line_indent);
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len = 79, int indent = 0);
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len, int indent,
+                                int first_line_indent);
+    void write_wrapped(std::FILE* file, token_view str,
+                       int line_len, int indent, int first_line_indent);
+    std::size_t write_wrapped(char* buffer, std::size_t size, token_view str,
+                              int line_len, int indent,
+                              int first_line_indent) noexcept;
     bool is_substr_at_pos(const std::string& str, const std::string& substr,
                           std::string::size_type pos = 0) noexcept;
+    std::size_t edit_distance(token_view a, token_view b,
+                              std::size_t max_distance
+                              = std::numeric_limits<std::size_t>::max() - 1);
+    std::chrono::nanoseconds parse_duration(const std::string& str);
+    std::uint64_t parse_size(const std::string& str);
+  }
+  namespace literals {
+    constexpr utility::static_string operator"" _static(const char* str,
+                                                        std::size_t size) noexcept {
+      return utility::static_string{str, size};
+    }
+  }
+}
+inline optionpp::utility::char_class&
+optionpp::utility::char_class::add(char c) noexcept {
+  if (!contains(c)) {
+    auto byte = static_cast<unsigned char>(c);
+    m_bits[byte >> 6] |= std::uint64_t{1} << (byte & 63);
+    if (m_size < max_listed)
+      m_listed[m_size] = c;
+    ++m_size;
   }
+  return *this;
 }
 template <typename OutputIt>
 void optionpp::utility::split(const std::string& str, OutputIt dest,
@@ -82,42 +358,57 @@ void optionpp::utility::split(const std::string& str, OutputIt dest,
                               const std::string& quotes,
                               char escape_char,
                               bool allow_empty) {
-  using size_type = decltype(str.size());
-  size_type pos{0};
+  split(str, dest, char_class{delims}, quotes, escape_char, allow_empty);
+}
+template <typename OutputIt>
+void optionpp::utility::split(const std::string& str, OutputIt dest,
+                              const char_class& delims,
+                              const std::string& quotes,
+                              char escape_char,
+                              bool allow_empty) {
+  char_class specials{delims};
+  specials.add(escape_char).add(quotes);
+  char_class quote_specials;
+  char closing_quote{'\0'};
+  const char* data = str.data();
+  const char* end = data + str.size();
+  const char* pos = data;
   bool escape_next{false};
   bool in_quotes{false};
-  size_type quote_index{0};
   std::string cur_token;
-  while (pos < str.size()) {
+  while (pos != end) {
+    if (escape_next) {
+      cur_token.push_back(*pos++);
+      escape_next = false;
+      continue;
+    }
     if (in_quotes) {
-      if (escape_next || str[pos] != quotes[quote_index]) {
-        if (!escape_next && str[pos] == escape_char)
-          escape_next = true;
-        else {
-          cur_token.push_back(str[pos]);
-          escape_next = false;
-        }
-      } else {
+      const char* stop = find_first_of(pos, end, quote_specials);
+      cur_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+      if (*pos == closing_quote)
         in_quotes = false;
-      }
+      else
+        escape_next = true;
     } else {
-      if (escape_next || delims.find(str[pos]) == std::string::npos) {
-        if (!escape_next && str[pos] == escape_char)
-          escape_next = true;
-        else if (escape_next) {
-          cur_token.push_back(str[pos]);
-          escape_next = false;
-        } else {
-          quote_index = quotes.find(str[pos]);
-          if (quote_index != std::string::npos)
-            in_quotes = true;
-          else
-            cur_token.push_back(str[pos]);
-        }
-      } else {
+      const char* stop = find_first_of(pos, end, specials);
+      cur_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+      if (delims.contains(*pos)) {
         if (!cur_token.empty() || allow_empty)
           *dest++ = cur_token;
         cur_token.clear();
+      } else if (*pos == escape_char) {
+        escape_next = true;
+      } else {
+        in_quotes = true;
+        closing_quote = *pos;
+        quote_specials = char_class{};
+        quote_specials.add(closing_quote).add(escape_char);
       }
     }
     ++pos;
@@ -125,6 +416,412 @@ void optionpp::utility::split(const std::string& str, OutputIt dest,
   if (!cur_token.empty() || allow_empty)
     *dest++ = cur_token;
 }
+template <typename OutputIt>
+void optionpp::utility::split_view(token_view str, OutputIt dest,
+                                   token_arena& arena,
+                                   const std::string& delims,
+                                   const std::string& quotes,
+                                   char escape_char,
+                                   bool allow_empty) {
+  split_view(str, dest, arena, char_class{delims}, quotes, escape_char,
+             allow_empty);
+}
+template <typename OutputIt>
+void optionpp::utility::split_view(token_view str, OutputIt dest,
+                                   token_arena& arena,
+                                   const char_class& delims,
+                                   const std::string& quotes,
+                                   char escape_char,
+                                   bool allow_empty) {
+  char_class specials{delims};
+  specials.add(escape_char).add(quotes);
+  char_class quote_specials;
+  char closing_quote{'\0'};
+  const char* data = str.data();
+  const char* end = data + str.size();
+  const char* pos = data;
+  const char* token_start = pos;
+  bool needs_copy{false};
+  std::string unescaped;
+  bool escape_next{false};
+  bool in_quotes{false};
+  while (true) {
+    if (pos != end && escape_next) {
+      unescaped.push_back(*pos++);
+      escape_next = false;
+      continue;
+    }
+    if (pos != end && in_quotes) {
+      const char* stop = find_first_of(pos, end, quote_specials);
+      unescaped.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        continue;
+      if (*pos == closing_quote)
+        in_quotes = false;
+      else
+        escape_next = true;
+    } else {
+      const char* stop = pos == end ? end : find_first_of(pos, end, specials);
+      if (needs_copy)
+        unescaped.append(pos, stop);
+      pos = stop;
+      if (pos == end || delims.contains(*pos)) {
+        if (needs_copy) {
+          if (!unescaped.empty() || allow_empty)
+            *dest++ = arena.store(unescaped);
+        } else if (pos != token_start || allow_empty) {
+          *dest++ = token_view{token_start,
+                               static_cast<std::size_t>(pos - token_start)};
+        }
+        if (pos == end)
+          break;
+        needs_copy = false;
+        unescaped.clear();
+        token_start = pos + 1;
+      } else {
+        if (!needs_copy) {
+          needs_copy = true;
+          unescaped.assign(token_start, pos);
+        }
+        if (*pos == escape_char) {
+          escape_next = true;
+        } else {
+          in_quotes = true;
+          closing_quote = *pos;
+          quote_specials = char_class{};
+          quote_specials.add(closing_quote).add(escape_char);
+        }
+      }
+    }
+    ++pos;
+  }
+}
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::feed(token_view chunk, OutputIt dest) {
+  const char* pos = chunk.data();
+  const char* end = pos + chunk.size();
+  if (m_table) {
+    while (scan(pos, end)) {
+      *dest++ = token_view{m_token};
+      m_token.clear();
+    }
+    return dest;
+  }
+  const char* token_start = pos;
+  while (pos != end) {
+    if (m_escape_next) {
+      m_token.push_back(*pos++);
+      m_escape_next = false;
+      continue;
+    }
+    if (m_in_quotes) {
+      const char* stop = find_first_of(pos, end, m_quote_specials);
+      m_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+      if (*pos == m_closing_quote)
+        m_in_quotes = false;
+      else
+        m_escape_next = true;
+    } else {
+      const char* stop = find_first_of(pos, end, m_specials);
+      if (m_buffered)
+        m_token.append(pos, stop);
+      pos = stop;
+      if (pos == end)
+        break;
+      if (m_delims.contains(*pos)) {
+        if (m_buffered) {
+          if (!m_token.empty() || m_allow_empty)
+            *dest++ = token_view{m_token};
+          m_token.clear();
+          m_buffered = false;
+        } else if (pos != token_start || m_allow_empty) {
+          *dest++ = token_view{token_start,
+                               static_cast<std::size_t>(pos - token_start)};
+        }
+        token_start = pos + 1;
+      } else {
+        if (!m_buffered) {
+          m_buffered = true;
+          m_token.assign(token_start, pos);
+        }
+        if (*pos == m_escape_char) {
+          m_escape_next = true;
+        } else {
+          m_in_quotes = true;
+          m_closing_quote = *pos;
+          m_quote_specials = char_class{};
+          m_quote_specials.add(m_closing_quote).add(m_escape_char);
+        }
+      }
+    }
+    ++pos;
+  }
+  if (!m_buffered && token_start != end) {
+    m_token.assign(token_start, end);
+    m_buffered = true;
+  }
+  return dest;
+}
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::finish(OutputIt dest) {
+  if (m_table ? scan_end() : (!m_token.empty() || m_allow_empty))
+    *dest++ = token_view{m_token};
+  reset();
+  return dest;
+}
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::read(std::istream& in, OutputIt dest) {
+  std::unique_ptr<char[]> buffer{new char[buffer_size]};
+  std::size_t count;
+  while ((count = read_chunk(in, buffer.get(), buffer_size)) != 0)
+    dest = feed(token_view{buffer.get(), count}, dest);
+  return finish(dest);
+}
+template <typename OutputIt>
+OutputIt optionpp::utility::tokenizer::read_fd(int fd, OutputIt dest) {
+  std::unique_ptr<char[]> buffer{new char[buffer_size]};
+  std::size_t count;
+  while ((count = read_chunk(fd, buffer.get(), buffer_size)) != 0)
+    dest = feed(token_view{buffer.get(), count}, dest);
+  return finish(dest);
+}
+
+
+namespace optionpp {
+  class mapped_file {
+  public:
+    struct file_id {
+      std::uint64_t device{0};
+      std::uint64_t index{0};
+      bool operator==(const file_id& other) const noexcept {
+        return device == other.device && index == other.index;
+      }
+      bool operator!=(const file_id& other) const noexcept {
+        return !(*this == other);
+      }
+    };
+    mapped_file() noexcept {}
+    explicit mapped_file(const std::string& path);
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    mapped_file(mapped_file&& other) noexcept { swap(other); }
+    mapped_file& operator=(mapped_file&& other) noexcept {
+      mapped_file temp{std::move(other)};
+      swap(temp);
+      return *this;
+    }
+    ~mapped_file() { close(); }
+    void swap(mapped_file& other) noexcept;
+    void close() noexcept;
+    const char* data() const noexcept { return m_data; }
+    std::size_t size() const noexcept { return m_size; }
+    const file_id& id() const noexcept { return m_id; }
+  private:
+    const char* m_data{""};
+    std::size_t m_size{0};
+    file_id m_id;
+    bool m_mapped{false};
+    bool m_allocated{false};
+  };
+}
+
+
+namespace optionpp {
+  class arg_callback {
+  public:
+    static constexpr std::size_t buffer_size = 4 * sizeof(void*);
+    arg_callback() noexcept {}
+    arg_callback(std::nullptr_t) noexcept {}
+    template <typename F,
+              typename = typename std::enable_if<
+                !std::is_same<typename std::decay<F>::type,
+                              arg_callback>::value>::type>
+    arg_callback(F&& fn);
+    arg_callback(const arg_callback& other);
+    arg_callback(arg_callback&& other) noexcept;
+    arg_callback& operator=(arg_callback other) noexcept {
+      swap(other);
+      return *this;
+    }
+    ~arg_callback() { reset(); }
+    void swap(arg_callback& other) noexcept;
+    void reset() noexcept;
+    bool is_inline() const noexcept { return m_ops && m_ops->is_inline; }
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+    template <typename F>
+    const F* target() const noexcept;
+    bool operator()(const std::string& arg) const {
+      return m_ops ? m_ops->invoke(m_storage, arg) : true;
+    }
+  private:
+    using storage_type
+    = typename std::aligned_storage<buffer_size,
+                                    alignof(std::max_align_t)>::type;
+    struct operations {
+      bool (*invoke)(const storage_type&, const std::string&);
+      void (*copy)(storage_type&, const storage_type&);
+      void (*move)(storage_type&, storage_type&) noexcept;
+      void (*destroy)(storage_type&) noexcept;
+      bool is_inline;
+    };
+    template <typename F>
+    struct fits_inline
+      : std::integral_constant<bool,
+                               sizeof(F) <= buffer_size
+                               && alignof(F) <= alignof(std::max_align_t)
+                               && std::is_nothrow_move_constructible<F>::value> {};
+    template <typename F, bool Inline = fits_inline<F>::value>
+    struct manager;
+    template <typename F>
+    static auto is_null(const F& fn, int)
+      -> decltype(static_cast<bool>(fn == nullptr)) {
+      return fn == nullptr;
+    }
+    template <typename F>
+    static bool is_null(const F&, long) { return false; }
+    storage_type m_storage;
+    const operations* m_ops{nullptr};
+  };
+}
+template <typename F>
+struct optionpp::arg_callback::manager<F, true> {
+  static F& get(const storage_type& s) {
+    return *const_cast<F*>(reinterpret_cast<const F*>(&s));
+  }
+  static bool invoke(const storage_type& s, const std::string& arg) {
+    return static_cast<bool>(get(s)(arg));
+  }
+  template <typename G>
+  static void create(storage_type& dest, G&& fn) {
+    ::new (static_cast<void*>(&dest)) F(std::forward<G>(fn));
+  }
+  static void copy(storage_type& dest, const storage_type& src) {
+    ::new (static_cast<void*>(&dest)) F(get(src));
+  }
+  static void move(storage_type& dest, storage_type& src) noexcept {
+    ::new (static_cast<void*>(&dest)) F(std::move(get(src)));
+    get(src).~F();
+  }
+  static void destroy(storage_type& s) noexcept { get(s).~F(); }
+  static const F* target(const storage_type& s) noexcept { return &get(s); }
+  static const operations ops;
+};
+template <typename F>
+const optionpp::arg_callback::operations
+optionpp::arg_callback::manager<F, true>::ops = {
+  &invoke, &copy, &move, &destroy, true
+};
+template <typename F>
+struct optionpp::arg_callback::manager<F, false> {
+  static F*& get(storage_type& s) {
+    return *reinterpret_cast<F**>(&s);
+  }
+  static F* get(const storage_type& s) {
+    return *reinterpret_cast<F* const*>(&s);
+  }
+  static bool invoke(const storage_type& s, const std::string& arg) {
+    return static_cast<bool>((*get(s))(arg));
+  }
+  template <typename G>
+  static void create(storage_type& dest, G&& fn) {
+    get(dest) = new F(std::forward<G>(fn));
+  }
+  static void copy(storage_type& dest, const storage_type& src) {
+    get(dest) = new F(*get(src));
+  }
+  static void move(storage_type& dest, storage_type& src) noexcept {
+    get(dest) = get(src);
+  }
+  static void destroy(storage_type& s) noexcept { delete get(s); }
+  static const F* target(const storage_type& s) noexcept { return get(s); }
+  static const operations ops;
+};
+template <typename F>
+const optionpp::arg_callback::operations
+optionpp::arg_callback::manager<F, false>::ops = {
+  &invoke, &copy, &move, &destroy, false
+};
+template <typename F, typename>
+optionpp::arg_callback::arg_callback(F&& fn) {
+  using type = typename std::decay<F>::type;
+  if (is_null(static_cast<const type&>(fn), 0))
+    return;
+  manager<type>::create(m_storage, std::forward<F>(fn));
+  m_ops = &manager<type>::ops;
+}
+template <typename F>
+const F* optionpp::arg_callback::target() const noexcept {
+  if (m_ops != &manager<F>::ops)
+    return nullptr;
+  return manager<F>::target(m_storage);
+}
+inline optionpp::arg_callback::arg_callback(const arg_callback& other) {
+  if (other.m_ops) {
+    other.m_ops->copy(m_storage, other.m_storage);
+    m_ops = other.m_ops;
+  }
+}
+inline optionpp::arg_callback::arg_callback(arg_callback&& other) noexcept {
+  if (other.m_ops) {
+    other.m_ops->move(m_storage, other.m_storage);
+    m_ops = other.m_ops;
+    other.m_ops = nullptr;
+  }
+}
+inline void optionpp::arg_callback::swap(arg_callback& other) noexcept {
+  if (this == &other)
+    return;
+  arg_callback temp{std::move(other)};
+  if (m_ops) {
+    m_ops->move(other.m_storage, m_storage);
+    other.m_ops = m_ops;
+    m_ops = nullptr;
+  }
+  if (temp.m_ops) {
+    temp.m_ops->move(m_storage, temp.m_storage);
+    m_ops = temp.m_ops;
+    temp.m_ops = nullptr;
+  }
+}
+inline void optionpp::arg_callback::reset() noexcept {
+  if (m_ops) {
+    m_ops->destroy(m_storage);
+    m_ops = nullptr;
+  }
+}
+
+
+namespace optionpp {
+  class choice_table {
+  public:
+    using value_type = long long;
+    using size_type = std::size_t;
+    static constexpr size_type npos = static_cast<size_type>(-1);
+    choice_table() noexcept {}
+    explicit choice_table(const std::vector<std::string>& names);
+    explicit choice_table(const std::vector<std::pair<std::string,
+                                                      value_type>>& choices);
+    size_type size() const noexcept { return m_names.size(); }
+    bool empty() const noexcept { return m_names.empty(); }
+    size_type find(const std::string& name) const noexcept;
+    const std::string& name(size_type index) const { return m_names[index]; }
+    value_type value(size_type index) const { return m_values[index]; }
+    std::string to_string(const std::string& separator = ", ") const;
+  private:
+    void build();
+    bool try_build(size_type slot_count);
+    static std::uint32_t hash(const std::string& str,
+                              std::uint32_t seed) noexcept;
+    std::vector<std::string> m_names;
+    std::vector<value_type> m_values;
+    std::vector<std::uint32_t> m_bucket_seeds;
+    std::vector<std::uint32_t> m_slots;
+  };
+}
 
 
 namespace optionpp {
@@ -133,7 +830,11 @@ namespace optionpp {
     enum arg_type { string_arg,
                     int_arg,
                     uint_arg,
-                    double_arg
+                    double_arg,
+                    custom_arg,
+                    enum_arg,
+                    duration_arg,
+                    size_arg
     };
     option() noexcept {}
     option(char short_name) : m_short_name{short_name} {}
@@ -147,9 +848,15 @@ namespace optionpp {
       m_short_name = short_name;
       return *this;
     }
+    option& name(utility::static_string long_name,
+                 char short_name = '\0') noexcept {
+      m_long_name = long_name;
+      m_short_name = short_name;
+      return *this;
+    }
     std::string name() const noexcept {
       if (!m_long_name.empty())
-        return m_long_name;
+        return m_long_name.view();
       else if (m_short_name != '\0')
         return std::string{m_short_name};
       else
@@ -159,7 +866,14 @@ namespace optionpp {
       m_long_name = name;
       return *this;
     }
-    const std::string& long_name() const noexcept { return m_long_name; }
+    option& long_name(utility::static_string name) noexcept {
+      m_long_name = name;
+      return *this;
+    }
+    std::string long_name() const { return m_long_name.str(); }
+    utility::token_view long_name_view() const noexcept {
+      return m_long_name.view();
+    }
     option& short_name(char name) noexcept {
       m_short_name = name;
       return *this;
@@ -167,7 +881,16 @@ namespace optionpp {
     char short_name() const noexcept { return m_short_name; }
     option& argument(const std::string& name,
                      bool required = true);
-    const std::string& argument_name() const noexcept { return m_arg_name; }
+    option& argument(utility::static_string name,
+                     bool required = true) noexcept {
+      m_arg_name = name;
+      m_arg_required = required;
+      return *this;
+    }
+    std::string argument_name() const { return m_arg_name.str(); }
+    utility::token_view argument_name_view() const noexcept {
+      return m_arg_name.view();
+    }
     bool is_argument_required() const noexcept { return m_arg_required; }
     arg_type argument_type() const noexcept { return m_arg_type; }
     option& bind_bool(bool* var) noexcept;
@@ -175,82 +898,653 @@ namespace optionpp {
     option& bind_int(int* var) noexcept;
     option& bind_uint(unsigned int* var) noexcept;
     option& bind_double(double* var) noexcept;
-    bool has_bound_argument_variable() const noexcept { return m_bound_variable; }
+    template <typename Rep, typename Period>
+    option& bind_duration(std::chrono::duration<Rep, Period>* var) noexcept;
+    option& bind_size(std::uint64_t* var) noexcept;
+    option& bind_custom(arg_callback converter) noexcept;
+    template <typename T, typename Converter>
+    option& bind_custom(T* var, Converter converter);
+    template <typename E>
+    option& bind_enum(E* var,
+                      std::initializer_list<std::pair<std::string, E>> values);
+    option& choices(const std::vector<std::string>& values);
+    const choice_table& choices() const noexcept { return m_choices; }
+    bool has_bound_argument_variable() const noexcept {
+      if (m_arg_type == custom_arg)
+        return static_cast<bool>(m_converter);
+      else
+        return m_bound_variable;
+    }
     void write_bool(bool value) const noexcept;
     void write_string(const std::string& value) const;
+    void write_string(const char* value, std::size_t size) const;
     void write_int(int value) const;
     void write_uint(unsigned int value) const;
     void write_double(double value) const;
+    void write_duration(std::chrono::nanoseconds value) const;
+    void write_size(std::uint64_t value) const;
+    bool write_custom(const std::string& value) const;
+    bool stage_custom(const std::string& value, arg_callback& commit) const;
+    void write_enum(choice_table::size_type index) const;
+    option& min_value(double value) noexcept {
+      m_min_value = value;
+      return *this;
+    }
+    double min_value() const noexcept { return m_min_value; }
+    option& max_value(double value) noexcept {
+      m_max_value = value;
+      return *this;
+    }
+    double max_value() const noexcept { return m_max_value; }
+    option& range(double min, double max) noexcept {
+      return min_value(min).max_value(max);
+    }
+    option& step(double value) noexcept {
+      m_step = value;
+      return *this;
+    }
+    double step() const noexcept { return m_step; }
+    option& validator(arg_callback fn) noexcept {
+      m_validator = std::move(fn);
+      return *this;
+    }
+    bool validate(const std::string& value) const { return m_validator(value); }
     option& description(const std::string& desc) {
       m_desc = desc;
       return *this;
     }
-    const std::string& description() const noexcept { return m_desc; }
+    option& description(utility::static_string desc) noexcept {
+      m_desc = desc;
+      return *this;
+    }
+    std::string description() const { return m_desc.str(); }
+    utility::token_view description_view() const noexcept {
+      return m_desc.view();
+    }
   private:
-    std::string m_long_name;
+    class text {
+    public:
+      text() noexcept : m_owned{} {}
+      text(std::string str) noexcept : m_owned{std::move(str)} {}
+      text(utility::static_string str) noexcept
+        : m_borrowed{str}, m_is_borrowed{true} {}
+      text(const text& other) : m_is_borrowed{other.m_is_borrowed} {
+        if (m_is_borrowed)
+          new (&m_borrowed) utility::static_string{other.m_borrowed};
+        else
+          new (&m_owned) std::string{other.m_owned};
+      }
+      text(text&& other) noexcept : m_is_borrowed{other.m_is_borrowed} {
+        if (m_is_borrowed)
+          new (&m_borrowed) utility::static_string{other.m_borrowed};
+        else
+          new (&m_owned) std::string{std::move(other.m_owned)};
+      }
+      ~text() { destroy(); }
+      text& operator=(text other) noexcept {
+        destroy();
+        m_is_borrowed = other.m_is_borrowed;
+        if (m_is_borrowed)
+          new (&m_borrowed) utility::static_string{other.m_borrowed};
+        else
+          new (&m_owned) std::string{std::move(other.m_owned)};
+        return *this;
+      }
+      utility::token_view view() const noexcept {
+        if (m_is_borrowed)
+          return m_borrowed;
+        return m_owned;
+      }
+      bool empty() const noexcept { return view().empty(); }
+      std::string str() const { return view(); }
+    private:
+      void destroy() noexcept {
+        if (!m_is_borrowed)
+          m_owned.~basic_string();
+      }
+      union {
+        std::string m_owned;
+        utility::static_string m_borrowed;
+      };
+      bool m_is_borrowed{false};
+    };
+    template <typename T, typename Converter>
+    struct typed_converter {
+      T* var;
+      Converter convert;
+      bool operator()(const std::string& arg) const {
+        T value{};
+        if (!convert(arg, value))
+          return false;
+        *var = std::move(value);
+        return true;
+      }
+    };
+    template <typename T>
+    struct staged_value {
+      T* var;
+      T value;
+      bool operator()(const std::string&) {
+        *var = std::move(value);
+        return true;
+      }
+    };
+    template <typename T, typename Converter>
+    static bool stage(const arg_callback& converter, const std::string& arg,
+                      arg_callback& commit);
+    text m_long_name;
     char m_short_name{'\0'};
-    std::string m_desc;
-    std::string m_arg_name;
+    text m_desc;
+    text m_arg_name;
     bool m_arg_required{false};
     arg_type m_arg_type{string_arg};
     bool* m_is_option_set = nullptr;
     void* m_bound_variable = nullptr;
+    arg_callback m_converter;
+    arg_callback m_validator;
+    choice_table m_choices;
+    double m_min_value{-std::numeric_limits<double>::infinity()};
+    double m_max_value{std::numeric_limits<double>::infinity()};
+    double m_step{0.0};
+    void (*m_value_writer)(void*, long long) = nullptr;
+    bool (*m_stager)(const arg_callback&, const std::string&,
+                     arg_callback&) = nullptr;
+  };
+}
+template <typename E>
+optionpp::option&
+optionpp::option::bind_enum(E* var,
+                            std::initializer_list<std::pair<std::string, E>> values) {
+  std::vector<std::pair<std::string, choice_table::value_type>> table;
+  table.reserve(values.size());
+  for (const auto& v : values)
+    table.emplace_back(v.first, static_cast<choice_table::value_type>(v.second));
+  if (var && m_arg_name.empty()) {
+    m_arg_name = std::string{"CHOICE"};
+    m_arg_required = true;
+  }
+  m_arg_type = enum_arg;
+  m_bound_variable = var;
+  m_choices = choice_table{table};
+  m_value_writer = [](void* dest, long long value) {
+    *static_cast<E*>(dest) = static_cast<E>(value);
+  };
+  return *this;
+}
+template <typename Rep, typename Period>
+optionpp::option&
+optionpp::option::bind_duration(std::chrono::duration<Rep, Period>* var) noexcept {
+  using duration = std::chrono::duration<Rep, Period>;
+  if (var && m_arg_name.empty()) {
+    m_arg_name = std::string{"DURATION"};
+    m_arg_required = true;
+  }
+  m_arg_type = duration_arg;
+  m_bound_variable = var;
+  m_value_writer = [](void* dest, long long value) {
+    *static_cast<duration*>(dest)
+      = std::chrono::duration_cast<duration>(std::chrono::nanoseconds{value});
   };
+  return *this;
+}
+template <typename T, typename Converter>
+optionpp::option&
+optionpp::option::bind_custom(T* var, Converter converter) {
+  if (!var)
+    return bind_custom(arg_callback{});
+  using converter_type = typed_converter<T, Converter>;
+  bind_custom(arg_callback{converter_type{var, std::move(converter)}});
+  m_stager = &stage<T, Converter>;
+  return *this;
+}
+template <typename T, typename Converter>
+bool optionpp::option::stage(const arg_callback& converter,
+                             const std::string& arg, arg_callback& commit) {
+  const auto* conv = converter.target<typed_converter<T, Converter>>();
+  T value{};
+  if (!conv->convert(arg, value))
+    return false;
+  commit = arg_callback{staged_value<T>{conv->var, std::move(value)}};
+  return true;
 }
 
 
 namespace optionpp {
-  class option_group {
+  class write_log {
   public:
-    using value_type = option;
-    using container_type = std::vector<option>;
-    using size_type = container_type::size_type;
-    using iterator = container_type::iterator;
-    using const_iterator = container_type::const_iterator;
-    using reverse_iterator = container_type::reverse_iterator;
-    using const_reverse_iterator = container_type::const_reverse_iterator;
-    option_group() noexcept {}
-    option_group(const std::string& name) : m_name{name} {}
-    template <typename InputIt>
-    option_group(const std::string& name,
-                 InputIt first, InputIt last)
-      : m_name{name}, m_options{first, last} {}
-    const std::string& name() const noexcept { return m_name; }
-    option& add_option(const option& opt = option{}) {
-      m_options.push_back(opt);
-      return m_options.back();
+    using size_type = std::vector<int>::size_type;
+    write_log() noexcept {}
+    explicit write_log(bool deferred) noexcept : m_deferred{deferred} {}
+    bool is_deferred() const noexcept { return m_deferred; }
+    void set_deferred(bool deferred) noexcept { m_deferred = deferred; }
+    bool records_unbound() const noexcept { return m_record_unbound; }
+    void set_record_unbound(bool record) noexcept { m_record_unbound = record; }
+    size_type size() const noexcept { return m_records.size(); }
+    bool empty() const noexcept { return m_records.empty(); }
+    void clear() noexcept {
+      m_records.clear();
+      m_strings.clear();
+      m_staged.clear();
     }
-    option& add_option(const std::string& long_name,
-                       char short_name = '\0',
-                       const std::string& description = "",
-                       const std::string& arg_name = "",
-                       bool arg_required = false);
-    size_type size() const noexcept { return m_options.size(); }
-    bool empty() const noexcept { return m_options.empty(); }
-    iterator begin() noexcept { return m_options.begin(); }
-    const_iterator begin() const noexcept { return cbegin(); }
-    iterator end() noexcept { return m_options.end(); }
-    const_iterator end() const noexcept { return cend(); }
-    const_iterator cbegin() const noexcept { return m_options.cbegin(); }
-    const_iterator cend() const noexcept { return m_options.cend(); }
-    reverse_iterator rbegin() noexcept { return m_options.rbegin(); }
-    const_reverse_iterator rbegin() const noexcept { return crbegin(); }
-    reverse_iterator rend() noexcept { return m_options.rend(); }
-    const_reverse_iterator rend() const noexcept { return crend(); }
-    const_reverse_iterator crbegin() const noexcept { return m_options.crbegin(); }
-    const_reverse_iterator crend() const noexcept { return m_options.crend(); }
-    iterator find(const std::string& long_name);
-    const_iterator find(const std::string& long_name) const;
-    iterator find(char short_name);
-    const_iterator find(char short_name) const;
-    void sort();
-    option& operator[](const std::string long_name);
-    option& operator[](char short_name);
+    void commit();
+    template <typename Visitor>
+    void replay(Visitor& visitor) const;
+    void write_bool(const option& opt, bool value);
+    void write_string(const option& opt, const std::string& value);
+    void write_int(const option& opt, int value);
+    void write_uint(const option& opt, unsigned int value);
+    void write_double(const option& opt, double value);
+    void write_duration(const option& opt, std::chrono::nanoseconds value);
+    void write_size(const option& opt, std::uint64_t value);
+    void write_enum(const option& opt, choice_table::size_type index);
+    bool write_custom(const option& opt, const std::string& value);
   private:
-    std::string m_name;
-    container_type m_options;
-  };
-}
+    enum class write_type : unsigned char {
+      bool_write,
+      string_write,
+      int_write,
+      uint_write,
+      double_write,
+      duration_write,
+      size_write,
+      enum_write,
+      custom_write
+    };
+    struct string_ref {
+      std::uint32_t pos;
+      std::uint32_t len;
+    };
+    struct record {
+      const option* opt;
+      write_type type;
+      union {
+        long long int_value;
+        unsigned long long uint_value;
+        double double_value;
+        string_ref str;
+      };
+    };
+    void record_string(const option& opt, write_type type,
+                       const std::string& value);
+    bool m_deferred{false};
+    bool m_record_unbound{false};
+    std::vector<record> m_records;
+    std::string m_strings;
+    std::vector<arg_callback> m_staged;
+  };
+}
+template <typename Visitor>
+void optionpp::write_log::replay(Visitor& visitor) const {
+  std::string value;
+  for (const auto& r : m_records) {
+    const option& opt = *r.opt;
+    switch (r.type) {
+    case write_type::bool_write:
+      visitor.write_bool(opt, r.int_value != 0);
+      break;
+    case write_type::string_write:
+      value.assign(m_strings, r.str.pos, r.str.len);
+      visitor.write_string(opt, value);
+      break;
+    case write_type::int_write:
+      visitor.write_int(opt, static_cast<int>(r.int_value));
+      break;
+    case write_type::uint_write:
+      visitor.write_uint(opt, static_cast<unsigned int>(r.uint_value));
+      break;
+    case write_type::double_write:
+      visitor.write_double(opt, r.double_value);
+      break;
+    case write_type::duration_write:
+      visitor.write_duration(opt, std::chrono::nanoseconds{r.int_value});
+      break;
+    case write_type::size_write:
+      visitor.write_size(opt, r.uint_value);
+      break;
+    case write_type::enum_write:
+      visitor.write_enum(opt, static_cast<choice_table::size_type>(r.uint_value));
+      break;
+    case write_type::custom_write:
+      value.assign(m_strings, r.str.pos, r.str.len);
+      visitor.write_custom(opt, value);
+      break;
+    }
+  }
+}
+
+
+namespace optionpp {
+  template <typename Target>
+  class binding_map {
+  public:
+    binding_map& bind_bool(const option& opt, bool Target::* member);
+    binding_map& bind_string(const option& opt,
+                             std::string Target::* member);
+    binding_map& bind_int(const option& opt, int Target::* member);
+    binding_map& bind_uint(const option& opt,
+                           unsigned int Target::* member);
+    binding_map& bind_double(const option& opt, double Target::* member);
+    template <typename Rep, typename Period>
+    binding_map& bind_duration(const option& opt,
+                               std::chrono::duration<Rep, Period> Target::* member);
+    binding_map& bind_size(const option& opt,
+                           std::uint64_t Target::* member);
+    bool empty() const noexcept { return m_bindings.empty(); }
+    void apply(const write_log& writes, Target& target) const;
+  private:
+    enum class member_type : unsigned char {
+      bool_member,
+      string_member,
+      int_member,
+      uint_member,
+      double_member,
+      duration_member,
+      size_member
+    };
+    using erased_member = char Target::*;
+    struct binding {
+      std::string long_name;
+      char short_name;
+      member_type type;
+      union {
+        bool Target::* bool_ptr;
+        std::string Target::* string_ptr;
+        int Target::* int_ptr;
+        unsigned int Target::* uint_ptr;
+        double Target::* double_ptr;
+        erased_member duration_ptr;
+        std::uint64_t Target::* size_ptr;
+      };
+      void (*duration_writer)(Target&, erased_member,
+                              std::chrono::nanoseconds) = nullptr;
+    };
+    class writer;
+    static void check_type(const option& opt, option::arg_type type,
+                           option::arg_type alt_type,
+                           const std::string& fn_name);
+    static binding make_binding(const option& opt, member_type type);
+    void insert(const binding& b);
+    const binding* find(const option& opt, bool flag) const noexcept;
+    static int compare(const binding& b, utility::token_view long_name,
+                       char short_name) noexcept {
+      int result = b.long_name.compare(0, std::string::npos,
+                                       long_name.data(), long_name.size());
+      if (result != 0)
+        return result;
+      return static_cast<unsigned char>(b.short_name)
+        - static_cast<unsigned char>(short_name);
+    }
+    static bool before(const binding& a, const binding& b) noexcept {
+      int result = compare(a, b.long_name, b.short_name);
+      if (result != 0)
+        return result < 0;
+      return a.type == member_type::bool_member
+        && b.type != member_type::bool_member;
+    }
+    std::vector<binding> m_bindings;
+  };
+}
+template <typename Target>
+class optionpp::binding_map<Target>::writer {
+public:
+  writer(const binding_map& map, Target& target) noexcept
+    : m_map{map}, m_target{target} {}
+  void write_bool(const option& opt, bool value) const {
+    if (auto b = m_map.find(opt, true))
+      m_target.*(b->bool_ptr) = value;
+  }
+  void write_string(const option& opt, const std::string& value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::string_member)
+      m_target.*(b->string_ptr) = value;
+  }
+  void write_int(const option& opt, int value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::int_member)
+      m_target.*(b->int_ptr) = value;
+  }
+  void write_uint(const option& opt, unsigned int value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::uint_member)
+      m_target.*(b->uint_ptr) = value;
+  }
+  void write_double(const option& opt, double value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::double_member)
+      m_target.*(b->double_ptr) = value;
+  }
+  void write_duration(const option& opt,
+                      std::chrono::nanoseconds value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::duration_member)
+      b->duration_writer(m_target, b->duration_ptr, value);
+  }
+  void write_size(const option& opt, std::uint64_t value) const {
+    auto b = m_map.find(opt, false);
+    if (b && b->type == member_type::size_member)
+      m_target.*(b->size_ptr) = value;
+  }
+  void write_enum(const option& opt, choice_table::size_type index) const {
+    auto b = m_map.find(opt, false);
+    if (!b)
+      return;
+    if (b->type == member_type::string_member)
+      m_target.*(b->string_ptr) = opt.choices().name(index);
+    else if (b->type == member_type::int_member)
+      m_target.*(b->int_ptr) = static_cast<int>(opt.choices().value(index));
+  }
+  void write_custom(const option& opt, const std::string& value) const {
+    write_string(opt, value);
+  }
+private:
+  const binding_map& m_map;
+  Target& m_target;
+};
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_bool(const option& opt,
+                                         bool Target::* member) {
+  binding b = make_binding(opt, member_type::bool_member);
+  b.bool_ptr = member;
+  insert(b);
+  return *this;
+}
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_string(const option& opt,
+                                           std::string Target::* member) {
+  if (opt.argument_type() != option::custom_arg)
+    check_type(opt, option::string_arg, option::enum_arg,
+               "optionpp::binding_map::bind_string");
+  else if (opt.has_bound_argument_variable())
+    throw type_error{"option '" + opt.name()
+        + "' has a converter, which cannot write to a member",
+        "optionpp::binding_map::bind_string"};
+  binding b = make_binding(opt, member_type::string_member);
+  b.string_ptr = member;
+  insert(b);
+  return *this;
+}
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_int(const option& opt,
+                                        int Target::* member) {
+  check_type(opt, option::int_arg, option::enum_arg,
+             "optionpp::binding_map::bind_int");
+  binding b = make_binding(opt, member_type::int_member);
+  b.int_ptr = member;
+  insert(b);
+  return *this;
+}
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_uint(const option& opt,
+                                         unsigned int Target::* member) {
+  check_type(opt, option::uint_arg, option::uint_arg,
+             "optionpp::binding_map::bind_uint");
+  binding b = make_binding(opt, member_type::uint_member);
+  b.uint_ptr = member;
+  insert(b);
+  return *this;
+}
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_double(const option& opt,
+                                           double Target::* member) {
+  check_type(opt, option::double_arg, option::double_arg,
+             "optionpp::binding_map::bind_double");
+  binding b = make_binding(opt, member_type::double_member);
+  b.double_ptr = member;
+  insert(b);
+  return *this;
+}
+template <typename Target>
+template <typename Rep, typename Period>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_duration(const option& opt,
+                                             std::chrono::duration<Rep, Period> Target::* member) {
+  using duration = std::chrono::duration<Rep, Period>;
+  check_type(opt, option::duration_arg, option::duration_arg,
+             "optionpp::binding_map::bind_duration");
+  binding b = make_binding(opt, member_type::duration_member);
+  b.duration_ptr = reinterpret_cast<erased_member>(member);
+  b.duration_writer = [](Target& target, erased_member ptr,
+                         std::chrono::nanoseconds value) {
+    target.*reinterpret_cast<duration Target::*>(ptr)
+      = std::chrono::duration_cast<duration>(value);
+  };
+  insert(b);
+  return *this;
+}
+template <typename Target>
+optionpp::binding_map<Target>&
+optionpp::binding_map<Target>::bind_size(const option& opt,
+                                         std::uint64_t Target::* member) {
+  check_type(opt, option::size_arg, option::size_arg,
+             "optionpp::binding_map::bind_size");
+  binding b = make_binding(opt, member_type::size_member);
+  b.size_ptr = member;
+  insert(b);
+  return *this;
+}
+template <typename Target>
+void optionpp::binding_map<Target>::apply(const write_log& writes,
+                                          Target& target) const {
+  writer w{*this, target};
+  writes.replay(w);
+}
+template <typename Target>
+void optionpp::binding_map<Target>::check_type(const option& opt,
+                                               option::arg_type type,
+                                               option::arg_type alt_type,
+                                               const std::string& fn_name) {
+  if (opt.argument_type() != type && opt.argument_type() != alt_type)
+    throw type_error{"option '" + opt.name()
+        + "' does not accept this type of argument", fn_name};
+}
+template <typename Target>
+typename optionpp::binding_map<Target>::binding
+optionpp::binding_map<Target>::make_binding(const option& opt,
+                                            member_type type) {
+  binding b;
+  b.long_name = opt.long_name();
+  b.short_name = opt.short_name();
+  b.type = type;
+  return b;
+}
+template <typename Target>
+void optionpp::binding_map<Target>::insert(const binding& b) {
+  auto it = std::lower_bound(m_bindings.begin(), m_bindings.end(), b,
+                             before);
+  if (it != m_bindings.end() && !before(b, *it))
+    *it = b;
+  else
+    m_bindings.insert(it, b);
+}
+template <typename Target>
+const typename optionpp::binding_map<Target>::binding*
+optionpp::binding_map<Target>::find(const option& opt,
+                                    bool flag) const noexcept {
+  utility::token_view long_name = opt.long_name_view();
+  char short_name = opt.short_name();
+  auto it = std::lower_bound(m_bindings.begin(), m_bindings.end(), flag,
+                             [&](const binding& b, bool find_flag) {
+                               int result = compare(b, long_name, short_name);
+                               if (result != 0)
+                                 return result < 0;
+                               return !find_flag
+                                 && b.type == member_type::bool_member;
+                             });
+  if (it == m_bindings.end()
+      || compare(*it, long_name, short_name) != 0
+      || flag != (it->type == member_type::bool_member))
+    return nullptr;
+  return &*it;
+}
+
+
+namespace optionpp {
+  class option_group {
+  public:
+    using value_type = option;
+    using container_type = std::vector<option>;
+    using size_type = container_type::size_type;
+    using iterator = container_type::iterator;
+    using const_iterator = container_type::const_iterator;
+    using reverse_iterator = container_type::reverse_iterator;
+    using const_reverse_iterator = container_type::const_reverse_iterator;
+    option_group() noexcept {}
+    option_group(std::string name) : m_name{std::move(name)} {}
+    template <typename InputIt>
+    option_group(std::string name, InputIt first, InputIt last)
+      : m_name{std::move(name)}, m_options{first, last} {}
+    const std::string& name() const noexcept { return m_name; }
+    option& add_option(const option& opt = option{}) {
+      m_options.push_back(opt);
+      return m_options.back();
+    }
+    option& add_option(option&& opt) {
+      m_options.push_back(std::move(opt));
+      return m_options.back();
+    }
+    template <typename... Args>
+    option& emplace_option(Args&&... args) {
+      m_options.emplace_back(std::forward<Args>(args)...);
+      return m_options.back();
+    }
+    option& add_option(const std::string& long_name,
+                       char short_name = '\0',
+                       const std::string& description = "",
+                       const std::string& arg_name = "",
+                       bool arg_required = false);
+    size_type size() const noexcept { return m_options.size(); }
+    bool empty() const noexcept { return m_options.empty(); }
+    void reserve(size_type count) { m_options.reserve(count); }
+    iterator begin() noexcept { return m_options.begin(); }
+    const_iterator begin() const noexcept { return cbegin(); }
+    iterator end() noexcept { return m_options.end(); }
+    const_iterator end() const noexcept { return cend(); }
+    const_iterator cbegin() const noexcept { return m_options.cbegin(); }
+    const_iterator cend() const noexcept { return m_options.cend(); }
+    reverse_iterator rbegin() noexcept { return m_options.rbegin(); }
+    const_reverse_iterator rbegin() const noexcept { return crbegin(); }
+    reverse_iterator rend() noexcept { return m_options.rend(); }
+    const_reverse_iterator rend() const noexcept { return crend(); }
+    const_reverse_iterator crbegin() const noexcept { return m_options.crbegin(); }
+    const_reverse_iterator crend() const noexcept { return m_options.crend(); }
+    iterator find(utility::token_view long_name);
+    const_iterator find(utility::token_view long_name) const;
+    iterator find(char short_name);
+    const_iterator find(char short_name) const;
+    void sort();
+    option& operator[](const std::string& long_name);
+    option& operator[](utility::static_string long_name);
+    option& operator[](char short_name);
+  private:
+    std::string m_name;
+    container_type m_options;
+  };
+}
 
 
 namespace optionpp {
@@ -287,7 +1581,10 @@ namespace optionpp {
     parser_result(InputIt first, InputIt last) : m_entries{first, last} {}
     void push_back(const value_type& entry) { m_entries.push_back(entry); }
     void push_back(value_type&& entry) { m_entries.push_back(std::move(entry)); }
-    void clear() noexcept { m_entries.clear(); }
+    void clear() noexcept {
+      m_entries.clear();
+      m_writes.clear();
+    }
     size_type size() const noexcept { return m_entries.size(); }
     bool empty() const noexcept { return m_entries.empty(); }
     iterator begin() noexcept { return m_entries.begin(); }
@@ -334,8 +1631,17 @@ namespace optionpp {
     bool is_option_set(char short_name) const noexcept;
     std::string get_argument(std::string long_name) const noexcept;
     std::string get_argument(char short_name) const noexcept;
+    write_log& pending_writes() noexcept { return m_writes; }
+    const write_log& pending_writes() const noexcept { return m_writes; }
+    void commit() { m_writes.commit(); }
   private:
     container_type m_entries;
+    write_log m_writes;
+  };
+  struct batch_entry {
+    parser_result result;
+    std::exception_ptr error;
+    bool ok() const noexcept { return !error; }
   };
 }
 
@@ -457,15 +1763,6 @@ bool optionpp::result_iterator<T, Ptr, Ref, IsOption>
 
 
 namespace optionpp {
-  class parse_error : public error {
-  public:
-    parse_error(const std::string msg, const std::string fn_name,
-                const std::string option = "")
-      : error(msg, fn_name), m_option{option} {}
-    const std::string& option() const noexcept { return m_option; }
-  private:
-    std::string m_option;
-  };
   class parser {
   public:
     parser() noexcept {}
@@ -476,6 +1773,11 @@ namespace optionpp {
     parser(InputIt first, InputIt last) { m_groups.emplace_back("", first, last); }
     option_group& group(const std::string& name);
     option& add_option(const option& opt = option{});
+    option& add_option(option&& opt);
+    template <typename... Args>
+    option& emplace_option(Args&&... args) {
+      return group("").emplace_option(std::forward<Args>(args)...);
+    }
     option& add_option(const std::string& long_name,
                        char short_name = '\0',
                        const std::string& description = "",
@@ -486,14 +1788,37 @@ namespace optionpp {
     parser_result parse(InputIt first, InputIt last, bool ignore_first = true) const;
     parser_result parse(int argc, char* argv[], bool ignore_first = true) const;
     parser_result parse(const std::string& cmd_line, bool ignore_first = false) const;
+    template <typename InputIt, typename Target>
+    parser_result parse(InputIt first, InputIt last,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first = true) const;
+    template <typename Target>
+    parser_result parse(const std::string& cmd_line,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first = false) const;
+    parser_result parse(std::istream& in, bool ignore_first = false) const;
+    parser_result parse_fd(int fd, bool ignore_first = false) const;
+    template <typename ForwardIt>
+    std::vector<batch_entry> parse_batch(ForwardIt first, ForwardIt last,
+                                         unsigned thread_count = 0,
+                                         bool ignore_first = false) const;
     void set_custom_strings(const std::string& delims,
                             const std::string& short_prefix = "",
                             const std::string& long_prefix = "",
                             const std::string& end_indicator = "",
                             const std::string& equals = "");
+    void set_transactional(bool enabled) noexcept { m_transactional = enabled; }
+    bool is_transactional() const noexcept { return m_transactional; }
+    void set_response_files(bool enabled) noexcept { m_response_files = enabled; }
+    bool has_response_files() const noexcept { return m_response_files; }
+    void set_dialect(utility::shell_dialect dialect) noexcept {
+      m_dialect = dialect;
+    }
+    utility::shell_dialect dialect() const noexcept { return m_dialect; }
     void sort_groups();
     void sort_options();
     option& operator[](const std::string& long_name);
+    option& operator[](utility::static_string long_name);
     option& operator[](char short_name);
     std::ostream& print_help(std::ostream& os,
                              int max_line_length = 78,
@@ -501,6 +1826,33 @@ namespace optionpp {
                              int option_indent = 2,
                              int desc_first_line_indent = 30,
                              int desc_multiline_indent = 32) const;
+    struct man_page_info {
+      std::string name;
+      int section{1};
+      std::string date;
+      std::string source;
+      std::string manual;
+      std::string summary;
+      std::string synopsis;
+      std::string description;
+    };
+    std::ostream& print_man_page(std::ostream& os,
+                                 const man_page_info& info) const;
+    std::ostream& print_markdown(std::ostream& os,
+                                 int heading_level = 2) const;
+    std::ostream& print_json(std::ostream& os) const;
+    std::vector<std::string> complete(const std::string& prefix,
+                                      const std::string& previous = "") const;
+    enum class completion_shell {
+      bash,
+      zsh,
+      fish
+    };
+    static std::ostream& print_completion_script(std::ostream& os,
+                                                 completion_shell shell,
+                                                 const std::string& program);
+    bool run_completion(int argc, char* argv[]) const;
+    bool run_completion(int argc, char* argv[], std::ostream& os) const;
   private:
     using group_container = std::vector<option_group>;
     using group_iterator = group_container::iterator;
@@ -509,8 +1861,8 @@ namespace optionpp {
     using option_const_iterator = option_group::const_iterator;
     group_iterator find_group(const std::string& name);
     group_const_iterator find_group(const std::string& name) const;
-    option* find_option(const std::string& long_name);
-    const option* find_option(const std::string& long_name) const;
+    option* find_option(utility::token_view long_name);
+    const option* find_option(utility::token_view long_name) const;
     option* find_option(char short_name);
     const option* find_option(char short_name) const;
     bool is_end_indicator(const std::string& argument) const noexcept {
@@ -529,7 +1881,11 @@ namespace optionpp {
         && !is_long_option(argument)
         && !is_short_option_group(argument);
     }
-    void write_option_argument(const parsed_entry& entry) const;
+    const option* option_awaiting_argument(const std::string& argument) const;
+    void write_option_argument(const parsed_entry& entry,
+                               write_log& writes) const;
+    void check_range(const option& opt, double value,
+                     const std::string& opt_name) const;
     enum class cl_arg_type { non_option,
                              end_indicator,
                              arg_required,
@@ -541,56 +1897,174 @@ namespace optionpp {
     void parse_short_option_group(const std::string& short_names,
                                   const std::string& argument, bool has_arg,
                                   parser_result& result, cl_arg_type& type) const;
+    void parse_token(const std::string& token, parser_result& result,
+                     cl_arg_type& type) const;
+    void parse_token(const std::string& token, parser_result& result,
+                     cl_arg_type& type,
+                     std::vector<mapped_file::file_id>& includes) const;
+    void parse_response_file(const std::string& path, parser_result& result,
+                             cl_arg_type& type,
+                             std::vector<mapped_file::file_id>& includes) const;
+    void finish_parse(const parser_result& result, cl_arg_type type) const;
+    template <typename InputIt>
+    void parse_range(InputIt first, InputIt last, bool ignore_first,
+                     parser_result& result) const;
+    void parse_string(const std::string& cmd_line, bool ignore_first,
+                      parser_result& result) const;
+    static void run_batch(std::size_t count, unsigned thread_count,
+                          const std::function<void(std::size_t,
+                                                   std::size_t)>& task);
+    void render_help(std::ostream& os, int max_line_length,
+                     int group_indent, int option_indent,
+                     int desc_first_line_indent,
+                     int desc_multiline_indent) const;
+    class help_cache {
+    public:
+      using key_type = std::array<int, 5>;
+      help_cache() noexcept {}
+      help_cache(const help_cache&) noexcept {}
+      help_cache& operator=(const help_cache&) noexcept {
+        clear();
+        return *this;
+      }
+      std::shared_ptr<const std::string> find(const key_type& key) const;
+      void insert(const key_type& key,
+                  std::shared_ptr<const std::string> text);
+      void clear() noexcept;
+    private:
+      static constexpr std::size_t max_entries = 4;
+      mutable std::mutex m_mutex;
+      std::vector<std::pair<key_type,
+                            std::shared_ptr<const std::string>>> m_entries;
+    };
+    class name_index {
+    public:
+      name_index() noexcept {}
+      name_index(const name_index&) noexcept {}
+      name_index& operator=(const name_index&) noexcept {
+        clear();
+        return *this;
+      }
+      std::vector<std::string> suggest(const group_container& groups,
+                                       const std::string& name) const;
+      std::vector<std::string> complete(const group_container& groups,
+                                        const std::string& prefix) const;
+      std::string short_names(const group_container& groups) const;
+      void clear() noexcept;
+    private:
+      static constexpr std::size_t max_suggestions = 3;
+      struct tree;
+      struct sorted_names;
+      std::shared_ptr<const sorted_names>
+      get_sorted(const group_container& groups) const;
+      mutable std::mutex m_mutex;
+      mutable std::shared_ptr<const tree> m_tree;
+      mutable std::shared_ptr<const sorted_names> m_sorted;
+    };
+    class token_sink;
+    utility::tokenizer make_tokenizer() const;
+    friend class incremental_parser;
     group_container m_groups;
-    std::string m_delims{" \t\n\r"};
+    utility::char_class m_delims{" \t\n\r"};
     std::string m_short_option_prefix{"-"};
     std::string m_long_option_prefix{"--"};
     std::string m_end_of_options{"--"};
     std::string m_equals{"="};
+    bool m_transactional{false};
+    bool m_response_files{false};
+    utility::shell_dialect m_dialect{utility::shell_dialect::generic};
+    mutable help_cache m_help_cache;
+    name_index m_names;
+  };
+  class incremental_parser {
+  public:
+    explicit incremental_parser(const parser& parser,
+                                bool ignore_first = false);
+    void feed(const std::string& token);
+    parser_result finish();
+    void reset(bool ignore_first = false);
+    const parser_result& result() const noexcept { return m_result; }
+    bool awaiting_argument() const noexcept {
+      return m_type == parser::cl_arg_type::arg_required
+        || m_type == parser::cl_arg_type::arg_optional;
+    }
+  private:
+    const parser* m_parser;
+    parser_result m_result;
+    parser::cl_arg_type m_type{parser::cl_arg_type::non_option};
+    bool m_skip_next;
+    std::vector<mapped_file::file_id> m_includes;
   };
   std::ostream& operator<<(std::ostream& os, const parser& parser);
 }
 template <typename InputIt>
 optionpp::parser_result
 optionpp::parser::parse(InputIt first, InputIt last, bool ignore_first) const {
+  parser_result result{};
+  result.pending_writes().set_deferred(m_transactional);
+  parse_range(first, last, ignore_first, result);
+  return result;
+}
+template <typename InputIt, typename Target>
+optionpp::parser_result
+optionpp::parser::parse(InputIt first, InputIt last,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first) const {
+  parser_result result{};
+  result.pending_writes().set_deferred(true);
+  result.pending_writes().set_record_unbound(true);
+  parse_range(first, last, ignore_first, result);
+  bindings.apply(result.pending_writes(), target);
+  result.pending_writes().clear();
+  return result;
+}
+template <typename Target>
+optionpp::parser_result
+optionpp::parser::parse(const std::string& cmd_line,
+                        const binding_map<Target>& bindings, Target& target,
+                        bool ignore_first) const {
+  parser_result result{};
+  result.pending_writes().set_deferred(true);
+  result.pending_writes().set_record_unbound(true);
+  parse_string(cmd_line, ignore_first, result);
+  bindings.apply(result.pending_writes(), target);
+  result.pending_writes().clear();
+  return result;
+}
+template <typename InputIt>
+void optionpp::parser::parse_range(InputIt first, InputIt last,
+                                   bool ignore_first,
+                                   parser_result& result) const {
   if (ignore_first && first != last)
     ++first;
   InputIt it{first};
-  parser_result result{};
   cl_arg_type prev_type{cl_arg_type::non_option};
-  while (it != last) {
-    const std::string& arg{*it};
-    if (prev_type == cl_arg_type::arg_required
-        || prev_type == cl_arg_type::arg_optional) {
-      if (is_non_option(arg)
-          || prev_type == cl_arg_type::arg_required) {
-        auto& arg_info = result.back();
-        arg_info.argument = arg;
-        arg_info.original_text.push_back(' ');
-        arg_info.original_text += arg;
-        prev_type = cl_arg_type::non_option;
-        if (arg_info.opt_info)
-          write_option_argument(arg_info);
-      } else {
-        prev_type = cl_arg_type::non_option;
-        continue;
-      }
-    } else if (prev_type == cl_arg_type::end_indicator) {
-      parsed_entry arg_info;
-      arg_info.original_text = arg;
-      arg_info.is_option = false;
-      result.push_back(std::move(arg_info));
-    } else {
-      parse_argument(arg, result, prev_type);
-    }
-    ++it;
-  }
-  if (prev_type == cl_arg_type::arg_required) {
-    const auto& opt_name = result.back().original_text;
-    throw parse_error{"option '" + opt_name + "' requires an argument",
-        "optionpp::parser::parse", opt_name};
-  }
-  return result;
+  for (; it != last; ++it)
+    parse_token(*it, result, prev_type);
+  finish_parse(result, prev_type);
+}
+template <typename ForwardIt>
+std::vector<optionpp::batch_entry>
+optionpp::parser::parse_batch(ForwardIt first, ForwardIt last,
+                              unsigned thread_count, bool ignore_first) const {
+  std::vector<ForwardIt> lines;
+  for (; first != last; ++first)
+    lines.push_back(first);
+  std::vector<batch_entry> entries(lines.size());
+  run_batch(lines.size(), thread_count,
+            [&](std::size_t begin, std::size_t end) {
+              for (std::size_t i = begin; i != end; ++i) {
+                try {
+                  parser_result result{};
+                  result.pending_writes().set_deferred(true);
+                  parse_string(*lines[i], ignore_first, result);
+                  entries[i].result = std::move(result);
+                } catch (...) {
+                  entries[i].error = std::current_exception();
+                }
+              }
+            });
+  return entries;
 }
 
 
@@ -599,24 +2073,745 @@ optionpp::parser::parse(InputIt first, InputIt last, bool ignore_first) const {
 
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <istream>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
+#if defined(_WIN32)
+#include <io.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#if !defined(OPTIONPP_NO_SIMD) && defined(__AVX2__)
+#define OPTIONPP_USE_AVX2
+#include <immintrin.h>
+#endif
+#if !defined(OPTIONPP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) \
+                                   || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define OPTIONPP_USE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <functional>
+#include <iterator>
+#endif
+
 
 namespace optionpp {
   namespace utility {
-    bool is_space(char c) {
-      return std::isspace(static_cast<unsigned char>(c));
+    const char_class& whitespace() {
+      static const char_class space_chars{" \t\n\v\f\r"};
+      return space_chars;
     }
-    std::string wrap_line(const std::string& str,
-                          int line_len,
-                          int indent,
-                          int first_line_indent) {
-      if (line_len <= 0)
-        return std::string(first_line_indent, ' ') + str;
+    inline unsigned count_trailing_zeros(std::uint32_t mask) noexcept {
+#if defined(_MSC_VER)
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+      return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+      unsigned index = 0;
+      while (!(mask & 1)) {
+        mask >>= 1;
+        ++index;
+      }
+      return index;
+#endif
+    }
+    constexpr std::size_t char_class::max_listed;
+    constexpr std::size_t token_arena::block_size;
+    std::ostream& operator<<(std::ostream& os, token_view view) {
+      return os.write(view.data(), view.size());
+    }
+    token_view token_arena::store(const char* data, std::size_t size) {
+      if (size == 0)
+        return token_view{};
+      while (m_current < m_blocks.size()
+             && m_blocks[m_current].size - m_used < size) {
+        ++m_current;
+        m_used = 0;
+      }
+      if (m_current == m_blocks.size()) {
+        std::size_t new_size = std::max(block_size, size);
+        m_blocks.push_back(block{std::unique_ptr<char[]>{new char[new_size]},
+                                 new_size});
+        m_used = 0;
+      }
+      char* dest = m_blocks[m_current].data.get() + m_used;
+      std::copy(data, data + size, dest);
+      m_used += size;
+      return token_view{dest, size};
+    }
+    constexpr std::size_t tokenizer::buffer_size;
+    tokenizer::tokenizer(const char_class& delims, const std::string& quotes,
+                         char escape_char, bool allow_empty)
+      : m_delims{delims}, m_specials{delims}, m_escape_char{escape_char},
+        m_allow_empty{allow_empty} {
+      m_specials.add(escape_char).add(quotes);
+    }
+    tokenizer::tokenizer(shell_dialect dialect) : tokenizer{} {
+      if (dialect != shell_dialect::generic)
+        m_table = &table(dialect);
+    }
+    void tokenizer::reset() noexcept {
+      m_token.clear();
+      m_buffered = false;
+      m_escape_next = false;
+      m_in_quotes = false;
+      m_closing_quote = '\0';
+      m_state = 0;
+      m_backslashes = 0;
+      m_started = false;
+    }
+    struct tokenizer::shell_table {
+      enum char_type : unsigned char {
+        other_char, space_char, newline_char, single_quote, double_quote,
+        backslash, dquote_special, char_type_count
+      };
+      enum action : unsigned char {
+        count_backslash = 1,
+        drop_backslashes = 2,
+        flush_backslashes = 4,
+        halve_backslashes = 8,
+        start_token = 16,
+        append_char = 32,
+        end_token = 64,
+        retry_char = 128
+      };
+      struct transition {
+        unsigned char next;
+        unsigned char actions;
+      };
+      static constexpr unsigned max_states = 8;
+      unsigned char types[256];
+      transition moves[max_states][char_type_count];
+      void set_all(unsigned state, unsigned next, unsigned actions) {
+        for (auto& t : moves[state])
+          t = transition{static_cast<unsigned char>(next),
+                         static_cast<unsigned char>(actions)};
+      }
+      void set(unsigned state, char_type type, unsigned next,
+               unsigned actions) {
+        moves[state][type] = transition{static_cast<unsigned char>(next),
+                                        static_cast<unsigned char>(actions)};
+      }
+    };
+    constexpr unsigned tokenizer::shell_table::max_states;
+    const tokenizer::shell_table& tokenizer::table(shell_dialect dialect) {
+      using table_type = shell_table;
+      static const table_type posix_table = []() {
+        enum { between, between_escape, unquoted, unquoted_escape,
+               single_quoted, double_quoted, double_escape };
+        table_type t{};
+        t.types[static_cast<unsigned char>(' ')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('\t')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('\n')] = table_type::newline_char;
+        t.types[static_cast<unsigned char>('\'')] = table_type::single_quote;
+        t.types[static_cast<unsigned char>('"')] = table_type::double_quote;
+        t.types[static_cast<unsigned char>('\\')] = table_type::backslash;
+        t.types[static_cast<unsigned char>('$')] = table_type::dquote_special;
+        t.types[static_cast<unsigned char>('`')] = table_type::dquote_special;
+        t.set_all(between, unquoted,
+                  table_type::start_token | table_type::append_char);
+        t.set(between, table_type::space_char, between, 0);
+        t.set(between, table_type::newline_char, between, 0);
+        t.set(between, table_type::single_quote, single_quoted,
+              table_type::start_token);
+        t.set(between, table_type::double_quote, double_quoted,
+              table_type::start_token);
+        t.set(between, table_type::backslash, between_escape,
+              table_type::count_backslash);
+        t.set_all(between_escape, unquoted, table_type::drop_backslashes
+                  | table_type::start_token | table_type::append_char);
+        t.set(between_escape, table_type::newline_char, between,
+              table_type::drop_backslashes);
+        t.set_all(unquoted, unquoted, table_type::append_char);
+        t.set(unquoted, table_type::space_char, between, table_type::end_token);
+        t.set(unquoted, table_type::newline_char, between,
+              table_type::end_token);
+        t.set(unquoted, table_type::single_quote, single_quoted, 0);
+        t.set(unquoted, table_type::double_quote, double_quoted, 0);
+        t.set(unquoted, table_type::backslash, unquoted_escape,
+              table_type::count_backslash);
+        t.set_all(unquoted_escape, unquoted,
+                  table_type::drop_backslashes | table_type::append_char);
+        t.set(unquoted_escape, table_type::newline_char, unquoted,
+              table_type::drop_backslashes);
+        t.set_all(single_quoted, single_quoted, table_type::append_char);
+        t.set(single_quoted, table_type::single_quote, unquoted, 0);
+        t.set_all(double_quoted, double_quoted, table_type::append_char);
+        t.set(double_quoted, table_type::double_quote, unquoted, 0);
+        t.set(double_quoted, table_type::backslash, double_escape,
+              table_type::count_backslash);
+        t.set_all(double_escape, double_quoted,
+                  table_type::flush_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::double_quote, double_quoted,
+              table_type::drop_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::backslash, double_quoted,
+              table_type::drop_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::dquote_special, double_quoted,
+              table_type::drop_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::newline_char, double_quoted,
+              table_type::drop_backslashes);
+        return t;
+      }();
+      static const table_type windows_table = []() {
+        enum { between, unquoted, quoted, quote_pending,
+               unquoted_odd, unquoted_even, quoted_odd, quoted_even };
+        table_type t{};
+        t.types[static_cast<unsigned char>(' ')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('\t')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('"')] = table_type::double_quote;
+        t.types[static_cast<unsigned char>('\\')] = table_type::backslash;
+        t.set_all(between, unquoted,
+                  table_type::start_token | table_type::append_char);
+        t.set(between, table_type::space_char, between, 0);
+        t.set(between, table_type::double_quote, quoted,
+              table_type::start_token);
+        t.set(between, table_type::backslash, unquoted_odd,
+              table_type::start_token | table_type::count_backslash);
+        t.set_all(unquoted, unquoted, table_type::append_char);
+        t.set(unquoted, table_type::space_char, between, table_type::end_token);
+        t.set(unquoted, table_type::double_quote, quoted, 0);
+        t.set(unquoted, table_type::backslash, unquoted_odd,
+              table_type::count_backslash);
+        t.set_all(quoted, quoted, table_type::append_char);
+        t.set(quoted, table_type::double_quote, quote_pending, 0);
+        t.set(quoted, table_type::backslash, quoted_odd,
+              table_type::count_backslash);
+        t.set_all(quote_pending, unquoted, table_type::retry_char);
+        t.set(quote_pending, table_type::double_quote, unquoted,
+              table_type::append_char);
+        t.set_all(unquoted_odd, unquoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(unquoted_odd, table_type::backslash, unquoted_even,
+              table_type::count_backslash);
+        t.set(unquoted_odd, table_type::double_quote, unquoted,
+              table_type::halve_backslashes | table_type::append_char);
+        t.set_all(unquoted_even, unquoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(unquoted_even, table_type::backslash, unquoted_odd,
+              table_type::count_backslash);
+        t.set(unquoted_even, table_type::double_quote, quoted,
+              table_type::halve_backslashes);
+        t.set_all(quoted_odd, quoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(quoted_odd, table_type::backslash, quoted_even,
+              table_type::count_backslash);
+        t.set(quoted_odd, table_type::double_quote, quoted,
+              table_type::halve_backslashes | table_type::append_char);
+        t.set_all(quoted_even, quoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(quoted_even, table_type::backslash, quoted_odd,
+              table_type::count_backslash);
+        t.set(quoted_even, table_type::double_quote, quote_pending,
+              table_type::halve_backslashes);
+        return t;
+      }();
+      return dialect == shell_dialect::windows ? windows_table : posix_table;
+    }
+    bool tokenizer::scan(const char*& pos, const char* end) {
+      const shell_table& t = *m_table;
+      unsigned state = m_state;
+      while (pos != end) {
+        auto move = t.moves[state][t.types[static_cast<unsigned char>(*pos)]];
+        if (move.actions == shell_table::append_char && move.next == state) {
+          const char* run = pos + 1;
+          while (run != end) {
+            auto m = t.moves[state][t.types[static_cast<unsigned char>(*run)]];
+            if (m.actions != shell_table::append_char || m.next != state)
+              break;
+            ++run;
+          }
+          m_token.append(pos, run);
+          pos = run;
+          continue;
+        }
+        unsigned actions = move.actions;
+        if (actions & shell_table::count_backslash)
+          ++m_backslashes;
+        if (actions & shell_table::drop_backslashes)
+          m_backslashes = 0;
+        if (actions & shell_table::flush_backslashes) {
+          m_token.append(m_backslashes, '\\');
+          m_backslashes = 0;
+        }
+        if (actions & shell_table::halve_backslashes) {
+          m_token.append(m_backslashes / 2, '\\');
+          m_backslashes = 0;
+        }
+        if (actions & shell_table::start_token)
+          m_started = true;
+        if (actions & shell_table::append_char)
+          m_token.push_back(*pos);
+        state = move.next;
+        if (!(actions & shell_table::retry_char))
+          ++pos;
+        if (actions & shell_table::end_token) {
+          m_state = static_cast<unsigned char>(state);
+          m_started = false;
+          return true;
+        }
+      }
+      m_state = static_cast<unsigned char>(state);
+      return false;
+    }
+    bool tokenizer::scan_end() {
+      if (m_backslashes) {
+        m_token.append(m_backslashes, '\\');
+        m_started = true;
+      }
+      return m_started;
+    }
+    std::size_t tokenizer::read_chunk(std::istream& in, char* buffer,
+                                      std::size_t size) {
+      in.read(buffer, static_cast<std::streamsize>(size));
+      if (in.bad())
+        throw file_error{"error reading from stream",
+            "optionpp::utility::tokenizer::read", ""};
+      return static_cast<std::size_t>(in.gcount());
+    }
+    std::size_t tokenizer::read_chunk(int fd, char* buffer, std::size_t size) {
+#if defined(_WIN32)
+      int count = ::_read(fd, buffer, static_cast<unsigned>(size));
+#elif defined(__unix__) || defined(__APPLE__)
+      ssize_t count;
+      do {
+        count = ::read(fd, buffer, size);
+      } while (count < 0 && errno == EINTR);
+#else
+      int count = -1;
+      errno = ENOSYS;
+#endif
+      if (count < 0)
+        throw file_error{std::string{"error reading from file descriptor: "}
+                         + std::strerror(errno),
+            "optionpp::utility::tokenizer::read_fd", ""};
+      return static_cast<std::size_t>(count);
+    }
+    std::size_t token_arena::capacity() const noexcept {
+      std::size_t total = 0;
+      for (const auto& b : m_blocks)
+        total += b.size;
+      return total;
+    }
+    std::size_t string_pool::statistics::saved_bytes() const noexcept {
+      return string_bytes > allocated_bytes ? string_bytes - allocated_bytes : 0;
+    }
+    static_string string_pool::intern(token_view str) {
+      if (str.empty())
+        return static_string{};
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if (4 * (m_stats.strings + 1) > 3 * m_slots.size())
+        grow();
+      const std::size_t mask = m_slots.size() - 1;
+      std::size_t index = static_cast<std::size_t>(hash(str)) & mask;
+      while (!m_slots[index].empty() && m_slots[index] != str)
+        index = (index + 1) & mask;
+      if (m_slots[index].empty()) {
+        m_slots[index] = m_arena.store(str.data(), str.size());
+        ++m_stats.strings;
+        m_stats.bytes += str.size();
+      }
+      ++m_stats.references;
+      m_stats.referenced_bytes += str.size();
+      if (str.size() > 15)
+        m_stats.string_bytes += str.size() + 1;
+      return static_string{m_slots[index].data(), m_slots[index].size()};
+    }
+    auto string_pool::stats() const -> statistics {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      statistics result = m_stats;
+      result.allocated_bytes = m_arena.capacity()
+        + m_slots.capacity() * sizeof(token_view);
+      return result;
+    }
+    std::uint64_t string_pool::hash(token_view str) noexcept {
+      std::uint64_t h = 14695981039346656037ULL;
+      for (char c : str) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+      }
+      return h;
+    }
+    void string_pool::grow() {
+      std::vector<token_view> slots(m_slots.empty() ? 64 : 2 * m_slots.size());
+      const std::size_t mask = slots.size() - 1;
+      for (const auto& str : m_slots) {
+        if (str.empty())
+          continue;
+        std::size_t index = static_cast<std::size_t>(hash(str)) & mask;
+        while (!slots[index].empty())
+          index = (index + 1) & mask;
+        slots[index] = str;
+      }
+      m_slots.swap(slots);
+    }
+    const char* find_first_of(const char* first, const char* last,
+                              const char* chars, std::size_t count) noexcept {
+      return find_first_of(first, last, char_class{chars, count});
+    }
+    const char* find_first_of(const char* first, const char* last,
+                              const char_class& char_set) noexcept {
+      if (char_set.empty())
+        return last;
+#if defined(OPTIONPP_USE_AVX2) || defined(OPTIONPP_USE_SSE2)
+      const std::size_t max_simd_chars = char_class::max_listed;
+      const char* chars = char_set.m_listed;
+      std::size_t count = char_set.m_size;
+      if (count <= max_simd_chars) {
+#ifdef OPTIONPP_USE_AVX2
+        __m256i wide_needles[max_simd_chars];
+        for (std::size_t i = 0; i != count; ++i)
+          wide_needles[i] = _mm256_set1_epi8(chars[i]);
+        while (last - first >= 32) {
+          __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+          __m256i match = _mm256_cmpeq_epi8(block, wide_needles[0]);
+          for (std::size_t i = 1; i != count; ++i)
+            match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, wide_needles[i]));
+          auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(match));
+          if (mask)
+            return first + count_trailing_zeros(mask);
+          first += 32;
+        }
+#endif
+#ifdef OPTIONPP_USE_SSE2
+        __m128i needles[max_simd_chars];
+        for (std::size_t i = 0; i != count; ++i)
+          needles[i] = _mm_set1_epi8(chars[i]);
+        while (last - first >= 16) {
+          __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+          __m128i match = _mm_cmpeq_epi8(block, needles[0]);
+          for (std::size_t i = 1; i != count; ++i)
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(block, needles[i]));
+          auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(match));
+          if (mask)
+            return first + count_trailing_zeros(mask);
+          first += 16;
+        }
+#endif
+      }
+#endif
+      while (first != last && !char_set.contains(*first))
+        ++first;
+      return first;
+    }
+    bool is_ascii(const char* first, const char* last) noexcept {
+#ifdef OPTIONPP_USE_AVX2
+      while (last - first >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        if (_mm256_movemask_epi8(block))
+          return false;
+        first += 32;
+      }
+#endif
+#ifdef OPTIONPP_USE_SSE2
+      while (last - first >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        if (_mm_movemask_epi8(block))
+          return false;
+        first += 16;
+      }
+#endif
+      for (; first != last; ++first) {
+        if (static_cast<unsigned char>(*first) & 0x80)
+          return false;
+      }
+      return true;
+    }
+    struct code_point_range {
+      char32_t first;
+      char32_t last;
+    };
+    const code_point_range zero_width_chars[] = {
+      {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF},
+      {0x05C1, 0x05C2}, {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A},
+      {0x061C, 0x061C}, {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DC},
+      {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0711, 0x0711},
+      {0x0730, 0x074A}, {0x07A6, 0x07B0}, {0x07EB, 0x07F3}, {0x07FD, 0x07FD},
+      {0x0816, 0x0819}, {0x081B, 0x0823}, {0x0825, 0x0827}, {0x0829, 0x082D},
+      {0x0859, 0x085B}, {0x0898, 0x089F}, {0x08CA, 0x08E1}, {0x08E3, 0x0902},
+      {0x093A, 0x093A}, {0x093C, 0x093C}, {0x0941, 0x0948}, {0x094D, 0x094D},
+      {0x0951, 0x0957}, {0x0962, 0x0963}, {0x0981, 0x0981}, {0x09BC, 0x09BC},
+      {0x09C1, 0x09C4}, {0x09CD, 0x09CD}, {0x09E2, 0x09E3}, {0x09FE, 0x09FE},
+      {0x0A01, 0x0A02}, {0x0A3C, 0x0A3C}, {0x0A41, 0x0A42}, {0x0A47, 0x0A48},
+      {0x0A4B, 0x0A4D}, {0x0A51, 0x0A51}, {0x0A70, 0x0A71}, {0x0A75, 0x0A75},
+      {0x0A81, 0x0A82}, {0x0ABC, 0x0ABC}, {0x0AC1, 0x0AC5}, {0x0AC7, 0x0AC8},
+      {0x0ACD, 0x0ACD}, {0x0AE2, 0x0AE3}, {0x0AFA, 0x0AFF}, {0x0B01, 0x0B01},
+      {0x0B3C, 0x0B3C}, {0x0B3F, 0x0B3F}, {0x0B41, 0x0B44}, {0x0B4D, 0x0B4D},
+      {0x0B55, 0x0B56}, {0x0B62, 0x0B63}, {0x0B82, 0x0B82}, {0x0BC0, 0x0BC0},
+      {0x0BCD, 0x0BCD}, {0x0C00, 0x0C00}, {0x0C04, 0x0C04}, {0x0C3C, 0x0C3C},
+      {0x0C3E, 0x0C40}, {0x0C46, 0x0C48}, {0x0C4A, 0x0C4D}, {0x0C55, 0x0C56},
+      {0x0C62, 0x0C63}, {0x0C81, 0x0C81}, {0x0CBC, 0x0CBC}, {0x0CBF, 0x0CBF},
+      {0x0CC6, 0x0CC6}, {0x0CCC, 0x0CCD}, {0x0CE2, 0x0CE3}, {0x0D00, 0x0D01},
+      {0x0D3B, 0x0D3C}, {0x0D41, 0x0D44}, {0x0D4D, 0x0D4D}, {0x0D62, 0x0D63},
+      {0x0D81, 0x0D81}, {0x0DCA, 0x0DCA}, {0x0DD2, 0x0DD4}, {0x0DD6, 0x0DD6},
+      {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x0EB1, 0x0EB1},
+      {0x0EB4, 0x0EBC}, {0x0EC8, 0x0ECE}, {0x0F18, 0x0F19}, {0x0F35, 0x0F35},
+      {0x0F37, 0x0F37}, {0x0F39, 0x0F39}, {0x0F71, 0x0F7E}, {0x0F80, 0x0F84},
+      {0x0F86, 0x0F87}, {0x0F8D, 0x0F97}, {0x0F99, 0x0FBC}, {0x0FC6, 0x0FC6},
+      {0x102D, 0x1030}, {0x1032, 0x1037}, {0x1039, 0x103A}, {0x103D, 0x103E},
+      {0x1058, 0x1059}, {0x105E, 0x1060}, {0x1071, 0x1074}, {0x1082, 0x1082},
+      {0x1085, 0x1086}, {0x108D, 0x108D}, {0x109D, 0x109D}, {0x1160, 0x11FF},
+      {0x135D, 0x135F}, {0x1712, 0x1714}, {0x1732, 0x1733}, {0x1752, 0x1753},
+      {0x1772, 0x1773}, {0x17B4, 0x17B5}, {0x17B7, 0x17BD}, {0x17C6, 0x17C6},
+      {0x17C9, 0x17D3}, {0x17DD, 0x17DD}, {0x180B, 0x180F}, {0x1885, 0x1886},
+      {0x18A9, 0x18A9}, {0x1920, 0x1922}, {0x1927, 0x1928}, {0x1932, 0x1932},
+      {0x1939, 0x193B}, {0x1A17, 0x1A18}, {0x1A1B, 0x1A1B}, {0x1A56, 0x1A56},
+      {0x1A58, 0x1A5E}, {0x1A60, 0x1A60}, {0x1A62, 0x1A62}, {0x1A65, 0x1A6C},
+      {0x1A73, 0x1A7C}, {0x1A7F, 0x1A7F}, {0x1AB0, 0x1ACE}, {0x1B00, 0x1B03},
+      {0x1B34, 0x1B34}, {0x1B36, 0x1B3A}, {0x1B3C, 0x1B3C}, {0x1B42, 0x1B42},
+      {0x1B6B, 0x1B73}, {0x1B80, 0x1B81}, {0x1BA2, 0x1BA5}, {0x1BA8, 0x1BA9},
+      {0x1BAB, 0x1BAD}, {0x1BE6, 0x1BE6}, {0x1BE8, 0x1BE9}, {0x1BED, 0x1BED},
+      {0x1BEF, 0x1BF1}, {0x1C2C, 0x1C33}, {0x1C36, 0x1C37}, {0x1CD0, 0x1CD2},
+      {0x1CD4, 0x1CE0}, {0x1CE2, 0x1CE8}, {0x1CED, 0x1CED}, {0x1CF4, 0x1CF4},
+      {0x1CF8, 0x1CF9}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x202A, 0x202E},
+      {0x2060, 0x2064}, {0x20D0, 0x20F0}, {0x2CEF, 0x2CF1}, {0x2D7F, 0x2D7F},
+      {0x2DE0, 0x2DFF}, {0x302A, 0x302D}, {0x3099, 0x309A}, {0xA66F, 0xA672},
+      {0xA674, 0xA67D}, {0xA69E, 0xA69F}, {0xA6F0, 0xA6F1}, {0xA802, 0xA802},
+      {0xA806, 0xA806}, {0xA80B, 0xA80B}, {0xA825, 0xA826}, {0xA82C, 0xA82C},
+      {0xA8C4, 0xA8C5}, {0xA8E0, 0xA8F1}, {0xA8FF, 0xA8FF}, {0xA926, 0xA92D},
+      {0xA947, 0xA951}, {0xA980, 0xA982}, {0xA9B3, 0xA9B3}, {0xA9B6, 0xA9B9},
+      {0xA9BC, 0xA9BD}, {0xA9E5, 0xA9E5}, {0xAA29, 0xAA2E}, {0xAA31, 0xAA32},
+      {0xAA35, 0xAA36}, {0xAA43, 0xAA43}, {0xAA4C, 0xAA4C}, {0xAA7C, 0xAA7C},
+      {0xAAB0, 0xAAB0}, {0xAAB2, 0xAAB4}, {0xAAB7, 0xAAB8}, {0xAABE, 0xAABF},
+      {0xAAC1, 0xAAC1}, {0xAAEC, 0xAAED}, {0xAAF6, 0xAAF6}, {0xABE5, 0xABE5},
+      {0xABE8, 0xABE8}, {0xABED, 0xABED}, {0xD7B0, 0xD7FF}, {0xFB1E, 0xFB1E},
+      {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0xFFF9, 0xFFFB},
+      {0x101FD, 0x101FD}, {0x102E0, 0x102E0}, {0x10376, 0x1037A},
+      {0x10A01, 0x10A03}, {0x10A05, 0x10A06}, {0x10A0C, 0x10A0F},
+      {0x10A38, 0x10A3A}, {0x10A3F, 0x10A3F}, {0x10AE5, 0x10AE6},
+      {0x10D24, 0x10D27}, {0x10EAB, 0x10EAC}, {0x10F46, 0x10F50},
+      {0x11001, 0x11001}, {0x11038, 0x11046}, {0x1107F, 0x11081},
+      {0x110B3, 0x110B6}, {0x110B9, 0x110BA}, {0x11100, 0x11102},
+      {0x11127, 0x1112B}, {0x1112D, 0x11134}, {0x1D167, 0x1D169},
+      {0x1D173, 0x1D182}, {0x1D185, 0x1D18B}, {0x1D1AA, 0x1D1AD},
+      {0x1E8D0, 0x1E8D6}, {0x1E944, 0x1E94A}, {0xE0001, 0xE0001},
+      {0xE0020, 0xE007F}, {0xE0100, 0xE01EF}
+    };
+    const code_point_range wide_chars[] = {
+      {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+      {0x23F0, 0x23F0}, {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615},
+      {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+      {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE},
+      {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+      {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+      {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755},
+      {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF},
+      {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x2E99},
+      {0x2E9B, 0x2EF3}, {0x2F00, 0x2FD5}, {0x2FF0, 0x2FFB}, {0x3000, 0x3029},
+      {0x302E, 0x303E}, {0x3041, 0x3096}, {0x309B, 0x30FF}, {0x3105, 0x312F},
+      {0x3131, 0x318E}, {0x3190, 0x31E3}, {0x31F0, 0x321E}, {0x3220, 0x3247},
+      {0x3250, 0x4DBF}, {0x4E00, 0xA48C}, {0xA490, 0xA4C6}, {0xA960, 0xA97C},
+      {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE52},
+      {0xFE54, 0xFE66}, {0xFE68, 0xFE6B}, {0xFF01, 0xFF60}, {0xFFE0, 0xFFE6},
+      {0x16FE0, 0x16FE4}, {0x16FF0, 0x16FF1}, {0x17000, 0x187F7},
+      {0x18800, 0x18CD5}, {0x18D00, 0x18D08}, {0x1AFF0, 0x1AFF3},
+      {0x1AFF5, 0x1AFFB}, {0x1AFFD, 0x1AFFE}, {0x1B000, 0x1B122},
+      {0x1B132, 0x1B132}, {0x1B150, 0x1B152}, {0x1B155, 0x1B155},
+      {0x1B164, 0x1B167}, {0x1B170, 0x1B2FB}, {0x1F004, 0x1F004},
+      {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A},
+      {0x1F200, 0x1F202}, {0x1F210, 0x1F23B}, {0x1F240, 0x1F248},
+      {0x1F250, 0x1F251}, {0x1F260, 0x1F265}, {0x1F300, 0x1F320},
+      {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C}, {0x1F37E, 0x1F393},
+      {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0},
+      {0x1F3F4, 0x1F3F4}, {0x1F3F8, 0x1F43E}, {0x1F440, 0x1F440},
+      {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E},
+      {0x1F550, 0x1F567}, {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596},
+      {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F}, {0x1F680, 0x1F6C5},
+      {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7},
+      {0x1F6DC, 0x1F6DF}, {0x1F6EB, 0x1F6EC}, {0x1F6F4, 0x1F6FC},
+      {0x1F7E0, 0x1F7EB}, {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A},
+      {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF}, {0x1FA70, 0x1FA7C},
+      {0x1FA80, 0x1FA88}, {0x1FA90, 0x1FABD}, {0x1FABF, 0x1FAC5},
+      {0x1FACE, 0x1FADB}, {0x1FAE0, 0x1FAE8}, {0x1FAF0, 0x1FAF8},
+      {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}
+    };
+    template <std::size_t N>
+    bool in_ranges(const code_point_range (&ranges)[N],
+                   char32_t code_point) noexcept {
+      if (code_point < ranges[0].first || code_point > ranges[N - 1].last)
+        return false;
+      auto it = std::lower_bound(std::begin(ranges), std::end(ranges),
+                                 code_point,
+                                 [](const code_point_range& r, char32_t cp) {
+                                   return r.last < cp;
+                                 });
+      return it != std::end(ranges) && it->first <= code_point;
+    }
+    std::size_t decode_utf8(const char* first, const char* last,
+                            char32_t& code_point) noexcept {
+      auto byte = [first](std::size_t i) {
+        return static_cast<unsigned char>(first[i]);
+      };
+      auto is_continuation = [&](std::size_t i) {
+        return first + i < last && (byte(i) & 0xC0) == 0x80;
+      };
+      unsigned char lead = byte(0);
+      std::size_t length;
+      char32_t min_value;
+      if (lead < 0x80) {
+        code_point = lead;
+        return 1;
+      } else if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        code_point = lead & 0x1F;
+        min_value = 0x80;
+      } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        code_point = lead & 0x0F;
+        min_value = 0x800;
+      } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        code_point = lead & 0x07;
+        min_value = 0x10000;
+      } else {
+        code_point = 0xFFFD;
+        return 1;
+      }
+      for (std::size_t i = 1; i != length; ++i) {
+        if (!is_continuation(i)) {
+          code_point = 0xFFFD;
+          return 1;
+        }
+        code_point = (code_point << 6) | (byte(i) & 0x3F);
+      }
+      if (code_point < min_value || code_point > 0x10FFFF
+          || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        code_point = 0xFFFD;
+        return 1;
+      }
+      return length;
+    }
+    int char_width(char32_t code_point) noexcept {
+      if (code_point < 0x300)
+        return 1;
+      if (in_ranges(zero_width_chars, code_point))
+        return 0;
+      if (in_ranges(wide_chars, code_point))
+        return 2;
+      return 1;
+    }
+    std::size_t display_width(token_view str) noexcept {
+      if (is_ascii(str.begin(), str.end()))
+        return str.size();
+      std::size_t width = 0;
+      const char* pos = str.begin();
+      while (pos != str.end()) {
+        char32_t code_point;
+        pos += decode_utf8(pos, str.end(), code_point);
+        width += static_cast<std::size_t>(char_width(code_point));
+      }
+      return width;
+    }
+    std::size_t advance_columns(token_view str, std::size_t start,
+                                int columns) noexcept {
+      const char* pos = str.begin() + start;
+      int used = 0;
+      while (pos != str.end()) {
+        char32_t code_point;
+        std::size_t length = decode_utf8(pos, str.end(), code_point);
+        int width = char_width(code_point);
+        if (used + width > columns && pos != str.begin() + start)
+          break;
+        used += width;
+        pos += length;
+      }
+      return static_cast<std::size_t>(pos - str.begin());
+    }
+    class stream_sink {
+    public:
+      explicit stream_sink(std::ostream& os) noexcept : m_os{os} {}
+      void write(const char* data, std::size_t size) {
+        m_os.write(data, static_cast<std::streamsize>(size));
+      }
+    private:
+      std::ostream& m_os;
+    };
+    class file_sink {
+    public:
+      explicit file_sink(std::FILE* file) noexcept : m_file{file} {}
+      void write(const char* data, std::size_t size) noexcept {
+        std::fwrite(data, 1, size, m_file);
+      }
+    private:
+      std::FILE* m_file;
+    };
+    class buffer_sink {
+    public:
+      buffer_sink(char* buffer, std::size_t size) noexcept
+        : m_buffer{buffer}, m_size{size} {}
+      void write(const char* data, std::size_t size) noexcept {
+        if (m_length < m_size)
+          std::copy(data, data + std::min(size, m_size - m_length),
+                    m_buffer + m_length);
+        m_length += size;
+      }
+      std::size_t length() const noexcept { return m_length; }
+    private:
+      char* m_buffer;
+      std::size_t m_size;
+      std::size_t m_length{0};
+    };
+    class string_sink {
+    public:
+      explicit string_sink(std::string& str) noexcept : m_str{str} {}
+      void write(const char* data, std::size_t size) {
+        m_str.append(data, size);
+      }
+    private:
+      std::string& m_str;
+    };
+    template <typename Sink>
+    void write_spaces(Sink& sink, int count) {
+      static const char spaces[] = "                                ";
+      const int chunk = static_cast<int>(sizeof(spaces) - 1);
+      for (; count > chunk; count -= chunk)
+        sink.write(spaces, chunk);
+      if (count > 0)
+        sink.write(spaces, static_cast<std::size_t>(count));
+    }
+    template <typename Sink>
+    bool wrap_line(Sink& sink, token_view str,
+                   int line_len, int indent, int first_line_indent) {
+      if (line_len <= 0) {
+        write_spaces(sink, first_line_indent);
+        sink.write(str.data(), str.size());
+        return first_line_indent > 0 || !str.empty();
+      }
       if (indent < 0)
         indent = 0;
       else if (indent > line_len - 1)
@@ -625,37 +2820,189 @@ namespace optionpp {
         first_line_indent = 0;
       else if (first_line_indent > line_len - 1)
         first_line_indent = line_len - 1;
-      std::string result;
-      std::string::size_type pos{0};
+      const char_class& space = whitespace();
+      const bool ascii = is_ascii(str.begin(), str.end());
+      bool written = false;
+      std::size_t pos{0};
       while (pos < str.size()) {
-        int cur_indent = result.empty() ? first_line_indent : indent;
+        int cur_indent = written ? indent : first_line_indent;
         auto start = pos;
-        if (!result.empty()) {
-          while (start < str.size() && is_space(str[start]))
+        if (written) {
+          while (start < str.size() && space.contains(str[start]))
             ++start;
         }
-        auto end = start + line_len - cur_indent;
-        if (end > str.size())
-          end = str.size();
+        std::size_t end;
+        if (ascii) {
+          end = start + line_len - cur_indent;
+          if (end > str.size())
+            end = str.size();
+        } else {
+          end = advance_columns(str, start, line_len - cur_indent);
+        }
         if (end < str.size()) {
           auto word_start = end;
-          while (word_start > start && !is_space(str[word_start]))
+          while (word_start > start && !space.contains(str[word_start]))
             --word_start;
           if (word_start > start)
             end = word_start;
         }
         pos = end;
-        while (end > start && is_space(str[end - 1]))
+        while (end > start && space.contains(str[end - 1]))
           --end;
         if (end > start) {
-          if (!result.empty())
-            result.push_back('\n');
-          if (cur_indent > 0)
-            result += std::string(cur_indent, ' ');
-          result += str.substr(start, end - start);
+          if (written)
+            sink.write("\n", 1);
+          write_spaces(sink, cur_indent);
+          sink.write(str.data() + start, end - start);
+          written = true;
         }
       }
-      return result;
+      return written;
+    }
+    template <typename Sink>
+    void wrap_into(Sink& sink, token_view str,
+                   int line_len, int indent, int first_line_indent) {
+      const char* line = str.begin();
+      bool written = false;
+      for (;;) {
+        const char* line_end = std::find(line, str.end(), '\n');
+        if (written)
+          sink.write("\n", 1);
+        if (wrap_line(sink, token_view{line, static_cast<std::size_t>(line_end - line)},
+                      line_len, indent, first_line_indent))
+          written = true;
+        if (line_end == str.end())
+          break;
+        line = line_end + 1;
+        first_line_indent = indent;
+      }
+    }
+    void read_decimal(const std::string& str, std::string::size_type& pos,
+                      std::uint64_t& int_part, std::uint64_t& frac,
+                      std::uint64_t& frac_scale) {
+      const auto max = std::numeric_limits<std::uint64_t>::max();
+      bool has_digits = false;
+      int_part = 0;
+      while (pos < str.size() && std::isdigit(static_cast<unsigned char>(str[pos]))) {
+        unsigned digit = str[pos] - '0';
+        if (int_part > (max - digit) / 10)
+          throw std::out_of_range{"out of range"};
+        int_part = int_part * 10 + digit;
+        has_digits = true;
+        ++pos;
+      }
+      frac = 0;
+      frac_scale = 1;
+      if (pos < str.size() && str[pos] == '.') {
+        ++pos;
+        while (pos < str.size() && std::isdigit(static_cast<unsigned char>(str[pos]))) {
+          if (frac_scale < 1000000000) {
+            frac = frac * 10 + (str[pos] - '0');
+            frac_scale *= 10;
+          }
+          has_digits = true;
+          ++pos;
+        }
+      }
+      if (!has_digits)
+        throw std::invalid_argument{"invalid argument"};
+    }
+    std::uint64_t scale_decimal(std::uint64_t int_part, std::uint64_t frac,
+                                std::uint64_t frac_scale, std::uint64_t unit,
+                                std::uint64_t max) {
+      if (unit != 0 && int_part > max / unit)
+        throw std::out_of_range{"out of range"};
+      std::uint64_t result = int_part * unit;
+      std::uint64_t frac_result = frac * (unit / frac_scale)
+        + frac * (unit % frac_scale) / frac_scale;
+      if (frac_result > max - result)
+        throw std::out_of_range{"out of range"};
+      return result + frac_result;
+    }
+    std::chrono::nanoseconds parse_duration(const std::string& str) {
+      struct unit_info {
+        const char* name;
+        std::uint64_t nanoseconds;
+      };
+      static const unit_info units[] = {
+        {"ns", 1ull},
+        {"us", 1000ull},
+        {"ms", 1000000ull},
+        {"s", 1000000000ull},
+        {"min", 60000000000ull},
+        {"m", 60000000000ull},
+        {"h", 3600000000000ull},
+        {"d", 86400000000000ull}
+      };
+      const std::uint64_t max = std::numeric_limits<std::chrono::nanoseconds::rep>::max();
+      std::uint64_t total = 0;
+      std::string::size_type pos = 0;
+      bool first = true;
+      do {
+        std::uint64_t int_part, frac, frac_scale;
+        read_decimal(str, pos, int_part, frac, frac_scale);
+        std::uint64_t unit = 0;
+        auto unit_start = pos;
+        while (pos < str.size() && std::isalpha(static_cast<unsigned char>(str[pos])))
+          ++pos;
+        if (unit_start == pos) {
+          if (!first || pos != str.size())
+            throw std::invalid_argument{"invalid argument"};
+          unit = 1000000000ull;
+        } else {
+          for (const auto& u : units) {
+            if (is_substr_at_pos(str, u.name, unit_start)
+                && std::char_traits<char>::length(u.name) == pos - unit_start) {
+              unit = u.nanoseconds;
+              break;
+            }
+          }
+          if (unit == 0)
+            throw std::invalid_argument{"invalid argument"};
+        }
+        auto value = scale_decimal(int_part, frac, frac_scale, unit, max);
+        if (value > max - total)
+          throw std::out_of_range{"out of range"};
+        total += value;
+        first = false;
+      } while (pos < str.size());
+      return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(total)};
+    }
+    std::uint64_t parse_size(const std::string& str) {
+      std::uint64_t int_part, frac, frac_scale;
+      std::string::size_type pos = 0;
+      read_decimal(str, pos, int_part, frac, frac_scale);
+      std::uint64_t unit = 1;
+      if (pos < str.size()) {
+        static const char prefixes[] = "kmgtpe";
+        const char* prefix = nullptr;
+        char c = static_cast<char>(std::tolower(static_cast<unsigned char>(str[pos])));
+        for (const char* p = prefixes; *p; ++p) {
+          if (*p == c)
+            prefix = p;
+        }
+        if (prefix) {
+          ++pos;
+          std::uint64_t base = 1024;
+          if (pos < str.size() && str[pos] == 'i') {
+            ++pos;
+            if (pos == str.size() || str[pos] != 'B')
+              throw std::invalid_argument{"invalid argument"};
+            ++pos;
+          } else if (pos < str.size() && str[pos] == 'B') {
+            base = 1000;
+            ++pos;
+          }
+          for (const char* p = prefixes; p <= prefix; ++p)
+            unit *= base;
+        } else if (str[pos] == 'B') {
+          ++pos;
+        }
+        if (pos != str.size())
+          throw std::invalid_argument{"invalid argument"};
+      }
+      return scale_decimal(int_part, frac, frac_scale, unit,
+                           std::numeric_limits<std::uint64_t>::max());
     }
     std::string wrap_text(const std::string& str,
                           int line_len,
@@ -666,17 +3013,34 @@ namespace optionpp {
                           int line_len,
                           int indent,
                           int first_line_indent) {
-      std::vector<std::string> lines;
-      split(str, std::back_inserter(lines), "\n", "", '\0', true);
       std::string result;
-      for (const auto& line : lines) {
-        if (!result.empty())
-          result.push_back('\n');
-        result += wrap_line(line, line_len, indent, first_line_indent);
-        first_line_indent = indent;
-      }
+      string_sink sink{result};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
       return result;
     }
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len, int indent) {
+      return write_wrapped(os, str, line_len, indent, indent);
+    }
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len, int indent,
+                                int first_line_indent) {
+      stream_sink sink{os};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
+      return os;
+    }
+    void write_wrapped(std::FILE* file, token_view str,
+                       int line_len, int indent, int first_line_indent) {
+      file_sink sink{file};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
+    }
+    std::size_t write_wrapped(char* buffer, std::size_t size, token_view str,
+                              int line_len, int indent,
+                              int first_line_indent) noexcept {
+      buffer_sink sink{buffer, size};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
+      return sink.length();
+    }
     bool is_substr_at_pos(const std::string& str, const std::string& substr,
                           typename std::string::size_type pos) noexcept {
       if (pos + substr.size() > str.size())
@@ -687,6 +3051,332 @@ namespace optionpp {
       }
       return true;
     }
+    std::size_t edit_distance(token_view a, token_view b,
+                              std::size_t max_distance) {
+      std::size_t m = a.size();
+      std::size_t n = b.size();
+      if ((m > n ? m - n : n - m) > max_distance)
+        return max_distance + 1;
+      if (m == 0 || n == 0)
+        return m + n;
+      const std::size_t width = n + 2;
+      std::size_t small[32 * 32];
+      std::vector<std::size_t> large;
+      std::size_t* d = small;
+      if ((m + 2) * width > sizeof(small) / sizeof(small[0])) {
+        large.resize((m + 2) * width);
+        d = large.data();
+      }
+      const std::size_t infinity = m + n;
+      std::fill(d, d + width, infinity);
+      for (std::size_t i = 0; i <= m; ++i) {
+        d[(i + 1) * width] = infinity;
+        d[(i + 1) * width + 1] = i;
+      }
+      for (std::size_t j = 0; j <= n; ++j)
+        d[width + j + 1] = j;
+      std::size_t last_row[256];
+      for (std::size_t i = 0; i != m; ++i)
+        last_row[static_cast<unsigned char>(a[i])] = 0;
+      for (std::size_t j = 0; j != n; ++j)
+        last_row[static_cast<unsigned char>(b[j])] = 0;
+      for (std::size_t i = 1; i <= m; ++i) {
+        const std::size_t* above = d + i * width;
+        std::size_t* row = d + (i + 1) * width;
+        const char ai = a[i - 1];
+        std::size_t last_match_col = 0;
+        std::size_t row_min = i;
+        for (std::size_t j = 1; j <= n; ++j) {
+          std::size_t k = last_row[static_cast<unsigned char>(b[j - 1])];
+          std::size_t l = last_match_col;
+          std::size_t value;
+          if (ai == b[j - 1]) {
+            value = above[j];
+            last_match_col = j;
+          } else {
+            value = std::min(above[j], std::min(row[j], above[j + 1])) + 1;
+          }
+          value = std::min(value, d[k * width + l] + (i - k) + (j - l) - 1);
+          row[j + 1] = value;
+          row_min = std::min(row_min, value);
+        }
+        last_row[static_cast<unsigned char>(ai)] = i;
+        if (row_min > max_distance)
+          return max_distance + 1;
+      }
+      return std::min(d[(m + 1) * width + n + 1], max_distance + 1);
+    }
+  }
+}
+
+namespace optionpp {
+  [[noreturn]] void throw_file_error(const std::string& path,
+                                     const std::string& reason) {
+    throw file_error{"cannot read file '" + path + "': " + reason,
+        "optionpp::mapped_file::mapped_file", path};
+  }
+#if defined(_WIN32)
+  mapped_file::mapped_file(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      throw_file_error(path, "unable to open file");
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(file, &info)) {
+      CloseHandle(file);
+      throw_file_error(path, "unable to get file information");
+    }
+    m_id.device = info.dwVolumeSerialNumber;
+    m_id.index = (std::uint64_t{info.nFileIndexHigh} << 32) | info.nFileIndexLow;
+    std::uint64_t size = (std::uint64_t{info.nFileSizeHigh} << 32)
+      | info.nFileSizeLow;
+    if (size > 0) {
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                          0, 0, nullptr);
+      void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+        : nullptr;
+      if (mapping)
+        CloseHandle(mapping);
+      if (!view) {
+        CloseHandle(file);
+        throw_file_error(path, "unable to map file");
+      }
+      m_data = static_cast<const char*>(view);
+      m_size = static_cast<std::size_t>(size);
+      m_mapped = true;
+    }
+    CloseHandle(file);
+  }
+#elif defined(__unix__) || defined(__APPLE__)
+  mapped_file::mapped_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw_file_error(path, std::strerror(errno));
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      int err = errno;
+      ::close(fd);
+      throw_file_error(path, std::strerror(err));
+    }
+    m_id.device = static_cast<std::uint64_t>(info.st_dev);
+    m_id.index = static_cast<std::uint64_t>(info.st_ino);
+    if (S_ISREG(info.st_mode)) {
+      if (info.st_size > 0) {
+        auto size = static_cast<std::size_t>(info.st_size);
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+          int err = errno;
+          ::close(fd);
+          throw_file_error(path, std::strerror(err));
+        }
+        m_data = static_cast<const char*>(addr);
+        m_size = size;
+        m_mapped = true;
+      }
+    } else {
+      std::string contents;
+      char buffer[4096];
+      ssize_t count;
+      while ((count = ::read(fd, buffer, sizeof(buffer))) != 0) {
+        if (count < 0) {
+          if (errno == EINTR)
+            continue;
+          int err = errno;
+          ::close(fd);
+          throw_file_error(path, std::strerror(err));
+        }
+        contents.append(buffer, static_cast<std::size_t>(count));
+      }
+      if (!contents.empty()) {
+        std::unique_ptr<char[]> data{new char[contents.size()]};
+        std::memcpy(data.get(), contents.data(), contents.size());
+        m_data = data.release();
+        m_size = contents.size();
+        m_allocated = true;
+      }
+    }
+    ::close(fd);
+  }
+#else
+  mapped_file::mapped_file(const std::string& path) {
+    std::ifstream in{path, std::ios::in | std::ios::binary};
+    if (!in)
+      throw_file_error(path, "unable to open file");
+    std::string contents{std::istreambuf_iterator<char>{in},
+                         std::istreambuf_iterator<char>{}};
+    if (in.bad())
+      throw_file_error(path, "unable to read file");
+    m_id.index = std::hash<std::string>{}(path);
+    if (!contents.empty()) {
+      std::unique_ptr<char[]> data{new char[contents.size()]};
+      std::memcpy(data.get(), contents.data(), contents.size());
+      m_data = data.release();
+      m_size = contents.size();
+      m_allocated = true;
+    }
+  }
+#endif
+  void mapped_file::swap(mapped_file& other) noexcept {
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_id, other.m_id);
+    std::swap(m_mapped, other.m_mapped);
+    std::swap(m_allocated, other.m_allocated);
+  }
+  void mapped_file::close() noexcept {
+    if (m_mapped) {
+#if defined(_WIN32)
+      UnmapViewOfFile(m_data);
+#elif defined(__unix__) || defined(__APPLE__)
+      ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    } else if (m_allocated) {
+      delete[] m_data;
+    }
+    m_data = "";
+    m_size = 0;
+    m_id = file_id{};
+    m_mapped = false;
+    m_allocated = false;
+  }
+}
+
+
+namespace optionpp {
+  constexpr choice_table::size_type choice_table::npos;
+  choice_table::choice_table(const std::vector<std::string>& names)
+    : m_names{names} {
+    m_values.reserve(m_names.size());
+    for (size_type i = 0; i != m_names.size(); ++i)
+      m_values.push_back(static_cast<value_type>(i));
+    build();
+  }
+  choice_table::choice_table(const std::vector<std::pair<std::string,
+                                                         value_type>>& choices) {
+    m_names.reserve(choices.size());
+    m_values.reserve(choices.size());
+    for (const auto& c : choices) {
+      m_names.push_back(c.first);
+      m_values.push_back(c.second);
+    }
+    build();
+  }
+  auto choice_table::find(const std::string& name) const noexcept -> size_type {
+    if (m_slots.empty())
+      return npos;
+    auto bucket = hash(name, 0) & (m_bucket_seeds.size() - 1);
+    auto slot = hash(name, m_bucket_seeds[bucket]) & (m_slots.size() - 1);
+    auto index = m_slots[slot];
+    if (index != 0 && m_names[index - 1] == name)
+      return index - 1;
+    else
+      return npos;
+  }
+  std::string choice_table::to_string(const std::string& separator) const {
+    std::string result;
+    for (const auto& name : m_names) {
+      if (!result.empty())
+        result += separator;
+      result += name;
+    }
+    return result;
+  }
+  void choice_table::build() {
+    std::vector<size_type> order(m_names.size());
+    for (size_type i = 0; i != order.size(); ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_type a, size_type b) {
+                       return m_names[a] < m_names[b];
+                     });
+    std::vector<bool> keep(m_names.size(), true);
+    for (size_type i = 1; i < order.size(); ++i) {
+      if (m_names[order[i]] == m_names[order[i - 1]])
+        keep[order[i]] = false;
+    }
+    size_type count = 0;
+    for (size_type i = 0; i != m_names.size(); ++i) {
+      if (keep[i]) {
+        if (count != i) {
+          m_names[count] = std::move(m_names[i]);
+          m_values[count] = m_values[i];
+        }
+        ++count;
+      }
+    }
+    m_names.resize(count);
+    m_values.resize(count);
+    m_bucket_seeds.clear();
+    m_slots.clear();
+    if (m_names.empty())
+      return;
+    size_type slot_count = 1;
+    while (slot_count < 2 * m_names.size())
+      slot_count *= 2;
+    while (!try_build(slot_count))
+      slot_count *= 2;
+  }
+  bool choice_table::try_build(size_type slot_count) {
+    size_type bucket_count = 1;
+    while (bucket_count * 4 < m_names.size())
+      bucket_count *= 2;
+    std::vector<std::vector<size_type>> buckets(bucket_count);
+    for (size_type i = 0; i != m_names.size(); ++i)
+      buckets[hash(m_names[i], 0) & (bucket_count - 1)].push_back(i);
+    std::vector<size_type> order(bucket_count);
+    for (size_type i = 0; i != bucket_count; ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_type a, size_type b) {
+                       return buckets[a].size() > buckets[b].size();
+                     });
+    const std::uint32_t max_seed = 1 << 16;
+    std::vector<std::uint32_t> slots(slot_count, 0);
+    std::vector<std::uint32_t> seeds(bucket_count, 0);
+    std::vector<size_type> placed;
+    for (auto b : order) {
+      if (buckets[b].empty())
+        break;
+      bool found = false;
+      for (std::uint32_t seed = 1; seed != max_seed && !found; ++seed) {
+        placed.clear();
+        found = true;
+        for (auto index : buckets[b]) {
+          auto slot = hash(m_names[index], seed) & (slot_count - 1);
+          if (slots[slot] != 0
+              || std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+            found = false;
+            break;
+          }
+          placed.push_back(slot);
+        }
+        if (found) {
+          seeds[b] = seed;
+          for (size_type i = 0; i != placed.size(); ++i)
+            slots[placed[i]] = static_cast<std::uint32_t>(buckets[b][i] + 1);
+        }
+      }
+      if (!found)
+        return false;
+    }
+    m_bucket_seeds = std::move(seeds);
+    m_slots = std::move(slots);
+    return true;
+  }
+  std::uint32_t choice_table::hash(const std::string& str,
+                                   std::uint32_t seed) noexcept {
+    std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char c : str) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
   }
 }
 
@@ -710,7 +3400,7 @@ namespace optionpp {
   }
   option& option::bind_string(std::string* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "STRING";
+      m_arg_name = std::string{"STRING"};
       m_arg_required = true;
     }
     m_arg_type = string_arg;
@@ -719,7 +3409,7 @@ namespace optionpp {
   }
   option& option::bind_int(int* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "INTEGER";
+      m_arg_name = std::string{"INTEGER"};
       m_arg_required = true;
     }
     m_arg_type = int_arg;
@@ -728,7 +3418,7 @@ namespace optionpp {
   }
   option& option::bind_uint(unsigned int* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "INTEGER";
+      m_arg_name = std::string{"INTEGER"};
       m_arg_required = true;
     }
     m_arg_type = uint_arg;
@@ -737,13 +3427,41 @@ namespace optionpp {
   }
   option& option::bind_double(double* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "NUMBER";
+      m_arg_name = std::string{"NUMBER"};
       m_arg_required = true;
     }
     m_arg_type = double_arg;
     m_bound_variable = var;
     return *this;
   }
+  option& option::bind_size(std::uint64_t* var) noexcept {
+    if (var && m_arg_name.empty()) {
+      m_arg_name = std::string{"SIZE"};
+      m_arg_required = true;
+    }
+    m_arg_type = size_arg;
+    m_bound_variable = var;
+    return *this;
+  }
+  option& option::bind_custom(arg_callback converter) noexcept {
+    if (converter && m_arg_name.empty()) {
+      m_arg_name = std::string{"VALUE"};
+      m_arg_required = true;
+    }
+    m_arg_type = custom_arg;
+    m_bound_variable = nullptr;
+    m_converter = std::move(converter);
+    m_stager = nullptr;
+    return *this;
+  }
+  option& option::choices(const std::vector<std::string>& values) {
+    if (m_arg_name.empty()) {
+      m_arg_name = std::string{"CHOICE"};
+      m_arg_required = true;
+    }
+    m_choices = choice_table{values};
+    return *this;
+  }
   void option::write_bool(bool value) const noexcept {
     if (m_is_option_set)
       *m_is_option_set = value;
@@ -754,23 +3472,227 @@ namespace optionpp {
           "optionpp::option::write_string"};
     *static_cast<std::string*>(m_bound_variable) = value;
   }
+  void option::write_string(const char* value, std::size_t size) const {
+    if (m_arg_type != string_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept a string argument",
+          "optionpp::option::write_string"};
+    static_cast<std::string*>(m_bound_variable)->assign(value, size);
+  }
   void option::write_int(int value) const {
     if (m_arg_type != int_arg || !m_bound_variable)
       throw type_error{"option '" + name() + "' does not accept an int argument",
           "optionpp::option::write_int"};
     *static_cast<int*>(m_bound_variable) = value;
   }
-  void option::write_uint(unsigned int value) const {
-    if (m_arg_type != uint_arg || !m_bound_variable)
-      throw type_error{"option '" + name() + "' does not accept an unsigned int argument",
-          "optionpp::option::write_uint"};
-    *static_cast<unsigned int*>(m_bound_variable) = value;
+  void option::write_uint(unsigned int value) const {
+    if (m_arg_type != uint_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept an unsigned int argument",
+          "optionpp::option::write_uint"};
+    *static_cast<unsigned int*>(m_bound_variable) = value;
+  }
+  void option::write_double(double value) const {
+    if (m_arg_type != double_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept a double argument",
+          "optionpp::option::write_double"};
+    *static_cast<double*>(m_bound_variable) = value;
+  }
+  void option::write_duration(std::chrono::nanoseconds value) const {
+    if (m_arg_type != duration_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept a duration argument",
+          "optionpp::option::write_duration"};
+    m_value_writer(m_bound_variable, value.count());
+  }
+  void option::write_size(std::uint64_t value) const {
+    if (m_arg_type != size_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept a size argument",
+          "optionpp::option::write_size"};
+    *static_cast<std::uint64_t*>(m_bound_variable) = value;
+  }
+  bool option::write_custom(const std::string& value) const {
+    if (m_arg_type != custom_arg || !m_converter)
+      throw type_error{"option '" + name() + "' does not accept a custom argument",
+          "optionpp::option::write_custom"};
+    return m_converter(value);
+  }
+  bool option::stage_custom(const std::string& value,
+                            arg_callback& commit) const {
+    if (m_arg_type != custom_arg || !m_converter)
+      throw type_error{"option '" + name() + "' does not accept a custom argument",
+          "optionpp::option::stage_custom"};
+    if (!m_stager)
+      return true;
+    return m_stager(m_converter, value, commit);
+  }
+  void option::write_enum(choice_table::size_type index) const {
+    if (m_arg_type != enum_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept an enumeration argument",
+          "optionpp::option::write_enum"};
+    if (index >= m_choices.size())
+      throw out_of_range{"invalid choice index for option '" + name() + "'",
+          "optionpp::option::write_enum"};
+    m_value_writer(m_bound_variable, m_choices.value(index));
+  }
+}
+
+namespace optionpp {
+  void write_log::commit() {
+    struct clear_guard {
+      write_log& log;
+      ~clear_guard() { log.clear(); }
+    } guard{*this};
+    static const std::string no_argument;
+    auto staged = m_staged.begin();
+    for (const auto& r : m_records) {
+      const option& opt = *r.opt;
+      if (r.type == write_type::custom_write) {
+        const arg_callback& store = *staged++;
+        if (store)
+          store(no_argument);
+        else if (!m_record_unbound && opt.has_bound_argument_variable())
+          opt.write_custom(std::string(m_strings, r.str.pos, r.str.len));
+        continue;
+      }
+      if (r.type != write_type::bool_write
+          && !opt.has_bound_argument_variable())
+        continue;
+      switch (r.type) {
+      case write_type::bool_write:
+        opt.write_bool(r.int_value != 0);
+        break;
+      case write_type::string_write:
+        opt.write_string(m_strings.data() + r.str.pos, r.str.len);
+        break;
+      case write_type::int_write:
+        opt.write_int(static_cast<int>(r.int_value));
+        break;
+      case write_type::uint_write:
+        opt.write_uint(static_cast<unsigned int>(r.uint_value));
+        break;
+      case write_type::double_write:
+        opt.write_double(r.double_value);
+        break;
+      case write_type::duration_write:
+        opt.write_duration(std::chrono::nanoseconds{r.int_value});
+        break;
+      case write_type::size_write:
+        opt.write_size(r.uint_value);
+        break;
+      case write_type::enum_write:
+        opt.write_enum(static_cast<choice_table::size_type>(r.uint_value));
+        break;
+      case write_type::custom_write:
+        break;
+      }
+    }
+  }
+  void write_log::write_bool(const option& opt, bool value) {
+    if (!m_deferred) {
+      opt.write_bool(value);
+      return;
+    }
+    record r;
+    r.opt = &opt;
+    r.type = write_type::bool_write;
+    r.int_value = value;
+    m_records.push_back(r);
+  }
+  void write_log::write_string(const option& opt, const std::string& value) {
+    if (m_deferred)
+      record_string(opt, write_type::string_write, value);
+    else
+      opt.write_string(value);
+  }
+  void write_log::write_int(const option& opt, int value) {
+    if (!m_deferred) {
+      opt.write_int(value);
+      return;
+    }
+    record r;
+    r.opt = &opt;
+    r.type = write_type::int_write;
+    r.int_value = value;
+    m_records.push_back(r);
+  }
+  void write_log::write_uint(const option& opt, unsigned int value) {
+    if (!m_deferred) {
+      opt.write_uint(value);
+      return;
+    }
+    record r;
+    r.opt = &opt;
+    r.type = write_type::uint_write;
+    r.uint_value = value;
+    m_records.push_back(r);
+  }
+  void write_log::write_double(const option& opt, double value) {
+    if (!m_deferred) {
+      opt.write_double(value);
+      return;
+    }
+    record r;
+    r.opt = &opt;
+    r.type = write_type::double_write;
+    r.double_value = value;
+    m_records.push_back(r);
+  }
+  void write_log::write_duration(const option& opt,
+                                 std::chrono::nanoseconds value) {
+    if (!m_deferred) {
+      opt.write_duration(value);
+      return;
+    }
+    record r;
+    r.opt = &opt;
+    r.type = write_type::duration_write;
+    r.int_value = value.count();
+    m_records.push_back(r);
+  }
+  void write_log::write_size(const option& opt, std::uint64_t value) {
+    if (!m_deferred) {
+      opt.write_size(value);
+      return;
+    }
+    record r;
+    r.opt = &opt;
+    r.type = write_type::size_write;
+    r.uint_value = value;
+    m_records.push_back(r);
+  }
+  void write_log::write_enum(const option& opt, choice_table::size_type index) {
+    if (!m_deferred) {
+      opt.write_enum(index);
+      return;
+    }
+    record r;
+    r.opt = &opt;
+    r.type = write_type::enum_write;
+    r.uint_value = index;
+    m_records.push_back(r);
   }
-  void option::write_double(double value) const {
-    if (m_arg_type != double_arg || !m_bound_variable)
-      throw type_error{"option '" + name() + "' does not accept a double argument",
-          "optionpp::option::write_double"};
-    *static_cast<double*>(m_bound_variable) = value;
+  bool write_log::write_custom(const option& opt, const std::string& value) {
+    if (!m_deferred)
+      return opt.write_custom(value);
+    arg_callback store;
+    if (!m_record_unbound && opt.has_bound_argument_variable()
+        && !opt.stage_custom(value, store))
+      return false;
+    record_string(opt, write_type::custom_write, value);
+    m_staged.push_back(std::move(store));
+    return true;
+  }
+  void write_log::record_string(const option& opt, write_type type,
+                                const std::string& value) {
+    constexpr std::size_t max_size = std::numeric_limits<std::uint32_t>::max();
+    if (value.size() > max_size - m_strings.size())
+      throw out_of_range{"too much string data to record",
+          "optionpp::write_log::record_string"};
+    record r;
+    r.opt = &opt;
+    r.type = type;
+    r.str.pos = static_cast<std::uint32_t>(m_strings.size());
+    r.str.len = static_cast<std::uint32_t>(value.size());
+    m_strings += value;
+    m_records.push_back(r);
   }
 }
 
@@ -784,13 +3706,20 @@ namespace optionpp {
                            arg_name, arg_required);
     return m_options.back();
   }
-  option& option_group::operator[](const std::string long_name) {
+  option& option_group::operator[](const std::string& long_name) {
     auto it = find(long_name);
     if (it == end())
       return add_option().long_name(long_name);
     else
       return *it;
   }
+  option& option_group::operator[](utility::static_string long_name) {
+    auto it = find(utility::token_view{long_name});
+    if (it == end())
+      return add_option().long_name(long_name);
+    else
+      return *it;
+  }
   option& option_group::operator[](char short_name) {
     auto it = find(short_name);
     if (it == end())
@@ -798,13 +3727,13 @@ namespace optionpp {
     else
       return *it;
   }
-  auto option_group::find(const std::string& long_name) -> iterator {
+  auto option_group::find(utility::token_view long_name) -> iterator {
     return std::find_if(m_options.begin(), m_options.end(),
-                        [&](const option& o) { return o.long_name() == long_name; });
+                        [&](const option& o) { return o.long_name_view() == long_name; });
   }
-  auto option_group::find(const std::string& long_name) const -> const_iterator {
+  auto option_group::find(utility::token_view long_name) const -> const_iterator {
     return std::find_if(m_options.begin(), m_options.end(),
-                        [&](const option& o) { return o.long_name() == long_name; });
+                        [&](const option& o) { return o.long_name_view() == long_name; });
   }
   auto option_group::find(char short_name) -> iterator {
     return std::find_if(m_options.begin(), m_options.end(),
@@ -869,14 +3798,47 @@ namespace optionpp {
 
 
 namespace optionpp {
-  option& parser::add_option(const option& opt) {
-    auto it = find_group("");
-    if (it == m_groups.end()) {
-      m_groups.emplace_back("");
-      return m_groups.back().add_option(opt);
-    } else {
-      return it->add_option(opt);
+  std::string format_number(double value) {
+    std::ostringstream oss;
+    oss.precision(15);
+    oss << value;
+    return oss.str();
+  }
+  std::string format_bound(const option& opt, double value) {
+    std::string str = format_number(value);
+    if (opt.argument_type() == option::duration_arg)
+      str += 's';
+    return str;
+  }
+  std::string describe_constraints(const option& opt) {
+    std::string notes;
+    if (!opt.choices().empty())
+      notes = "choices: " + opt.choices().to_string();
+    bool has_min = std::isfinite(opt.min_value());
+    bool has_max = std::isfinite(opt.max_value());
+    if (has_min || has_max) {
+      if (!notes.empty())
+        notes += "; ";
+      if (has_min && has_max)
+        notes += "range: " + format_bound(opt, opt.min_value())
+          + " to " + format_bound(opt, opt.max_value());
+      else if (has_min)
+        notes += "minimum: " + format_bound(opt, opt.min_value());
+      else
+        notes += "maximum: " + format_bound(opt, opt.max_value());
+    }
+    if (opt.step() > 0) {
+      if (!notes.empty())
+        notes += "; ";
+      notes += "step: " + format_bound(opt, opt.step());
     }
+    return notes;
+  }
+  option& parser::add_option(const option& opt) {
+    return group("").add_option(opt);
+  }
+  option& parser::add_option(option&& opt) {
+    return group("").add_option(std::move(opt));
   }
   option& parser::add_option(const std::string& long_name,
                              char short_name,
@@ -884,10 +3846,14 @@ namespace optionpp {
                              const std::string& arg_name,
                              bool arg_required,
                              const std::string& group_name) {
+    m_help_cache.clear();
+    m_names.clear();
     return group(group_name).add_option(long_name, short_name)
       .description(description).argument(arg_name, arg_required);
   }
   option_group& parser::group(const std::string& name) {
+    m_help_cache.clear();
+    m_names.clear();
     auto it = std::find_if(m_groups.rbegin(), m_groups.rend(),
                            [&](const option_group& g) {
                              return g.name() == name;
@@ -904,8 +3870,10 @@ namespace optionpp {
                                   const std::string& long_prefix,
                                   const std::string& end_indicator,
                                   const std::string& equals) {
+    m_help_cache.clear();
+    m_names.clear();
     if (!delims.empty())
-      m_delims = delims;
+      m_delims = utility::char_class{delims};
     if (!short_prefix.empty())
       m_short_option_prefix = short_prefix;
     if (!long_prefix.empty())
@@ -916,23 +3884,40 @@ namespace optionpp {
       m_equals = equals;
   }
   void parser::sort_groups() {
+    m_help_cache.clear();
+    m_names.clear();
     std::sort(m_groups.begin(), m_groups.end(),
               [](const option_group& a, const option_group& b) {
                 return a.name() < b.name();
               });
   }
   void parser::sort_options() {
+    m_help_cache.clear();
+    m_names.clear();
     std::for_each(m_groups.begin(), m_groups.end(),
                   [](option_group& g) { g.sort(); });
   }
   option& parser::operator[](const std::string& long_name) {
+    m_help_cache.clear();
+    m_names.clear();
     option* opt = find_option(long_name);
     if (opt)
       return *opt;
     else
       return add_option().long_name(long_name);
   }
+  option& parser::operator[](utility::static_string long_name) {
+    m_help_cache.clear();
+    m_names.clear();
+    option* opt = find_option(utility::token_view{long_name});
+    if (opt)
+      return *opt;
+    else
+      return add_option().long_name(long_name);
+  }
   option& parser::operator[](char short_name) {
+    m_help_cache.clear();
+    m_names.clear();
     option* opt = find_option(short_name);
     if (opt)
       return *opt;
@@ -945,6 +3930,24 @@ namespace optionpp {
                                    int option_indent,
                                    int desc_first_line_indent,
                                    int desc_multiline_indent) const {
+    help_cache::key_type key{{max_line_length, group_indent, option_indent,
+                              desc_first_line_indent, desc_multiline_indent}};
+    auto text = m_help_cache.find(key);
+    if (!text) {
+      std::ostringstream oss;
+      render_help(oss, max_line_length, group_indent, option_indent,
+                  desc_first_line_indent, desc_multiline_indent);
+      text = std::make_shared<const std::string>(oss.str());
+      m_help_cache.insert(key, text);
+    }
+    return os.write(text->data(), static_cast<std::streamsize>(text->size()));
+  }
+  void parser::render_help(std::ostream& os,
+                           int max_line_length,
+                           int group_indent,
+                           int option_indent,
+                           int desc_first_line_indent,
+                           int desc_multiline_indent) const {
     bool first = true;
     for (const auto& group : m_groups) {
       if (group.empty())
@@ -954,8 +3957,8 @@ namespace optionpp {
       else
         os << "\n\n";
       if (!group.name().empty()) {
-        os << utility::wrap_text(group.name(), max_line_length, group_indent)
-           << "\n";
+        utility::write_wrapped(os, group.name(), max_line_length, group_indent)
+          << "\n";
       }
       bool first_opt = true;
       for (const auto& opt : group) {
@@ -967,42 +3970,749 @@ namespace optionpp {
         if (opt.short_name() != '\0') {
           usage += m_short_option_prefix;
           usage += opt.short_name();
-          if (!opt.long_name().empty())
+          if (!opt.long_name_view().empty())
             usage += ", ";
         } else {
           usage += std::string(m_short_option_prefix.size() + 3, ' ');
         }
-        if (!opt.long_name().empty()) {
+        utility::token_view long_name = opt.long_name_view();
+        if (!long_name.empty()) {
           usage += m_long_option_prefix;
-          usage += opt.long_name();
+          usage.append(long_name.data(), long_name.size());
         }
-        if (!opt.argument_name().empty()) {
-          if (opt.is_argument_required())
-            usage += m_equals + opt.argument_name();
-          else
-            usage += "[" + m_equals + opt.argument_name() + "]";
+        utility::token_view arg_name = opt.argument_name_view();
+        if (!arg_name.empty()) {
+          if (!opt.is_argument_required())
+            usage += "[";
+          usage += m_equals;
+          usage.append(arg_name.data(), arg_name.size());
+          if (!opt.is_argument_required())
+            usage += "]";
+        }
+        utility::token_view desc = opt.description_view();
+        std::string described;
+        std::string notes = describe_constraints(opt);
+        if (!notes.empty()) {
+          described = desc;
+          if (!described.empty())
+            described.push_back(' ');
+          described += "(" + notes + ")";
+          desc = described;
         }
-        int spacing = desc_first_line_indent - usage.size();
+        int spacing = desc_first_line_indent
+          - static_cast<int>(utility::display_width(usage));
         if (spacing <= 1) {
-          os << utility::wrap_text(usage, max_line_length);
-          if (!opt.description().empty()) {
-            os << "\n" << utility::wrap_text(opt.description(),
-                                             max_line_length,
-                                             desc_multiline_indent,
-                                             desc_first_line_indent);
+          utility::write_wrapped(os, usage, max_line_length);
+          if (!desc.empty()) {
+            os << "\n";
+            utility::write_wrapped(os, desc, max_line_length,
+                                   desc_multiline_indent,
+                                   desc_first_line_indent);
           }
         } else {
-          if (!opt.description().empty()) {
+          if (!desc.empty()) {
             usage += std::string(spacing, ' ');
-            usage += opt.description();
+            usage.append(desc.data(), desc.size());
+          }
+          utility::write_wrapped(os, usage, max_line_length,
+                                 desc_multiline_indent, 0);
+        }
+      }
+    }
+  }
+  void write_roff(std::ostream& os, utility::token_view text) {
+    const char* run = text.begin();
+    if (run != text.end() && (*run == '.' || *run == '\''))
+      os << "\\&";
+    for (const char* pos = run; pos != text.end(); ++pos) {
+      if (*pos != '\\' && *pos != '-')
+        continue;
+      os.write(run, pos - run);
+      os << (*pos == '\\' ? "\\e" : "\\-");
+      run = pos + 1;
+    }
+    os.write(run, text.end() - run);
+  }
+  void write_roff_argument(std::ostream& os, const std::string& text) {
+    os << '"';
+    const char* run = text.data();
+    const char* end = run + text.size();
+    for (const char* pos = run; pos != end; ++pos) {
+      if (*pos != '"')
+        continue;
+      write_roff(os, utility::token_view{run,
+            static_cast<std::size_t>(pos - run)});
+      os << "\\(dq";
+      run = pos + 1;
+    }
+    write_roff(os, utility::token_view{run,
+          static_cast<std::size_t>(end - run)});
+    os << '"';
+  }
+  void write_roff_lines(std::ostream& os, const std::string& text,
+                        const char* paragraph) {
+    const char* line = text.data();
+    const char* end = line + text.size();
+    while (line != end) {
+      const char* line_end = std::find(line, end, '\n');
+      utility::token_view view{line,
+          static_cast<std::size_t>(line_end - line)};
+      if (std::all_of(view.begin(), view.end(),
+                      [](char c) { return c == ' ' || c == '\t'; }))
+        os << paragraph << '\n';
+      else {
+        write_roff(os, view);
+        os << '\n';
+      }
+      line = line_end == end ? end : line_end + 1;
+    }
+  }
+  void write_markdown_text(std::ostream& os, const std::string& text,
+                           const char* indent) {
+    static const utility::char_class specials{"\\`*_[]<>|\n"};
+    static const utility::char_class line_starts{"#+-="};
+    const char* run = text.data();
+    const char* end = run + text.size();
+    bool line_start = false;
+    for (const char* pos = run; pos != end; ++pos) {
+      if (line_start) {
+        line_start = false;
+        const char* digits = pos;
+        while (digits != end && *digits >= '0' && *digits <= '9')
+          ++digits;
+        if (digits != pos && digits != end
+            && (*digits == '.' || *digits == ')')) {
+          os.write(run, digits - run);
+          os << '\\';
+          run = pos = digits;
+          continue;
+        }
+        if (line_starts.contains(*pos)) {
+          os.write(run, pos - run);
+          os << '\\';
+          run = pos;
+          continue;
+        }
+      }
+      if (!specials.contains(*pos))
+        continue;
+      os.write(run, pos - run);
+      if (*pos == '\n') {
+        if (pos + 1 != end && pos[1] == '\n') {
+          os << "\n\n" << indent;
+          ++pos;
+        } else {
+          os << "\\\n" << indent;
+        }
+        line_start = true;
+      } else {
+        os << '\\' << *pos;
+      }
+      run = pos + 1;
+    }
+    os.write(run, end - run);
+  }
+  void write_code_span(std::ostream& os, const std::string& text) {
+    std::size_t longest = 0;
+    std::size_t current = 0;
+    for (char c : text) {
+      current = c == '`' ? current + 1 : 0;
+      longest = std::max(longest, current);
+    }
+    std::string fence(longest + 1, '`');
+    bool pad = longest > 0;
+    os << fence << (pad ? " " : "") << text << (pad ? " " : "") << fence;
+  }
+  void write_json_string(std::ostream& os, utility::token_view text) {
+    static const char hex_digits[] = "0123456789abcdef";
+    os << '"';
+    const char* run = text.begin();
+    for (const char* pos = run; pos != text.end(); ++pos) {
+      auto c = static_cast<unsigned char>(*pos);
+      if (c >= 0x20 && c != '"' && c != '\\')
+        continue;
+      os.write(run, pos - run);
+      switch (c) {
+      case '"': os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\r': os << "\\r"; break;
+      case '\t': os << "\\t"; break;
+      default:
+        os << "\\u00" << hex_digits[c >> 4] << hex_digits[c & 15];
+        break;
+      }
+      run = pos + 1;
+    }
+    os.write(run, text.end() - run);
+    os << '"';
+  }
+  const char* argument_type_name(option::arg_type type) noexcept {
+    switch (type) {
+    case option::int_arg: return "int";
+    case option::uint_arg: return "uint";
+    case option::double_arg: return "double";
+    case option::custom_arg: return "custom";
+    case option::enum_arg: return "enum";
+    case option::duration_arg: return "duration";
+    case option::size_arg: return "size";
+    default: return "string";
+    }
+  }
+  std::string help_description(const option& opt) {
+    std::string notes = describe_constraints(opt);
+    if (notes.empty())
+      return opt.description_view();
+    std::string desc = opt.description_view();
+    if (!desc.empty())
+      desc.push_back(' ');
+    return desc + "(" + notes + ")";
+  }
+  std::ostream& parser::print_man_page(std::ostream& os,
+                                       const man_page_info& info) const {
+    os << ".TH ";
+    write_roff_argument(os, info.name);
+    os << ' ' << info.section;
+    for (const std::string* field : {&info.date, &info.source, &info.manual}) {
+      os << ' ';
+      write_roff_argument(os, *field);
+    }
+    os << "\n";
+    os << ".SH NAME\n";
+    write_roff(os, info.name);
+    if (!info.summary.empty()) {
+      os << " \\- ";
+      write_roff(os, info.summary);
+    }
+    os << "\n";
+    os << ".SH SYNOPSIS\n.B ";
+    write_roff_argument(os, info.name);
+    os << "\n";
+    if (info.synopsis.empty())
+      os << "[\\fIOPTION\\fR]...\n";
+    else
+      write_roff_lines(os, info.synopsis, ".br");
+    if (!info.description.empty()) {
+      os << ".SH DESCRIPTION\n";
+      write_roff_lines(os, info.description, ".PP");
+    }
+    bool first = true;
+    for (const auto& group : m_groups) {
+      if (group.empty())
+        continue;
+      if (first) {
+        os << ".SH OPTIONS\n";
+        first = false;
+      }
+      if (!group.name().empty()) {
+        os << ".SS ";
+        write_roff_argument(os, group.name());
+        os << "\n";
+      }
+      for (const auto& opt : group) {
+        char short_name = opt.short_name();
+        os << ".TP\n";
+        if (short_name != '\0') {
+          os << "\\fB";
+          write_roff(os, m_short_option_prefix);
+          write_roff(os, utility::token_view{&short_name, 1});
+          os << "\\fR";
+          if (!opt.long_name_view().empty())
+            os << ", ";
+        }
+        if (!opt.long_name_view().empty()) {
+          os << "\\fB";
+          write_roff(os, m_long_option_prefix);
+          write_roff(os, opt.long_name_view());
+          os << "\\fR";
+        }
+        if (!opt.argument_name_view().empty()) {
+          bool optional = !opt.is_argument_required();
+          os << (optional ? "[" : "");
+          write_roff(os, m_equals);
+          os << "\\fI";
+          write_roff(os, opt.argument_name_view());
+          os << "\\fR" << (optional ? "]" : "");
+        }
+        os << "\n";
+        write_roff_lines(os, help_description(opt), ".IP");
+      }
+    }
+    return os;
+  }
+  std::ostream& parser::print_markdown(std::ostream& os,
+                                       int heading_level) const {
+    heading_level = std::min(std::max(heading_level, 1), 6);
+    auto argument_suffix = [this](const option& opt) {
+      utility::token_view arg_name = opt.argument_name_view();
+      if (arg_name.empty())
+        return std::string{};
+      std::string suffix = m_equals;
+      suffix.append(arg_name.data(), arg_name.size());
+      if (opt.is_argument_required())
+        return suffix;
+      return "[" + suffix + "]";
+    };
+    bool first = true;
+    for (const auto& group : m_groups) {
+      if (group.empty())
+        continue;
+      if (first)
+        first = false;
+      else
+        os << "\n";
+      if (!group.name().empty()) {
+        os << std::string(heading_level, '#') << ' ';
+        write_markdown_text(os, group.name(), "");
+        os << "\n\n";
+      }
+      for (const auto& opt : group) {
+        os << "- ";
+        if (opt.short_name() != '\0') {
+          std::string name = m_short_option_prefix + opt.short_name();
+          if (opt.long_name_view().empty() && !opt.argument_name_view().empty())
+            name += argument_suffix(opt);
+          write_code_span(os, name);
+          if (!opt.long_name_view().empty())
+            os << ", ";
+        }
+        utility::token_view long_name = opt.long_name_view();
+        if (!long_name.empty()) {
+          std::string name = m_long_option_prefix;
+          name.append(long_name.data(), long_name.size());
+          write_code_span(os, name + argument_suffix(opt));
+        }
+        std::string desc = help_description(opt);
+        if (!desc.empty()) {
+          os << ": ";
+          write_markdown_text(os, desc, "  ");
+        }
+        os << "\n";
+      }
+    }
+    return os;
+  }
+  std::ostream& parser::print_json(std::ostream& os) const {
+    os << "{\n  \"short_prefix\": ";
+    write_json_string(os, m_short_option_prefix);
+    os << ",\n  \"long_prefix\": ";
+    write_json_string(os, m_long_option_prefix);
+    os << ",\n  \"end_of_options\": ";
+    write_json_string(os, m_end_of_options);
+    os << ",\n  \"equals\": ";
+    write_json_string(os, m_equals);
+    os << ",\n  \"groups\": [";
+    bool first_group = true;
+    for (const auto& group : m_groups) {
+      if (group.empty())
+        continue;
+      os << (first_group ? "\n" : ",\n") << "    {\n      \"name\": ";
+      first_group = false;
+      write_json_string(os, group.name());
+      os << ",\n      \"options\": [";
+      bool first_opt = true;
+      for (const auto& opt : group) {
+        os << (first_opt ? "\n" : ",\n") << "        {";
+        first_opt = false;
+        const char* separator = "";
+        if (!opt.long_name_view().empty()) {
+          os << "\"long_name\": ";
+          write_json_string(os, opt.long_name_view());
+          separator = ", ";
+        }
+        char short_name = opt.short_name();
+        if (short_name != '\0') {
+          os << separator << "\"short_name\": ";
+          write_json_string(os, utility::token_view{&short_name, 1});
+          separator = ", ";
+        }
+        if (!opt.description_view().empty()) {
+          os << separator << "\"description\": ";
+          write_json_string(os, opt.description_view());
+          separator = ", ";
+        }
+        if (!opt.argument_name_view().empty()) {
+          os << separator << "\"argument\": {\"name\": ";
+          write_json_string(os, opt.argument_name_view());
+          os << ", \"required\": "
+             << (opt.is_argument_required() ? "true" : "false")
+             << ", \"type\": \"" << argument_type_name(opt.argument_type())
+             << '"';
+          const auto& choices = opt.choices();
+          if (!choices.empty()) {
+            os << ", \"choices\": [";
+            for (choice_table::size_type i = 0; i != choices.size(); ++i) {
+              if (i != 0)
+                os << ", ";
+              write_json_string(os, choices.name(i));
+            }
+            os << ']';
           }
-          os << utility::wrap_text(usage, max_line_length,
-                                   desc_multiline_indent, 0);
+          if (std::isfinite(opt.min_value()))
+            os << ", \"minimum\": " << format_number(opt.min_value());
+          if (std::isfinite(opt.max_value()))
+            os << ", \"maximum\": " << format_number(opt.max_value());
+          if (opt.step() > 0)
+            os << ", \"step\": " << format_number(opt.step());
+          os << '}';
         }
+        os << '}';
+      }
+      os << (first_opt ? "]\n" : "\n      ]\n") << "    }";
+    }
+    os << (first_group ? "]\n" : "\n  ]\n") << "}\n";
+    return os;
+  }
+  std::vector<std::string> parser::complete(const std::string& prefix,
+                                            const std::string& previous) const {
+    std::vector<std::string> result;
+    auto add_choices = [&result](const option& opt, const std::string& head,
+                                 const std::string& value) {
+      const auto& choices = opt.choices();
+      for (choice_table::size_type i = 0; i != choices.size(); ++i) {
+        if (utility::is_substr_at_pos(choices.name(i), value))
+          result.push_back(head + choices.name(i));
+      }
+    };
+    const option* opt = option_awaiting_argument(previous);
+    if (opt && (opt->is_argument_required() || is_non_option(prefix))) {
+      add_choices(*opt, "", prefix);
+      return result;
+    }
+    if (is_long_option(prefix)) {
+      auto start = m_long_option_prefix.size();
+      auto pos = prefix.find(m_equals, start);
+      if (pos == std::string::npos) {
+        for (const auto& name : m_names.complete(m_groups, prefix.substr(start)))
+          result.push_back(m_long_option_prefix + name);
+      } else if ((opt = find_option(prefix.substr(start, pos - start)))) {
+        pos += m_equals.size();
+        add_choices(*opt, prefix.substr(0, pos), prefix.substr(pos));
+      }
+    } else if (prefix == m_short_option_prefix
+               || (!prefix.empty()
+                   && utility::is_substr_at_pos(m_long_option_prefix, prefix))) {
+      if (prefix == m_short_option_prefix) {
+        for (char c : m_names.short_names(m_groups))
+          result.push_back(m_short_option_prefix + c);
       }
+      for (const auto& name : m_names.complete(m_groups, ""))
+        result.push_back(m_long_option_prefix + name);
+    }
+    return result;
+  }
+  const option*
+  parser::option_awaiting_argument(const std::string& argument) const {
+    if (argument.find(m_equals) != std::string::npos)
+      return nullptr;
+    if (is_long_option(argument)) {
+      const option* opt
+        = find_option(argument.substr(m_long_option_prefix.size()));
+      if (opt && !opt->argument_name_view().empty())
+        return opt;
+    } else if (is_short_option_group(argument)) {
+      for (auto pos = m_short_option_prefix.size();
+           pos != argument.size(); ++pos) {
+        const option* opt = find_option(argument[pos]);
+        if (!opt)
+          return nullptr;
+        if (!opt->argument_name_view().empty())
+          return pos + 1 == argument.size() ? opt : nullptr;
+      }
+    }
+    return nullptr;
+  }
+  std::string shell_identifier(const std::string& program) {
+    std::string id = program;
+    for (char& c : id) {
+      if (!std::isalnum(static_cast<unsigned char>(c)))
+        c = '_';
+    }
+    return id;
+  }
+  std::string shell_quote(const std::string& text, bool fish) {
+    std::string quoted = "'";
+    for (char c : text) {
+      if (c == '\'')
+        quoted += fish ? "\\'" : "'\\''";
+      else if (c == '\\' && fish)
+        quoted += "\\\\";
+      else
+        quoted.push_back(c);
+    }
+    return quoted + "'";
+  }
+  std::ostream& parser::print_completion_script(std::ostream& os,
+                                                completion_shell shell,
+                                                const std::string& program) {
+    const std::string id = shell_identifier(program);
+    switch (shell) {
+    case completion_shell::bash:
+      os << "# Bash completion for " << program
+         << ", generated by Option++.\n"
+         << "_optionpp_" << id << "() {\n"
+         << R"(  local line="${COMP_LINE:0:COMP_POINT}"
+  local cur="${line##*[[:space:]]}"
+  local prev="${line%"$cur"}"
+  prev="${prev%"${prev##*[![:space:]]}"}"
+  prev="${prev##*[[:space:]]}"
+  # Bash splits words at = and :, so only the text after them is
+  # replaced
+  local head="${cur%"${cur##*[=:]}"}"
+  if [[ -z "$head" || "$COMP_WORDBREAKS" != *"${head: -1}"* ]]; then
+    head=""
+  fi
+  COMPREPLY=()
+  local word
+  while IFS= read -r word; do
+    COMPREPLY+=("${word#"$head"}")
+  done < <("$1" --__complete "$prev" "$cur" 2>/dev/null)
+}
+)"
+         << "complete -o default -F _optionpp_" << id << " "
+         << shell_quote(program, false) << "\n";
+      break;
+    case completion_shell::zsh:
+      os << "#compdef " << program << "\n"
+         << "# Zsh completion for " << program
+         << ", generated by Option++.\n"
+         << "_" << id << "() {\n"
+         << R"(  local -a candidates
+  candidates=("${(@f)$("${words[1]}" --__complete "${words[CURRENT-1]}" "${words[CURRENT]}" 2>/dev/null)}")
+  candidates=("${(@)candidates:#}")
+  if (( ${#candidates} )); then
+    compadd -- "${candidates[@]}"
+  else
+    _files
+  fi
+}
+)"
+         << "if [[ \"${funcstack[1]}\" == _" << id << " ]]; then\n"
+         << "  _" << id << " \"$@\"\n"
+         << "else\n"
+         << "  compdef _" << id << " " << shell_quote(program, false) << "\n"
+         << "fi\n";
+      break;
+    case completion_shell::fish:
+      os << "# Fish completion for " << program
+         << ", generated by Option++.\n"
+         << "function __optionpp_" << id << "\n"
+         << R"(    set -l tokens (commandline -opc)
+    $tokens[1] --__complete $tokens[-1] (commandline -ct) 2>/dev/null
+end
+)"
+         << "complete -c " << shell_quote(program, true)
+         << " -a '(__optionpp_" << id << ")'\n";
+      break;
     }
     return os;
   }
+  bool parser::run_completion(int argc, char* argv[]) const {
+    return run_completion(argc, argv, std::cout);
+  }
+  bool parser::run_completion(int argc, char* argv[], std::ostream& os) const {
+    if (argc < 2 || std::string{argv[1]} != "--__complete")
+      return false;
+    std::string previous = argc > 2 ? argv[2] : "";
+    std::string prefix = argc > 3 ? argv[3] : "";
+    for (const auto& completion : complete(prefix, previous))
+      os << completion << '\n';
+    os.flush();
+    return true;
+  }
+  std::uint64_t char_set(const std::string& str) noexcept {
+    std::uint64_t set = 0;
+    for (char c : str)
+      set |= std::uint64_t{1} << (static_cast<unsigned char>(c) & 63);
+    return set;
+  }
+  std::size_t count_bits(std::uint64_t mask) noexcept {
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_popcountll(mask));
+#else
+    std::size_t count = 0;
+    for (; mask; mask &= mask - 1)
+      ++count;
+    return count;
+#endif
+  }
+  constexpr std::size_t parser::name_index::max_suggestions;
+  struct parser::name_index::tree {
+    struct node {
+      std::string name;
+      std::size_t distance;
+      std::size_t first_child;
+      std::size_t next_sibling;
+      std::size_t max_child_distance;
+      std::uint64_t chars;
+    };
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+    void insert(const std::string& name) {
+      if (nodes.empty()) {
+        nodes.push_back(node{name, 0, npos, npos, 0, char_set(name)});
+        return;
+      }
+      std::size_t current = 0;
+      for (;;) {
+        std::size_t distance = utility::edit_distance(name, nodes[current].name);
+        if (distance == 0)
+          return;
+        std::size_t child = nodes[current].first_child;
+        std::size_t last = npos;
+        while (child != npos && nodes[child].distance != distance) {
+          last = child;
+          child = nodes[child].next_sibling;
+        }
+        if (child == npos) {
+          nodes.push_back(node{name, distance, npos, npos, 0, char_set(name)});
+          nodes[current].max_child_distance
+            = std::max(nodes[current].max_child_distance, distance);
+          if (last == npos)
+            nodes[current].first_child = nodes.size() - 1;
+          else
+            nodes[last].next_sibling = nodes.size() - 1;
+          return;
+        }
+        current = child;
+      }
+    }
+    std::vector<node> nodes;
+  };
+  constexpr std::size_t parser::name_index::tree::npos;
+  std::vector<std::string>
+  parser::name_index::suggest(const group_container& groups,
+                                    const std::string& name) const {
+    std::shared_ptr<const tree> names;
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if (!m_tree) {
+        std::shared_ptr<tree> built = std::make_shared<tree>();
+        for (const auto& group : groups) {
+          for (const auto& opt : group) {
+            if (!opt.long_name_view().empty())
+              built->insert(opt.long_name_view());
+          }
+        }
+        m_tree = std::move(built);
+      }
+      names = m_tree;
+    }
+    std::size_t max_distance = name.size() <= 4 ? 1
+      : name.size() <= 8 ? 2 : 3;
+    if (max_distance >= name.size())
+      max_distance = name.size() - (name.empty() ? 0 : 1);
+    std::vector<std::pair<std::size_t, const std::string*>> matches;
+    const std::uint64_t chars = char_set(name);
+    if (!names->nodes.empty() && max_distance > 0) {
+      std::vector<std::size_t> pending{0};
+      while (!pending.empty()) {
+        const tree::node& current = names->nodes[pending.back()];
+        pending.pop_back();
+        std::size_t bound = current.max_child_distance + max_distance;
+        if (std::max(count_bits(chars & ~current.chars),
+                     count_bits(current.chars & ~chars)) > bound)
+          continue;
+        std::size_t distance = utility::edit_distance(name, current.name,
+                                                      bound);
+        if (distance <= max_distance)
+          matches.emplace_back(distance, &current.name);
+        if (distance > bound)
+          continue;
+        for (std::size_t child = current.first_child; child != tree::npos;
+             child = names->nodes[child].next_sibling) {
+          std::size_t edge = names->nodes[child].distance;
+          if (edge + max_distance >= distance
+              && edge <= distance + max_distance)
+            pending.push_back(child);
+        }
+      }
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const std::pair<std::size_t, const std::string*>& lhs,
+                 const std::pair<std::size_t, const std::string*>& rhs) {
+                return lhs.first < rhs.first
+                  || (lhs.first == rhs.first && *lhs.second < *rhs.second);
+              });
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i != matches.size() && i != max_suggestions; ++i)
+      result.push_back(*matches[i].second);
+    return result;
+  }
+  struct parser::name_index::sorted_names {
+    std::vector<std::string> long_names;
+    std::string short_names;
+  };
+  std::shared_ptr<const parser::name_index::sorted_names>
+  parser::name_index::get_sorted(const group_container& groups) const {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (!m_sorted) {
+      std::shared_ptr<sorted_names> built = std::make_shared<sorted_names>();
+      for (const auto& group : groups) {
+        for (const auto& opt : group) {
+          if (!opt.long_name_view().empty())
+            built->long_names.push_back(opt.long_name_view());
+          if (opt.short_name() != '\0')
+            built->short_names.push_back(opt.short_name());
+        }
+      }
+      auto& names = built->long_names;
+      std::sort(names.begin(), names.end());
+      names.erase(std::unique(names.begin(), names.end()), names.end());
+      auto& chars = built->short_names;
+      std::sort(chars.begin(), chars.end());
+      chars.erase(std::unique(chars.begin(), chars.end()), chars.end());
+      m_sorted = std::move(built);
+    }
+    return m_sorted;
+  }
+  std::vector<std::string>
+  parser::name_index::complete(const group_container& groups,
+                               const std::string& prefix) const {
+    auto names = get_sorted(groups);
+    const auto& list = names->long_names;
+    std::vector<std::string> result;
+    for (auto it = std::lower_bound(list.begin(), list.end(), prefix);
+         it != list.end() && it->compare(0, prefix.size(), prefix) == 0;
+         ++it)
+      result.push_back(*it);
+    return result;
+  }
+  std::string
+  parser::name_index::short_names(const group_container& groups) const {
+    return get_sorted(groups)->short_names;
+  }
+  void parser::name_index::clear() noexcept {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_tree.reset();
+    m_sorted.reset();
+  }
+  constexpr std::size_t parser::help_cache::max_entries;
+  std::shared_ptr<const std::string>
+  parser::help_cache::find(const key_type& key) const {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (const auto& entry : m_entries) {
+      if (entry.first == key)
+        return entry.second;
+    }
+    return nullptr;
+  }
+  void parser::help_cache::insert(const key_type& key,
+                                  std::shared_ptr<const std::string> text) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (auto& entry : m_entries) {
+      if (entry.first == key) {
+        entry.second = std::move(text);
+        return;
+      }
+    }
+    if (m_entries.size() == max_entries)
+      m_entries.erase(m_entries.begin());
+    m_entries.emplace_back(key, std::move(text));
+  }
+  void parser::help_cache::clear() noexcept {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_entries.clear();
+  }
   auto parser::find_group(const std::string& name) -> group_iterator {
     return std::find_if(m_groups.begin(), m_groups.end(),
                         [&](const option_group& g) {
@@ -1015,7 +4725,7 @@ namespace optionpp {
                           return g.name() == name;
                         });
   }
-  option* parser::find_option(const std::string& long_name) {
+  option* parser::find_option(utility::token_view long_name) {
     for (auto& group : m_groups) {
       auto it = group.find(long_name);
       if (it != group.end())
@@ -1023,7 +4733,7 @@ namespace optionpp {
     }
     return nullptr;
   }
-  const option* parser::find_option(const std::string& long_name) const {
+  const option* parser::find_option(utility::token_view long_name) const {
     for (const auto& group : m_groups) {
       auto it = group.find(long_name);
       if (it != group.end())
@@ -1050,22 +4760,243 @@ namespace optionpp {
   parser_result parser::parse(int argc, char* argv[], bool ignore_first) const {
     return parse(argv, argv + argc, ignore_first);
   }
+  class parser::token_sink {
+  public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+    struct state {
+      state(bool ignore_first, cl_arg_type prev_type,
+            std::vector<mapped_file::file_id>& open_files)
+        : type{prev_type}, skip_next{ignore_first}, includes{open_files} {}
+      std::string token;
+      cl_arg_type type;
+      bool skip_next;
+      std::vector<mapped_file::file_id>& includes;
+    };
+    token_sink(const parser& p, parser_result& result,
+               utility::token_arena* arena, state& st) noexcept
+      : m_parser{&p}, m_result{&result}, m_arena{arena}, m_state{&st} {}
+    token_sink& operator*() noexcept { return *this; }
+    token_sink& operator++() noexcept { return *this; }
+    token_sink& operator++(int) noexcept { return *this; }
+    token_sink& operator=(utility::token_view token) {
+      if (m_state->skip_next) {
+        m_state->skip_next = false;
+      } else {
+        m_state->token.assign(token.data(), token.size());
+        m_parser->parse_token(m_state->token, *m_result, m_state->type,
+                              m_state->includes);
+      }
+      if (m_arena)
+        m_arena->clear();
+      return *this;
+    }
+  private:
+    const parser* m_parser;
+    parser_result* m_result;
+    utility::token_arena* m_arena;
+    state* m_state;
+  };
   parser_result parser::parse(const std::string& cmd_line, bool ignore_first) const {
-    std::vector<std::string> container;
-    utility::split(cmd_line, std::back_inserter(container),
-                   m_delims, "\"'", '\\');
-    return parse(container.begin(), container.end(), ignore_first);
+    parser_result result{};
+    result.pending_writes().set_deferred(m_transactional);
+    parse_string(cmd_line, ignore_first, result);
+    return result;
+  }
+  void parser::parse_string(const std::string& cmd_line, bool ignore_first,
+                            parser_result& result) const {
+    std::vector<mapped_file::file_id> includes;
+    token_sink::state st{ignore_first, cl_arg_type::non_option, includes};
+    if (m_dialect == utility::shell_dialect::generic) {
+      utility::token_arena arena;
+      utility::split_view(cmd_line, token_sink{*this, result, &arena, st},
+                          arena, m_delims, "\"'", '\\');
+    } else {
+      utility::tokenizer tok{m_dialect};
+      tok.finish(tok.feed(cmd_line, token_sink{*this, result, nullptr, st}));
+    }
+    finish_parse(result, st.type);
+  }
+  parser_result parser::parse(std::istream& in, bool ignore_first) const {
+    parser_result result{};
+    result.pending_writes().set_deferred(m_transactional);
+    std::vector<mapped_file::file_id> includes;
+    token_sink::state st{ignore_first, cl_arg_type::non_option, includes};
+    utility::tokenizer tok{make_tokenizer()};
+    tok.read(in, token_sink{*this, result, nullptr, st});
+    finish_parse(result, st.type);
+    return result;
+  }
+  parser_result parser::parse_fd(int fd, bool ignore_first) const {
+    parser_result result{};
+    result.pending_writes().set_deferred(m_transactional);
+    std::vector<mapped_file::file_id> includes;
+    token_sink::state st{ignore_first, cl_arg_type::non_option, includes};
+    utility::tokenizer tok{make_tokenizer()};
+    tok.read_fd(fd, token_sink{*this, result, nullptr, st});
+    finish_parse(result, st.type);
+    return result;
+  }
+  incremental_parser::incremental_parser(const parser& parser,
+                                         bool ignore_first)
+    : m_parser{&parser}, m_skip_next{ignore_first} {
+    m_result.pending_writes().set_deferred(parser.m_transactional);
+  }
+  void incremental_parser::feed(const std::string& token) {
+    if (m_skip_next)
+      m_skip_next = false;
+    else
+      m_parser->parse_token(token, m_result, m_type, m_includes);
+  }
+  parser_result incremental_parser::finish() {
+    m_parser->finish_parse(m_result, m_type);
+    parser_result result{std::move(m_result)};
+    reset();
+    return result;
+  }
+  void incremental_parser::reset(bool ignore_first) {
+    m_result = parser_result{};
+    m_result.pending_writes().set_deferred(m_parser->m_transactional);
+    m_type = parser::cl_arg_type::non_option;
+    m_skip_next = ignore_first;
+    m_includes.clear();
+  }
+  utility::tokenizer parser::make_tokenizer() const {
+    if (m_dialect == utility::shell_dialect::generic)
+      return utility::tokenizer{m_delims, "\"'", '\\'};
+    return utility::tokenizer{m_dialect};
+  }
+  void parser::parse_token(const std::string& token, parser_result& result,
+                           cl_arg_type& type) const {
+    std::vector<mapped_file::file_id> includes;
+    parse_token(token, result, type, includes);
+  }
+  void parser::parse_token(const std::string& token, parser_result& result,
+                           cl_arg_type& type,
+                           std::vector<mapped_file::file_id>& includes) const {
+    if (m_response_files && type != cl_arg_type::end_indicator
+        && token.size() > 1 && token[0] == '@') {
+      parse_response_file(token.substr(1), result, type, includes);
+      return;
+    }
+    if (type == cl_arg_type::arg_required
+        || type == cl_arg_type::arg_optional) {
+      if (is_non_option(token)
+          || type == cl_arg_type::arg_required) {
+        auto& arg_info = result.back();
+        arg_info.argument = token;
+        arg_info.original_text.push_back(' ');
+        arg_info.original_text += token;
+        type = cl_arg_type::non_option;
+        if (arg_info.opt_info)
+          write_option_argument(arg_info, result.pending_writes());
+        return;
+      }
+      type = cl_arg_type::non_option;
+    }
+    if (type == cl_arg_type::end_indicator) {
+      parsed_entry arg_info;
+      arg_info.original_text = token;
+      arg_info.is_option = false;
+      result.push_back(std::move(arg_info));
+    } else {
+      parse_argument(token, result, type);
+    }
+  }
+  void parser::parse_response_file(const std::string& path,
+                                   parser_result& result, cl_arg_type& type,
+                                   std::vector<mapped_file::file_id>& includes) const {
+    mapped_file file;
+    try {
+      file = mapped_file{path};
+    } catch (const file_error& e) {
+      throw parse_error{e.what(), "optionpp::parser::parse", "@" + path};
+    }
+    if (std::find(includes.begin(), includes.end(), file.id())
+        != includes.end()) {
+      throw parse_error{"response file '" + path + "' includes itself",
+          "optionpp::parser::parse", "@" + path};
+    }
+    includes.push_back(file.id());
+    token_sink::state st{false, type, includes};
+    utility::token_view contents{file.data(), file.size()};
+    if (m_dialect == utility::shell_dialect::generic) {
+      utility::token_arena arena;
+      utility::split_view(contents, token_sink{*this, result, &arena, st},
+                          arena, utility::char_class{" \t\n\r"}, "\"'", '\\');
+    } else {
+      utility::tokenizer tok{m_dialect};
+      tok.finish(tok.feed(contents, token_sink{*this, result, nullptr, st}));
+    }
+    type = st.type;
+    includes.pop_back();
+  }
+  void parser::run_batch(std::size_t count, unsigned thread_count,
+                         const std::function<void(std::size_t,
+                                                  std::size_t)>& task) {
+    if (thread_count == 0)
+      thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::size_t max_block_size = 256;
+    std::size_t block_size = count / (std::size_t{thread_count} * 16);
+    block_size = std::min(std::max(block_size, std::size_t{1}),
+                          max_block_size);
+    std::size_t block_count = (count + block_size - 1) / block_size;
+    if (thread_count > block_count)
+      thread_count = static_cast<unsigned>(std::max(block_count,
+                                                    std::size_t{1}));
+    std::atomic<std::size_t> next_block{0};
+    auto worker = [&]() {
+      std::size_t block;
+      while ((block = next_block.fetch_add(1)) < block_count) {
+        std::size_t begin = block * block_size;
+        task(begin, std::min(begin + block_size, count));
+      }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (unsigned i = 1; i < thread_count; ++i) {
+      try {
+        threads.emplace_back(worker);
+      } catch (const std::system_error&) {
+        break;
+      }
+    }
+    worker();
+    for (auto& t : threads)
+      t.join();
+  }
+  void parser::finish_parse(const parser_result& result,
+                            cl_arg_type type) const {
+    if (type == cl_arg_type::arg_required) {
+      const auto& opt_name = result.back().original_text;
+      throw parse_error{"option '" + opt_name + "' requires an argument",
+          "optionpp::parser::parse", opt_name};
+    }
   }
-  void parser::write_option_argument(const parsed_entry& entry) const {
+  void parser::write_option_argument(const parsed_entry& entry,
+                                     write_log& writes) const {
     if (!entry.opt_info)
       return;
     const option& opt = *entry.opt_info;
-    if (!opt.has_bound_argument_variable())
-      return;
     std::string::size_type pos = 0;
     const std::string& arg = entry.argument;
     const std::string& opt_name = entry.original_without_argument;
     const std::string& fn_name = "optionpp::parser::write_option_argument";
+    auto choice = choice_table::npos;
+    if (!opt.choices().empty()) {
+      choice = opt.choices().find(arg);
+      if (choice == choice_table::npos)
+        throw parse_error{"argument for option '" + opt_name + "' must be one of: "
+            + opt.choices().to_string(), fn_name, opt_name};
+    }
+    if (!opt.validate(arg))
+      throw parse_error{"invalid argument for option '" + opt_name + "'",
+          fn_name, opt_name};
+    if (!opt.has_bound_argument_variable() && !writes.records_unbound())
+      return;
     try {
       switch (opt.argument_type()) {
       case option::uint_arg: {
@@ -1077,26 +5008,50 @@ namespace optionpp {
               fn_name, opt_name};
         else if (value > std::numeric_limits<unsigned>::max())
           throw std::out_of_range{"out of range"};
-        opt.write_uint(static_cast<unsigned>(value));
+        check_range(opt, static_cast<double>(value), opt_name);
+        writes.write_uint(opt, static_cast<unsigned>(value));
         break;
       }
       case option::int_arg: {
         int value = std::stoi(entry.argument, &pos);
         if (pos != arg.size())
           throw std::invalid_argument{"invalid argument"};
-        opt.write_int(value);
+        check_range(opt, value, opt_name);
+        writes.write_int(opt, value);
         break;
       }
       case option::double_arg: {
         double value = std::stod(entry.argument, &pos);
         if (pos != arg.size())
           throw std::invalid_argument{"invalid argument"};
-        opt.write_double(value);
+        check_range(opt, value, opt_name);
+        writes.write_double(opt, value);
+        break;
+      }
+      case option::duration_arg: {
+        auto value = utility::parse_duration(arg);
+        check_range(opt, std::chrono::duration<double>(value).count(),
+                    opt_name);
+        writes.write_duration(opt, value);
+        break;
+      }
+      case option::size_arg: {
+        auto value = utility::parse_size(arg);
+        check_range(opt, static_cast<double>(value), opt_name);
+        writes.write_size(opt, value);
         break;
       }
+      case option::enum_arg:
+        writes.write_enum(opt, choice);
+        break;
+      case option::custom_arg:
+        if (!writes.write_custom(opt, arg))
+          throw parse_error{"invalid argument for option '" + opt_name + "'",
+              fn_name, opt_name};
+        break;
       default:
       case option::string_arg:
-        opt.write_string(arg);
+        writes.write_string(opt, arg);
         break;
       }
     } catch(const std::invalid_argument&) {
@@ -1108,6 +5063,15 @@ namespace optionpp {
       case option::double_arg:
         throw parse_error{"argument for option '" + opt_name + "' must be a number",
             fn_name, opt_name};
+      case option::duration_arg:
+        throw parse_error{"argument for option '" + opt_name + "' must be a duration",
+            fn_name, opt_name};
+      case option::size_arg:
+        throw parse_error{"argument for option '" + opt_name + "' must be a size",
+            fn_name, opt_name};
+      case option::custom_arg:
+        throw parse_error{"invalid argument for option '" + opt_name + "'",
+            fn_name, opt_name};
       default:
         throw type_error{"type error in argument for option '" + opt_name + "'", fn_name};
       }
@@ -1116,6 +5080,27 @@ namespace optionpp {
           fn_name, opt_name};
     }
   }
+  void parser::check_range(const option& opt, double value,
+                           const std::string& opt_name) const {
+    const std::string& fn_name = "optionpp::parser::check_range";
+    if (value < opt.min_value())
+      throw parse_error{"argument for option '" + opt_name + "' must be at least "
+          + format_bound(opt, opt.min_value()), fn_name, opt_name};
+    if (value > opt.max_value())
+      throw parse_error{"argument for option '" + opt_name + "' must be at most "
+          + format_bound(opt, opt.max_value()), fn_name, opt_name};
+    if (opt.step() > 0) {
+      double base = std::isfinite(opt.min_value()) ? opt.min_value() : 0.0;
+      double steps = (value - base) / opt.step();
+      if (std::abs(steps - std::round(steps)) > 1e-9 * std::max(1.0, std::abs(steps))) {
+        std::string msg = "argument for option '" + opt_name + "' must be ";
+        if (base != 0.0)
+          msg += format_bound(opt, base) + " plus ";
+        msg += "a multiple of " + format_bound(opt, opt.step());
+        throw parse_error{std::move(msg), fn_name, opt_name};
+      }
+    }
+  }
   void parser::parse_argument(const std::string& argument,
                               parser_result& result, cl_arg_type& type) const {
     if (is_end_indicator(argument)) {
@@ -1144,11 +5129,26 @@ namespace optionpp {
     if (is_long_option(option_specifier)) {
       std::string option_name = option_specifier.substr(m_long_option_prefix.size());
       const option* opt = find_option(option_name);
-      if (!opt)
-        throw parse_error{"invalid option: '" + option_specifier + "'",
-            "optionpp::parser::parse_argument", option_specifier};
+      if (!opt) {
+        auto suggestions = m_names.suggest(m_groups, option_name);
+        std::string msg = "invalid option: '" + option_specifier + "'";
+        for (std::size_t i = 0; i != suggestions.size(); ++i) {
+          suggestions[i].insert(0, m_long_option_prefix);
+          if (i == 0)
+            msg += " (did you mean ";
+          else if (i + 1 == suggestions.size())
+            msg += " or ";
+          else
+            msg += ", ";
+          msg += "'" + suggestions[i] + "'";
+        }
+        if (!suggestions.empty())
+          msg += "?)";
+        throw parse_error{std::move(msg), "optionpp::parser::parse_argument",
+            option_specifier, std::move(suggestions)};
+      }
       arg_info.opt_info = &(*opt);
-      if (!opt->argument_name().empty()) {
+      if (!opt->argument_name_view().empty()) {
         if (!assignment_found) {
           if (opt->is_argument_required())
             type = cl_arg_type::arg_required;
@@ -1170,8 +5170,8 @@ namespace optionpp {
       arg_info.long_name = option_name;
       arg_info.short_name = opt->short_name();
       if (assignment_found)
-        write_option_argument(arg_info);
-      opt->write_bool(true);
+        write_option_argument(arg_info, result.pending_writes());
+      result.pending_writes().write_bool(*opt, true);
       result.push_back(std::move(arg_info));
     } else if (is_short_option_group(option_specifier)) {
       parse_short_option_group(option_specifier.substr(m_short_option_prefix.size()),
@@ -1201,11 +5201,11 @@ namespace optionpp {
       arg_info.original_text.push_back(short_names[pos]);
       arg_info.original_without_argument = arg_info.original_text;
       arg_info.is_option = true;
-      arg_info.long_name = opt->long_name();
+      arg_info.long_name = opt->long_name_view();
       arg_info.short_name = short_names[pos];
       arg_info.opt_info = &(*opt);
-      opt->write_bool(true);
-      if (!opt->argument_name().empty()) {
+      result.pending_writes().write_bool(*opt, true);
+      if (!opt->argument_name_view().empty()) {
         if (pos + 1 < short_names.size()) {
           arg_info.argument = short_names.substr(pos + 1);
           if (has_arg) {
@@ -1213,7 +5213,7 @@ namespace optionpp {
             arg_info.argument += argument;
           }
           arg_info.original_text += arg_info.argument;
-          write_option_argument(arg_info);
+          write_option_argument(arg_info, result.pending_writes());
           result.push_back(std::move(arg_info));
           type = cl_arg_type::no_arg;
           break;
@@ -1222,7 +5222,7 @@ namespace optionpp {
             arg_info.original_text += m_equals;
             arg_info.original_text += argument;
             arg_info.argument = argument;
-            write_option_argument(arg_info);
+            write_option_argument(arg_info, result.pending_writes());
             type = cl_arg_type::no_arg;
           } else if (opt->is_argument_required()) {
             type = cl_arg_type::arg_required;
@@ -1251,3 +5251,4 @@ namespace optionpp {
 
 
 #endif
+#undef OPTIONPP_MAIN
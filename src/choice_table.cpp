@@ -0,0 +1,190 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+/**
+ * @file
+ * @brief Source file for `choice_table` class implementation.
+ */
+
+#include <optionpp/choice_table.hpp>
+
+#include <algorithm>
+
+namespace optionpp {
+
+  constexpr choice_table::size_type choice_table::npos;
+
+  choice_table::choice_table(const std::vector<std::string>& names)
+    : m_names{names} {
+    m_values.reserve(m_names.size());
+    for (size_type i = 0; i != m_names.size(); ++i)
+      m_values.push_back(static_cast<value_type>(i));
+    build();
+  }
+
+  choice_table::choice_table(const std::vector<std::pair<std::string,
+                                                         value_type>>& choices) {
+    m_names.reserve(choices.size());
+    m_values.reserve(choices.size());
+    for (const auto& c : choices) {
+      m_names.push_back(c.first);
+      m_values.push_back(c.second);
+    }
+    build();
+  }
+
+  auto choice_table::find(const std::string& name) const noexcept -> size_type {
+    if (m_slots.empty())
+      return npos;
+
+    auto bucket = hash(name, 0) & (m_bucket_seeds.size() - 1);
+    auto slot = hash(name, m_bucket_seeds[bucket]) & (m_slots.size() - 1);
+    auto index = m_slots[slot];
+    if (index != 0 && m_names[index - 1] == name)
+      return index - 1;
+    else
+      return npos;
+  }
+
+  std::string choice_table::to_string(const std::string& separator) const {
+    std::string result;
+    for (const auto& name : m_names) {
+      if (!result.empty())
+        result += separator;
+      result += name;
+    }
+    return result;
+  }
+
+  void choice_table::build() {
+    // Remove duplicates, keeping the first occurrence of each name
+    std::vector<size_type> order(m_names.size());
+    for (size_type i = 0; i != order.size(); ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_type a, size_type b) {
+                       return m_names[a] < m_names[b];
+                     });
+    std::vector<bool> keep(m_names.size(), true);
+    for (size_type i = 1; i < order.size(); ++i) {
+      if (m_names[order[i]] == m_names[order[i - 1]])
+        keep[order[i]] = false;
+    }
+    size_type count = 0;
+    for (size_type i = 0; i != m_names.size(); ++i) {
+      if (keep[i]) {
+        if (count != i) {
+          m_names[count] = std::move(m_names[i]);
+          m_values[count] = m_values[i];
+        }
+        ++count;
+      }
+    }
+    m_names.resize(count);
+    m_values.resize(count);
+
+    m_bucket_seeds.clear();
+    m_slots.clear();
+    if (m_names.empty())
+      return;
+
+    // Use a load factor of at most 1/2, growing if no mapping is found
+    size_type slot_count = 1;
+    while (slot_count < 2 * m_names.size())
+      slot_count *= 2;
+    while (!try_build(slot_count))
+      slot_count *= 2;
+  }
+
+  bool choice_table::try_build(size_type slot_count) {
+    // Split choices into buckets of about four each
+    size_type bucket_count = 1;
+    while (bucket_count * 4 < m_names.size())
+      bucket_count *= 2;
+
+    std::vector<std::vector<size_type>> buckets(bucket_count);
+    for (size_type i = 0; i != m_names.size(); ++i)
+      buckets[hash(m_names[i], 0) & (bucket_count - 1)].push_back(i);
+
+    // Place the largest buckets first while there is the most room
+    std::vector<size_type> order(bucket_count);
+    for (size_type i = 0; i != bucket_count; ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_type a, size_type b) {
+                       return buckets[a].size() > buckets[b].size();
+                     });
+
+    const std::uint32_t max_seed = 1 << 16;
+    std::vector<std::uint32_t> slots(slot_count, 0);
+    std::vector<std::uint32_t> seeds(bucket_count, 0);
+    std::vector<size_type> placed;
+    for (auto b : order) {
+      if (buckets[b].empty())
+        break;
+
+      bool found = false;
+      for (std::uint32_t seed = 1; seed != max_seed && !found; ++seed) {
+        placed.clear();
+        found = true;
+        for (auto index : buckets[b]) {
+          auto slot = hash(m_names[index], seed) & (slot_count - 1);
+          if (slots[slot] != 0
+              || std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+            found = false;
+            break;
+          }
+          placed.push_back(slot);
+        }
+
+        if (found) {
+          seeds[b] = seed;
+          for (size_type i = 0; i != placed.size(); ++i)
+            slots[placed[i]] = static_cast<std::uint32_t>(buckets[b][i] + 1);
+        }
+      }
+
+      if (!found)
+        return false;
+    }
+
+    m_bucket_seeds = std::move(seeds);
+    m_slots = std::move(slots);
+    return true;
+  }
+
+  std::uint32_t choice_table::hash(const std::string& str,
+                                   std::uint32_t seed) noexcept {
+    // FNV-1a, with the seed mixed into the offset basis
+    std::uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char c : str) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 16777619u;
+    }
+
+    // Finalize so that the low bits depend on every input byte
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+  }
+
+} // End namespace
@@ -0,0 +1,213 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+
+/**
+ * @file
+ * @brief Source file for `mapped_file` class implementation.
+ */
+
+#include <optionpp/mapped_file.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <optionpp/error.hpp>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <functional>
+#include <iterator>
+#endif
+
+namespace optionpp {
+
+  /**
+   * @brief Throw an exception for a file that could not be read.
+   * @param path Path of the file.
+   * @param reason Description of the problem.
+   * @throw file_error Always.
+   */
+  [[noreturn]] void throw_file_error(const std::string& path,
+                                     const std::string& reason) {
+    throw file_error{"cannot read file '" + path + "': " + reason,
+        "optionpp::mapped_file::mapped_file", path};
+  }
+
+#if defined(_WIN32)
+
+  mapped_file::mapped_file(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      throw_file_error(path, "unable to open file");
+
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(file, &info)) {
+      CloseHandle(file);
+      throw_file_error(path, "unable to get file information");
+    }
+    m_id.device = info.dwVolumeSerialNumber;
+    m_id.index = (std::uint64_t{info.nFileIndexHigh} << 32) | info.nFileIndexLow;
+    std::uint64_t size = (std::uint64_t{info.nFileSizeHigh} << 32)
+      | info.nFileSizeLow;
+
+    if (size > 0) {
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                          0, 0, nullptr);
+      void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+        : nullptr;
+      if (mapping)
+        CloseHandle(mapping);
+      if (!view) {
+        CloseHandle(file);
+        throw_file_error(path, "unable to map file");
+      }
+      m_data = static_cast<const char*>(view);
+      m_size = static_cast<std::size_t>(size);
+      m_mapped = true;
+    }
+
+    CloseHandle(file);
+  }
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+  mapped_file::mapped_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw_file_error(path, std::strerror(errno));
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      int err = errno;
+      ::close(fd);
+      throw_file_error(path, std::strerror(err));
+    }
+    m_id.device = static_cast<std::uint64_t>(info.st_dev);
+    m_id.index = static_cast<std::uint64_t>(info.st_ino);
+
+    if (S_ISREG(info.st_mode)) {
+      if (info.st_size > 0) {
+        auto size = static_cast<std::size_t>(info.st_size);
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+          int err = errno;
+          ::close(fd);
+          throw_file_error(path, std::strerror(err));
+        }
+        m_data = static_cast<const char*>(addr);
+        m_size = size;
+        m_mapped = true;
+      }
+    } else {
+      // Pipes and devices cannot be mapped, so read them instead
+      std::string contents;
+      char buffer[4096];
+      ssize_t count;
+      while ((count = ::read(fd, buffer, sizeof(buffer))) != 0) {
+        if (count < 0) {
+          if (errno == EINTR)
+            continue;
+          int err = errno;
+          ::close(fd);
+          throw_file_error(path, std::strerror(err));
+        }
+        contents.append(buffer, static_cast<std::size_t>(count));
+      }
+
+      if (!contents.empty()) {
+        std::unique_ptr<char[]> data{new char[contents.size()]};
+        std::memcpy(data.get(), contents.data(), contents.size());
+        m_data = data.release();
+        m_size = contents.size();
+        m_allocated = true;
+      }
+    }
+
+    ::close(fd);
+  }
+
+#else
+
+  mapped_file::mapped_file(const std::string& path) {
+    std::ifstream in{path, std::ios::in | std::ios::binary};
+    if (!in)
+      throw_file_error(path, "unable to open file");
+
+    std::string contents{std::istreambuf_iterator<char>{in},
+                         std::istreambuf_iterator<char>{}};
+    if (in.bad())
+      throw_file_error(path, "unable to read file");
+
+    // Without file system support, the best we can do is compare paths
+    m_id.index = std::hash<std::string>{}(path);
+
+    if (!contents.empty()) {
+      std::unique_ptr<char[]> data{new char[contents.size()]};
+      std::memcpy(data.get(), contents.data(), contents.size());
+      m_data = data.release();
+      m_size = contents.size();
+      m_allocated = true;
+    }
+  }
+
+#endif
+
+  void mapped_file::swap(mapped_file& other) noexcept {
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_id, other.m_id);
+    std::swap(m_mapped, other.m_mapped);
+    std::swap(m_allocated, other.m_allocated);
+  }
+
+  void mapped_file::close() noexcept {
+    if (m_mapped) {
+#if defined(_WIN32)
+      UnmapViewOfFile(m_data);
+#elif defined(__unix__) || defined(__APPLE__)
+      ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    } else if (m_allocated) {
+      delete[] m_data;
+    }
+
+    m_data = "";
+    m_size = 0;
+    m_id = file_id{};
+    m_mapped = false;
+    m_allocated = false;
+  }
+
+} // End namespace
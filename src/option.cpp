@@ -24,6 +24,7 @@
 
 #include <optionpp/option.hpp>
 
+#include <utility>
 #include <optionpp/error.hpp>
 
 namespace optionpp {
@@ -51,7 +52,7 @@ namespace optionpp {
 
   option& option::bind_string(std::string* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "STRING";
+      m_arg_name = std::string{"STRING"};
       m_arg_required = true;
     }
     m_arg_type = string_arg;
@@ -61,7 +62,7 @@ namespace optionpp {
 
   option& option::bind_int(int* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "INTEGER";
+      m_arg_name = std::string{"INTEGER"};
       m_arg_required = true;
     }
     m_arg_type = int_arg;
@@ -71,7 +72,7 @@ namespace optionpp {
 
   option& option::bind_uint(unsigned int* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "INTEGER";
+      m_arg_name = std::string{"INTEGER"};
       m_arg_required = true;
     }
     m_arg_type = uint_arg;
@@ -81,7 +82,7 @@ namespace optionpp {
 
   option& option::bind_double(double* var) noexcept {
     if (var && m_arg_name.empty()) {
-      m_arg_name = "NUMBER";
+      m_arg_name = std::string{"NUMBER"};
       m_arg_required = true;
     }
     m_arg_type = double_arg;
@@ -89,6 +90,37 @@ namespace optionpp {
     return *this;
   }
 
+  option& option::bind_size(std::uint64_t* var) noexcept {
+    if (var && m_arg_name.empty()) {
+      m_arg_name = std::string{"SIZE"};
+      m_arg_required = true;
+    }
+    m_arg_type = size_arg;
+    m_bound_variable = var;
+    return *this;
+  }
+
+  option& option::bind_custom(arg_callback converter) noexcept {
+    if (converter && m_arg_name.empty()) {
+      m_arg_name = std::string{"VALUE"};
+      m_arg_required = true;
+    }
+    m_arg_type = custom_arg;
+    m_bound_variable = nullptr;
+    m_converter = std::move(converter);
+    m_stager = nullptr;
+    return *this;
+  }
+
+  option& option::choices(const std::vector<std::string>& values) {
+    if (m_arg_name.empty()) {
+      m_arg_name = std::string{"CHOICE"};
+      m_arg_required = true;
+    }
+    m_choices = choice_table{values};
+    return *this;
+  }
+
   void option::write_bool(bool value) const noexcept {
     if (m_is_option_set)
       *m_is_option_set = value;
@@ -101,6 +133,13 @@ namespace optionpp {
     *static_cast<std::string*>(m_bound_variable) = value;
   }
 
+  void option::write_string(const char* value, std::size_t size) const {
+    if (m_arg_type != string_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept a string argument",
+          "optionpp::option::write_string"};
+    static_cast<std::string*>(m_bound_variable)->assign(value, size);
+  }
+
   void option::write_int(int value) const {
     if (m_arg_type != int_arg || !m_bound_variable)
       throw type_error{"option '" + name() + "' does not accept an int argument",
@@ -122,4 +161,45 @@ namespace optionpp {
     *static_cast<double*>(m_bound_variable) = value;
   }
 
+  void option::write_duration(std::chrono::nanoseconds value) const {
+    if (m_arg_type != duration_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept a duration argument",
+          "optionpp::option::write_duration"};
+    m_value_writer(m_bound_variable, value.count());
+  }
+
+  void option::write_size(std::uint64_t value) const {
+    if (m_arg_type != size_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept a size argument",
+          "optionpp::option::write_size"};
+    *static_cast<std::uint64_t*>(m_bound_variable) = value;
+  }
+
+  bool option::write_custom(const std::string& value) const {
+    if (m_arg_type != custom_arg || !m_converter)
+      throw type_error{"option '" + name() + "' does not accept a custom argument",
+          "optionpp::option::write_custom"};
+    return m_converter(value);
+  }
+
+  bool option::stage_custom(const std::string& value,
+                            arg_callback& commit) const {
+    if (m_arg_type != custom_arg || !m_converter)
+      throw type_error{"option '" + name() + "' does not accept a custom argument",
+          "optionpp::option::stage_custom"};
+    if (!m_stager)
+      return true; // The converter stores its result itself
+    return m_stager(m_converter, value, commit);
+  }
+
+  void option::write_enum(choice_table::size_type index) const {
+    if (m_arg_type != enum_arg || !m_bound_variable)
+      throw type_error{"option '" + name() + "' does not accept an enumeration argument",
+          "optionpp::option::write_enum"};
+    if (index >= m_choices.size())
+      throw out_of_range{"invalid choice index for option '" + name() + "'",
+          "optionpp::option::write_enum"};
+    m_value_writer(m_bound_variable, m_choices.value(index));
+  }
+
 } // End namespace
@@ -38,7 +38,7 @@ namespace optionpp {
     return m_options.back();
   }
 
-  option& option_group::operator[](const std::string long_name) {
+  option& option_group::operator[](const std::string& long_name) {
     auto it = find(long_name);
     if (it == end())
       return add_option().long_name(long_name);
@@ -46,6 +46,14 @@ namespace optionpp {
       return *it;
   }
 
+  option& option_group::operator[](utility::static_string long_name) {
+    auto it = find(utility::token_view{long_name});
+    if (it == end())
+      return add_option().long_name(long_name);
+    else
+      return *it;
+  }
+
   option& option_group::operator[](char short_name) {
     auto it = find(short_name);
     if (it == end())
@@ -54,14 +62,14 @@ namespace optionpp {
       return *it;
   }
 
-  auto option_group::find(const std::string& long_name) -> iterator {
+  auto option_group::find(utility::token_view long_name) -> iterator {
     return std::find_if(m_options.begin(), m_options.end(),
-                        [&](const option& o) { return o.long_name() == long_name; });
+                        [&](const option& o) { return o.long_name_view() == long_name; });
   }
 
-  auto option_group::find(const std::string& long_name) const -> const_iterator {
+  auto option_group::find(utility::token_view long_name) const -> const_iterator {
     return std::find_if(m_options.begin(), m_options.end(),
-                        [&](const option& o) { return o.long_name() == long_name; });
+                        [&](const option& o) { return o.long_name_view() == long_name; });
   }
 
   auto option_group::find(char short_name) -> iterator {
@@ -25,21 +25,91 @@
 #include <optionpp/parser.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <iterator>
 #include <limits>
+#include <sstream>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
 
 namespace optionpp {
 
-  option& parser::add_option(const option& opt) {
-    auto it = find_group("");
-    if (it == m_groups.end()) {
-      m_groups.emplace_back("");
-      return m_groups.back().add_option(opt);
-    } else {
-      return it->add_option(opt);
+  /**
+   * @brief Format a number for use in messages.
+   * @param value Number to format.
+   * @return String representation without trailing zeros.
+   */
+  std::string format_number(double value) {
+    std::ostringstream oss;
+    oss.precision(15);
+    oss << value;
+    return oss.str();
+  }
+
+  /**
+   * @brief Format a bound on an option's argument for use in messages.
+   *
+   * Bounds on duration arguments are in seconds, which is shown with
+   * an `s` suffix.
+   *
+   * @param opt The option.
+   * @param value The minimum, maximum or step of the argument.
+   * @return String representation of the bound.
+   */
+  std::string format_bound(const option& opt, double value) {
+    std::string str = format_number(value);
+    if (opt.argument_type() == option::duration_arg)
+      str += 's';
+    return str;
+  }
+
+  /**
+   * @brief Describe the constraints on an option's argument.
+   *
+   * This lists the choices, range and step of the argument, as shown
+   * in the help text.
+   *
+   * @param opt The option.
+   * @return Description of the constraints, or an empty string if
+   *         there are none.
+   */
+  std::string describe_constraints(const option& opt) {
+    std::string notes;
+    if (!opt.choices().empty())
+      notes = "choices: " + opt.choices().to_string();
+    bool has_min = std::isfinite(opt.min_value());
+    bool has_max = std::isfinite(opt.max_value());
+    if (has_min || has_max) {
+      if (!notes.empty())
+        notes += "; ";
+      if (has_min && has_max)
+        notes += "range: " + format_bound(opt, opt.min_value())
+          + " to " + format_bound(opt, opt.max_value());
+      else if (has_min)
+        notes += "minimum: " + format_bound(opt, opt.min_value());
+      else
+        notes += "maximum: " + format_bound(opt, opt.max_value());
+    }
+    if (opt.step() > 0) {
+      if (!notes.empty())
+        notes += "; ";
+      notes += "step: " + format_bound(opt, opt.step());
     }
+    return notes;
+  }
+
+  option& parser::add_option(const option& opt) {
+    return group("").add_option(opt);
+  }
+
+  option& parser::add_option(option&& opt) {
+    return group("").add_option(std::move(opt));
   }
 
   option& parser::add_option(const std::string& long_name,
@@ -48,11 +118,16 @@ namespace optionpp {
                              const std::string& arg_name,
                              bool arg_required,
                              const std::string& group_name) {
+    m_help_cache.clear();
+    m_names.clear();
     return group(group_name).add_option(long_name, short_name)
       .description(description).argument(arg_name, arg_required);
   }
 
   option_group& parser::group(const std::string& name) {
+    m_help_cache.clear();
+    m_names.clear();
+
     // We'll use reverse iterators since the user is more likely to
     // access a recently-added group
     auto it = std::find_if(m_groups.rbegin(), m_groups.rend(),
@@ -72,8 +147,10 @@ namespace optionpp {
                                   const std::string& long_prefix,
                                   const std::string& end_indicator,
                                   const std::string& equals) {
+    m_help_cache.clear();
+    m_names.clear();
     if (!delims.empty())
-      m_delims = delims;
+      m_delims = utility::char_class{delims};
     if (!short_prefix.empty())
       m_short_option_prefix = short_prefix;
     if (!long_prefix.empty())
@@ -85,6 +162,8 @@ namespace optionpp {
   }
 
   void parser::sort_groups() {
+    m_help_cache.clear();
+    m_names.clear();
     std::sort(m_groups.begin(), m_groups.end(),
               [](const option_group& a, const option_group& b) {
                 return a.name() < b.name();
@@ -92,11 +171,15 @@ namespace optionpp {
   }
 
   void parser::sort_options() {
+    m_help_cache.clear();
+    m_names.clear();
     std::for_each(m_groups.begin(), m_groups.end(),
                   [](option_group& g) { g.sort(); });
   }
 
   option& parser::operator[](const std::string& long_name) {
+    m_help_cache.clear();
+    m_names.clear();
     option* opt = find_option(long_name);
     if (opt)
       return *opt;
@@ -104,7 +187,19 @@ namespace optionpp {
       return add_option().long_name(long_name);
   }
 
+  option& parser::operator[](utility::static_string long_name) {
+    m_help_cache.clear();
+    m_names.clear();
+    option* opt = find_option(utility::token_view{long_name});
+    if (opt)
+      return *opt;
+    else
+      return add_option().long_name(long_name);
+  }
+
   option& parser::operator[](char short_name) {
+    m_help_cache.clear();
+    m_names.clear();
     option* opt = find_option(short_name);
     if (opt)
       return *opt;
@@ -118,6 +213,26 @@ namespace optionpp {
                                    int option_indent,
                                    int desc_first_line_indent,
                                    int desc_multiline_indent) const {
+    help_cache::key_type key{{max_line_length, group_indent, option_indent,
+                              desc_first_line_indent, desc_multiline_indent}};
+    auto text = m_help_cache.find(key);
+    if (!text) {
+      std::ostringstream oss;
+      render_help(oss, max_line_length, group_indent, option_indent,
+                  desc_first_line_indent, desc_multiline_indent);
+      text = std::make_shared<const std::string>(oss.str());
+      m_help_cache.insert(key, text);
+    }
+
+    return os.write(text->data(), static_cast<std::streamsize>(text->size()));
+  }
+
+  void parser::render_help(std::ostream& os,
+                           int max_line_length,
+                           int group_indent,
+                           int option_indent,
+                           int desc_first_line_indent,
+                           int desc_multiline_indent) const {
     bool first = true;
 
     for (const auto& group : m_groups) {
@@ -132,8 +247,8 @@ namespace optionpp {
 
       // Print group name
       if (!group.name().empty()) {
-        os << utility::wrap_text(group.name(), max_line_length, group_indent)
-           << "\n";
+        utility::write_wrapped(os, group.name(), max_line_length, group_indent)
+          << "\n";
       }
 
       // Print options
@@ -152,49 +267,970 @@ namespace optionpp {
           usage += m_short_option_prefix;
           usage += opt.short_name();
 
-          if (!opt.long_name().empty())
+          if (!opt.long_name_view().empty())
             usage += ", ";
         } else {
           usage += std::string(m_short_option_prefix.size() + 3, ' ');
         }
 
         // Long name
-        if (!opt.long_name().empty()) {
+        utility::token_view long_name = opt.long_name_view();
+        if (!long_name.empty()) {
           usage += m_long_option_prefix;
-          usage += opt.long_name();
+          usage.append(long_name.data(), long_name.size());
         }
 
         // Argument
-        if (!opt.argument_name().empty()) {
-          if (opt.is_argument_required())
-            usage += m_equals + opt.argument_name();
-          else
-            usage += "[" + m_equals + opt.argument_name() + "]";
+        utility::token_view arg_name = opt.argument_name_view();
+        if (!arg_name.empty()) {
+          if (!opt.is_argument_required())
+            usage += "[";
+          usage += m_equals;
+          usage.append(arg_name.data(), arg_name.size());
+          if (!opt.is_argument_required())
+            usage += "]";
         }
 
-        // Description
-        int spacing = desc_first_line_indent - usage.size();
+        // Description; only copied when constraint notes are added
+        utility::token_view desc = opt.description_view();
+        std::string described;
+        std::string notes = describe_constraints(opt);
+        if (!notes.empty()) {
+          described = desc;
+          if (!described.empty())
+            described.push_back(' ');
+          described += "(" + notes + ")";
+          desc = described;
+        }
+
+        int spacing = desc_first_line_indent
+          - static_cast<int>(utility::display_width(usage));
         if (spacing <= 1) {
-          os << utility::wrap_text(usage, max_line_length);
-          if (!opt.description().empty()) {
-            os << "\n" << utility::wrap_text(opt.description(),
-                                             max_line_length,
-                                             desc_multiline_indent,
-                                             desc_first_line_indent);
+          utility::write_wrapped(os, usage, max_line_length);
+          if (!desc.empty()) {
+            os << "\n";
+            utility::write_wrapped(os, desc, max_line_length,
+                                   desc_multiline_indent,
+                                   desc_first_line_indent);
           }
         } else {
-          if (!opt.description().empty()) {
+          if (!desc.empty()) {
             usage += std::string(spacing, ' ');
-            usage += opt.description();
+            usage.append(desc.data(), desc.size());
           }
-          os << utility::wrap_text(usage, max_line_length,
-                                   desc_multiline_indent, 0);
+          utility::write_wrapped(os, usage, max_line_length,
+                                 desc_multiline_indent, 0);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Write text with `roff` escapes.
+   *
+   * Backslashes are written as `\e`, and hyphens as `\-` so that
+   * option names can be copied from the formatted page. A `\&` is
+   * added before a period or apostrophe at the start of a line, which
+   * would otherwise begin a request.
+   *
+   * @param os Output stream.
+   * @param text Text to write, which should not contain newlines.
+   */
+  void write_roff(std::ostream& os, utility::token_view text) {
+    const char* run = text.begin();
+    if (run != text.end() && (*run == '.' || *run == '\''))
+      os << "\\&";
+    for (const char* pos = run; pos != text.end(); ++pos) {
+      if (*pos != '\\' && *pos != '-')
+        continue;
+      os.write(run, pos - run);
+      os << (*pos == '\\' ? "\\e" : "\\-");
+      run = pos + 1;
+    }
+    os.write(run, text.end() - run);
+  }
+
+  /**
+   * @brief Write a quoted argument to a `roff` request or macro.
+   *
+   * The text is escaped by `write_roff`, and double quotes are
+   * written as `\(dq`.
+   *
+   * @param os Output stream.
+   * @param text Argument to write, which should not contain newlines.
+   */
+  void write_roff_argument(std::ostream& os, const std::string& text) {
+    os << '"';
+    const char* run = text.data();
+    const char* end = run + text.size();
+    for (const char* pos = run; pos != end; ++pos) {
+      if (*pos != '"')
+        continue;
+      write_roff(os, utility::token_view{run,
+            static_cast<std::size_t>(pos - run)});
+      os << "\\(dq";
+      run = pos + 1;
+    }
+    write_roff(os, utility::token_view{run,
+          static_cast<std::size_t>(end - run)});
+    os << '"';
+  }
+
+  /**
+   * @brief Write lines of text with `roff` escapes.
+   *
+   * Each line is escaped by `write_roff`. A blank line is replaced by
+   * a paragraph macro.
+   *
+   * @param os Output stream.
+   * @param text Text to write.
+   * @param paragraph Macro used to start a new paragraph.
+   */
+  void write_roff_lines(std::ostream& os, const std::string& text,
+                        const char* paragraph) {
+    const char* line = text.data();
+    const char* end = line + text.size();
+    while (line != end) {
+      const char* line_end = std::find(line, end, '\n');
+      utility::token_view view{line,
+          static_cast<std::size_t>(line_end - line)};
+      if (std::all_of(view.begin(), view.end(),
+                      [](char c) { return c == ' ' || c == '\t'; }))
+        os << paragraph << '\n';
+      else {
+        write_roff(os, view);
+        os << '\n';
+      }
+      line = line_end == end ? end : line_end + 1;
+    }
+  }
+
+  /**
+   * @brief Write text with Markdown formatting characters escaped.
+   *
+   * Characters that start emphasis, code, links, HTML and tables are
+   * escaped with a backslash, as are characters at the start of a
+   * later line that would make it a heading, list item or rule. Line
+   * breaks are kept, and later lines are indented to stay in the
+   * enclosing list item.
+   *
+   * @param os Output stream.
+   * @param text Text to write.
+   * @param indent Indentation of continuation lines.
+   */
+  void write_markdown_text(std::ostream& os, const std::string& text,
+                           const char* indent) {
+    static const utility::char_class specials{"\\`*_[]<>|\n"};
+    static const utility::char_class line_starts{"#+-="};
+
+    const char* run = text.data();
+    const char* end = run + text.size();
+    bool line_start = false; // The first line follows a list marker
+    for (const char* pos = run; pos != end; ++pos) {
+      if (line_start) {
+        line_start = false;
+
+        // Numbers followed by a period or parenthesis start a list
+        const char* digits = pos;
+        while (digits != end && *digits >= '0' && *digits <= '9')
+          ++digits;
+        if (digits != pos && digits != end
+            && (*digits == '.' || *digits == ')')) {
+          os.write(run, digits - run);
+          os << '\\';
+          run = pos = digits;
+          continue;
+        }
+        if (line_starts.contains(*pos)) {
+          os.write(run, pos - run);
+          os << '\\';
+          run = pos;
+          continue;
         }
       }
+
+      if (!specials.contains(*pos))
+        continue;
+      os.write(run, pos - run);
+      if (*pos == '\n') {
+        // Hard line break, or a new paragraph for a blank line
+        if (pos + 1 != end && pos[1] == '\n') {
+          os << "\n\n" << indent;
+          ++pos;
+        } else {
+          os << "\\\n" << indent;
+        }
+        line_start = true;
+      } else {
+        os << '\\' << *pos;
+      }
+      run = pos + 1;
+    }
+    os.write(run, end - run);
+  }
+
+  /**
+   * @brief Write text as a Markdown code span.
+   *
+   * Code spans cannot contain escapes, so the span is delimited by
+   * more backticks than the longest run of backticks in the text.
+   *
+   * @param os Output stream.
+   * @param text Text to write.
+   */
+  void write_code_span(std::ostream& os, const std::string& text) {
+    std::size_t longest = 0;
+    std::size_t current = 0;
+    for (char c : text) {
+      current = c == '`' ? current + 1 : 0;
+      longest = std::max(longest, current);
+    }
+
+    std::string fence(longest + 1, '`');
+    bool pad = longest > 0;
+    os << fence << (pad ? " " : "") << text << (pad ? " " : "") << fence;
+  }
+
+  /**
+   * @brief Write a JSON string literal.
+   * @param os Output stream.
+   * @param text Contents of the string.
+   */
+  void write_json_string(std::ostream& os, utility::token_view text) {
+    static const char hex_digits[] = "0123456789abcdef";
+
+    os << '"';
+    const char* run = text.begin();
+    for (const char* pos = run; pos != text.end(); ++pos) {
+      auto c = static_cast<unsigned char>(*pos);
+      if (c >= 0x20 && c != '"' && c != '\\')
+        continue;
+      os.write(run, pos - run);
+      switch (c) {
+      case '"': os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\r': os << "\\r"; break;
+      case '\t': os << "\\t"; break;
+      default:
+        os << "\\u00" << hex_digits[c >> 4] << hex_digits[c & 15];
+        break;
+      }
+      run = pos + 1;
+    }
+    os.write(run, text.end() - run);
+    os << '"';
+  }
+
+  /**
+   * @brief Return the name of an argument type.
+   * @param type The argument type.
+   * @return Name used for the type in `parser::print_json`.
+   */
+  const char* argument_type_name(option::arg_type type) noexcept {
+    switch (type) {
+    case option::int_arg: return "int";
+    case option::uint_arg: return "uint";
+    case option::double_arg: return "double";
+    case option::custom_arg: return "custom";
+    case option::enum_arg: return "enum";
+    case option::duration_arg: return "duration";
+    case option::size_arg: return "size";
+    default: return "string";
+    }
+  }
+
+  /**
+   * @brief Return an option's description as shown in help text.
+   *
+   * Constraints on the argument are added in parentheses.
+   *
+   * @param opt The option.
+   * @return The description.
+   */
+  std::string help_description(const option& opt) {
+    std::string notes = describe_constraints(opt);
+    if (notes.empty())
+      return opt.description_view();
+
+    std::string desc = opt.description_view();
+    if (!desc.empty())
+      desc.push_back(' ');
+    return desc + "(" + notes + ")";
+  }
+
+  std::ostream& parser::print_man_page(std::ostream& os,
+                                       const man_page_info& info) const {
+    // Title line
+    os << ".TH ";
+    write_roff_argument(os, info.name);
+    os << ' ' << info.section;
+    for (const std::string* field : {&info.date, &info.source, &info.manual}) {
+      os << ' ';
+      write_roff_argument(os, *field);
+    }
+    os << "\n";
+
+    os << ".SH NAME\n";
+    write_roff(os, info.name);
+    if (!info.summary.empty()) {
+      os << " \\- ";
+      write_roff(os, info.summary);
+    }
+    os << "\n";
+
+    os << ".SH SYNOPSIS\n.B ";
+    write_roff_argument(os, info.name);
+    os << "\n";
+    if (info.synopsis.empty())
+      os << "[\\fIOPTION\\fR]...\n";
+    else
+      write_roff_lines(os, info.synopsis, ".br");
+
+    if (!info.description.empty()) {
+      os << ".SH DESCRIPTION\n";
+      write_roff_lines(os, info.description, ".PP");
     }
+
+    bool first = true;
+    for (const auto& group : m_groups) {
+      if (group.empty())
+        continue;
+
+      if (first) {
+        os << ".SH OPTIONS\n";
+        first = false;
+      }
+      if (!group.name().empty()) {
+        os << ".SS ";
+        write_roff_argument(os, group.name());
+        os << "\n";
+      }
+
+      for (const auto& opt : group) {
+        char short_name = opt.short_name();
+        os << ".TP\n";
+        if (short_name != '\0') {
+          os << "\\fB";
+          write_roff(os, m_short_option_prefix);
+          write_roff(os, utility::token_view{&short_name, 1});
+          os << "\\fR";
+          if (!opt.long_name_view().empty())
+            os << ", ";
+        }
+        if (!opt.long_name_view().empty()) {
+          os << "\\fB";
+          write_roff(os, m_long_option_prefix);
+          write_roff(os, opt.long_name_view());
+          os << "\\fR";
+        }
+        if (!opt.argument_name_view().empty()) {
+          bool optional = !opt.is_argument_required();
+          os << (optional ? "[" : "");
+          write_roff(os, m_equals);
+          os << "\\fI";
+          write_roff(os, opt.argument_name_view());
+          os << "\\fR" << (optional ? "]" : "");
+        }
+        os << "\n";
+
+        write_roff_lines(os, help_description(opt), ".IP");
+      }
+    }
+
+    return os;
+  }
+
+  std::ostream& parser::print_markdown(std::ostream& os,
+                                       int heading_level) const {
+    heading_level = std::min(std::max(heading_level, 1), 6);
+    auto argument_suffix = [this](const option& opt) {
+      utility::token_view arg_name = opt.argument_name_view();
+      if (arg_name.empty())
+        return std::string{};
+      std::string suffix = m_equals;
+      suffix.append(arg_name.data(), arg_name.size());
+      if (opt.is_argument_required())
+        return suffix;
+      return "[" + suffix + "]";
+    };
+
+    bool first = true;
+    for (const auto& group : m_groups) {
+      if (group.empty())
+        continue;
+
+      if (first)
+        first = false;
+      else
+        os << "\n";
+
+      if (!group.name().empty()) {
+        os << std::string(heading_level, '#') << ' ';
+        write_markdown_text(os, group.name(), "");
+        os << "\n\n";
+      }
+
+      for (const auto& opt : group) {
+        os << "- ";
+        if (opt.short_name() != '\0') {
+          std::string name = m_short_option_prefix + opt.short_name();
+          if (opt.long_name_view().empty() && !opt.argument_name_view().empty())
+            name += argument_suffix(opt);
+          write_code_span(os, name);
+          if (!opt.long_name_view().empty())
+            os << ", ";
+        }
+        utility::token_view long_name = opt.long_name_view();
+        if (!long_name.empty()) {
+          std::string name = m_long_option_prefix;
+          name.append(long_name.data(), long_name.size());
+          write_code_span(os, name + argument_suffix(opt));
+        }
+
+        std::string desc = help_description(opt);
+        if (!desc.empty()) {
+          os << ": ";
+          write_markdown_text(os, desc, "  ");
+        }
+        os << "\n";
+      }
+    }
+
     return os;
   }
 
+  std::ostream& parser::print_json(std::ostream& os) const {
+    os << "{\n  \"short_prefix\": ";
+    write_json_string(os, m_short_option_prefix);
+    os << ",\n  \"long_prefix\": ";
+    write_json_string(os, m_long_option_prefix);
+    os << ",\n  \"end_of_options\": ";
+    write_json_string(os, m_end_of_options);
+    os << ",\n  \"equals\": ";
+    write_json_string(os, m_equals);
+    os << ",\n  \"groups\": [";
+
+    bool first_group = true;
+    for (const auto& group : m_groups) {
+      if (group.empty())
+        continue;
+
+      os << (first_group ? "\n" : ",\n") << "    {\n      \"name\": ";
+      first_group = false;
+      write_json_string(os, group.name());
+      os << ",\n      \"options\": [";
+
+      bool first_opt = true;
+      for (const auto& opt : group) {
+        os << (first_opt ? "\n" : ",\n") << "        {";
+        first_opt = false;
+
+        // Members are separated by commas after the first one
+        const char* separator = "";
+        if (!opt.long_name_view().empty()) {
+          os << "\"long_name\": ";
+          write_json_string(os, opt.long_name_view());
+          separator = ", ";
+        }
+        char short_name = opt.short_name();
+        if (short_name != '\0') {
+          os << separator << "\"short_name\": ";
+          write_json_string(os, utility::token_view{&short_name, 1});
+          separator = ", ";
+        }
+        if (!opt.description_view().empty()) {
+          os << separator << "\"description\": ";
+          write_json_string(os, opt.description_view());
+          separator = ", ";
+        }
+
+        if (!opt.argument_name_view().empty()) {
+          os << separator << "\"argument\": {\"name\": ";
+          write_json_string(os, opt.argument_name_view());
+          os << ", \"required\": "
+             << (opt.is_argument_required() ? "true" : "false")
+             << ", \"type\": \"" << argument_type_name(opt.argument_type())
+             << '"';
+
+          const auto& choices = opt.choices();
+          if (!choices.empty()) {
+            os << ", \"choices\": [";
+            for (choice_table::size_type i = 0; i != choices.size(); ++i) {
+              if (i != 0)
+                os << ", ";
+              write_json_string(os, choices.name(i));
+            }
+            os << ']';
+          }
+          if (std::isfinite(opt.min_value()))
+            os << ", \"minimum\": " << format_number(opt.min_value());
+          if (std::isfinite(opt.max_value()))
+            os << ", \"maximum\": " << format_number(opt.max_value());
+          if (opt.step() > 0)
+            os << ", \"step\": " << format_number(opt.step());
+          os << '}';
+        }
+        os << '}';
+      }
+
+      os << (first_opt ? "]\n" : "\n      ]\n") << "    }";
+    }
+
+    os << (first_group ? "]\n" : "\n  ]\n") << "}\n";
+    return os;
+  }
+
+  std::vector<std::string> parser::complete(const std::string& prefix,
+                                            const std::string& previous) const {
+    std::vector<std::string> result;
+    auto add_choices = [&result](const option& opt, const std::string& head,
+                                 const std::string& value) {
+      const auto& choices = opt.choices();
+      for (choice_table::size_type i = 0; i != choices.size(); ++i) {
+        if (utility::is_substr_at_pos(choices.name(i), value))
+          result.push_back(head + choices.name(i));
+      }
+    };
+
+    // Argument of the previous option
+    const option* opt = option_awaiting_argument(previous);
+    if (opt && (opt->is_argument_required() || is_non_option(prefix))) {
+      add_choices(*opt, "", prefix);
+      return result;
+    }
+
+    if (is_long_option(prefix)) {
+      auto start = m_long_option_prefix.size();
+      auto pos = prefix.find(m_equals, start);
+      if (pos == std::string::npos) {
+        for (const auto& name : m_names.complete(m_groups, prefix.substr(start)))
+          result.push_back(m_long_option_prefix + name);
+      } else if ((opt = find_option(prefix.substr(start, pos - start)))) {
+        pos += m_equals.size();
+        add_choices(*opt, prefix.substr(0, pos), prefix.substr(pos));
+      }
+    } else if (prefix == m_short_option_prefix
+               || (!prefix.empty()
+                   && utility::is_substr_at_pos(m_long_option_prefix, prefix))) {
+      if (prefix == m_short_option_prefix) {
+        for (char c : m_names.short_names(m_groups))
+          result.push_back(m_short_option_prefix + c);
+      }
+      for (const auto& name : m_names.complete(m_groups, ""))
+        result.push_back(m_long_option_prefix + name);
+    }
+
+    return result;
+  }
+
+  const option*
+  parser::option_awaiting_argument(const std::string& argument) const {
+    if (argument.find(m_equals) != std::string::npos)
+      return nullptr;
+
+    if (is_long_option(argument)) {
+      const option* opt
+        = find_option(argument.substr(m_long_option_prefix.size()));
+      if (opt && !opt->argument_name_view().empty())
+        return opt;
+    } else if (is_short_option_group(argument)) {
+      // Only the first option in a group that takes an argument can
+      // have one, and it is attached unless that option is last
+      for (auto pos = m_short_option_prefix.size();
+           pos != argument.size(); ++pos) {
+        const option* opt = find_option(argument[pos]);
+        if (!opt)
+          return nullptr;
+        if (!opt->argument_name_view().empty())
+          return pos + 1 == argument.size() ? opt : nullptr;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * @brief Make a shell function name from a program name.
+   * @param program Program name.
+   * @return `program` with each character other than a letter or
+   *         digit replaced by an underscore.
+   */
+  std::string shell_identifier(const std::string& program) {
+    std::string id = program;
+    for (char& c : id) {
+      if (!std::isalnum(static_cast<unsigned char>(c)))
+        c = '_';
+    }
+    return id;
+  }
+
+  /**
+   * @brief Quote a string for a shell script.
+   *
+   * The string is put in single quotes. For POSIX-like shells, a
+   * single quote inside it is written as `'\''`; for Fish, single
+   * quotes and backslashes are escaped with a backslash.
+   *
+   * @param text String to quote.
+   * @param fish Whether the script is for Fish.
+   * @return The quoted string.
+   */
+  std::string shell_quote(const std::string& text, bool fish) {
+    std::string quoted = "'";
+    for (char c : text) {
+      if (c == '\'')
+        quoted += fish ? "\\'" : "'\\''";
+      else if (c == '\\' && fish)
+        quoted += "\\\\";
+      else
+        quoted.push_back(c);
+    }
+    return quoted + "'";
+  }
+
+  std::ostream& parser::print_completion_script(std::ostream& os,
+                                                completion_shell shell,
+                                                const std::string& program) {
+    const std::string id = shell_identifier(program);
+
+    switch (shell) {
+    case completion_shell::bash:
+      os << "# Bash completion for " << program
+         << ", generated by Option++.\n"
+         << "_optionpp_" << id << "() {\n"
+         << R"(  local line="${COMP_LINE:0:COMP_POINT}"
+  local cur="${line##*[[:space:]]}"
+  local prev="${line%"$cur"}"
+  prev="${prev%"${prev##*[![:space:]]}"}"
+  prev="${prev##*[[:space:]]}"
+
+  # Bash splits words at = and :, so only the text after them is
+  # replaced
+  local head="${cur%"${cur##*[=:]}"}"
+  if [[ -z "$head" || "$COMP_WORDBREAKS" != *"${head: -1}"* ]]; then
+    head=""
+  fi
+
+  COMPREPLY=()
+  local word
+  while IFS= read -r word; do
+    COMPREPLY+=("${word#"$head"}")
+  done < <("$1" --__complete "$prev" "$cur" 2>/dev/null)
+}
+)"
+         << "complete -o default -F _optionpp_" << id << " "
+         << shell_quote(program, false) << "\n";
+      break;
+    case completion_shell::zsh:
+      os << "#compdef " << program << "\n"
+         << "# Zsh completion for " << program
+         << ", generated by Option++.\n"
+         << "_" << id << "() {\n"
+         << R"(  local -a candidates
+  candidates=("${(@f)$("${words[1]}" --__complete "${words[CURRENT-1]}" "${words[CURRENT]}" 2>/dev/null)}")
+  candidates=("${(@)candidates:#}")
+  if (( ${#candidates} )); then
+    compadd -- "${candidates[@]}"
+  else
+    _files
+  fi
+}
+
+)"
+         << "if [[ \"${funcstack[1]}\" == _" << id << " ]]; then\n"
+         << "  _" << id << " \"$@\"\n"
+         << "else\n"
+         << "  compdef _" << id << " " << shell_quote(program, false) << "\n"
+         << "fi\n";
+      break;
+    case completion_shell::fish:
+      os << "# Fish completion for " << program
+         << ", generated by Option++.\n"
+         << "function __optionpp_" << id << "\n"
+         << R"(    set -l tokens (commandline -opc)
+    $tokens[1] --__complete $tokens[-1] (commandline -ct) 2>/dev/null
+end
+)"
+         << "complete -c " << shell_quote(program, true)
+         << " -a '(__optionpp_" << id << ")'\n";
+      break;
+    }
+
+    return os;
+  }
+
+  bool parser::run_completion(int argc, char* argv[]) const {
+    return run_completion(argc, argv, std::cout);
+  }
+
+  bool parser::run_completion(int argc, char* argv[], std::ostream& os) const {
+    if (argc < 2 || std::string{argv[1]} != "--__complete")
+      return false;
+
+    std::string previous = argc > 2 ? argv[2] : "";
+    std::string prefix = argc > 3 ? argv[3] : "";
+    for (const auto& completion : complete(prefix, previous))
+      os << completion << '\n';
+    os.flush();
+    return true;
+  }
+
+  /**
+   * @brief Return the set of characters in a string.
+   *
+   * Each character sets the bit given by its value modulo 64, so
+   * distinct characters may share a bit.
+   *
+   * @param str String to examine.
+   * @return Bit mask of the characters in `str`.
+   */
+  std::uint64_t char_set(const std::string& str) noexcept {
+    std::uint64_t set = 0;
+    for (char c : str)
+      set |= std::uint64_t{1} << (static_cast<unsigned char>(c) & 63);
+    return set;
+  }
+
+  /**
+   * @brief Count the set bits in a mask.
+   * @param mask Bit mask.
+   * @return Number of bits set in `mask`.
+   */
+  std::size_t count_bits(std::uint64_t mask) noexcept {
+#if defined(__GNUC__)
+    return static_cast<std::size_t>(__builtin_popcountll(mask));
+#else
+    std::size_t count = 0;
+    for (; mask; mask &= mask - 1)
+      ++count;
+    return count;
+#endif
+  }
+
+  constexpr std::size_t parser::name_index::max_suggestions;
+
+  struct parser::name_index::tree {
+    /**
+     * @brief A name in the tree.
+     *
+     * The children of a node are kept in a linked list, each one at
+     * a different distance from its parent.
+     */
+    struct node {
+      std::string name; //< Option name.
+      std::size_t distance; //< Distance from the parent node.
+      std::size_t first_child; //< Index of the first child, or `npos`.
+      std::size_t next_sibling; //< Index of the next sibling, or `npos`.
+      std::size_t max_child_distance; //< Largest distance of a child.
+      std::uint64_t chars; //< Characters in the name (see `char_set`).
+    };
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief Add a name to the tree.
+     * @param name Name to add. Duplicates are ignored.
+     */
+    void insert(const std::string& name) {
+      if (nodes.empty()) {
+        nodes.push_back(node{name, 0, npos, npos, 0, char_set(name)});
+        return;
+      }
+
+      std::size_t current = 0;
+      for (;;) {
+        std::size_t distance = utility::edit_distance(name, nodes[current].name);
+        if (distance == 0)
+          return;
+
+        // Find the child at this distance, remembering the last one
+        std::size_t child = nodes[current].first_child;
+        std::size_t last = npos;
+        while (child != npos && nodes[child].distance != distance) {
+          last = child;
+          child = nodes[child].next_sibling;
+        }
+        if (child == npos) {
+          nodes.push_back(node{name, distance, npos, npos, 0, char_set(name)});
+          nodes[current].max_child_distance
+            = std::max(nodes[current].max_child_distance, distance);
+          if (last == npos)
+            nodes[current].first_child = nodes.size() - 1;
+          else
+            nodes[last].next_sibling = nodes.size() - 1;
+          return;
+        }
+        current = child;
+      }
+    }
+
+    std::vector<node> nodes; //< Nodes of the tree, root first.
+  };
+
+  constexpr std::size_t parser::name_index::tree::npos;
+
+  std::vector<std::string>
+  parser::name_index::suggest(const group_container& groups,
+                                    const std::string& name) const {
+    std::shared_ptr<const tree> names;
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      if (!m_tree) {
+        std::shared_ptr<tree> built = std::make_shared<tree>();
+        for (const auto& group : groups) {
+          for (const auto& opt : group) {
+            if (!opt.long_name_view().empty())
+              built->insert(opt.long_name_view());
+          }
+        }
+        m_tree = std::move(built);
+      }
+      names = m_tree;
+    }
+
+    std::size_t max_distance = name.size() <= 4 ? 1
+      : name.size() <= 8 ? 2 : 3;
+    if (max_distance >= name.size())
+      max_distance = name.size() - (name.empty() ? 0 : 1);
+
+    // Search the tree, skipping subtrees that the triangle inequality
+    // rules out
+    std::vector<std::pair<std::size_t, const std::string*>> matches;
+    const std::uint64_t chars = char_set(name);
+    if (!names->nodes.empty() && max_distance > 0) {
+      std::vector<std::size_t> pending{0};
+      while (!pending.empty()) {
+        const tree::node& current = names->nodes[pending.back()];
+        pending.pop_back();
+
+        // Beyond this bound, the node cannot match and no child can
+        // be close enough
+        std::size_t bound = current.max_child_distance + max_distance;
+
+        // Each edit adds or removes at most one character from each
+        // set, which gives a cheap lower bound on the distance
+        if (std::max(count_bits(chars & ~current.chars),
+                     count_bits(current.chars & ~chars)) > bound)
+          continue;
+
+        std::size_t distance = utility::edit_distance(name, current.name,
+                                                      bound);
+        if (distance <= max_distance)
+          matches.emplace_back(distance, &current.name);
+        if (distance > bound)
+          continue;
+
+        for (std::size_t child = current.first_child; child != tree::npos;
+             child = names->nodes[child].next_sibling) {
+          std::size_t edge = names->nodes[child].distance;
+          if (edge + max_distance >= distance
+              && edge <= distance + max_distance)
+            pending.push_back(child);
+        }
+      }
+    }
+
+    std::sort(matches.begin(), matches.end(),
+              [](const std::pair<std::size_t, const std::string*>& lhs,
+                 const std::pair<std::size_t, const std::string*>& rhs) {
+                return lhs.first < rhs.first
+                  || (lhs.first == rhs.first && *lhs.second < *rhs.second);
+              });
+
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i != matches.size() && i != max_suggestions; ++i)
+      result.push_back(*matches[i].second);
+    return result;
+  }
+
+  struct parser::name_index::sorted_names {
+    std::vector<std::string> long_names; //< Long option names, sorted.
+    std::string short_names; //< Short option names, sorted.
+  };
+
+  std::shared_ptr<const parser::name_index::sorted_names>
+  parser::name_index::get_sorted(const group_container& groups) const {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (!m_sorted) {
+      std::shared_ptr<sorted_names> built = std::make_shared<sorted_names>();
+      for (const auto& group : groups) {
+        for (const auto& opt : group) {
+          if (!opt.long_name_view().empty())
+            built->long_names.push_back(opt.long_name_view());
+          if (opt.short_name() != '\0')
+            built->short_names.push_back(opt.short_name());
+        }
+      }
+
+      auto& names = built->long_names;
+      std::sort(names.begin(), names.end());
+      names.erase(std::unique(names.begin(), names.end()), names.end());
+      auto& chars = built->short_names;
+      std::sort(chars.begin(), chars.end());
+      chars.erase(std::unique(chars.begin(), chars.end()), chars.end());
+      m_sorted = std::move(built);
+    }
+    return m_sorted;
+  }
+
+  std::vector<std::string>
+  parser::name_index::complete(const group_container& groups,
+                               const std::string& prefix) const {
+    auto names = get_sorted(groups);
+    const auto& list = names->long_names;
+
+    std::vector<std::string> result;
+    for (auto it = std::lower_bound(list.begin(), list.end(), prefix);
+         it != list.end() && it->compare(0, prefix.size(), prefix) == 0;
+         ++it)
+      result.push_back(*it);
+    return result;
+  }
+
+  std::string
+  parser::name_index::short_names(const group_container& groups) const {
+    return get_sorted(groups)->short_names;
+  }
+
+  void parser::name_index::clear() noexcept {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_tree.reset();
+    m_sorted.reset();
+  }
+
+  constexpr std::size_t parser::help_cache::max_entries;
+
+  std::shared_ptr<const std::string>
+  parser::help_cache::find(const key_type& key) const {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (const auto& entry : m_entries) {
+      if (entry.first == key)
+        return entry.second;
+    }
+    return nullptr;
+  }
+
+  void parser::help_cache::insert(const key_type& key,
+                                  std::shared_ptr<const std::string> text) {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    for (auto& entry : m_entries) {
+      if (entry.first == key) { // Rendered by another thread meanwhile
+        entry.second = std::move(text);
+        return;
+      }
+    }
+
+    if (m_entries.size() == max_entries)
+      m_entries.erase(m_entries.begin());
+    m_entries.emplace_back(key, std::move(text));
+  }
+
+  void parser::help_cache::clear() noexcept {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_entries.clear();
+  }
+
   auto parser::find_group(const std::string& name) -> group_iterator {
     return std::find_if(m_groups.begin(), m_groups.end(),
                         [&](const option_group& g) {
@@ -209,7 +1245,7 @@ namespace optionpp {
                         });
   }
 
-  option* parser::find_option(const std::string& long_name) {
+  option* parser::find_option(utility::token_view long_name) {
     for (auto& group : m_groups) {
       auto it = group.find(long_name);
       if (it != group.end())
@@ -219,7 +1255,7 @@ namespace optionpp {
     return nullptr;
   }
 
-  const option* parser::find_option(const std::string& long_name) const {
+  const option* parser::find_option(utility::token_view long_name) const {
     for (const auto& group : m_groups) {
       auto it = group.find(long_name);
       if (it != group.end())
@@ -253,26 +1289,301 @@ namespace optionpp {
     return parse(argv, argv + argc, ignore_first);
   }
 
+  class parser::token_sink {
+  public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+
+    // Parsing state shared by all copies of the iterator
+    struct state {
+      state(bool ignore_first, cl_arg_type prev_type,
+            std::vector<mapped_file::file_id>& open_files)
+        : type{prev_type}, skip_next{ignore_first}, includes{open_files} {}
+
+      std::string token; //< Buffer reused for every token.
+      cl_arg_type type; //< Type of the last token.
+      bool skip_next; //< True if the next token should be ignored.
+      std::vector<mapped_file::file_id>& includes; //< Response files being read.
+    };
+
+    token_sink(const parser& p, parser_result& result,
+               utility::token_arena* arena, state& st) noexcept
+      : m_parser{&p}, m_result{&result}, m_arena{arena}, m_state{&st} {}
+
+    token_sink& operator*() noexcept { return *this; }
+    token_sink& operator++() noexcept { return *this; }
+    token_sink& operator++(int) noexcept { return *this; }
+
+    token_sink& operator=(utility::token_view token) {
+      if (m_state->skip_next) {
+        m_state->skip_next = false;
+      } else {
+        m_state->token.assign(token.data(), token.size());
+        m_parser->parse_token(m_state->token, *m_result, m_state->type,
+                              m_state->includes);
+      }
+
+      // The token has been consumed, so any unescaped copy in the
+      // arena can be discarded
+      if (m_arena)
+        m_arena->clear();
+      return *this;
+    }
+
+  private:
+    const parser* m_parser; //< Parser receiving the tokens.
+    parser_result* m_result; //< Result being built.
+    utility::token_arena* m_arena; //< Storage for unescaped tokens, if any.
+    state* m_state; //< Shared parsing state.
+  };
+
   parser_result parser::parse(const std::string& cmd_line, bool ignore_first) const {
-    std::vector<std::string> container;
-    utility::split(cmd_line, std::back_inserter(container),
-                   m_delims, "\"'", '\\');
-    return parse(container.begin(), container.end(), ignore_first);
+    parser_result result{};
+    result.pending_writes().set_deferred(m_transactional);
+    parse_string(cmd_line, ignore_first, result);
+
+    return result;
   }
 
-  void parser::write_option_argument(const parsed_entry& entry) const {
-    if (!entry.opt_info)
+  void parser::parse_string(const std::string& cmd_line, bool ignore_first,
+                            parser_result& result) const {
+    // Tokens are parsed as soon as they are found, without being
+    // collected first
+    std::vector<mapped_file::file_id> includes;
+    token_sink::state st{ignore_first, cl_arg_type::non_option, includes};
+    if (m_dialect == utility::shell_dialect::generic) {
+      utility::token_arena arena;
+      utility::split_view(cmd_line, token_sink{*this, result, &arena, st},
+                          arena, m_delims, "\"'", '\\');
+    } else {
+      utility::tokenizer tok{m_dialect};
+      tok.finish(tok.feed(cmd_line, token_sink{*this, result, nullptr, st}));
+    }
+    finish_parse(result, st.type);
+  }
+
+  parser_result parser::parse(std::istream& in, bool ignore_first) const {
+    parser_result result{};
+    result.pending_writes().set_deferred(m_transactional);
+
+    std::vector<mapped_file::file_id> includes;
+    token_sink::state st{ignore_first, cl_arg_type::non_option, includes};
+    utility::tokenizer tok{make_tokenizer()};
+    tok.read(in, token_sink{*this, result, nullptr, st});
+    finish_parse(result, st.type);
+
+    return result;
+  }
+
+  parser_result parser::parse_fd(int fd, bool ignore_first) const {
+    parser_result result{};
+    result.pending_writes().set_deferred(m_transactional);
+
+    std::vector<mapped_file::file_id> includes;
+    token_sink::state st{ignore_first, cl_arg_type::non_option, includes};
+    utility::tokenizer tok{make_tokenizer()};
+    tok.read_fd(fd, token_sink{*this, result, nullptr, st});
+    finish_parse(result, st.type);
+
+    return result;
+  }
+
+  incremental_parser::incremental_parser(const parser& parser,
+                                         bool ignore_first)
+    : m_parser{&parser}, m_skip_next{ignore_first} {
+    m_result.pending_writes().set_deferred(parser.m_transactional);
+  }
+
+  void incremental_parser::feed(const std::string& token) {
+    if (m_skip_next)
+      m_skip_next = false;
+    else
+      m_parser->parse_token(token, m_result, m_type, m_includes);
+  }
+
+  parser_result incremental_parser::finish() {
+    m_parser->finish_parse(m_result, m_type);
+
+    parser_result result{std::move(m_result)};
+    reset();
+    return result;
+  }
+
+  void incremental_parser::reset(bool ignore_first) {
+    m_result = parser_result{};
+    m_result.pending_writes().set_deferred(m_parser->m_transactional);
+    m_type = parser::cl_arg_type::non_option;
+    m_skip_next = ignore_first;
+    m_includes.clear();
+  }
+
+  utility::tokenizer parser::make_tokenizer() const {
+    if (m_dialect == utility::shell_dialect::generic)
+      return utility::tokenizer{m_delims, "\"'", '\\'};
+    return utility::tokenizer{m_dialect};
+  }
+
+  void parser::parse_token(const std::string& token, parser_result& result,
+                           cl_arg_type& type) const {
+    std::vector<mapped_file::file_id> includes;
+    parse_token(token, result, type, includes);
+  }
+
+  void parser::parse_token(const std::string& token, parser_result& result,
+                           cl_arg_type& type,
+                           std::vector<mapped_file::file_id>& includes) const {
+    // Expand response files
+    if (m_response_files && type != cl_arg_type::end_indicator
+        && token.size() > 1 && token[0] == '@') {
+      parse_response_file(token.substr(1), result, type, includes);
       return;
+    }
 
-    const option& opt = *entry.opt_info;
-    if (!opt.has_bound_argument_variable())
+    // If we are expecting a standalone option argument...
+    if (type == cl_arg_type::arg_required
+        || type == cl_arg_type::arg_optional) {
+      // ...then this token should be a non-option; but if the
+      // argument is required we'll interpret it that way regardless
+      if (is_non_option(token)
+          || type == cl_arg_type::arg_required) {
+        auto& arg_info = result.back();
+        arg_info.argument = token;
+        arg_info.original_text.push_back(' ');
+        arg_info.original_text += token;
+        type = cl_arg_type::non_option;
+        if (arg_info.opt_info)
+          write_option_argument(arg_info, result.pending_writes());
+        return;
+      }
+
+      // Found an option instead, so parse it normally
+      type = cl_arg_type::non_option;
+    }
+
+    if (type == cl_arg_type::end_indicator) { // Ignore options
+      parsed_entry arg_info;
+      arg_info.original_text = token;
+      arg_info.is_option = false;
+      result.push_back(std::move(arg_info));
+    } else { // Regular argument
+      parse_argument(token, result, type);
+    }
+  }
+
+  void parser::parse_response_file(const std::string& path,
+                                   parser_result& result, cl_arg_type& type,
+                                   std::vector<mapped_file::file_id>& includes) const {
+    mapped_file file;
+    try {
+      file = mapped_file{path};
+    } catch (const file_error& e) {
+      throw parse_error{e.what(), "optionpp::parser::parse", "@" + path};
+    }
+
+    if (std::find(includes.begin(), includes.end(), file.id())
+        != includes.end()) {
+      throw parse_error{"response file '" + path + "' includes itself",
+          "optionpp::parser::parse", "@" + path};
+    }
+
+    // Tokenize the file in place, parsing tokens as they are found
+    includes.push_back(file.id());
+    token_sink::state st{false, type, includes};
+    utility::token_view contents{file.data(), file.size()};
+    if (m_dialect == utility::shell_dialect::generic) {
+      utility::token_arena arena;
+      utility::split_view(contents, token_sink{*this, result, &arena, st},
+                          arena, utility::char_class{" \t\n\r"}, "\"'", '\\');
+    } else {
+      utility::tokenizer tok{m_dialect};
+      tok.finish(tok.feed(contents, token_sink{*this, result, nullptr, st}));
+    }
+    type = st.type;
+    includes.pop_back();
+  }
+
+  void parser::run_batch(std::size_t count, unsigned thread_count,
+                         const std::function<void(std::size_t,
+                                                  std::size_t)>& task) {
+    if (thread_count == 0)
+      thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Use blocks small enough to balance the load between threads,
+    // but large enough that claiming them is not a bottleneck
+    const std::size_t max_block_size = 256;
+    std::size_t block_size = count / (std::size_t{thread_count} * 16);
+    block_size = std::min(std::max(block_size, std::size_t{1}),
+                          max_block_size);
+
+    std::size_t block_count = (count + block_size - 1) / block_size;
+    if (thread_count > block_count)
+      thread_count = static_cast<unsigned>(std::max(block_count,
+                                                    std::size_t{1}));
+
+    std::atomic<std::size_t> next_block{0};
+    auto worker = [&]() {
+      std::size_t block;
+      while ((block = next_block.fetch_add(1)) < block_count) {
+        std::size_t begin = block * block_size;
+        task(begin, std::min(begin + block_size, count));
+      }
+    };
+
+    // The calling thread also does its share of the work
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (unsigned i = 1; i < thread_count; ++i) {
+      try {
+        threads.emplace_back(worker);
+      } catch (const std::system_error&) {
+        break; // Continue with the threads we have
+      }
+    }
+    worker();
+
+    for (auto& t : threads)
+      t.join();
+  }
+
+  void parser::finish_parse(const parser_result& result,
+                            cl_arg_type type) const {
+    // Make sure we don't still need a mandatory argument
+    if (type == cl_arg_type::arg_required) {
+      const auto& opt_name = result.back().original_text;
+      throw parse_error{"option '" + opt_name + "' requires an argument",
+          "optionpp::parser::parse", opt_name};
+    }
+  }
+
+  void parser::write_option_argument(const parsed_entry& entry,
+                                     write_log& writes) const {
+    if (!entry.opt_info)
       return;
 
+    const option& opt = *entry.opt_info;
     std::string::size_type pos = 0;
     const std::string& arg = entry.argument;
     const std::string& opt_name = entry.original_without_argument;
     const std::string& fn_name = "optionpp::parser::write_option_argument";
 
+    auto choice = choice_table::npos;
+    if (!opt.choices().empty()) {
+      choice = opt.choices().find(arg);
+      if (choice == choice_table::npos)
+        throw parse_error{"argument for option '" + opt_name + "' must be one of: "
+            + opt.choices().to_string(), fn_name, opt_name};
+    }
+
+    if (!opt.validate(arg))
+      throw parse_error{"invalid argument for option '" + opt_name + "'",
+          fn_name, opt_name};
+
+    if (!opt.has_bound_argument_variable() && !writes.records_unbound())
+      return;
+
     try {
       switch (opt.argument_type()) {
       case option::uint_arg: {
@@ -284,26 +1595,50 @@ namespace optionpp {
               fn_name, opt_name};
         else if (value > std::numeric_limits<unsigned>::max())
           throw std::out_of_range{"out of range"};
-        opt.write_uint(static_cast<unsigned>(value));
+        check_range(opt, static_cast<double>(value), opt_name);
+        writes.write_uint(opt, static_cast<unsigned>(value));
         break;
       }
       case option::int_arg: {
         int value = std::stoi(entry.argument, &pos);
         if (pos != arg.size())
           throw std::invalid_argument{"invalid argument"};
-        opt.write_int(value);
+        check_range(opt, value, opt_name);
+        writes.write_int(opt, value);
         break;
       }
       case option::double_arg: {
         double value = std::stod(entry.argument, &pos);
         if (pos != arg.size())
           throw std::invalid_argument{"invalid argument"};
-        opt.write_double(value);
+        check_range(opt, value, opt_name);
+        writes.write_double(opt, value);
         break;
       }
+      case option::duration_arg: {
+        auto value = utility::parse_duration(arg);
+        check_range(opt, std::chrono::duration<double>(value).count(),
+                    opt_name);
+        writes.write_duration(opt, value);
+        break;
+      }
+      case option::size_arg: {
+        auto value = utility::parse_size(arg);
+        check_range(opt, static_cast<double>(value), opt_name);
+        writes.write_size(opt, value);
+        break;
+      }
+      case option::enum_arg:
+        writes.write_enum(opt, choice);
+        break;
+      case option::custom_arg:
+        if (!writes.write_custom(opt, arg))
+          throw parse_error{"invalid argument for option '" + opt_name + "'",
+              fn_name, opt_name};
+        break;
       default:
       case option::string_arg:
-        opt.write_string(arg);
+        writes.write_string(opt, arg);
         break;
       }
     } catch(const std::invalid_argument&) {
@@ -315,6 +1650,15 @@ namespace optionpp {
       case option::double_arg:
         throw parse_error{"argument for option '" + opt_name + "' must be a number",
             fn_name, opt_name};
+      case option::duration_arg:
+        throw parse_error{"argument for option '" + opt_name + "' must be a duration",
+            fn_name, opt_name};
+      case option::size_arg:
+        throw parse_error{"argument for option '" + opt_name + "' must be a size",
+            fn_name, opt_name};
+      case option::custom_arg:
+        throw parse_error{"invalid argument for option '" + opt_name + "'",
+            fn_name, opt_name};
       default:
         throw type_error{"type error in argument for option '" + opt_name + "'", fn_name};
       }
@@ -324,6 +1668,29 @@ namespace optionpp {
     }
   }
 
+  void parser::check_range(const option& opt, double value,
+                           const std::string& opt_name) const {
+    const std::string& fn_name = "optionpp::parser::check_range";
+    if (value < opt.min_value())
+      throw parse_error{"argument for option '" + opt_name + "' must be at least "
+          + format_bound(opt, opt.min_value()), fn_name, opt_name};
+    if (value > opt.max_value())
+      throw parse_error{"argument for option '" + opt_name + "' must be at most "
+          + format_bound(opt, opt.max_value()), fn_name, opt_name};
+
+    if (opt.step() > 0) {
+      double base = std::isfinite(opt.min_value()) ? opt.min_value() : 0.0;
+      double steps = (value - base) / opt.step();
+      if (std::abs(steps - std::round(steps)) > 1e-9 * std::max(1.0, std::abs(steps))) {
+        std::string msg = "argument for option '" + opt_name + "' must be ";
+        if (base != 0.0)
+          msg += format_bound(opt, base) + " plus ";
+        msg += "a multiple of " + format_bound(opt, opt.step());
+        throw parse_error{std::move(msg), fn_name, opt_name};
+      }
+    }
+  }
+
   void parser::parse_argument(const std::string& argument,
                               parser_result& result, cl_arg_type& type) const {
     // Check for end-of-option marker
@@ -362,13 +1729,28 @@ namespace optionpp {
 
       // Look up option info
       const option* opt = find_option(option_name);
-      if (!opt)
-        throw parse_error{"invalid option: '" + option_specifier + "'",
-            "optionpp::parser::parse_argument", option_specifier};
+      if (!opt) {
+        auto suggestions = m_names.suggest(m_groups, option_name);
+        std::string msg = "invalid option: '" + option_specifier + "'";
+        for (std::size_t i = 0; i != suggestions.size(); ++i) {
+          suggestions[i].insert(0, m_long_option_prefix);
+          if (i == 0)
+            msg += " (did you mean ";
+          else if (i + 1 == suggestions.size())
+            msg += " or ";
+          else
+            msg += ", ";
+          msg += "'" + suggestions[i] + "'";
+        }
+        if (!suggestions.empty())
+          msg += "?)";
+        throw parse_error{std::move(msg), "optionpp::parser::parse_argument",
+            option_specifier, std::move(suggestions)};
+      }
       arg_info.opt_info = &(*opt);
 
       // Does this option take an argument?
-      if (!opt->argument_name().empty()) {
+      if (!opt->argument_name_view().empty()) {
         if (!assignment_found) { // No arg was found, caller should look for it
           if (opt->is_argument_required())
             type = cl_arg_type::arg_required;
@@ -390,8 +1772,8 @@ namespace optionpp {
       arg_info.long_name = option_name;
       arg_info.short_name = opt->short_name();
       if (assignment_found)
-        write_option_argument(arg_info);
-      opt->write_bool(true);
+        write_option_argument(arg_info, result.pending_writes());
+      result.pending_writes().write_bool(*opt, true);
       result.push_back(std::move(arg_info));
     } else if (is_short_option_group(option_specifier)) { // Short options
       parse_short_option_group(option_specifier.substr(m_short_option_prefix.size()),
@@ -425,13 +1807,13 @@ namespace optionpp {
       arg_info.original_text.push_back(short_names[pos]);
       arg_info.original_without_argument = arg_info.original_text;
       arg_info.is_option = true;
-      arg_info.long_name = opt->long_name();
+      arg_info.long_name = opt->long_name_view();
       arg_info.short_name = short_names[pos];
       arg_info.opt_info = &(*opt);
-      opt->write_bool(true);
+      result.pending_writes().write_bool(*opt, true);
 
       // Check if option takes an argument
-      if (!opt->argument_name().empty()) {
+      if (!opt->argument_name_view().empty()) {
         if (pos + 1 < short_names.size()) {
           // This isn't the last option, so the rest of the string is an argument
           arg_info.argument = short_names.substr(pos + 1);
@@ -441,7 +1823,7 @@ namespace optionpp {
             arg_info.argument += argument;
           }
           arg_info.original_text += arg_info.argument;
-          write_option_argument(arg_info);
+          write_option_argument(arg_info, result.pending_writes());
           result.push_back(std::move(arg_info));
           type = cl_arg_type::no_arg;
           break;
@@ -451,7 +1833,7 @@ namespace optionpp {
             arg_info.original_text += m_equals;
             arg_info.original_text += argument;
             arg_info.argument = argument;
-            write_option_argument(arg_info);
+            write_option_argument(arg_info, result.pending_writes());
             type = cl_arg_type::no_arg;
           } else if (opt->is_argument_required()) {
             type = cl_arg_type::arg_required;
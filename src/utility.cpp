@@ -24,42 +24,933 @@
 
 #include <optionpp/utility.hpp>
 
+#include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <istream>
 #include <iterator>
+#include <limits>
+#include <ostream>
 #include <vector>
+#include <optionpp/error.hpp>
+
+#if defined(_WIN32)
+#include <io.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#if !defined(OPTIONPP_NO_SIMD) && defined(__AVX2__)
+#define OPTIONPP_USE_AVX2
+#include <immintrin.h>
+#endif
+#if !defined(OPTIONPP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) \
+                                   || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define OPTIONPP_USE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace optionpp {
   namespace utility {
 
     /**
-     * @brief Determine if a character is whitespace.
-     * @param c Character to check.
-     * @return True if `c` is a whitespace character and false
-     *         otherwise.
+     * @brief Return the set of whitespace characters.
+     *
+     * These are the characters recognized by `std::isspace` in the
+     * "C" locale.
+     *
+     * @return Reference to the set of whitespace characters.
+     */
+    const char_class& whitespace() {
+      static const char_class space_chars{" \t\n\v\f\r"};
+      return space_chars;
+    }
+
+    /**
+     * @brief Return the index of the lowest set bit.
+     * @param mask Nonzero bit mask.
+     * @return Number of trailing zero bits in `mask`.
+     */
+    inline unsigned count_trailing_zeros(std::uint32_t mask) noexcept {
+#if defined(_MSC_VER)
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+      return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+      unsigned index = 0;
+      while (!(mask & 1)) {
+        mask >>= 1;
+        ++index;
+      }
+      return index;
+#endif
+    }
+
+    constexpr std::size_t char_class::max_listed;
+    constexpr std::size_t token_arena::block_size;
+
+    std::ostream& operator<<(std::ostream& os, token_view view) {
+      return os.write(view.data(), view.size());
+    }
+
+    token_view token_arena::store(const char* data, std::size_t size) {
+      if (size == 0)
+        return token_view{};
+
+      // Find a block with enough room, allocating one if necessary
+      while (m_current < m_blocks.size()
+             && m_blocks[m_current].size - m_used < size) {
+        ++m_current;
+        m_used = 0;
+      }
+      if (m_current == m_blocks.size()) {
+        std::size_t new_size = std::max(block_size, size);
+        m_blocks.push_back(block{std::unique_ptr<char[]>{new char[new_size]},
+                                 new_size});
+        m_used = 0;
+      }
+
+      char* dest = m_blocks[m_current].data.get() + m_used;
+      std::copy(data, data + size, dest);
+      m_used += size;
+      return token_view{dest, size};
+    }
+
+    constexpr std::size_t tokenizer::buffer_size;
+
+    tokenizer::tokenizer(const char_class& delims, const std::string& quotes,
+                         char escape_char, bool allow_empty)
+      : m_delims{delims}, m_specials{delims}, m_escape_char{escape_char},
+        m_allow_empty{allow_empty} {
+      m_specials.add(escape_char).add(quotes);
+    }
+
+    tokenizer::tokenizer(shell_dialect dialect) : tokenizer{} {
+      if (dialect != shell_dialect::generic)
+        m_table = &table(dialect);
+    }
+
+    void tokenizer::reset() noexcept {
+      m_token.clear();
+      m_buffered = false;
+      m_escape_next = false;
+      m_in_quotes = false;
+      m_closing_quote = '\0';
+      m_state = 0;
+      m_backslashes = 0;
+      m_started = false;
+    }
+
+    struct tokenizer::shell_table {
+      // Kinds of characters
+      enum char_type : unsigned char {
+        other_char, space_char, newline_char, single_quote, double_quote,
+        backslash, dquote_special, char_type_count
+      };
+
+      // Actions performed on a transition, in this order
+      enum action : unsigned char {
+        count_backslash = 1, //< Add a pending backslash.
+        drop_backslashes = 2, //< Discard the pending backslashes.
+        flush_backslashes = 4, //< Append all pending backslashes.
+        halve_backslashes = 8, //< Append half of the pending backslashes.
+        start_token = 16, //< Begin a token, even if it stays empty.
+        append_char = 32, //< Append the character.
+        end_token = 64, //< Complete the token.
+        retry_char = 128 //< Process the character again in the new state.
+      };
+
+      struct transition {
+        unsigned char next; //< State to move to.
+        unsigned char actions; //< Bitwise OR of `action` values.
+      };
+
+      static constexpr unsigned max_states = 8;
+
+      unsigned char types[256]; //< Kind of each character.
+      transition moves[max_states][char_type_count]; //< Transition for each state and kind of character.
+
+      // Set the transition from a state for every kind of character
+      void set_all(unsigned state, unsigned next, unsigned actions) {
+        for (auto& t : moves[state])
+          t = transition{static_cast<unsigned char>(next),
+                         static_cast<unsigned char>(actions)};
+      }
+
+      // Set the transition from a state for one kind of character
+      void set(unsigned state, char_type type, unsigned next,
+               unsigned actions) {
+        moves[state][type] = transition{static_cast<unsigned char>(next),
+                                        static_cast<unsigned char>(actions)};
+      }
+    };
+
+    constexpr unsigned tokenizer::shell_table::max_states;
+
+    const tokenizer::shell_table& tokenizer::table(shell_dialect dialect) {
+      using table_type = shell_table;
+
+      // POSIX sh
+      static const table_type posix_table = []() {
+        enum { between, between_escape, unquoted, unquoted_escape,
+               single_quoted, double_quoted, double_escape };
+
+        table_type t{};
+        t.types[static_cast<unsigned char>(' ')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('\t')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('\n')] = table_type::newline_char;
+        t.types[static_cast<unsigned char>('\'')] = table_type::single_quote;
+        t.types[static_cast<unsigned char>('"')] = table_type::double_quote;
+        t.types[static_cast<unsigned char>('\\')] = table_type::backslash;
+        t.types[static_cast<unsigned char>('$')] = table_type::dquote_special;
+        t.types[static_cast<unsigned char>('`')] = table_type::dquote_special;
+
+        t.set_all(between, unquoted,
+                  table_type::start_token | table_type::append_char);
+        t.set(between, table_type::space_char, between, 0);
+        t.set(between, table_type::newline_char, between, 0);
+        t.set(between, table_type::single_quote, single_quoted,
+              table_type::start_token);
+        t.set(between, table_type::double_quote, double_quoted,
+              table_type::start_token);
+        t.set(between, table_type::backslash, between_escape,
+              table_type::count_backslash);
+
+        t.set_all(between_escape, unquoted, table_type::drop_backslashes
+                  | table_type::start_token | table_type::append_char);
+        t.set(between_escape, table_type::newline_char, between,
+              table_type::drop_backslashes);
+
+        t.set_all(unquoted, unquoted, table_type::append_char);
+        t.set(unquoted, table_type::space_char, between, table_type::end_token);
+        t.set(unquoted, table_type::newline_char, between,
+              table_type::end_token);
+        t.set(unquoted, table_type::single_quote, single_quoted, 0);
+        t.set(unquoted, table_type::double_quote, double_quoted, 0);
+        t.set(unquoted, table_type::backslash, unquoted_escape,
+              table_type::count_backslash);
+
+        t.set_all(unquoted_escape, unquoted,
+                  table_type::drop_backslashes | table_type::append_char);
+        t.set(unquoted_escape, table_type::newline_char, unquoted,
+              table_type::drop_backslashes);
+
+        t.set_all(single_quoted, single_quoted, table_type::append_char);
+        t.set(single_quoted, table_type::single_quote, unquoted, 0);
+
+        t.set_all(double_quoted, double_quoted, table_type::append_char);
+        t.set(double_quoted, table_type::double_quote, unquoted, 0);
+        t.set(double_quoted, table_type::backslash, double_escape,
+              table_type::count_backslash);
+
+        // Only some characters can be escaped in double quotes
+        t.set_all(double_escape, double_quoted,
+                  table_type::flush_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::double_quote, double_quoted,
+              table_type::drop_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::backslash, double_quoted,
+              table_type::drop_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::dquote_special, double_quoted,
+              table_type::drop_backslashes | table_type::append_char);
+        t.set(double_escape, table_type::newline_char, double_quoted,
+              table_type::drop_backslashes);
+        return t;
+      }();
+
+      // CommandLineToArgvW
+      static const table_type windows_table = []() {
+        enum { between, unquoted, quoted, quote_pending,
+               unquoted_odd, unquoted_even, quoted_odd, quoted_even };
+
+        table_type t{};
+        t.types[static_cast<unsigned char>(' ')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('\t')] = table_type::space_char;
+        t.types[static_cast<unsigned char>('"')] = table_type::double_quote;
+        t.types[static_cast<unsigned char>('\\')] = table_type::backslash;
+
+        t.set_all(between, unquoted,
+                  table_type::start_token | table_type::append_char);
+        t.set(between, table_type::space_char, between, 0);
+        t.set(between, table_type::double_quote, quoted,
+              table_type::start_token);
+        t.set(between, table_type::backslash, unquoted_odd,
+              table_type::start_token | table_type::count_backslash);
+
+        t.set_all(unquoted, unquoted, table_type::append_char);
+        t.set(unquoted, table_type::space_char, between, table_type::end_token);
+        t.set(unquoted, table_type::double_quote, quoted, 0);
+        t.set(unquoted, table_type::backslash, unquoted_odd,
+              table_type::count_backslash);
+
+        t.set_all(quoted, quoted, table_type::append_char);
+        t.set(quoted, table_type::double_quote, quote_pending, 0);
+        t.set(quoted, table_type::backslash, quoted_odd,
+              table_type::count_backslash);
+
+        // A closing quote followed by another quote produces a
+        // literal quote
+        t.set_all(quote_pending, unquoted, table_type::retry_char);
+        t.set(quote_pending, table_type::double_quote, unquoted,
+              table_type::append_char);
+
+        // Backslashes are only special when followed by a quote, and
+        // then it matters whether there was an odd or even number
+        t.set_all(unquoted_odd, unquoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(unquoted_odd, table_type::backslash, unquoted_even,
+              table_type::count_backslash);
+        t.set(unquoted_odd, table_type::double_quote, unquoted,
+              table_type::halve_backslashes | table_type::append_char);
+
+        t.set_all(unquoted_even, unquoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(unquoted_even, table_type::backslash, unquoted_odd,
+              table_type::count_backslash);
+        t.set(unquoted_even, table_type::double_quote, quoted,
+              table_type::halve_backslashes);
+
+        t.set_all(quoted_odd, quoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(quoted_odd, table_type::backslash, quoted_even,
+              table_type::count_backslash);
+        t.set(quoted_odd, table_type::double_quote, quoted,
+              table_type::halve_backslashes | table_type::append_char);
+
+        t.set_all(quoted_even, quoted,
+                  table_type::flush_backslashes | table_type::retry_char);
+        t.set(quoted_even, table_type::backslash, quoted_odd,
+              table_type::count_backslash);
+        t.set(quoted_even, table_type::double_quote, quote_pending,
+              table_type::halve_backslashes);
+        return t;
+      }();
+
+      return dialect == shell_dialect::windows ? windows_table : posix_table;
+    }
+
+    bool tokenizer::scan(const char*& pos, const char* end) {
+      const shell_table& t = *m_table;
+      unsigned state = m_state;
+
+      while (pos != end) {
+        auto move = t.moves[state][t.types[static_cast<unsigned char>(*pos)]];
+
+        // Copy ordinary characters in a single run
+        if (move.actions == shell_table::append_char && move.next == state) {
+          const char* run = pos + 1;
+          while (run != end) {
+            auto m = t.moves[state][t.types[static_cast<unsigned char>(*run)]];
+            if (m.actions != shell_table::append_char || m.next != state)
+              break;
+            ++run;
+          }
+          m_token.append(pos, run);
+          pos = run;
+          continue;
+        }
+
+        unsigned actions = move.actions;
+        if (actions & shell_table::count_backslash)
+          ++m_backslashes;
+        if (actions & shell_table::drop_backslashes)
+          m_backslashes = 0;
+        if (actions & shell_table::flush_backslashes) {
+          m_token.append(m_backslashes, '\\');
+          m_backslashes = 0;
+        }
+        if (actions & shell_table::halve_backslashes) {
+          m_token.append(m_backslashes / 2, '\\');
+          m_backslashes = 0;
+        }
+        if (actions & shell_table::start_token)
+          m_started = true;
+        if (actions & shell_table::append_char)
+          m_token.push_back(*pos);
+        state = move.next;
+        if (!(actions & shell_table::retry_char))
+          ++pos;
+
+        if (actions & shell_table::end_token) {
+          m_state = static_cast<unsigned char>(state);
+          m_started = false;
+          return true;
+        }
+      }
+
+      m_state = static_cast<unsigned char>(state);
+      return false;
+    }
+
+    bool tokenizer::scan_end() {
+      // Trailing backslashes are kept literally
+      if (m_backslashes) {
+        m_token.append(m_backslashes, '\\');
+        m_started = true;
+      }
+      return m_started;
+    }
+
+    std::size_t tokenizer::read_chunk(std::istream& in, char* buffer,
+                                      std::size_t size) {
+      in.read(buffer, static_cast<std::streamsize>(size));
+      if (in.bad())
+        throw file_error{"error reading from stream",
+            "optionpp::utility::tokenizer::read", ""};
+      return static_cast<std::size_t>(in.gcount());
+    }
+
+    std::size_t tokenizer::read_chunk(int fd, char* buffer, std::size_t size) {
+#if defined(_WIN32)
+      int count = ::_read(fd, buffer, static_cast<unsigned>(size));
+#elif defined(__unix__) || defined(__APPLE__)
+      ssize_t count;
+      do {
+        count = ::read(fd, buffer, size);
+      } while (count < 0 && errno == EINTR);
+#else
+      int count = -1;
+      errno = ENOSYS;
+#endif
+      if (count < 0)
+        throw file_error{std::string{"error reading from file descriptor: "}
+                         + std::strerror(errno),
+            "optionpp::utility::tokenizer::read_fd", ""};
+      return static_cast<std::size_t>(count);
+    }
+
+    std::size_t token_arena::capacity() const noexcept {
+      std::size_t total = 0;
+      for (const auto& b : m_blocks)
+        total += b.size;
+      return total;
+    }
+
+    std::size_t string_pool::statistics::saved_bytes() const noexcept {
+      return string_bytes > allocated_bytes ? string_bytes - allocated_bytes : 0;
+    }
+
+    static_string string_pool::intern(token_view str) {
+      if (str.empty())
+        return static_string{};
+
+      std::lock_guard<std::mutex> lock{m_mutex};
+
+      // Keep at least a quarter of the slots free
+      if (4 * (m_stats.strings + 1) > 3 * m_slots.size())
+        grow();
+
+      const std::size_t mask = m_slots.size() - 1;
+      std::size_t index = static_cast<std::size_t>(hash(str)) & mask;
+      while (!m_slots[index].empty() && m_slots[index] != str)
+        index = (index + 1) & mask;
+
+      if (m_slots[index].empty()) {
+        m_slots[index] = m_arena.store(str.data(), str.size());
+        ++m_stats.strings;
+        m_stats.bytes += str.size();
+      }
+
+      ++m_stats.references;
+      m_stats.referenced_bytes += str.size();
+      if (str.size() > 15)
+        m_stats.string_bytes += str.size() + 1;
+      return static_string{m_slots[index].data(), m_slots[index].size()};
+    }
+
+    auto string_pool::stats() const -> statistics {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      statistics result = m_stats;
+      result.allocated_bytes = m_arena.capacity()
+        + m_slots.capacity() * sizeof(token_view);
+      return result;
+    }
+
+    std::uint64_t string_pool::hash(token_view str) noexcept {
+      // FNV-1a
+      std::uint64_t h = 14695981039346656037ULL;
+      for (char c : str) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+      }
+      return h;
+    }
+
+    void string_pool::grow() {
+      std::vector<token_view> slots(m_slots.empty() ? 64 : 2 * m_slots.size());
+      const std::size_t mask = slots.size() - 1;
+      for (const auto& str : m_slots) {
+        if (str.empty())
+          continue;
+        std::size_t index = static_cast<std::size_t>(hash(str)) & mask;
+        while (!slots[index].empty())
+          index = (index + 1) & mask;
+        slots[index] = str;
+      }
+      m_slots.swap(slots);
+    }
+
+    const char* find_first_of(const char* first, const char* last,
+                              const char* chars, std::size_t count) noexcept {
+      return find_first_of(first, last, char_class{chars, count});
+    }
+
+    const char* find_first_of(const char* first, const char* last,
+                              const char_class& char_set) noexcept {
+      if (char_set.empty())
+        return last;
+
+#if defined(OPTIONPP_USE_AVX2) || defined(OPTIONPP_USE_SSE2)
+      const std::size_t max_simd_chars = char_class::max_listed;
+      const char* chars = char_set.m_listed;
+      std::size_t count = char_set.m_size;
+      if (count <= max_simd_chars) {
+#ifdef OPTIONPP_USE_AVX2
+        __m256i wide_needles[max_simd_chars];
+        for (std::size_t i = 0; i != count; ++i)
+          wide_needles[i] = _mm256_set1_epi8(chars[i]);
+
+        while (last - first >= 32) {
+          __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+          __m256i match = _mm256_cmpeq_epi8(block, wide_needles[0]);
+          for (std::size_t i = 1; i != count; ++i)
+            match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, wide_needles[i]));
+          auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(match));
+          if (mask)
+            return first + count_trailing_zeros(mask);
+          first += 32;
+        }
+#endif
+#ifdef OPTIONPP_USE_SSE2
+        __m128i needles[max_simd_chars];
+        for (std::size_t i = 0; i != count; ++i)
+          needles[i] = _mm_set1_epi8(chars[i]);
+
+        while (last - first >= 16) {
+          __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+          __m128i match = _mm_cmpeq_epi8(block, needles[0]);
+          for (std::size_t i = 1; i != count; ++i)
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(block, needles[i]));
+          auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(match));
+          if (mask)
+            return first + count_trailing_zeros(mask);
+          first += 16;
+        }
+#endif
+      }
+#endif
+
+      // Check any remaining characters one at a time
+      while (first != last && !char_set.contains(*first))
+        ++first;
+      return first;
+    }
+
+    bool is_ascii(const char* first, const char* last) noexcept {
+#ifdef OPTIONPP_USE_AVX2
+      while (last - first >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        if (_mm256_movemask_epi8(block))
+          return false;
+        first += 32;
+      }
+#endif
+#ifdef OPTIONPP_USE_SSE2
+      while (last - first >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        if (_mm_movemask_epi8(block))
+          return false;
+        first += 16;
+      }
+#endif
+
+      // Check any remaining characters one at a time
+      for (; first != last; ++first) {
+        if (static_cast<unsigned char>(*first) & 0x80)
+          return false;
+      }
+      return true;
+    }
+
+    /**
+     * @brief An inclusive range of code points.
+     */
+    struct code_point_range {
+      char32_t first; //< First code point in the range.
+      char32_t last; //< Last code point in the range.
+    };
+
+    /**
+     * @brief Code points that take no columns.
+     *
+     * These are the nonspacing and enclosing combining marks, the
+     * Hangul medial vowels and final consonants, and zero-width
+     * format characters, sorted and not overlapping.
+     */
+    const code_point_range zero_width_chars[] = {
+      {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF},
+      {0x05C1, 0x05C2}, {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A},
+      {0x061C, 0x061C}, {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DC},
+      {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0711, 0x0711},
+      {0x0730, 0x074A}, {0x07A6, 0x07B0}, {0x07EB, 0x07F3}, {0x07FD, 0x07FD},
+      {0x0816, 0x0819}, {0x081B, 0x0823}, {0x0825, 0x0827}, {0x0829, 0x082D},
+      {0x0859, 0x085B}, {0x0898, 0x089F}, {0x08CA, 0x08E1}, {0x08E3, 0x0902},
+      {0x093A, 0x093A}, {0x093C, 0x093C}, {0x0941, 0x0948}, {0x094D, 0x094D},
+      {0x0951, 0x0957}, {0x0962, 0x0963}, {0x0981, 0x0981}, {0x09BC, 0x09BC},
+      {0x09C1, 0x09C4}, {0x09CD, 0x09CD}, {0x09E2, 0x09E3}, {0x09FE, 0x09FE},
+      {0x0A01, 0x0A02}, {0x0A3C, 0x0A3C}, {0x0A41, 0x0A42}, {0x0A47, 0x0A48},
+      {0x0A4B, 0x0A4D}, {0x0A51, 0x0A51}, {0x0A70, 0x0A71}, {0x0A75, 0x0A75},
+      {0x0A81, 0x0A82}, {0x0ABC, 0x0ABC}, {0x0AC1, 0x0AC5}, {0x0AC7, 0x0AC8},
+      {0x0ACD, 0x0ACD}, {0x0AE2, 0x0AE3}, {0x0AFA, 0x0AFF}, {0x0B01, 0x0B01},
+      {0x0B3C, 0x0B3C}, {0x0B3F, 0x0B3F}, {0x0B41, 0x0B44}, {0x0B4D, 0x0B4D},
+      {0x0B55, 0x0B56}, {0x0B62, 0x0B63}, {0x0B82, 0x0B82}, {0x0BC0, 0x0BC0},
+      {0x0BCD, 0x0BCD}, {0x0C00, 0x0C00}, {0x0C04, 0x0C04}, {0x0C3C, 0x0C3C},
+      {0x0C3E, 0x0C40}, {0x0C46, 0x0C48}, {0x0C4A, 0x0C4D}, {0x0C55, 0x0C56},
+      {0x0C62, 0x0C63}, {0x0C81, 0x0C81}, {0x0CBC, 0x0CBC}, {0x0CBF, 0x0CBF},
+      {0x0CC6, 0x0CC6}, {0x0CCC, 0x0CCD}, {0x0CE2, 0x0CE3}, {0x0D00, 0x0D01},
+      {0x0D3B, 0x0D3C}, {0x0D41, 0x0D44}, {0x0D4D, 0x0D4D}, {0x0D62, 0x0D63},
+      {0x0D81, 0x0D81}, {0x0DCA, 0x0DCA}, {0x0DD2, 0x0DD4}, {0x0DD6, 0x0DD6},
+      {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x0EB1, 0x0EB1},
+      {0x0EB4, 0x0EBC}, {0x0EC8, 0x0ECE}, {0x0F18, 0x0F19}, {0x0F35, 0x0F35},
+      {0x0F37, 0x0F37}, {0x0F39, 0x0F39}, {0x0F71, 0x0F7E}, {0x0F80, 0x0F84},
+      {0x0F86, 0x0F87}, {0x0F8D, 0x0F97}, {0x0F99, 0x0FBC}, {0x0FC6, 0x0FC6},
+      {0x102D, 0x1030}, {0x1032, 0x1037}, {0x1039, 0x103A}, {0x103D, 0x103E},
+      {0x1058, 0x1059}, {0x105E, 0x1060}, {0x1071, 0x1074}, {0x1082, 0x1082},
+      {0x1085, 0x1086}, {0x108D, 0x108D}, {0x109D, 0x109D}, {0x1160, 0x11FF},
+      {0x135D, 0x135F}, {0x1712, 0x1714}, {0x1732, 0x1733}, {0x1752, 0x1753},
+      {0x1772, 0x1773}, {0x17B4, 0x17B5}, {0x17B7, 0x17BD}, {0x17C6, 0x17C6},
+      {0x17C9, 0x17D3}, {0x17DD, 0x17DD}, {0x180B, 0x180F}, {0x1885, 0x1886},
+      {0x18A9, 0x18A9}, {0x1920, 0x1922}, {0x1927, 0x1928}, {0x1932, 0x1932},
+      {0x1939, 0x193B}, {0x1A17, 0x1A18}, {0x1A1B, 0x1A1B}, {0x1A56, 0x1A56},
+      {0x1A58, 0x1A5E}, {0x1A60, 0x1A60}, {0x1A62, 0x1A62}, {0x1A65, 0x1A6C},
+      {0x1A73, 0x1A7C}, {0x1A7F, 0x1A7F}, {0x1AB0, 0x1ACE}, {0x1B00, 0x1B03},
+      {0x1B34, 0x1B34}, {0x1B36, 0x1B3A}, {0x1B3C, 0x1B3C}, {0x1B42, 0x1B42},
+      {0x1B6B, 0x1B73}, {0x1B80, 0x1B81}, {0x1BA2, 0x1BA5}, {0x1BA8, 0x1BA9},
+      {0x1BAB, 0x1BAD}, {0x1BE6, 0x1BE6}, {0x1BE8, 0x1BE9}, {0x1BED, 0x1BED},
+      {0x1BEF, 0x1BF1}, {0x1C2C, 0x1C33}, {0x1C36, 0x1C37}, {0x1CD0, 0x1CD2},
+      {0x1CD4, 0x1CE0}, {0x1CE2, 0x1CE8}, {0x1CED, 0x1CED}, {0x1CF4, 0x1CF4},
+      {0x1CF8, 0x1CF9}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x202A, 0x202E},
+      {0x2060, 0x2064}, {0x20D0, 0x20F0}, {0x2CEF, 0x2CF1}, {0x2D7F, 0x2D7F},
+      {0x2DE0, 0x2DFF}, {0x302A, 0x302D}, {0x3099, 0x309A}, {0xA66F, 0xA672},
+      {0xA674, 0xA67D}, {0xA69E, 0xA69F}, {0xA6F0, 0xA6F1}, {0xA802, 0xA802},
+      {0xA806, 0xA806}, {0xA80B, 0xA80B}, {0xA825, 0xA826}, {0xA82C, 0xA82C},
+      {0xA8C4, 0xA8C5}, {0xA8E0, 0xA8F1}, {0xA8FF, 0xA8FF}, {0xA926, 0xA92D},
+      {0xA947, 0xA951}, {0xA980, 0xA982}, {0xA9B3, 0xA9B3}, {0xA9B6, 0xA9B9},
+      {0xA9BC, 0xA9BD}, {0xA9E5, 0xA9E5}, {0xAA29, 0xAA2E}, {0xAA31, 0xAA32},
+      {0xAA35, 0xAA36}, {0xAA43, 0xAA43}, {0xAA4C, 0xAA4C}, {0xAA7C, 0xAA7C},
+      {0xAAB0, 0xAAB0}, {0xAAB2, 0xAAB4}, {0xAAB7, 0xAAB8}, {0xAABE, 0xAABF},
+      {0xAAC1, 0xAAC1}, {0xAAEC, 0xAAED}, {0xAAF6, 0xAAF6}, {0xABE5, 0xABE5},
+      {0xABE8, 0xABE8}, {0xABED, 0xABED}, {0xD7B0, 0xD7FF}, {0xFB1E, 0xFB1E},
+      {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0xFFF9, 0xFFFB},
+      {0x101FD, 0x101FD}, {0x102E0, 0x102E0}, {0x10376, 0x1037A},
+      {0x10A01, 0x10A03}, {0x10A05, 0x10A06}, {0x10A0C, 0x10A0F},
+      {0x10A38, 0x10A3A}, {0x10A3F, 0x10A3F}, {0x10AE5, 0x10AE6},
+      {0x10D24, 0x10D27}, {0x10EAB, 0x10EAC}, {0x10F46, 0x10F50},
+      {0x11001, 0x11001}, {0x11038, 0x11046}, {0x1107F, 0x11081},
+      {0x110B3, 0x110B6}, {0x110B9, 0x110BA}, {0x11100, 0x11102},
+      {0x11127, 0x1112B}, {0x1112D, 0x11134}, {0x1D167, 0x1D169},
+      {0x1D173, 0x1D182}, {0x1D185, 0x1D18B}, {0x1D1AA, 0x1D1AD},
+      {0x1E8D0, 0x1E8D6}, {0x1E944, 0x1E94A}, {0xE0001, 0xE0001},
+      {0xE0020, 0xE007F}, {0xE0100, 0xE01EF}
+    };
+
+    /**
+     * @brief Code points that take two columns.
+     *
+     * These are the characters whose East Asian width is Wide or
+     * Fullwidth, sorted and not overlapping.
+     */
+    const code_point_range wide_chars[] = {
+      {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+      {0x23F0, 0x23F0}, {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615},
+      {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+      {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE},
+      {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+      {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+      {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755},
+      {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF},
+      {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x2E99},
+      {0x2E9B, 0x2EF3}, {0x2F00, 0x2FD5}, {0x2FF0, 0x2FFB}, {0x3000, 0x3029},
+      {0x302E, 0x303E}, {0x3041, 0x3096}, {0x309B, 0x30FF}, {0x3105, 0x312F},
+      {0x3131, 0x318E}, {0x3190, 0x31E3}, {0x31F0, 0x321E}, {0x3220, 0x3247},
+      {0x3250, 0x4DBF}, {0x4E00, 0xA48C}, {0xA490, 0xA4C6}, {0xA960, 0xA97C},
+      {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE52},
+      {0xFE54, 0xFE66}, {0xFE68, 0xFE6B}, {0xFF01, 0xFF60}, {0xFFE0, 0xFFE6},
+      {0x16FE0, 0x16FE4}, {0x16FF0, 0x16FF1}, {0x17000, 0x187F7},
+      {0x18800, 0x18CD5}, {0x18D00, 0x18D08}, {0x1AFF0, 0x1AFF3},
+      {0x1AFF5, 0x1AFFB}, {0x1AFFD, 0x1AFFE}, {0x1B000, 0x1B122},
+      {0x1B132, 0x1B132}, {0x1B150, 0x1B152}, {0x1B155, 0x1B155},
+      {0x1B164, 0x1B167}, {0x1B170, 0x1B2FB}, {0x1F004, 0x1F004},
+      {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A},
+      {0x1F200, 0x1F202}, {0x1F210, 0x1F23B}, {0x1F240, 0x1F248},
+      {0x1F250, 0x1F251}, {0x1F260, 0x1F265}, {0x1F300, 0x1F320},
+      {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C}, {0x1F37E, 0x1F393},
+      {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0},
+      {0x1F3F4, 0x1F3F4}, {0x1F3F8, 0x1F43E}, {0x1F440, 0x1F440},
+      {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E},
+      {0x1F550, 0x1F567}, {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596},
+      {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F}, {0x1F680, 0x1F6C5},
+      {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7},
+      {0x1F6DC, 0x1F6DF}, {0x1F6EB, 0x1F6EC}, {0x1F6F4, 0x1F6FC},
+      {0x1F7E0, 0x1F7EB}, {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A},
+      {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF}, {0x1FA70, 0x1FA7C},
+      {0x1FA80, 0x1FA88}, {0x1FA90, 0x1FABD}, {0x1FABF, 0x1FAC5},
+      {0x1FACE, 0x1FADB}, {0x1FAE0, 0x1FAE8}, {0x1FAF0, 0x1FAF8},
+      {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}
+    };
+
+    /**
+     * @brief Check whether a code point lies in one of a sorted list
+     *        of ranges.
+     * @tparam N Number of ranges.
+     * @param ranges Sorted, non-overlapping ranges.
+     * @param code_point Code point to look up.
+     * @return True if some range contains `code_point`.
+     */
+    template <std::size_t N>
+    bool in_ranges(const code_point_range (&ranges)[N],
+                   char32_t code_point) noexcept {
+      if (code_point < ranges[0].first || code_point > ranges[N - 1].last)
+        return false;
+
+      // Find the first range that ends at or after the code point
+      auto it = std::lower_bound(std::begin(ranges), std::end(ranges),
+                                 code_point,
+                                 [](const code_point_range& r, char32_t cp) {
+                                   return r.last < cp;
+                                 });
+      return it != std::end(ranges) && it->first <= code_point;
+    }
+
+    /**
+     * @brief Decode one UTF-8 sequence.
+     *
+     * A byte that does not start a valid, shortest-form sequence is
+     * decoded by itself as U+FFFD.
+     *
+     * @param first Pointer to the start of the sequence.
+     * @param last Pointer to the end of the input; must be greater
+     *             than `first`.
+     * @param code_point Set to the decoded code point.
+     * @return Number of bytes in the sequence.
+     */
+    std::size_t decode_utf8(const char* first, const char* last,
+                            char32_t& code_point) noexcept {
+      auto byte = [first](std::size_t i) {
+        return static_cast<unsigned char>(first[i]);
+      };
+      auto is_continuation = [&](std::size_t i) {
+        return first + i < last && (byte(i) & 0xC0) == 0x80;
+      };
+
+      unsigned char lead = byte(0);
+      std::size_t length;
+      char32_t min_value;
+      if (lead < 0x80) {
+        code_point = lead;
+        return 1;
+      } else if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        code_point = lead & 0x1F;
+        min_value = 0x80;
+      } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        code_point = lead & 0x0F;
+        min_value = 0x800;
+      } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        code_point = lead & 0x07;
+        min_value = 0x10000;
+      } else {
+        code_point = 0xFFFD;
+        return 1;
+      }
+
+      for (std::size_t i = 1; i != length; ++i) {
+        if (!is_continuation(i)) {
+          code_point = 0xFFFD;
+          return 1;
+        }
+        code_point = (code_point << 6) | (byte(i) & 0x3F);
+      }
+
+      if (code_point < min_value || code_point > 0x10FFFF
+          || (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        code_point = 0xFFFD;
+        return 1;
+      }
+      return length;
+    }
+
+    int char_width(char32_t code_point) noexcept {
+      if (code_point < 0x300)
+        return 1;
+      if (in_ranges(zero_width_chars, code_point))
+        return 0;
+      if (in_ranges(wide_chars, code_point))
+        return 2;
+      return 1;
+    }
+
+    std::size_t display_width(token_view str) noexcept {
+      if (is_ascii(str.begin(), str.end()))
+        return str.size();
+
+      std::size_t width = 0;
+      const char* pos = str.begin();
+      while (pos != str.end()) {
+        char32_t code_point;
+        pos += decode_utf8(pos, str.end(), code_point);
+        width += static_cast<std::size_t>(char_width(code_point));
+      }
+      return width;
+    }
+
+    /**
+     * @brief Find where a line of a given width ends.
+     *
+     * This is a helper function for `wrap_line`. Characters are added
+     * as long as they fit, and zero-width characters following the
+     * last one are kept with it. At least one character is taken, so
+     * a wide character is not lost when it is wider than the space
+     * available.
+     *
+     * @param str UTF-8 text.
+     * @param start Index at which the line starts.
+     * @param columns Number of columns available.
+     * @return Index one past the last byte of the line, which is never
+     *         inside a multibyte character.
+     */
+    std::size_t advance_columns(token_view str, std::size_t start,
+                                int columns) noexcept {
+      const char* pos = str.begin() + start;
+      int used = 0;
+      while (pos != str.end()) {
+        char32_t code_point;
+        std::size_t length = decode_utf8(pos, str.end(), code_point);
+        int width = char_width(code_point);
+        if (used + width > columns && pos != str.begin() + start)
+          break;
+        used += width;
+        pos += length;
+      }
+      return static_cast<std::size_t>(pos - str.begin());
+    }
+
+    /**
+     * @brief Destination for `wrap_into` that writes to a stream.
+     */
+    class stream_sink {
+    public:
+      explicit stream_sink(std::ostream& os) noexcept : m_os{os} {}
+
+      void write(const char* data, std::size_t size) {
+        m_os.write(data, static_cast<std::streamsize>(size));
+      }
+
+    private:
+      std::ostream& m_os;
+    };
+
+    /**
+     * @brief Destination for `wrap_into` that writes to a C file.
+     */
+    class file_sink {
+    public:
+      explicit file_sink(std::FILE* file) noexcept : m_file{file} {}
+
+      void write(const char* data, std::size_t size) noexcept {
+        std::fwrite(data, 1, size, m_file);
+      }
+
+    private:
+      std::FILE* m_file;
+    };
+
+    /**
+     * @brief Destination for `wrap_into` that fills a buffer,
+     *        counting what does not fit.
+     */
+    class buffer_sink {
+    public:
+      buffer_sink(char* buffer, std::size_t size) noexcept
+        : m_buffer{buffer}, m_size{size} {}
+
+      void write(const char* data, std::size_t size) noexcept {
+        if (m_length < m_size)
+          std::copy(data, data + std::min(size, m_size - m_length),
+                    m_buffer + m_length);
+        m_length += size;
+      }
+
+      std::size_t length() const noexcept { return m_length; }
+
+    private:
+      char* m_buffer;
+      std::size_t m_size;
+      std::size_t m_length{0};
+    };
+
+    /**
+     * @brief Destination for `wrap_into` that appends to a string.
+     */
+    class string_sink {
+    public:
+      explicit string_sink(std::string& str) noexcept : m_str{str} {}
+
+      void write(const char* data, std::size_t size) {
+        m_str.append(data, size);
+      }
+
+    private:
+      std::string& m_str;
+    };
+
+    /**
+     * @brief Write a number of spaces to a sink.
+     * @tparam Sink Type with a `write(const char*, std::size_t)`
+     *              member function.
+     * @param sink Destination.
+     * @param count Number of spaces.
      */
-    bool is_space(char c) {
-      return std::isspace(static_cast<unsigned char>(c));
+    template <typename Sink>
+    void write_spaces(Sink& sink, int count) {
+      static const char spaces[] = "                                ";
+      const int chunk = static_cast<int>(sizeof(spaces) - 1);
+      for (; count > chunk; count -= chunk)
+        sink.write(spaces, chunk);
+      if (count > 0)
+        sink.write(spaces, static_cast<std::size_t>(count));
     }
 
     /**
      * @brief Performs word-wrapping for a single line of text.
      *
-     * This is a helper function for `wrap_text`.
+     * This is a helper function for `wrap_into`.
      *
-     * @param str Text to wrap.
+     * @tparam Sink Type with a `write(const char*, std::size_t)`
+     *              member function.
+     * @param sink Destination for the wrapped text.
+     * @param str Text to wrap, which contains no newlines.
      * @param line_len Maximum desired line length, if any.
      * @param indent Number of spaces to indent each line.
      * @param first_line_indent Number of spaces to indent the
      *                          first line.
-     * @return Resulting word-wrapped string.
+     * @return True if anything was written to `sink`.
      */
-    std::string wrap_line(const std::string& str,
-                          int line_len,
-                          int indent,
-                          int first_line_indent) {
+    template <typename Sink>
+    bool wrap_line(Sink& sink, token_view str,
+                   int line_len, int indent, int first_line_indent) {
       // Check for unlimited length
-      if (line_len <= 0)
-        return std::string(first_line_indent, ' ') + str;
+      if (line_len <= 0) {
+        write_spaces(sink, first_line_indent);
+        sink.write(str.data(), str.size());
+        return first_line_indent > 0 || !str.empty();
+      }
 
       // Validate indentation
       if (indent < 0)
@@ -71,30 +962,38 @@ namespace optionpp {
       else if (first_line_indent > line_len - 1)
         first_line_indent = line_len - 1;
 
-      std::string result;
-      std::string::size_type pos{0};
+      const char_class& space = whitespace();
+      const bool ascii = is_ascii(str.begin(), str.end());
+      bool written = false;
+      std::size_t pos{0};
 
       while (pos < str.size()) {
-        int cur_indent = result.empty() ? first_line_indent : indent;
+        int cur_indent = written ? indent : first_line_indent;
         auto start = pos;
 
         // After the first line, new lines should start at non-whitespace
         // characters
-        if (!result.empty()) {
-          while (start < str.size() && is_space(str[start]))
+        if (written) {
+          while (start < str.size() && space.contains(str[start]))
             ++start;
         }
 
-        // Find ideal end point
-        auto end = start + line_len - cur_indent;
-        if (end > str.size())
-          end = str.size();
+        // Find ideal end point. Outside of ASCII, characters can take
+        // more or fewer bytes than columns.
+        std::size_t end;
+        if (ascii) {
+          end = start + line_len - cur_indent;
+          if (end > str.size())
+            end = str.size();
+        } else {
+          end = advance_columns(str, start, line_len - cur_indent);
+        }
 
         // We don't want to split in the middle of a word unless we don't
         // have a choice
         if (end < str.size()) {
           auto word_start = end;
-          while (word_start > start && !is_space(str[word_start]))
+          while (word_start > start && !space.contains(str[word_start]))
             --word_start;
 
           if (word_start > start)
@@ -105,20 +1004,241 @@ namespace optionpp {
         pos = end;
 
         // We don't want trailing whitespace
-        while (end > start && is_space(str[end - 1]))
+        while (end > start && space.contains(str[end - 1]))
           --end;
 
-        // Add line to result
+        // Write the line
         if (end > start) {
-          if (!result.empty())
-            result.push_back('\n');
-          if (cur_indent > 0)
-            result += std::string(cur_indent, ' ');
-          result += str.substr(start, end - start);
+          if (written)
+            sink.write("\n", 1);
+          write_spaces(sink, cur_indent);
+          sink.write(str.data() + start, end - start);
+          written = true;
         }
       }
 
-      return result;
+      return written;
+    }
+
+    /**
+     * @brief Perform word-wrapping, writing the result to a sink.
+     *
+     * This implements `wrap_text` and `write_wrapped`.
+     *
+     * @tparam Sink Type with a `write(const char*, std::size_t)`
+     *              member function.
+     * @param sink Destination for the wrapped text.
+     * @param str Text to wrap.
+     * @param line_len Maximum desired line length, if any.
+     * @param indent Number of spaces to indent each line after the
+     *               first one.
+     * @param first_line_indent Number of spaces to indent the first
+     *                          line.
+     */
+    template <typename Sink>
+    void wrap_into(Sink& sink, token_view str,
+                   int line_len, int indent, int first_line_indent) {
+      // Wrap each line separately. Lines are only separated once
+      // something has been written, so leading empty lines are dropped.
+      const char* line = str.begin();
+      bool written = false;
+      for (;;) {
+        const char* line_end = std::find(line, str.end(), '\n');
+        if (written)
+          sink.write("\n", 1);
+        if (wrap_line(sink, token_view{line, static_cast<std::size_t>(line_end - line)},
+                      line_len, indent, first_line_indent))
+          written = true;
+        if (line_end == str.end())
+          break;
+
+        line = line_end + 1;
+        first_line_indent = indent;
+      }
+    }
+
+    /**
+     * @brief Read a non-negative decimal number from a string.
+     *
+     * This is a helper function for `parse_duration` and
+     * `parse_size`. The integer and fractional parts are stored
+     * separately so that they can be scaled exactly.
+     *
+     * @param str String to read from.
+     * @param pos Position at which to start reading. On return, this
+     *            is set to the position after the number.
+     * @param int_part Set to the integer part of the number.
+     * @param frac Set to the fraction part of the number, as a
+     *             numerator of `frac_scale`.
+     * @param frac_scale Set to the denominator of the fraction (a
+     *                   power of ten, at most 10^9).
+     * @throw std::invalid_argument If there is no number at `pos`.
+     * @throw std::out_of_range If the integer part is too large.
+     */
+    void read_decimal(const std::string& str, std::string::size_type& pos,
+                      std::uint64_t& int_part, std::uint64_t& frac,
+                      std::uint64_t& frac_scale) {
+      const auto max = std::numeric_limits<std::uint64_t>::max();
+      bool has_digits = false;
+
+      int_part = 0;
+      while (pos < str.size() && std::isdigit(static_cast<unsigned char>(str[pos]))) {
+        unsigned digit = str[pos] - '0';
+        if (int_part > (max - digit) / 10)
+          throw std::out_of_range{"out of range"};
+        int_part = int_part * 10 + digit;
+        has_digits = true;
+        ++pos;
+      }
+
+      frac = 0;
+      frac_scale = 1;
+      if (pos < str.size() && str[pos] == '.') {
+        ++pos;
+        while (pos < str.size() && std::isdigit(static_cast<unsigned char>(str[pos]))) {
+          // Digits beyond the ninth are truncated
+          if (frac_scale < 1000000000) {
+            frac = frac * 10 + (str[pos] - '0');
+            frac_scale *= 10;
+          }
+          has_digits = true;
+          ++pos;
+        }
+      }
+
+      if (!has_digits)
+        throw std::invalid_argument{"invalid argument"};
+    }
+
+    /**
+     * @brief Scale a decimal number by an integer unit.
+     *
+     * This is a helper function for `parse_duration` and
+     * `parse_size`.
+     *
+     * @param int_part Integer part of the number.
+     * @param frac Fraction part of the number, as a numerator of
+     *             `frac_scale`.
+     * @param frac_scale Denominator of the fraction.
+     * @param unit Number to multiply by.
+     * @param max Largest acceptable result.
+     * @return The product, with any fractional part truncated.
+     * @throw std::out_of_range If the result is larger than `max`.
+     */
+    std::uint64_t scale_decimal(std::uint64_t int_part, std::uint64_t frac,
+                                std::uint64_t frac_scale, std::uint64_t unit,
+                                std::uint64_t max) {
+      if (unit != 0 && int_part > max / unit)
+        throw std::out_of_range{"out of range"};
+      std::uint64_t result = int_part * unit;
+
+      // Split the unit so that neither product can overflow, given
+      // that frac < frac_scale <= 10^9
+      std::uint64_t frac_result = frac * (unit / frac_scale)
+        + frac * (unit % frac_scale) / frac_scale;
+
+      if (frac_result > max - result)
+        throw std::out_of_range{"out of range"};
+      return result + frac_result;
+    }
+
+    std::chrono::nanoseconds parse_duration(const std::string& str) {
+      struct unit_info {
+        const char* name;
+        std::uint64_t nanoseconds;
+      };
+      static const unit_info units[] = {
+        {"ns", 1ull},
+        {"us", 1000ull},
+        {"ms", 1000000ull},
+        {"s", 1000000000ull},
+        {"min", 60000000000ull},
+        {"m", 60000000000ull},
+        {"h", 3600000000000ull},
+        {"d", 86400000000000ull}
+      };
+
+      const std::uint64_t max = std::numeric_limits<std::chrono::nanoseconds::rep>::max();
+      std::uint64_t total = 0;
+      std::string::size_type pos = 0;
+      bool first = true;
+
+      do {
+        std::uint64_t int_part, frac, frac_scale;
+        read_decimal(str, pos, int_part, frac, frac_scale);
+
+        // Find the unit
+        std::uint64_t unit = 0;
+        auto unit_start = pos;
+        while (pos < str.size() && std::isalpha(static_cast<unsigned char>(str[pos])))
+          ++pos;
+        if (unit_start == pos) {
+          // A lone number is a number of seconds
+          if (!first || pos != str.size())
+            throw std::invalid_argument{"invalid argument"};
+          unit = 1000000000ull;
+        } else {
+          for (const auto& u : units) {
+            if (is_substr_at_pos(str, u.name, unit_start)
+                && std::char_traits<char>::length(u.name) == pos - unit_start) {
+              unit = u.nanoseconds;
+              break;
+            }
+          }
+          if (unit == 0)
+            throw std::invalid_argument{"invalid argument"};
+        }
+
+        auto value = scale_decimal(int_part, frac, frac_scale, unit, max);
+        if (value > max - total)
+          throw std::out_of_range{"out of range"};
+        total += value;
+        first = false;
+      } while (pos < str.size());
+
+      return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(total)};
+    }
+
+    std::uint64_t parse_size(const std::string& str) {
+      std::uint64_t int_part, frac, frac_scale;
+      std::string::size_type pos = 0;
+      read_decimal(str, pos, int_part, frac, frac_scale);
+
+      // Parse unit: [prefix][i][B]
+      std::uint64_t unit = 1;
+      if (pos < str.size()) {
+        static const char prefixes[] = "kmgtpe";
+        const char* prefix = nullptr;
+        char c = static_cast<char>(std::tolower(static_cast<unsigned char>(str[pos])));
+        for (const char* p = prefixes; *p; ++p) {
+          if (*p == c)
+            prefix = p;
+        }
+
+        if (prefix) {
+          ++pos;
+          std::uint64_t base = 1024;
+          if (pos < str.size() && str[pos] == 'i') {
+            ++pos;
+            if (pos == str.size() || str[pos] != 'B')
+              throw std::invalid_argument{"invalid argument"};
+            ++pos;
+          } else if (pos < str.size() && str[pos] == 'B') {
+            base = 1000;
+            ++pos;
+          }
+          for (const char* p = prefixes; p <= prefix; ++p)
+            unit *= base;
+        } else if (str[pos] == 'B') {
+          ++pos;
+        }
+
+        if (pos != str.size())
+          throw std::invalid_argument{"invalid argument"};
+      }
+
+      return scale_decimal(int_part, frac, frac_scale, unit,
+                           std::numeric_limits<std::uint64_t>::max());
     }
 
     std::string wrap_text(const std::string& str,
@@ -131,20 +1251,39 @@ namespace optionpp {
                           int line_len,
                           int indent,
                           int first_line_indent) {
-      std::vector<std::string> lines;
-      split(str, std::back_inserter(lines), "\n", "", '\0', true);
-
       std::string result;
-      for (const auto& line : lines) {
-        if (!result.empty())
-          result.push_back('\n');
-        result += wrap_line(line, line_len, indent, first_line_indent);
-        first_line_indent = indent;
-      }
-
+      string_sink sink{result};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
       return result;
     }
 
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len, int indent) {
+      return write_wrapped(os, str, line_len, indent, indent);
+    }
+
+    std::ostream& write_wrapped(std::ostream& os, token_view str,
+                                int line_len, int indent,
+                                int first_line_indent) {
+      stream_sink sink{os};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
+      return os;
+    }
+
+    void write_wrapped(std::FILE* file, token_view str,
+                       int line_len, int indent, int first_line_indent) {
+      file_sink sink{file};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
+    }
+
+    std::size_t write_wrapped(char* buffer, std::size_t size, token_view str,
+                              int line_len, int indent,
+                              int first_line_indent) noexcept {
+      buffer_sink sink{buffer, size};
+      wrap_into(sink, str, line_len, indent, first_line_indent);
+      return sink.length();
+    }
+
     bool is_substr_at_pos(const std::string& str, const std::string& substr,
                           typename std::string::size_type pos) noexcept {
       if (pos + substr.size() > str.size())
@@ -158,5 +1297,76 @@ namespace optionpp {
       return true;
     }
 
+    std::size_t edit_distance(token_view a, token_view b,
+                              std::size_t max_distance) {
+      std::size_t m = a.size();
+      std::size_t n = b.size();
+      if ((m > n ? m - n : n - m) > max_distance)
+        return max_distance + 1;
+      if (m == 0 || n == 0)
+        return m + n; // At most max_distance here
+
+      // Lowrance-Wagner algorithm. Row i + 1 and column j + 1 hold
+      // the distances between prefixes of length i and j; the extra
+      // row and column hold a value larger than any distance.
+      const std::size_t width = n + 2;
+      std::size_t small[32 * 32];
+      std::vector<std::size_t> large;
+      std::size_t* d = small;
+      if ((m + 2) * width > sizeof(small) / sizeof(small[0])) {
+        large.resize((m + 2) * width);
+        d = large.data();
+      }
+
+      const std::size_t infinity = m + n;
+      std::fill(d, d + width, infinity);
+      for (std::size_t i = 0; i <= m; ++i) {
+        d[(i + 1) * width] = infinity;
+        d[(i + 1) * width + 1] = i;
+      }
+      for (std::size_t j = 0; j <= n; ++j)
+        d[width + j + 1] = j;
+
+      // Last row in which each byte value was seen in a. Only the
+      // entries for bytes of a and b are ever read.
+      std::size_t last_row[256];
+      for (std::size_t i = 0; i != m; ++i)
+        last_row[static_cast<unsigned char>(a[i])] = 0;
+      for (std::size_t j = 0; j != n; ++j)
+        last_row[static_cast<unsigned char>(b[j])] = 0;
+
+      for (std::size_t i = 1; i <= m; ++i) {
+        const std::size_t* above = d + i * width;
+        std::size_t* row = d + (i + 1) * width;
+        const char ai = a[i - 1];
+        std::size_t last_match_col = 0;
+        std::size_t row_min = i;
+        for (std::size_t j = 1; j <= n; ++j) {
+          std::size_t k = last_row[static_cast<unsigned char>(b[j - 1])];
+          std::size_t l = last_match_col;
+          std::size_t value;
+          if (ai == b[j - 1]) {
+            value = above[j];
+            last_match_col = j;
+          } else {
+            value = std::min(above[j], std::min(row[j], above[j + 1])) + 1;
+          }
+
+          // Transpose, deleting and inserting what lies between
+          value = std::min(value, d[k * width + l] + (i - k) + (j - l) - 1);
+          row[j + 1] = value;
+          row_min = std::min(row_min, value);
+        }
+        last_row[static_cast<unsigned char>(ai)] = i;
+
+        // Every edit sequence passes through this row, so no later
+        // row can do better
+        if (row_min > max_distance)
+          return max_distance + 1;
+      }
+
+      return std::min(d[(m + 1) * width + n + 1], max_distance + 1);
+    }
+
   } // End namespace utility
 } // End namespace optionpp
@@ -0,0 +1,219 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+/**
+ * @file
+ * @brief Source file for `write_log` class implementation.
+ */
+
+#include <optionpp/write_log.hpp>
+
+#include <limits>
+#include <optionpp/error.hpp>
+
+namespace optionpp {
+
+  void write_log::commit() {
+    // Clear the log even if a write throws
+    struct clear_guard {
+      write_log& log;
+      ~clear_guard() { log.clear(); }
+    } guard{*this};
+
+    static const std::string no_argument;
+    auto staged = m_staged.begin();
+    for (const auto& r : m_records) {
+      const option& opt = *r.opt;
+      if (r.type == write_type::custom_write) {
+        // Converters that store their own results run only now
+        const arg_callback& store = *staged++;
+        if (store)
+          store(no_argument);
+        else if (!m_record_unbound && opt.has_bound_argument_variable())
+          opt.write_custom(std::string(m_strings, r.str.pos, r.str.len));
+        continue;
+      }
+
+      if (r.type != write_type::bool_write
+          && !opt.has_bound_argument_variable())
+        continue; // Recorded for a binding_map, not for the option
+
+      switch (r.type) {
+      case write_type::bool_write:
+        opt.write_bool(r.int_value != 0);
+        break;
+      case write_type::string_write:
+        opt.write_string(m_strings.data() + r.str.pos, r.str.len);
+        break;
+      case write_type::int_write:
+        opt.write_int(static_cast<int>(r.int_value));
+        break;
+      case write_type::uint_write:
+        opt.write_uint(static_cast<unsigned int>(r.uint_value));
+        break;
+      case write_type::double_write:
+        opt.write_double(r.double_value);
+        break;
+      case write_type::duration_write:
+        opt.write_duration(std::chrono::nanoseconds{r.int_value});
+        break;
+      case write_type::size_write:
+        opt.write_size(r.uint_value);
+        break;
+      case write_type::enum_write:
+        opt.write_enum(static_cast<choice_table::size_type>(r.uint_value));
+        break;
+      case write_type::custom_write:
+        break; // Handled above
+      }
+    }
+  }
+
+  void write_log::write_bool(const option& opt, bool value) {
+    if (!m_deferred) {
+      opt.write_bool(value);
+      return;
+    }
+
+    record r;
+    r.opt = &opt;
+    r.type = write_type::bool_write;
+    r.int_value = value;
+    m_records.push_back(r);
+  }
+
+  void write_log::write_string(const option& opt, const std::string& value) {
+    if (m_deferred)
+      record_string(opt, write_type::string_write, value);
+    else
+      opt.write_string(value);
+  }
+
+  void write_log::write_int(const option& opt, int value) {
+    if (!m_deferred) {
+      opt.write_int(value);
+      return;
+    }
+
+    record r;
+    r.opt = &opt;
+    r.type = write_type::int_write;
+    r.int_value = value;
+    m_records.push_back(r);
+  }
+
+  void write_log::write_uint(const option& opt, unsigned int value) {
+    if (!m_deferred) {
+      opt.write_uint(value);
+      return;
+    }
+
+    record r;
+    r.opt = &opt;
+    r.type = write_type::uint_write;
+    r.uint_value = value;
+    m_records.push_back(r);
+  }
+
+  void write_log::write_double(const option& opt, double value) {
+    if (!m_deferred) {
+      opt.write_double(value);
+      return;
+    }
+
+    record r;
+    r.opt = &opt;
+    r.type = write_type::double_write;
+    r.double_value = value;
+    m_records.push_back(r);
+  }
+
+  void write_log::write_duration(const option& opt,
+                                 std::chrono::nanoseconds value) {
+    if (!m_deferred) {
+      opt.write_duration(value);
+      return;
+    }
+
+    record r;
+    r.opt = &opt;
+    r.type = write_type::duration_write;
+    r.int_value = value.count();
+    m_records.push_back(r);
+  }
+
+  void write_log::write_size(const option& opt, std::uint64_t value) {
+    if (!m_deferred) {
+      opt.write_size(value);
+      return;
+    }
+
+    record r;
+    r.opt = &opt;
+    r.type = write_type::size_write;
+    r.uint_value = value;
+    m_records.push_back(r);
+  }
+
+  void write_log::write_enum(const option& opt, choice_table::size_type index) {
+    if (!m_deferred) {
+      opt.write_enum(index);
+      return;
+    }
+
+    record r;
+    r.opt = &opt;
+    r.type = write_type::enum_write;
+    r.uint_value = index;
+    m_records.push_back(r);
+  }
+
+  bool write_log::write_custom(const option& opt, const std::string& value) {
+    if (!m_deferred)
+      return opt.write_custom(value);
+
+    // Arguments recorded for a binding_map are stored as strings, so
+    // the option's converter is not called
+    arg_callback store;
+    if (!m_record_unbound && opt.has_bound_argument_variable()
+        && !opt.stage_custom(value, store))
+      return false;
+
+    record_string(opt, write_type::custom_write, value);
+    m_staged.push_back(std::move(store));
+    return true;
+  }
+
+  void write_log::record_string(const option& opt, write_type type,
+                                const std::string& value) {
+    constexpr std::size_t max_size = std::numeric_limits<std::uint32_t>::max();
+    if (value.size() > max_size - m_strings.size())
+      throw out_of_range{"too much string data to record",
+          "optionpp::write_log::record_string"};
+
+    record r;
+    r.opt = &opt;
+    r.type = type;
+    r.str.pos = static_cast<std::uint32_t>(m_strings.size());
+    r.str.len = static_cast<std::uint32_t>(value.size());
+    m_strings += value;
+    m_records.push_back(r);
+  }
+
+} // End namespace
@@ -0,0 +1,45 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+#include <optionpp/parser.hpp>
+
+/*
+ * Options whose help text is pre-rendered at build time by
+ * optionpp_add_static_help and compared with print_help in
+ * tst_static_help.cpp. The descriptions include characters that need
+ * escaping in a C++ string literal.
+ */
+void define_static_help_options(optionpp::parser& p) {
+  p["help"].short_name('?')
+    .description("Show help information");
+  p["version"]
+    .description("Show version information");
+
+  p.group("Output \"formatting\"")["indent"].short_name('i')
+    .argument("N", false)
+    .description("Indent by N spaces. What?? The default is 4; "
+                 "use a backslash (\\) to escape a path like C:\\tmp, "
+                 "and ?\?= is not a trigraph.");
+  p.group("Output \"formatting\"")["width"].short_name('w')
+    .argument("COLUMNS")
+    .description("Wrap lines at COLUMNS characters \xe2\x80\x94 "
+                 "the help text itself is wrapped at the width given "
+                 "to the build, so this description is long enough to "
+                 "span several lines.");
+}
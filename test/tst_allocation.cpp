@@ -0,0 +1,223 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <optionpp/parser.hpp>
+
+using namespace optionpp;
+using namespace optionpp::literals;
+
+// Count every allocation made by the test program, including those
+// made inside the library
+namespace {
+  std::atomic<std::size_t> allocation_count{0};
+}
+
+void* operator new(std::size_t size) {
+  ++allocation_count;
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+TEST_CASE("allocation") {
+  parser p;
+  p.group("").reserve(8);
+
+  SECTION("literal registration") {
+    std::size_t before = allocation_count;
+    p["verbose"_static].short_name('v')
+      .description("Show more output"_static);
+    p["output-directory-for-generated-files"_static].short_name('o')
+      .argument("DIRECTORY"_static)
+      .description("Directory in which to write the generated files"_static);
+    p["quiet"_static].name("silent"_static, 's');
+    std::size_t after = allocation_count;
+
+    REQUIRE(after == before);
+    REQUIRE(p.group("").size() == 3);
+    REQUIRE(p["output-directory-for-generated-files"].argument_name()
+            == "DIRECTORY");
+    REQUIRE(p["silent"].short_name() == 's');
+  }
+
+  SECTION("literal lookup") {
+    p["verbose"_static].short_name('v');
+    p['q'].long_name("quiet"_static);
+
+    std::size_t before = allocation_count;
+    option& verbose = p["verbose"_static];
+    option& quiet = p["quiet"_static];
+    std::size_t after = allocation_count;
+
+    REQUIRE(after == before);
+    REQUIRE(verbose.short_name() == 'v');
+    REQUIRE(quiet.short_name() == 'q');
+    REQUIRE(p.group("").size() == 2);
+  }
+
+  SECTION("literals without the suffix are copied") {
+    char name[] = "buffer";
+    char desc[] = "From a buffer";
+    p[name].description(desc);
+    name[0] = 'x';
+    desc[0] = 'x';
+
+    REQUIRE(p.group("").begin()->long_name() == "buffer");
+    REQUIRE(p.group("").begin()->description() == "From a buffer");
+
+    // Without the suffix, even literals are copied
+    std::size_t before = allocation_count;
+    p["a-name-longer-than-fits-in-a-string"]
+      .description("A description longer than fits in a string");
+    std::size_t after = allocation_count;
+    REQUIRE(after > before);
+  }
+}
+
+TEST_CASE("move-aware registration") {
+  const std::size_t count = 1000;
+
+  // Choices make an option expensive to copy
+  std::vector<std::string> names;
+  std::vector<option> options;
+  for (std::size_t i = 0; i != count; ++i) {
+    names.push_back("option-" + std::to_string(i));
+    options.emplace_back(names.back(), 'x', "description");
+    options.back().choices({"fast", "slow"});
+  }
+
+  REQUIRE(std::is_nothrow_move_constructible<option>::value);
+  REQUIRE(std::is_nothrow_move_constructible<option_group>::value);
+
+  SECTION("moving options") {
+    parser p;
+    p.group("").reserve(count);
+
+    std::size_t before = allocation_count;
+    for (auto& opt : options)
+      p.add_option(std::move(opt));
+    std::size_t after = allocation_count;
+
+    REQUIRE(after == before);
+    REQUIRE(p.group("").size() == count);
+    REQUIRE(p["option-999"].choices().size() == 2);
+  }
+
+  SECTION("copying options") {
+    parser p;
+    p.group("").reserve(count);
+
+    std::size_t before = allocation_count;
+    for (const auto& opt : options)
+      p.add_option(opt);
+    std::size_t after = allocation_count;
+
+    REQUIRE(after - before >= count);
+    REQUIRE(options.back().choices().size() == 2);
+  }
+
+  SECTION("emplacing options") {
+    parser p;
+    p.group("").reserve(count);
+
+    // The strings are short enough to be stored inside the options
+    std::size_t before = allocation_count;
+    for (const auto& name : names)
+      p.emplace_option(name, 'x', "description");
+    std::size_t after = allocation_count;
+
+    REQUIRE(after == before);
+    REQUIRE(p.group("").size() == count);
+    REQUIRE(p["option-500"].description() == "description");
+  }
+
+  SECTION("growing") {
+    option_group group{"Group"};
+
+    // Only the container is reallocated; the options are moved
+    std::size_t before = allocation_count;
+    for (auto& opt : options)
+      group.add_option(std::move(opt));
+    std::size_t after = allocation_count;
+
+    REQUIRE(after - before < count / 10);
+    REQUIRE(group.size() == count);
+    REQUIRE(group["option-0"].choices().size() == 2);
+  }
+}
+
+TEST_CASE("error allocation") {
+  std::string msg(100, 'm');
+  std::string fn_name(100, 'f');
+  std::string opt_name(100, 'o');
+  std::vector<std::string> suggestions{std::string(100, 's')};
+
+  SECTION("parse_error") {
+    std::size_t before = allocation_count;
+    std::size_t after = before;
+    try {
+      throw parse_error{std::move(msg), std::move(fn_name),
+          std::move(opt_name), std::move(suggestions)};
+    } catch (const parse_error& e) {
+      after = allocation_count;
+      REQUIRE(e.what() == std::string(100, 'm'));
+      REQUIRE(e.function() == std::string(100, 'f'));
+      REQUIRE(e.option() == std::string(100, 'o'));
+      REQUIRE(e.suggestions().size() == 1);
+    }
+
+    // Only std::logic_error's own copy of the message is allocated
+    REQUIRE(after - before == 1);
+  }
+
+  SECTION("file_error") {
+    std::size_t before = allocation_count;
+    std::size_t after = before;
+    try {
+      throw file_error{std::move(msg), std::move(fn_name),
+          std::move(opt_name)};
+    } catch (const file_error& e) {
+      after = allocation_count;
+      REQUIRE(e.path() == std::string(100, 'o'));
+    }
+
+    REQUIRE(after - before == 1);
+  }
+}
@@ -0,0 +1,73 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <optionpp/choice_table.hpp>
+
+using namespace optionpp;
+
+TEST_CASE("choice_table") {
+  SECTION("empty") {
+    choice_table empty;
+    REQUIRE(empty.empty());
+    REQUIRE(empty.size() == 0);
+    REQUIRE(empty.find("") == choice_table::npos);
+    REQUIRE(empty.find("abc") == choice_table::npos);
+    REQUIRE(empty.to_string() == "");
+  }
+
+  SECTION("names") {
+    choice_table modes{std::vector<std::string>{"fast", "safe", "paranoid"}};
+    REQUIRE(modes.size() == 3);
+    REQUIRE(modes.find("fast") == 0);
+    REQUIRE(modes.find("safe") == 1);
+    REQUIRE(modes.find("paranoid") == 2);
+    REQUIRE(modes.find("Fast") == choice_table::npos);
+    REQUIRE(modes.find("") == choice_table::npos);
+    REQUIRE(modes.find("paranoi") == choice_table::npos);
+    REQUIRE(modes.value(2) == 2);
+    REQUIRE(modes.name(1) == "safe");
+    REQUIRE(modes.to_string() == "fast, safe, paranoid");
+    REQUIRE(modes.to_string("|") == "fast|safe|paranoid");
+  }
+
+  SECTION("values and duplicates") {
+    choice_table levels{std::vector<std::pair<std::string, long long>>{
+        {"low", 10}, {"high", 30}, {"low", 20}, {"", -1}}};
+    REQUIRE(levels.size() == 3);
+    REQUIRE(levels.value(levels.find("low")) == 10);
+    REQUIRE(levels.value(levels.find("high")) == 30);
+    REQUIRE(levels.value(levels.find("")) == -1);
+    REQUIRE(levels.to_string() == "low, high, ");
+  }
+
+  SECTION("many choices") {
+    std::vector<std::string> names;
+    for (int i = 0; i < 2000; ++i)
+      names.push_back("choice" + std::to_string(i));
+    choice_table table{names};
+    REQUIRE(table.size() == names.size());
+    for (std::size_t i = 0; i < names.size(); ++i)
+      REQUIRE(table.find(names[i]) == i);
+    REQUIRE(table.find("choice2000") == choice_table::npos);
+    REQUIRE(table.find("choice") == choice_table::npos);
+  }
+}
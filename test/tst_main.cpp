@@ -20,4 +20,7 @@
 // Catch2 needs this to be in exactly one
 // translation unit
 #define CATCH_CONFIG_MAIN
+
+// Catch2 2.x uses a non-constant MINSIGSTKSZ with newer glibc
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include <catch2/catch.hpp>
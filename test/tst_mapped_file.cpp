@@ -0,0 +1,84 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <catch2/catch.hpp>
+#include <optionpp/error.hpp>
+#include <optionpp/mapped_file.hpp>
+
+using namespace optionpp;
+
+TEST_CASE("mapped_file") {
+  const std::string path{"optionpp_tst_mapped_file.txt"};
+  const std::string empty_path{"optionpp_tst_mapped_file_empty.txt"};
+  const std::string contents{"first line\nsecond line\n"};
+  std::ofstream{path, std::ios::binary} << contents;
+  std::ofstream{empty_path, std::ios::binary};
+
+  SECTION("default") {
+    mapped_file file;
+    REQUIRE(file.size() == 0);
+    REQUIRE(file.data() != nullptr);
+  }
+
+  SECTION("contents") {
+    mapped_file file{path};
+    REQUIRE(std::string(file.data(), file.size()) == contents);
+
+    mapped_file again{path};
+    REQUIRE(again.id() == file.id());
+
+    mapped_file other{empty_path};
+    REQUIRE(other.size() == 0);
+    REQUIRE(other.id() != file.id());
+  }
+
+  SECTION("move") {
+    mapped_file file{path};
+    auto id = file.id();
+    mapped_file moved{std::move(file)};
+    REQUIRE(file.size() == 0);
+    REQUIRE(moved.id() == id);
+    REQUIRE(std::string(moved.data(), moved.size()) == contents);
+
+    file = std::move(moved);
+    REQUIRE(moved.size() == 0);
+    REQUIRE(std::string(file.data(), file.size()) == contents);
+
+    file.close();
+    REQUIRE(file.size() == 0);
+  }
+
+  SECTION("missing file") {
+    REQUIRE_THROWS_AS(mapped_file{"optionpp_tst_no_such_file.txt"},
+                      file_error);
+    try {
+      mapped_file file{"optionpp_tst_no_such_file.txt"};
+    } catch (const file_error& e) {
+      REQUIRE(e.path() == "optionpp_tst_no_such_file.txt");
+    }
+  }
+
+  std::remove(path.c_str());
+  std::remove(empty_path.c_str());
+}
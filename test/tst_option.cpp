@@ -17,10 +17,16 @@
  */
 /* Written by Greg Kikola <gkikola@gmail.com>. */
 
+#include <array>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
 #include <catch2/catch.hpp>
 #include <optionpp/option.hpp>
 
 using namespace optionpp;
+using namespace optionpp::literals;
 
 TEST_CASE("option") {
   option empty{};
@@ -139,5 +145,206 @@ TEST_CASE("option") {
     REQUIRE(combo.argument_type() == option::double_arg);
     combo.write_double(1.234);
     REQUIRE(dvalue == Approx(1.234));
+
+    std::vector<std::string> list;
+    combo.bind_custom([&](const std::string& arg) {
+      list.push_back(arg);
+      return !arg.empty();
+    });
+    REQUIRE(combo.argument_type() == option::custom_arg);
+    REQUIRE(combo.has_bound_argument_variable());
+    REQUIRE(combo.write_custom("first"));
+    REQUIRE_FALSE(combo.write_custom(""));
+    REQUIRE(list == std::vector<std::string>{"first", ""});
+    REQUIRE_THROWS_WITH(combo.write_string("Hello"),
+                        "option 'all' does not accept a string argument");
+    arg_callback store;
+    REQUIRE(combo.stage_custom("second", store));
+    REQUIRE_FALSE(store);
+    REQUIRE(list.size() == 2);
+
+    std::pair<int, int> size{1, 1};
+    combo.bind_custom(&size, [](const std::string& arg,
+                                std::pair<int, int>& value) {
+      auto x = arg.find('x');
+      if (x == std::string::npos)
+        return false;
+      value.first = std::stoi(arg.substr(0, x));
+      value.second = std::stoi(arg.substr(x + 1));
+      return true;
+    });
+    REQUIRE(combo.has_bound_argument_variable());
+    REQUIRE(combo.write_custom("640x480"));
+    REQUIRE(size == std::make_pair(640, 480));
+    REQUIRE_FALSE(combo.write_custom("640"));
+    REQUIRE(size == std::make_pair(640, 480));
+
+    REQUIRE(combo.stage_custom("800x600", store));
+    REQUIRE(store);
+    REQUIRE(size == std::make_pair(640, 480));
+    store("");
+    REQUIRE(size == std::make_pair(800, 600));
+
+    std::string text;
+    combo.bind_string(&text);
+    combo.write_string("abcdef", 3);
+    REQUIRE(text == "abc");
+
+    combo.bind_int(&ivalue);
+    REQUIRE_THROWS_WITH(combo.write_custom("Hello"),
+                        "option 'all' does not accept a custom argument");
+    REQUIRE_THROWS_WITH(combo.stage_custom("Hello", store),
+                        "option 'all' does not accept a custom argument");
+  }
+
+  SECTION("validator") {
+    REQUIRE(combo.validate("anything"));
+    combo.validator([](const std::string& arg) { return arg.size() < 4; });
+    REQUIRE(combo.validate("abc"));
+    REQUIRE_FALSE(combo.validate("abcd"));
+
+    option copy{combo};
+    REQUIRE_FALSE(copy.validate("abcd"));
+  }
+
+  SECTION("string storage") {
+    // Strings are copied
+    std::string name = "version";
+    long_name_only.long_name(name);
+    name = "changed";
+    REQUIRE(long_name_only.long_name() == "version");
+    std::string ref = long_name_only.long_name();
+    REQUIRE(ref.c_str() == std::string{"version"});
+    REQUIRE(ref.find('s') == 3);
+    REQUIRE("--" + ref == "--version");
+
+    // Borrowed text is not
+    char buffer[] = "borrowed";
+    utility::static_string text{buffer};
+    option borrowed;
+    borrowed.long_name(text).argument(text).description(text);
+    buffer[0] = 'x';
+    REQUIRE(borrowed.long_name() == "xorrowed");
+    REQUIRE(borrowed.argument_name() == "xorrowed");
+    REQUIRE(borrowed.description() == "xorrowed");
+    REQUIRE(borrowed.long_name_view().data() == buffer);
+    option copy{borrowed};
+    REQUIRE(copy.description() == "xorrowed");
+    copy = with_argument_req;
+    REQUIRE(copy.argument_name() == "FILE");
+    borrowed.description("owned");
+    REQUIRE(borrowed.description() == "owned");
+
+    // Options can share the strings of a pool
+    utility::string_pool pool;
+    option first{"first"}, second{"second"};
+    first.description(pool.intern("shared description"));
+    second.description(pool.intern(std::string{"shared "} + "description"));
+    REQUIRE(first.description() == "shared description");
+    REQUIRE(pool.stats().strings == 1);
+
+    REQUIRE(first.description_view().data()
+            == second.description_view().data());
+
+    // String literals are borrowed only when marked
+    option lit;
+    lit.long_name("literal"_static).argument("LITERAL"_static)
+      .description("From a literal"_static);
+    REQUIRE(lit.long_name() == "literal");
+    REQUIRE(lit.argument_name() == "LITERAL");
+    REQUIRE(lit.description() == "From a literal");
+    char local[] = "local";
+    lit.name(local, 'l');
+    local[0] = 'x';
+    REQUIRE(lit.long_name() == "local");
+  }
+}
+
+namespace {
+  bool is_yes(const std::string& arg) { return arg == "yes"; }
+}
+
+TEST_CASE("arg_callback") {
+  SECTION("empty") {
+    arg_callback empty;
+    REQUIRE_FALSE(empty);
+    REQUIRE(empty("anything"));
+  }
+
+  SECTION("small callable is stored inline") {
+    int calls{};
+    arg_callback fn{[&](const std::string& arg) {
+      ++calls;
+      return arg == "yes";
+    }};
+    REQUIRE(fn);
+    REQUIRE(fn.is_inline());
+    REQUIRE(fn("yes"));
+    REQUIRE_FALSE(fn("no"));
+    REQUIRE(calls == 2);
+
+    arg_callback copy{fn};
+    REQUIRE(copy("yes"));
+    REQUIRE(calls == 3);
+
+    arg_callback moved{std::move(copy)};
+    REQUIRE_FALSE(copy);
+    REQUIRE(moved("yes"));
+    REQUIRE(calls == 4);
+  }
+
+  SECTION("large callable") {
+    std::array<char, 2 * arg_callback::buffer_size> big{};
+    big[0] = 'x';
+    arg_callback fn{[big](const std::string& arg) {
+      return !arg.empty() && arg[0] == big[0];
+    }};
+    REQUIRE_FALSE(fn.is_inline());
+    REQUIRE(fn("xyz"));
+
+    arg_callback other{[](const std::string&) { return false; }};
+    other.swap(fn);
+    REQUIRE(other.is_inline() == false);
+    REQUIRE(other("xyz"));
+    REQUIRE_FALSE(fn("xyz"));
+
+    fn = other;
+    REQUIRE(fn("xyz"));
+    fn.reset();
+    REQUIRE_FALSE(fn);
+  }
+
+  SECTION("null callables") {
+    bool (*null_fn)(const std::string&) = nullptr;
+    arg_callback from_pointer{null_fn};
+    REQUIRE_FALSE(from_pointer);
+    REQUIRE(from_pointer("anything"));
+
+    std::function<bool(const std::string&)> empty_function;
+    arg_callback from_function{empty_function};
+    REQUIRE_FALSE(from_function);
+    REQUIRE(from_function("anything"));
+
+    arg_callback from_nullptr{nullptr};
+    REQUIRE_FALSE(from_nullptr);
+
+    arg_callback from_name{is_yes};
+    REQUIRE(from_name);
+    REQUIRE(from_name("yes"));
+    REQUIRE_FALSE(from_name("no"));
+
+    empty_function = is_yes;
+    arg_callback from_nonempty{empty_function};
+    REQUIRE(from_nonempty);
+    REQUIRE_FALSE(from_nonempty("no"));
+
+    REQUIRE(from_name.target<bool (*)(const std::string&)>());
+    REQUIRE(*from_name.target<bool (*)(const std::string&)>() == &is_yes);
+    REQUIRE_FALSE(from_name.target<std::function<bool(const std::string&)>>());
+    REQUIRE_FALSE(from_pointer.target<bool (*)(const std::string&)>());
+
+    option opt;
+    opt.validator(null_fn);
+    REQUIRE(opt.validate("anything"));
   }
 }
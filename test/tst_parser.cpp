@@ -17,14 +17,24 @@
  */
 /* Written by Greg Kikola <gkikola@gmail.com>. */
 
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <exception>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <catch2/catch.hpp>
 #include <optionpp/parser.hpp>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
 using namespace optionpp;
 
 TEST_CASE("parser") {
@@ -176,6 +186,32 @@ TEST_CASE("parser") {
 
     result = empty.parse("");
     REQUIRE(result.empty());
+
+    // Parsing a string should match parsing its split tokens
+    std::vector<std::string> cmd_lines{
+      "myprog -o 'my file' --indent 4 -- -n \"a b\"",
+      "myprog --output=\"x y\" -fo\\ z --color red",
+      "myprog --indent -v --color\t \t",
+      "  'quoted program'  --all  ''  \"\" last"
+    };
+    for (const auto& str : cmd_lines) {
+      for (bool ignore_first : {false, true}) {
+        std::vector<std::string> tokens;
+        utility::split(str, std::back_inserter(tokens), " \t\n\r", "\"'");
+        auto expected = example.parse(tokens.begin(), tokens.end(),
+                                      ignore_first);
+        auto actual = example.parse(str, ignore_first);
+
+        INFO("command line: " << str);
+        REQUIRE(actual.size() == expected.size());
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+          REQUIRE(actual[i].original_text == expected[i].original_text);
+          REQUIRE(actual[i].is_option == expected[i].is_option);
+          REQUIRE(actual[i].argument == expected[i].argument);
+          REQUIRE(actual[i].opt_info == expected[i].opt_info);
+        }
+      }
+    }
   }
 
   SECTION("no options") {
@@ -485,6 +521,480 @@ TEST_CASE("parser") {
     REQUIRE(data.line_nos);
   }
 
+  SECTION("transactional parsing") {
+    REQUIRE_FALSE(example.is_transactional());
+    example.set_transactional(true);
+    REQUIRE(example.is_transactional());
+
+    std::vector<std::string> includes{"default"};
+    example.add_option().long_name("include").short_name('I')
+      .bind_custom(&includes, [](const std::string& arg,
+                                 std::vector<std::string>& dirs) {
+          if (arg.empty() || arg.back() == '/')
+            return false;
+          dirs.push_back(arg);
+          return true;
+        });
+
+    std::vector<std::string> defines;
+    example.add_option().long_name("define").short_name('D')
+      .bind_custom([&](const std::string& arg) {
+          defines.push_back(arg);
+          return true;
+        });
+
+    REQUIRE_THROWS_WITH(example.parse("--help -o out.txt --indent=4 -I dir -D A -x"),
+                        "invalid option: '-x'");
+    REQUIRE_FALSE(data.help);
+    REQUIRE_FALSE(data.has_file);
+    REQUIRE(data.file.empty());
+    REQUIRE(data.indent == 2);
+    REQUIRE(includes == std::vector<std::string>{"default"});
+    REQUIRE(defines.empty());
+
+    REQUIRE_THROWS_WITH(example.parse("-f --indent=4 --indent=x"),
+                        "argument for option '--indent' must be an integer");
+    REQUIRE_FALSE(data.force);
+    REQUIRE(data.indent == 2);
+
+    // Converters reject arguments while parsing, before any writes
+    REQUIRE_THROWS_WITH(example.parse("-f --indent=4 -I dir -I bad/ -o out.txt"),
+                        "invalid argument for option '-I'");
+    REQUIRE_FALSE(data.force);
+    REQUIRE(data.indent == 2);
+    REQUIRE(includes == std::vector<std::string>{"default"});
+
+    auto result = example.parse("--help -o out.txt --indent=4 -I dir -o final.txt -D X");
+    REQUIRE(result.size() == 6);
+    REQUIRE(result.pending_writes().is_deferred());
+    REQUIRE(result.pending_writes().size() == 11);
+    REQUIRE_FALSE(data.help);
+    REQUIRE(data.file.empty());
+    REQUIRE(includes == std::vector<std::string>{"default"});
+
+    // A converter without a bound variable is only called on commit
+    REQUIRE(defines.empty());
+
+    result.commit();
+    REQUIRE(defines == std::vector<std::string>{"X"});
+    REQUIRE(result.pending_writes().empty());
+    REQUIRE(data.help);
+    REQUIRE(data.has_file);
+    REQUIRE(data.file == "final.txt");
+    REQUIRE(data.indent == 4);
+    REQUIRE(includes == std::vector<std::string>{"dir"});
+
+    example.set_transactional(false);
+    result = example.parse("--indent=8");
+    REQUIRE(data.indent == 8);
+    REQUIRE_FALSE(result.pending_writes().is_deferred());
+    REQUIRE(result.pending_writes().empty());
+  }
+
+  SECTION("response files") {
+    std::ofstream{"optionpp_tst_args1.txt"}
+      << "-v --output \"my file.txt\"\n\n  --indent=4 @optionpp_tst_args2.txt\n";
+    std::ofstream{"optionpp_tst_args2.txt"} << "-f cmd\\ 2\t'a b'";
+    std::ofstream{"optionpp_tst_loop1.txt"} << "-v @optionpp_tst_loop2.txt";
+    std::ofstream{"optionpp_tst_loop2.txt"} << "-f @optionpp_tst_loop1.txt";
+    std::ofstream{"optionpp_tst_empty.txt"};
+    std::ofstream{"optionpp_tst_arg.txt"} << "\"arg file.txt\" -n";
+
+    // Disabled by default
+    REQUIRE_FALSE(example.has_response_files());
+    auto result = example.parse("@optionpp_tst_args1.txt");
+    REQUIRE(result.size() == 1);
+    REQUIRE(result[0].original_text == "@optionpp_tst_args1.txt");
+    REQUIRE_FALSE(data.verbose);
+
+    example.set_response_files(true);
+    REQUIRE(example.has_response_files());
+    result = example.parse("cmd1 @optionpp_tst_args1.txt -n");
+    REQUIRE(result.size() == 8);
+    REQUIRE(result[0].original_text == "cmd1");
+    REQUIRE(result[1].original_text == "-v");
+    REQUIRE(result[2].original_text == "--output my file.txt");
+    REQUIRE(result[2].argument == "my file.txt");
+    REQUIRE(result[3].original_text == "--indent=4");
+    REQUIRE(result[4].original_text == "-f");
+    REQUIRE(result[5].original_text == "cmd 2");
+    REQUIRE(result[6].original_text == "a b");
+    REQUIRE(result[7].original_text == "-n");
+    REQUIRE(data.verbose);
+    REQUIRE(data.file == "my file.txt");
+    REQUIRE(data.indent == 4);
+    REQUIRE(data.force);
+
+    std::vector<std::string> args{"myprog", "@optionpp_tst_args2.txt",
+                                  "@optionpp_tst_empty.txt", "--",
+                                  "@optionpp_tst_args1.txt"};
+    result = example.parse(args.begin(), args.end());
+    REQUIRE(result.size() == 4);
+    REQUIRE(result[0].original_text == "-f");
+    REQUIRE(result[2].original_text == "a b");
+    REQUIRE(result[3].original_text == "@optionpp_tst_args1.txt");
+    REQUIRE_FALSE(result[3].is_option);
+
+    // An option's argument can come from a response file
+    result = example.parse("-o @optionpp_tst_arg.txt");
+    REQUIRE(result.size() == 2);
+    REQUIRE(result[0].argument == "arg file.txt");
+    REQUIRE(result[1].original_text == "-n");
+    REQUIRE(data.file == "arg file.txt");
+
+    REQUIRE_THROWS_WITH(example.parse("-o @optionpp_tst_empty.txt"),
+                        "option '-o' requires an argument");
+    REQUIRE_THROWS_WITH(example.parse("@optionpp_tst_loop1.txt"),
+                        "response file 'optionpp_tst_loop1.txt' includes itself");
+    REQUIRE_THROWS_AS(example.parse("@optionpp_tst_missing.txt"), parse_error);
+
+    for (auto name : {"args1", "args2", "loop1", "loop2", "empty", "arg"})
+      std::remove(("optionpp_tst_" + std::string{name} + ".txt").c_str());
+  }
+
+  SECTION("streams") {
+    std::istringstream in{"myprog -v --output 'out file'\n--indent=6 cmd"};
+    auto result = example.parse(in, true);
+    REQUIRE(result.size() == 4);
+    REQUIRE(result[0].original_text == "-v");
+    REQUIRE(result[1].argument == "out file");
+    REQUIRE(result[2].original_text == "--indent=6");
+    REQUIRE(result[3].original_text == "cmd");
+    REQUIRE(data.verbose);
+    REQUIRE(data.file == "out file");
+    REQUIRE(data.indent == 6);
+
+    std::istringstream missing{"-v -o"};
+    REQUIRE_THROWS_WITH(example.parse(missing),
+                        "option '-o' requires an argument");
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    const std::string text{"-f --color=blue"};
+    REQUIRE(write(fds[1], text.data(), text.size())
+            == static_cast<ssize_t>(text.size()));
+    close(fds[1]);
+    result = example.parse_fd(fds[0]);
+    close(fds[0]);
+    REQUIRE(result.size() == 2);
+    REQUIRE(data.force);
+    REQUIRE(data.color == "blue");
+#endif
+  }
+
+  SECTION("dialects") {
+    REQUIRE(example.dialect() == utility::shell_dialect::generic);
+
+    example.set_dialect(utility::shell_dialect::posix);
+    auto result = example.parse("-o 'it'\\''s here' \"\\$x\"");
+    REQUIRE(result.size() == 2);
+    REQUIRE(data.file == "it's here");
+    REQUIRE(result[1].original_text == "$x");
+
+    std::istringstream in{"--color='a b'\\\n -f"};
+    result = example.parse(in);
+    REQUIRE(result.size() == 2);
+    REQUIRE(data.color == "a b");
+
+    example.set_dialect(utility::shell_dialect::windows);
+    result = example.parse("prog.exe -o \"C:\\Program Files\\\\\" 'x y'", true);
+    REQUIRE(result.size() == 3);
+    REQUIRE(data.file == "C:\\Program Files\\");
+    REQUIRE(result[1].original_text == "'x");
+  }
+
+  SECTION("incremental parsing") {
+    std::vector<std::string> args{"myprog", "-v", "--output", "out file",
+                                  "--indent", "4", "cmd", "-c", "red", "--",
+                                  "-f"};
+    auto expected = example.parse(args.begin(), args.end());
+    data = settings{};
+
+    incremental_parser inc{example, true};
+    for (const auto& arg : args) {
+      inc.feed(arg);
+      if (arg == "--output")
+        REQUIRE(inc.awaiting_argument());
+      else if (arg == "out file")
+        REQUIRE_FALSE(inc.awaiting_argument());
+    }
+    REQUIRE(inc.result().size() == expected.size());
+    REQUIRE(data.verbose);
+    REQUIRE(data.file == "out file");
+
+    auto result = inc.finish();
+    REQUIRE(result.size() == expected.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      REQUIRE(result[i].original_text == expected[i].original_text);
+      REQUIRE(result[i].is_option == expected[i].is_option);
+      REQUIRE(result[i].argument == expected[i].argument);
+    }
+    REQUIRE(inc.result().empty());
+    REQUIRE_FALSE(data.force);
+
+    // Reusable after finish, without ignoring the first token
+    inc.feed("-f");
+    REQUIRE(inc.finish().size() == 1);
+    REQUIRE(data.force);
+
+    // An optional argument may still arrive later
+    inc.feed("--indent");
+    REQUIRE(inc.awaiting_argument());
+    result = inc.finish();
+    REQUIRE(result.size() == 1);
+    REQUIRE(result[0].argument.empty());
+
+    inc.feed("-o");
+    REQUIRE_THROWS_WITH(inc.finish(), "option '-o' requires an argument");
+    inc.reset();
+    REQUIRE_THROWS_WITH(inc.feed("--bogus"), "invalid option: '--bogus'");
+    inc.reset(true);
+    inc.feed("--bogus");
+    REQUIRE(inc.finish().empty());
+
+    // Deferred writes when transactional
+    data = settings{};
+    example.set_transactional(true);
+    incremental_parser deferred{example};
+    deferred.feed("-n");
+    result = deferred.finish();
+    REQUIRE_FALSE(data.line_nos);
+    result.commit();
+    REQUIRE(data.line_nos);
+  }
+
+  SECTION("batch parsing") {
+    std::vector<std::string> lines;
+    for (int i = 0; i < 1000; ++i) {
+      if (i % 97 == 0)
+        lines.push_back("--indent=" + std::to_string(i) + " --bogus");
+      else
+        lines.push_back("-v cmd" + std::to_string(i) + " --indent "
+                        + std::to_string(i) + " -o 'file " + std::to_string(i) + "'");
+    }
+
+    for (unsigned threads : {1u, 4u, 16u, 0u}) {
+      auto entries = example.parse_batch(lines.begin(), lines.end(), threads);
+      REQUIRE(entries.size() == lines.size());
+      for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (i % 97 == 0) {
+          REQUIRE_FALSE(entries[i].ok());
+          REQUIRE_THROWS_WITH(std::rethrow_exception(entries[i].error),
+                              "invalid option: '--bogus'");
+        } else {
+          REQUIRE(entries[i].ok());
+          const auto& result = entries[i].result;
+          REQUIRE(result.size() == 4);
+          REQUIRE(result[1].original_text == "cmd" + std::to_string(i));
+          REQUIRE(result[2].argument == std::to_string(i));
+          REQUIRE(result[3].argument == "file " + std::to_string(i));
+          REQUIRE(result.pending_writes().is_deferred());
+        }
+      }
+
+      // Bound variables are only written on commit
+      REQUIRE_FALSE(data.verbose);
+      REQUIRE(data.indent == 2);
+      REQUIRE(data.file.empty());
+
+      entries[5].result.commit();
+      REQUIRE(data.verbose);
+      REQUIRE(data.indent == 5);
+      REQUIRE(data.file == "file 5");
+      data = settings{};
+    }
+
+    // Converters that store their own results run only on commit
+    std::vector<std::string> defines;
+    example["define"].short_name('D').bind_custom([&](const std::string& arg) {
+        defines.push_back(arg);
+        return true;
+      });
+    std::vector<std::string> define_lines;
+    for (int i = 0; i < 200; ++i)
+      define_lines.push_back("-D d" + std::to_string(i));
+    auto defined = example.parse_batch(define_lines.begin(),
+                                       define_lines.end(), 8);
+    REQUIRE(defines.empty());
+    REQUIRE(defined[7].result.pending_writes().size() == 2);
+    defined[7].result.commit();
+    REQUIRE(defines == std::vector<std::string>{"d7"});
+
+    // Other iterator types
+    std::vector<const char*> raw{"-f", "myprog -n", "--color=red x"};
+    auto entries = example.parse_batch(raw.begin(), raw.end(), 2, true);
+    REQUIRE(entries.size() == 3);
+    REQUIRE(entries[0].result.empty());
+    REQUIRE(entries[1].result[0].original_text == "-n");
+    REQUIRE(entries[2].result[0].original_text == "x");
+
+    REQUIRE(example.parse_batch(raw.end(), raw.end()).empty());
+  }
+
+  SECTION("binding maps") {
+    struct request {
+      bool verbose{};
+      bool has_file{};
+      std::string file;
+      unsigned indent{2};
+      int level{};
+      std::string mode;
+      double scale{1.0};
+      std::chrono::milliseconds timeout{};
+      std::uint64_t cache{};
+    };
+
+    // The options only describe the syntax; nothing is bound to them
+    parser shared;
+    shared["verbose"].short_name('v');
+    shared["output"].short_name('o').argument("FILE").bind_string(nullptr);
+    shared["indent"].argument("WIDTH", false).bind_uint(nullptr);
+    shared["level"].argument("N").bind_int(nullptr).min_value(-5).max_value(5);
+    shared["mode"].choices({"fast", "slow"});
+    shared["scale"].argument("FACTOR").bind_double(nullptr);
+    shared["timeout"].argument("TIME")
+      .bind_duration(static_cast<std::chrono::milliseconds*>(nullptr));
+    shared["cache"].argument("SIZE").bind_size(nullptr);
+    shared["quiet"].short_name('q');
+
+    binding_map<request> bindings;
+    bindings.bind_bool(shared["verbose"], &request::verbose)
+      .bind_bool(shared["output"], &request::has_file)
+      .bind_string(shared["output"], &request::file)
+      .bind_uint(shared["indent"], &request::indent)
+      .bind_int(shared["level"], &request::level)
+      .bind_string(shared["mode"], &request::mode)
+      .bind_double(shared["scale"], &request::scale)
+      .bind_duration(shared["timeout"], &request::timeout)
+      .bind_size(shared["cache"], &request::cache);
+    REQUIRE_FALSE(bindings.empty());
+
+    request req;
+    auto result = shared.parse("-vq cmd -o out.txt --indent=4 --level=-3 "
+                               "--mode=slow --scale 0.5 --timeout=2s "
+                               "--cache=1k", bindings, req);
+    REQUIRE(result.size() == 10);
+    REQUIRE(result.pending_writes().empty());
+    REQUIRE(req.verbose);
+    REQUIRE(req.has_file);
+    REQUIRE(req.file == "out.txt");
+    REQUIRE(req.indent == 4);
+    REQUIRE(req.level == -3);
+    REQUIRE(req.mode == "slow");
+    REQUIRE(req.scale == Approx(0.5));
+    REQUIRE(req.timeout.count() == 2000);
+    REQUIRE(req.cache == 1024);
+
+    // Members are only written for options that are present
+    request other;
+    std::vector<std::string> args{"prog", "--output=x"};
+    shared.parse(args.begin(), args.end(), bindings, other);
+    REQUIRE(other.has_file);
+    REQUIRE(other.file == "x");
+    REQUIRE_FALSE(other.verbose);
+    REQUIRE(other.indent == 2);
+
+    // The target is untouched if parsing fails
+    request failed;
+    REQUIRE_THROWS_WITH(shared.parse("-v --level=9", bindings, failed),
+                        "argument for option '--level' must be at most 5");
+    REQUIRE_FALSE(failed.verbose);
+    REQUIRE_THROWS_AS(shared.parse("--mode=medium", bindings, failed),
+                      parse_error);
+
+    // Variables bound to the options are left alone
+    request ignored;
+    example.parse("-v --indent=7 -o file", binding_map<request>{}, ignored);
+    REQUIRE_FALSE(data.verbose);
+    REQUIRE(data.indent == 2);
+    REQUIRE(data.file.empty());
+    binding_map<request> partial;
+    partial.bind_uint(example["indent"], &request::indent);
+    example.parse("--indent=7", partial, ignored);
+    REQUIRE(ignored.indent == 7);
+    REQUIRE(data.indent == 2);
+
+    // Mismatched member types are rejected
+    REQUIRE_THROWS_AS(bindings.bind_int(shared["indent"], &request::level),
+                      type_error);
+    REQUIRE_THROWS_AS(bindings.bind_string(shared["scale"], &request::file),
+                      type_error);
+
+    // Rebinding replaces the previous member
+    binding_map<request> rebound;
+    rebound.bind_string(shared["mode"], &request::mode)
+      .bind_string(shared["mode"], &request::file);
+    request r;
+    shared.parse("--mode=fast", rebound, r);
+    REQUIRE(r.file == "fast");
+    REQUIRE(r.mode.empty());
+
+    // Bindings survive the options being moved
+    parser growing;
+    growing["first"].argument("ARG").bind_string(nullptr);
+    binding_map<request> moved;
+    moved.bind_string(growing["first"], &request::file)
+      .bind_bool(growing["first"], &request::has_file);
+    for (int i = 0; i < 100; ++i)
+      growing["extra-" + std::to_string(i)];
+    growing.sort_options();
+    parser copy = growing;
+    request m;
+    copy.parse("--first=moved", moved, m);
+    REQUIRE(m.file == "moved");
+    REQUIRE(m.has_file);
+
+    // Converters cannot write to a member, and are never called
+    int conversions = 0;
+    shared["custom"].argument("X").bind_custom([&](const std::string&) {
+        ++conversions;
+        return true;
+      });
+    REQUIRE_THROWS_AS(bindings.bind_string(shared["custom"], &request::file),
+                      type_error);
+    shared["raw"].argument("X").bind_custom(nullptr);
+    binding_map<request> raw;
+    raw.bind_string(shared["raw"], &request::mode);
+    request c;
+    int typed_value = 0;
+    shared["typed"].argument("N").bind_custom(&typed_value,
+        [&](const std::string&, int& value) {
+          ++conversions;
+          value = 1;
+          return true;
+        });
+    shared.parse("--raw=unconverted --custom=ignored --typed=1", raw, c);
+    REQUIRE(typed_value == 0);
+    REQUIRE(c.mode == "unconverted");
+    REQUIRE(conversions == 0);
+
+    // One parser and map shared by many threads
+    const int thread_count = 8;
+    const int per_thread = 200;
+    std::vector<int> failures(thread_count);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < per_thread; ++i) {
+          int n = t * per_thread + i;
+          request mine;
+          shared.parse("--indent=" + std::to_string(n) + " -o f"
+                       + std::to_string(n) + (n % 2 ? " -v" : ""),
+                       bindings, mine);
+          if (mine.indent != static_cast<unsigned>(n)
+              || mine.file != "f" + std::to_string(n)
+              || mine.verbose != (n % 2 == 1))
+            ++failures[t];
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    for (int f : failures)
+      REQUIRE(f == 0);
+  }
+
   SECTION("type errors") {
     struct settings_ex {
       double temperature;
@@ -521,6 +1031,322 @@ TEST_CASE("parser") {
                         "argument for option '-t' must be a number");
   }
 
+  SECTION("custom arguments and validators") {
+    std::vector<std::string> includes;
+    example.add_option().long_name("include").short_name('I')
+      .bind_custom([&](const std::string& arg) {
+          if (arg == "bad")
+            return false;
+          includes.push_back(arg);
+          return true;
+        });
+    example["indent"].validator([](const std::string& arg) {
+        if (arg == "13")
+          throw parse_error{"unlucky indent", "validator", "--indent"};
+        return arg.size() == 1;
+      });
+
+    example.parse("-I dir1 --include=dir2 -Idir3 --indent=4");
+    REQUIRE(includes == std::vector<std::string>{"dir1", "dir2", "dir3"});
+    REQUIRE(data.indent == 4);
+
+    REQUIRE_THROWS_WITH(example.parse("-I bad"),
+                        "invalid argument for option '-I'");
+    REQUIRE_THROWS_WITH(example.parse("--indent=12"),
+                        "invalid argument for option '--indent'");
+    REQUIRE_THROWS_WITH(example.parse("--indent 13"), "unlucky indent");
+    REQUIRE(data.indent == 4);
+
+    example["include"].bind_custom([](const std::string& arg) {
+        return std::stoi(arg) > 0;
+      });
+    REQUIRE_NOTHROW(example.parse("-I 5"));
+    REQUIRE_THROWS_WITH(example.parse("-I five"),
+                        "invalid argument for option '-I'");
+  }
+
+  SECTION("durations and sizes") {
+    std::chrono::milliseconds timeout{};
+    std::chrono::duration<double> interval{};
+    std::uint64_t cache{};
+    example.add_option().long_name("timeout").bind_duration(&timeout);
+    example.add_option().long_name("interval").short_name('i')
+      .bind_duration(&interval);
+    example.add_option().long_name("cache").bind_size(&cache);
+
+    REQUIRE(example["timeout"].argument_name() == "DURATION");
+    REQUIRE(example["cache"].argument_name() == "SIZE");
+
+    example.parse("--timeout=250ms -i 1.5s --cache 4GiB");
+    REQUIRE(timeout.count() == 250);
+    REQUIRE(interval.count() == Approx(1.5));
+    REQUIRE(cache == 4ULL << 30);
+
+    example.parse("--timeout=1m1500us");
+    REQUIRE(timeout.count() == 60001);
+
+    REQUIRE_THROWS_WITH(example.parse("--timeout=soon"),
+                        "argument for option '--timeout' must be a duration");
+    REQUIRE_THROWS_WITH(example.parse("--cache=lots"),
+                        "argument for option '--cache' must be a size");
+    REQUIRE_THROWS_WITH(example.parse("--cache=17EiB"),
+                        "argument for option '--cache' is out of range");
+  }
+
+  SECTION("range constraints") {
+    int threads{};
+    double ratio{};
+    std::uint64_t block{};
+    example.add_option().long_name("threads").short_name('j')
+      .bind_int(&threads).range(1, 1024);
+    example.add_option().long_name("ratio").bind_double(&ratio)
+      .min_value(0.0).max_value(1.0).step(0.25);
+    example.add_option().long_name("block").bind_size(&block)
+      .min_value(512).step(512);
+    example["indent"].max_value(8).step(2);
+
+    example.parse("-j 16 --ratio=0.75 --block=4K --indent=6");
+    REQUIRE(threads == 16);
+    REQUIRE(ratio == Approx(0.75));
+    REQUIRE(block == 4096);
+    REQUIRE(data.indent == 6);
+
+    REQUIRE_THROWS_WITH(example.parse("-j0"),
+                        "argument for option '-j' must be at least 1");
+    REQUIRE_THROWS_WITH(example.parse("--threads=1025"),
+                        "argument for option '--threads' must be at most 1024");
+    REQUIRE_THROWS_WITH(example.parse("--ratio=0.3"),
+                        "argument for option '--ratio' must be a multiple of 0.25");
+    REQUIRE_THROWS_WITH(example.parse("--ratio=1.25"),
+                        "argument for option '--ratio' must be at most 1");
+    REQUIRE_THROWS_WITH(example.parse("--block=1000"),
+                        "argument for option '--block' must be 512 plus a multiple of 512");
+    REQUIRE_THROWS_WITH(example.parse("--indent=5"),
+                        "argument for option '--indent' must be a multiple of 2");
+    REQUIRE_THROWS_WITH(example.parse("--indent=10"),
+                        "argument for option '--indent' must be at most 8");
+    REQUIRE(threads == 16);
+
+    std::chrono::milliseconds timeout{};
+    example.add_option().long_name("timeout").bind_duration(&timeout)
+      .range(0.5, 60).step(0.25);
+    example.parse("--timeout=1m");
+    REQUIRE(timeout.count() == 60000);
+    example.parse("--timeout=750ms");
+    REQUIRE(timeout.count() == 750);
+    REQUIRE_THROWS_WITH(example.parse("--timeout=100ms"),
+                        "argument for option '--timeout' must be at least 0.5s");
+    REQUIRE_THROWS_WITH(example.parse("--timeout=1m1s"),
+                        "argument for option '--timeout' must be at most 60s");
+    REQUIRE_THROWS_WITH(example.parse("--timeout=1100ms"),
+                        "argument for option '--timeout' must be 0.5s plus a multiple of 0.25s");
+    REQUIRE(timeout.count() == 750);
+
+    std::ostringstream oss;
+    parser p;
+    p.add_option().long_name("threads").bind_int(&threads).range(1, 1024)
+      .description("Number of threads");
+    p.add_option().long_name("ratio").bind_double(&ratio).max_value(0.5);
+    p.add_option().long_name("block").bind_size(&block)
+      .min_value(512).step(512);
+    p.add_option().long_name("level").choices({"low", "high"}).min_value(1);
+    p.add_option().long_name("timeout").bind_duration(&timeout)
+      .max_value(60);
+    p.print_help(oss);
+    REQUIRE(oss.str() == "      --threads=INTEGER       Number of threads (range: 1 to 1024)\n"
+            "      --ratio=NUMBER          (maximum: 0.5)\n"
+            "      --block=SIZE            (minimum: 512; step: 512)\n"
+            "      --level=CHOICE          (choices: low, high; minimum: 1)\n"
+            "      --timeout=DURATION      (maximum: 60s)");
+  }
+
+  SECTION("choices") {
+    enum class mode { fast, safe, paranoid };
+    mode m{mode::safe};
+    std::string level;
+    example.add_option().long_name("mode").short_name('m')
+      .bind_enum(&m, {{"fast", mode::fast},
+                      {"safe", mode::safe},
+                      {"paranoid", mode::paranoid}});
+    example.add_option().long_name("level").bind_string(&level)
+      .choices({"low", "high"});
+
+    example.parse("--mode=paranoid");
+    REQUIRE(m == mode::paranoid);
+    example.parse("-m fast --level high");
+    REQUIRE(m == mode::fast);
+    REQUIRE(level == "high");
+
+    REQUIRE_THROWS_WITH(example.parse("--mode=slow"),
+                        "argument for option '--mode' must be one of: "
+                        "fast, safe, paranoid");
+    REQUIRE_THROWS_WITH(example.parse("--level=medium"),
+                        "argument for option '--level' must be one of: low, high");
+    REQUIRE(m == mode::fast);
+    REQUIRE(level == "high");
+
+    std::ostringstream oss;
+    parser p;
+    p.add_option().long_name("mode").bind_enum(&m, {{"fast", mode::fast},
+                                                    {"safe", mode::safe}})
+      .description("Set the mode");
+    p.add_option().long_name("level").choices({"low", "high"});
+    p.print_help(oss);
+    REQUIRE(oss.str() == "      --mode=CHOICE           Set the mode (choices: fast, safe)\n"
+            "      --level=CHOICE          (choices: low, high)");
+  }
+
+  SECTION("suggestions") {
+    REQUIRE_THROWS_WITH(example.parse("--verbsoe"),
+                        "invalid option: '--verbsoe' (did you mean '--verbose'?)");
+    REQUIRE_THROWS_WITH(example.parse("--outptu=x"),
+                        "invalid option: '--outptu' (did you mean '--output'?)");
+    REQUIRE_THROWS_WITH(example.parse("--vers"),
+                        "invalid option: '--vers'");
+    REQUIRE_THROWS_WITH(example.parse("--colour"),
+                        "invalid option: '--colour' (did you mean '--color'?)");
+    REQUIRE_THROWS_WITH(example.parse("--xyz"), "invalid option: '--xyz'");
+
+    try {
+      example.parse("--verbson");
+      FAIL("no exception thrown");
+    } catch (const parse_error& e) {
+      REQUIRE(e.suggestions() == std::vector<std::string>{"--verbose",
+                                                          "--version"});
+      REQUIRE(std::string{e.what()} == "invalid option: '--verbson' "
+              "(did you mean '--verbose' or '--version'?)");
+    }
+
+    // Index is rebuilt when options change
+    example.add_option().long_name("verse");
+    example.add_option().long_name("vector");
+    try {
+      example.parse("--versoe");
+      FAIL("no exception thrown");
+    } catch (const parse_error& e) {
+      REQUIRE(e.suggestions() == std::vector<std::string>{"--verse",
+                                                          "--verbose",
+                                                          "--version"});
+      REQUIRE(std::string{e.what()} == "invalid option: '--versoe' (did you "
+              "mean '--verse', '--verbose' or '--version'?)");
+    }
+
+    parser dialect{example};
+    dialect.set_custom_strings(" ", "-", "/");
+    REQUIRE_THROWS_WITH(dialect.parse("/colr"),
+                        "invalid option: '/colr' (did you mean '/color'?)");
+
+    parser large;
+    for (int i = 0; i < 2000; ++i)
+      large.add_option().long_name("option-" + std::to_string(i));
+    try {
+      large.parse("--option-12a4");
+      FAIL("no exception thrown");
+    } catch (const parse_error& e) {
+      REQUIRE(e.suggestions() == std::vector<std::string>{"--option-1204",
+                                                          "--option-1214",
+                                                          "--option-1224"});
+    }
+
+    std::vector<std::string> lines(200, "--optoin-7");
+    auto entries = large.parse_batch(lines.begin(), lines.end(), 8);
+    for (const auto& entry : entries)
+      REQUIRE_THROWS_WITH(std::rethrow_exception(entry.error),
+                          "invalid option: '--optoin-7' (did you mean "
+                          "'--option-7', '--option-0' or '--option-1'?)");
+  }
+
+  SECTION("completion") {
+    using list = std::vector<std::string>;
+    example["level"].argument("LEVEL").choices({"low", "medium", "high"});
+    example["mode"].short_name('m').argument("MODE", false)
+      .choices({"fast", "safe"});
+
+    REQUIRE(example.complete("--ver") == list{"--verbose", "--version"});
+    REQUIRE(example.complete("--verbose") == list{"--verbose"});
+    REQUIRE(example.complete("--x").empty());
+    REQUIRE(example.complete("--") == list{"--all", "--color", "--force",
+          "--help", "--indent", "--level", "--mode", "--output",
+          "--verbose", "--version"});
+    REQUIRE(example.complete("-") == list{"-?", "-a", "-c", "-f", "-m",
+          "-n", "-o", "-v", "--all", "--color", "--force", "--help",
+          "--indent", "--level", "--mode", "--output", "--verbose",
+          "--version"});
+    REQUIRE(example.complete("").empty());
+    REQUIRE(example.complete("file").empty());
+    REQUIRE(example.complete("-v").empty());
+
+    // Choices
+    REQUIRE(example.complete("--level=") == list{"--level=low",
+          "--level=medium", "--level=high"});
+    REQUIRE(example.complete("--level=m") == list{"--level=medium"});
+    REQUIRE(example.complete("--bogus=m").empty());
+    REQUIRE(example.complete("", "--level") == list{"low", "medium", "high"});
+    REQUIRE(example.complete("h", "--level") == list{"high"});
+    REQUIRE(example.complete("--", "--level").empty());
+    REQUIRE(example.complete("", "--level=low").empty());
+    REQUIRE(example.complete("s", "-vm") == list{"safe"});
+    REQUIRE(example.complete("s", "-mv").empty());
+    REQUIRE(example.complete("--he", "-m") == list{"--help"});
+    REQUIRE(example.complete("", "--output").empty());
+    REQUIRE(example.complete("--ver", "--output").empty());
+    REQUIRE(example.complete("--ver", "--verbose") == list{"--verbose",
+          "--version"});
+
+    // Index is rebuilt when options change
+    example["verify"];
+    REQUIRE(example.complete("--veri") == list{"--verify"});
+
+    parser dialect{example};
+    dialect.set_custom_strings(" ", "-", "/", "//", ":");
+    REQUIRE(dialect.complete("/ver") == list{"/verbose", "/verify",
+          "/version"});
+    REQUIRE(dialect.complete("/level:l") == list{"/level:low"});
+
+    parser large;
+    for (int i = 0; i < 2000; ++i)
+      large.add_option().long_name("option-" + std::to_string(i));
+    REQUIRE(large.complete("--option-199") == list{"--option-199",
+          "--option-1990", "--option-1991", "--option-1992",
+          "--option-1993", "--option-1994", "--option-1995",
+          "--option-1996", "--option-1997", "--option-1998",
+          "--option-1999"});
+
+    // Requests from completion scripts
+    std::ostringstream oss;
+    std::string args[] = {"prog", "--__complete", "--level", "me"};
+    char* argv[] = {&args[0][0], &args[1][0], &args[2][0], &args[3][0]};
+    REQUIRE(example.run_completion(4, argv, oss));
+    REQUIRE(oss.str() == "medium\n");
+    oss.str("");
+    REQUIRE(example.run_completion(2, argv, oss));
+    REQUIRE(oss.str().empty());
+    REQUIRE_FALSE(example.run_completion(1, argv, oss));
+    REQUIRE_FALSE(example.run_completion(3, argv + 1, oss));
+
+    oss.str("");
+    parser::print_completion_script(oss, parser::completion_shell::bash,
+                                    "my-prog");
+    REQUIRE(oss.str().find("_optionpp_my_prog() {") != std::string::npos);
+    REQUIRE(oss.str().find("--__complete \"$prev\" \"$cur\"")
+            != std::string::npos);
+    REQUIRE(oss.str().find("\ncomplete -o default -F _optionpp_my_prog "
+                           "'my-prog'\n") != std::string::npos);
+
+    oss.str("");
+    parser::print_completion_script(oss, parser::completion_shell::zsh,
+                                    "my-prog");
+    REQUIRE(oss.str().compare(0, 18, "#compdef my-prog\n#") == 0);
+    REQUIRE(oss.str().find("\n  compdef _my_prog 'my-prog'\n")
+            != std::string::npos);
+
+    oss.str("");
+    parser::print_completion_script(oss, parser::completion_shell::fish,
+                                    "it's");
+    REQUIRE(oss.str().find("\ncomplete -c 'it\\'s' -a '(__optionpp_it_s)'\n")
+            != std::string::npos);
+  }
+
   SECTION("help message") {
     std::ostringstream oss;
     oss << empty;
@@ -607,5 +1433,232 @@ Output options
     oss.str("");
     example.print_help(oss, 80, 0, 2, 60, 58);
     REQUIRE(oss.str() == desired);
+
+    // Columns are counted in characters, not bytes
+    parser localized;
+    localized["taille"].short_name('t').argument("\xc3\x89" "CHELLE")
+      .description("\xc3\x89" "chelle de l'affichage, \xc3\xa0 choisir "
+                   "selon l'\xc3\xa9" "cran");
+    oss.str("");
+    localized.print_help(oss, 40, 0, 2, 24, 26);
+    REQUIRE(oss.str() == "  -t, --taille=\xc3\x89" "CHELLE  "
+            "\xc3\x89" "chelle de\n"
+            "                          l'affichage, \xc3\xa0\n"
+            "                          choisir selon\n"
+            "                          l'\xc3\xa9" "cran");
+  }
+
+  SECTION("help cache") {
+    auto render = [](const parser& p, int length) {
+      std::ostringstream oss;
+      p.print_help(oss, length);
+      return oss.str();
+    };
+
+    std::string wide = render(example, 78);
+    std::string narrow = render(example, 40);
+    REQUIRE(wide != narrow);
+    REQUIRE(render(example, 78) == wide);
+    REQUIRE(render(example, 40) == narrow);
+    for (int length = 50; length < 60; ++length) // Evict old layouts
+      render(example, length);
+    REQUIRE(render(example, 78) == wide);
+
+    // Each kind of change is noticed
+    example["help"].description("Show the help");
+    std::string changed = render(example, 78);
+    REQUIRE(changed.find("Show the help\n") != std::string::npos);
+    example['n'].description("Number lines");
+    REQUIRE(render(example, 78).find("Number lines") != std::string::npos);
+    example.group("Extra").add_option("extra");
+    REQUIRE(render(example, 78).find("--extra") != std::string::npos);
+    example.add_option("more");
+    REQUIRE(render(example, 78).find("--more") != std::string::npos);
+    example.add_option().long_name("another");
+    REQUIRE(render(example, 78).find("--another") != std::string::npos);
+    example.set_custom_strings("", "+", "++");
+    REQUIRE(render(example, 78).find("++another") != std::string::npos);
+    std::string unsorted = render(example, 78);
+    example.sort_options();
+    REQUIRE(render(example, 78) != unsorted);
+    unsorted = render(example, 78);
+    example.sort_groups();
+    REQUIRE(render(example, 78) != unsorted);
+
+    // Copies render their own options
+    parser copy{example};
+    copy["zzz"];
+    REQUIRE(render(copy, 78).find("++zzz") != std::string::npos);
+    REQUIRE(render(example, 78).find("++zzz") == std::string::npos);
+    copy = example;
+    REQUIRE(render(copy, 78) == render(example, 78));
+
+    // Concurrent rendering
+    std::vector<std::string> outputs(8);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < outputs.size(); ++t) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < 50; ++i)
+          outputs[t] = render(example, 40 + static_cast<int>(t + i) % 6);
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    for (std::size_t t = 0; t < outputs.size(); ++t)
+      REQUIRE(outputs[t] == render(example, 40 + static_cast<int>(t + 49) % 6));
+  }
+
+  SECTION("exporters") {
+    example["indent"].max_value(8);
+    example["color"].choices({"red", "green"});
+    std::ostringstream oss;
+
+    parser::man_page_info info;
+    info.name = "example";
+    info.date = "2020-06-09";
+    info.source = "Example 1.0";
+    info.manual = "User Commands";
+    info.summary = "show an example";
+    info.description = "Prints an example.\n\nOptions are listed below.";
+    example.print_man_page(oss, info);
+    REQUIRE(oss.str() == R"--(.TH "example" 1 "2020\-06\-09" "Example 1.0" "User Commands"
+.SH NAME
+example \- show an example
+.SH SYNOPSIS
+.B "example"
+[\fIOPTION\fR]...
+.SH DESCRIPTION
+Prints an example.
+.PP
+Options are listed below.
+.SH OPTIONS
+.TP
+\fB\-?\fR, \fB\-\-help\fR
+Show help information
+.TP
+\fB\-\-version\fR
+Get version info
+.TP
+\fB\-v\fR, \fB\-\-verbose\fR
+Show verbose output
+.TP
+\fB\-a\fR, \fB\-\-all\fR
+Show all lines
+.TP
+\fB\-f\fR, \fB\-\-force\fR
+Force file creation
+.SS "Output options"
+.TP
+\fB\-o\fR, \fB\-\-output\fR=\fIFILE\fR
+Write output to FILE
+.TP
+\fB\-n\fR
+Show line numbers
+.TP
+\fB\-\-indent\fR[=\fIWIDTH\fR]
+Indent each line by WIDTH spaces (default: 2) (maximum: 8)
+.TP
+\fB\-c\fR, \fB\-\-color\fR[=\fICOLOR\fR]
+Set the color of the output (choices: red, green)
+)--");
+
+    oss.str("");
+    example.print_markdown(oss, 3);
+    REQUIRE(oss.str() == R"--(- `-?`, `--help`: Show help information
+- `--version`: Get version info
+- `-v`, `--verbose`: Show verbose output
+- `-a`, `--all`: Show all lines
+- `-f`, `--force`: Force file creation
+
+### Output options
+
+- `-o`, `--output=FILE`: Write output to FILE
+- `-n`: Show line numbers
+- `--indent[=WIDTH]`: Indent each line by WIDTH spaces (default: 2) (maximum: 8)
+- `-c`, `--color[=COLOR]`: Set the color of the output (choices: red, green)
+)--");
+
+    oss.str("");
+    example.print_json(oss);
+    REQUIRE(oss.str() == R"--({
+  "short_prefix": "-",
+  "long_prefix": "--",
+  "end_of_options": "--",
+  "equals": "=",
+  "groups": [
+    {
+      "name": "",
+      "options": [
+        {"long_name": "help", "short_name": "?", "description": "Show help information"},
+        {"long_name": "version", "description": "Get version info"},
+        {"long_name": "verbose", "short_name": "v", "description": "Show verbose output"},
+        {"long_name": "all", "short_name": "a", "description": "Show all lines"},
+        {"long_name": "force", "short_name": "f", "description": "Force file creation"}
+      ]
+    },
+    {
+      "name": "Output options",
+      "options": [
+        {"long_name": "output", "short_name": "o", "description": "Write output to FILE", "argument": {"name": "FILE", "required": true, "type": "string"}},
+        {"short_name": "n", "description": "Show line numbers"},
+        {"long_name": "indent", "description": "Indent each line by WIDTH spaces (default: 2)", "argument": {"name": "WIDTH", "required": false, "type": "uint", "maximum": 8}},
+        {"long_name": "color", "short_name": "c", "description": "Set the color of the output", "argument": {"name": "COLOR", "required": false, "type": "string", "choices": ["red", "green"]}}
+      ]
+    }
+  ]
+}
+)--");
+
+    // Special characters
+    parser special;
+    special.group("Say \"hi\"")["path"].short_name('p')
+      .argument("DIR")
+      .description(".dir\\name, *not* `code`\n# 1. item\n\nmore\t\x01");
+    info = parser::man_page_info{};
+    info.name = "special";
+    oss.str("");
+    special.print_man_page(oss, info);
+    REQUIRE(oss.str() == R"--(.TH "special" 1 "" "" ""
+.SH NAME
+special
+.SH SYNOPSIS
+.B "special"
+[\fIOPTION\fR]...
+.SH OPTIONS
+.SS "Say \(dqhi\(dq"
+.TP
+\fB\-p\fR, \fB\-\-path\fR=\fIDIR\fR
+\&.dir\ename, *not* `code`
+# 1. item
+.IP
+more)--" "\t\x01\n");
+    oss.str("");
+    special.print_markdown(oss);
+    REQUIRE(oss.str() == R"--(## Say "hi"
+
+- `-p`, `--path=DIR`: .dir\\name, \*not\* \`code\`\
+  \# 1. item
+
+  more)--" "\t\x01\n");
+    oss.str("");
+    special.print_json(oss);
+    REQUIRE(oss.str().find(R"--("name": "Say \"hi\"")--")
+            != std::string::npos);
+    REQUIRE(oss.str().find(R"--("description": ".dir\\name, *not* `code`\n# 1. item\n\nmore\t\u0001")--")
+            != std::string::npos);
+
+    // Nothing to list
+    oss.str("");
+    empty.print_markdown(oss);
+    REQUIRE(oss.str() == "");
+    empty.print_json(oss);
+    REQUIRE(oss.str() == R"--({
+  "short_prefix": "-",
+  "long_prefix": "--",
+  "end_of_options": "--",
+  "equals": "=",
+  "groups": []
+}
+)--");
   }
 }
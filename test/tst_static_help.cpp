@@ -0,0 +1,56 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <catch2/catch.hpp>
+#include <optionpp/parser.hpp>
+#include "static_help_text.hpp"
+#include "static_help_narrow.hpp"
+
+using namespace optionpp;
+
+void define_static_help_options(parser& p);
+
+TEST_CASE("static help") {
+  parser p;
+  define_static_help_options(p);
+
+  SECTION("default layout") {
+    std::ostringstream ss;
+    p.print_help(ss);
+    REQUIRE(std::string(static_help_text, static_help_text_length)
+            == ss.str());
+    REQUIRE(std::strlen(static_help_text) == static_help_text_length);
+  }
+
+  SECTION("custom layout") {
+    std::ostringstream ss;
+    p.print_help(ss, 40, 1, 3, 16, 18);
+    REQUIRE(std::string(static_help_narrow, static_help_narrow_length)
+            == ss.str());
+  }
+
+  SECTION("constant expression") {
+    static_assert(sizeof(static_help_text) == static_help_text_length + 1,
+                  "length does not match the array");
+    static_assert(static_help_text[0] == ' ', "unexpected help text");
+  }
+}
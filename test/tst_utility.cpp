@@ -17,12 +17,24 @@
  */
 /* Written by Greg Kikola <gkikola@gmail.com>. */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 #include <catch2/catch.hpp>
+#include <optionpp/error.hpp>
 #include <optionpp/utility.hpp>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
 using std::back_inserter;
 using std::string;
 using std::vector;
@@ -169,6 +181,520 @@ TEST_CASE("utility::split") {
   }
 }
 
+// Byte-at-a-time implementation of split, used as a reference for
+// the optimized version
+void reference_split(const string& str, vector<string>& dest,
+                     const string& delims, const string& quotes,
+                     char escape_char, bool allow_empty) {
+  string::size_type pos{0};
+  bool escape_next{false};
+  bool in_quotes{false};
+  string::size_type quote_index{0};
+  string cur_token;
+  while (pos < str.size()) {
+    if (in_quotes) {
+      if (escape_next || str[pos] != quotes[quote_index]) {
+        if (!escape_next && str[pos] == escape_char)
+          escape_next = true;
+        else {
+          cur_token.push_back(str[pos]);
+          escape_next = false;
+        }
+      } else {
+        in_quotes = false;
+      }
+    } else {
+      if (escape_next || delims.find(str[pos]) == string::npos) {
+        if (!escape_next && str[pos] == escape_char)
+          escape_next = true;
+        else if (escape_next) {
+          cur_token.push_back(str[pos]);
+          escape_next = false;
+        } else {
+          quote_index = quotes.find(str[pos]);
+          if (quote_index != string::npos)
+            in_quotes = true;
+          else
+            cur_token.push_back(str[pos]);
+        }
+      } else {
+        if (!cur_token.empty() || allow_empty)
+          dest.push_back(cur_token);
+        cur_token.clear();
+      }
+    }
+    ++pos;
+  }
+  if (!cur_token.empty() || allow_empty)
+    dest.push_back(cur_token);
+}
+
+TEST_CASE("utility::split (differential)") {
+  std::mt19937 rng{12345};
+  const string alphabet = "abcxyz \t\n\"'\\;,#\0";
+  struct config {
+    string delims;
+    string quotes;
+    char escape_char;
+  };
+  const vector<config> configs = {
+    {" \t\n\r", "\"'", '\\'},
+    {";", "\"", '\\'},
+    {"\n", "", '\0'},
+    {" ,", "'", '#'},
+    {"", "\"'", '\\'},
+    {" ", "\"", '"'},
+    {" ", "\"", ' '},
+    {"abcdefghijklmnopqrstuvwxyz", "'", '\\'}
+  };
+
+  for (int trial = 0; trial < 2000; ++trial) {
+    // Mix short strings with long runs so both scalar and vector
+    // paths are exercised
+    auto len = std::uniform_int_distribution<int>{0, trial % 10 == 0 ? 300 : 40}(rng);
+    string str;
+    for (int i = 0; i < len; ++i) {
+      if (rng() % 4 == 0)
+        str.append(rng() % 40, 'a' + rng() % 3);
+      else
+        str.push_back(alphabet[rng() % alphabet.size()]);
+    }
+
+    for (const auto& c : configs) {
+      for (bool allow_empty : {false, true}) {
+        vector<string> expected, actual;
+        reference_split(str, expected, c.delims, c.quotes, c.escape_char,
+                        allow_empty);
+        split(str, back_inserter(actual), c.delims, c.quotes, c.escape_char,
+              allow_empty);
+        INFO("input: " << str);
+        REQUIRE(actual == expected);
+
+        actual.clear();
+        split(str, back_inserter(actual), char_class{c.delims}, c.quotes,
+              c.escape_char, allow_empty);
+        REQUIRE(actual == expected);
+
+        vector<token_view> views;
+        token_arena arena;
+        split_view(str, back_inserter(views), arena, c.delims, c.quotes,
+                   c.escape_char, allow_empty);
+        REQUIRE(vector<string>(views.begin(), views.end()) == expected);
+
+        // Feed the string to a tokenizer in random pieces
+        actual.clear();
+        tokenizer tok{c.delims, c.quotes, c.escape_char, allow_empty};
+        std::size_t pos = 0;
+        while (pos < str.size()) {
+          std::size_t count = std::min<std::size_t>(rng() % 12, str.size() - pos);
+          tok.feed(token_view{str.data() + pos, count}, back_inserter(actual));
+          pos += count;
+        }
+        tok.finish(back_inserter(actual));
+        REQUIRE(actual == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("utility::char_class") {
+  char_class empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.size() == 0);
+  for (int c = 0; c < 256; ++c)
+    REQUIRE(!empty.contains(static_cast<char>(c)));
+
+  char_class chars{"abca \\"};
+  REQUIRE(chars.size() == 5);
+  REQUIRE(chars.contains('a'));
+  REQUIRE(chars.contains('c'));
+  REQUIRE(chars.contains(' '));
+  REQUIRE(chars.contains('\\'));
+  REQUIRE(!chars.contains('d'));
+  REQUIRE(!chars.contains('A'));
+
+  chars.add('\0').add(string{"\x80\xff"});
+  REQUIRE(chars.size() == 8);
+  REQUIRE(chars.contains('\0'));
+  REQUIRE(chars.contains('\x80'));
+  REQUIRE(chars.contains('\xff'));
+  REQUIRE(!chars.contains('\x7f'));
+
+  // Sets larger than the vectorized limit
+  string all;
+  for (int c = 0; c < 256; ++c)
+    all.push_back(static_cast<char>(c));
+  char_class full{all};
+  REQUIRE(full.size() == 256);
+  for (int c = 0; c < 256; ++c)
+    REQUIRE(full.contains(static_cast<char>(c)));
+
+  string text(100, 'a');
+  text[70] = 'y';
+  REQUIRE(find_first_of(text.data(), text.data() + text.size(),
+                        char_class{"xyz"}) == text.data() + 70);
+  REQUIRE(find_first_of(text.data(), text.data() + text.size(),
+                        char_class{all.substr(123)}) == text.data() + text.size());
+  REQUIRE(find_first_of(text.data(), text.data() + text.size(),
+                        char_class{all.substr(97)}) == text.data());
+
+  // Precomputed delimiters
+  vector<string> output;
+  char_class delims{",;"};
+  split("a,b;;c", back_inserter(output), delims);
+  REQUIRE(output == vector<string>{"a", "b", "c"});
+}
+
+TEST_CASE("utility::token_view") {
+  token_view empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.size() == 0);
+  REQUIRE(empty.begin() == empty.end());
+  REQUIRE(empty.str() == "");
+
+  string str{"hello world"};
+  token_view hello{str.data(), 5};
+  REQUIRE(hello.size() == 5);
+  REQUIRE(hello[1] == 'e');
+  REQUIRE(hello == "hello");
+  REQUIRE(hello == string{"hello"});
+  REQUIRE(hello != "hello world");
+  REQUIRE(token_view{str} == "hello world");
+  REQUIRE(string(hello.begin(), hello.end()) == "hello");
+
+  string copy = hello;
+  REQUIRE(copy == "hello");
+}
+
+TEST_CASE("utility::split_view") {
+  vector<token_view> output;
+  token_arena arena;
+
+  SECTION("clean tokens refer to source") {
+    string str{"  one two\tthree  "};
+    split_view(str, back_inserter(output), arena);
+    REQUIRE(output.size() == 3);
+    REQUIRE(output[0] == "one");
+    REQUIRE(output[1] == "two");
+    REQUIRE(output[2] == "three");
+    REQUIRE(output[0].data() == str.data() + 2);
+    REQUIRE(output[1].data() == str.data() + 6);
+    REQUIRE(output[2].data() == str.data() + 10);
+    REQUIRE(arena.capacity() == 0);
+  }
+
+  SECTION("quoted and escaped tokens are stored in arena") {
+    string str{R"(plain "quoted text" esc\ aped 'mixed'\"x end)"};
+    split_view(str, back_inserter(output), arena);
+    REQUIRE(output.size() == 5);
+    REQUIRE(output[0] == "plain");
+    REQUIRE(output[1] == "quoted text");
+    REQUIRE(output[2] == "esc aped");
+    REQUIRE(output[3] == "mixed\"x");
+    REQUIRE(output[4] == "end");
+
+    auto in_source = [&](token_view v) {
+      return v.data() >= str.data() && v.data() < str.data() + str.size();
+    };
+    REQUIRE(in_source(output[0]));
+    REQUIRE(!in_source(output[1]));
+    REQUIRE(!in_source(output[2]));
+    REQUIRE(!in_source(output[3]));
+    REQUIRE(in_source(output[4]));
+    REQUIRE(arena.capacity() == token_arena::block_size);
+  }
+
+  SECTION("empty tokens") {
+    split_view(",a,,b,", back_inserter(output), arena, ",", "", '\\', true);
+    REQUIRE(vector<string>(output.begin(), output.end())
+            == vector<string>{"", "a", "", "b", ""});
+  }
+
+  SECTION("large tokens") {
+    string big(3 * token_arena::block_size, 'x');
+    split_view("\"" + big + "\" 'y'", back_inserter(output), arena);
+    REQUIRE(output.size() == 2);
+    REQUIRE(output[0] == big);
+    REQUIRE(output[1] == "y");
+    REQUIRE(arena.capacity() == big.size() + token_arena::block_size);
+  }
+
+  SECTION("arena reuse") {
+    for (int i = 0; i < 3; ++i) {
+      output.clear();
+      arena.clear();
+      split_view("'a' 'b' 'c'", back_inserter(output), arena);
+      REQUIRE(vector<string>(output.begin(), output.end())
+              == vector<string>{"a", "b", "c"});
+    }
+    REQUIRE(arena.capacity() == token_arena::block_size);
+  }
+}
+
+TEST_CASE("utility::tokenizer") {
+  vector<string> output;
+  tokenizer tok;
+
+  SECTION("chunks") {
+    tok.feed("first 'second ", back_inserter(output));
+    REQUIRE(output == vector<string>{"first"});
+    tok.feed("token' th", back_inserter(output));
+    REQUIRE(output == vector<string>{"first", "second token"});
+    tok.feed("ird\\", back_inserter(output));
+    tok.feed(" fourth", back_inserter(output));
+    REQUIRE(output.size() == 2);
+    tok.finish(back_inserter(output));
+    REQUIRE(output == vector<string>{"first", "second token", "third fourth"});
+
+    // The tokenizer is reset after finishing
+    output.clear();
+    tok.feed("'unterminated", back_inserter(output));
+    tok.finish(back_inserter(output));
+    tok.feed("a b", back_inserter(output));
+    tok.finish(back_inserter(output));
+    REQUIRE(output == vector<string>{"unterminated", "a", "b"});
+  }
+
+  SECTION("reset") {
+    tok.feed("'partial tok", back_inserter(output));
+    tok.reset();
+    tok.feed("new input", back_inserter(output));
+    tok.finish(back_inserter(output));
+    REQUIRE(output == vector<string>{"new", "input"});
+  }
+
+  SECTION("streams") {
+    // Tokens longer than the buffer size are carried across chunks
+    string big(tokenizer::buffer_size + 100, 'x');
+    std::istringstream in{"one \"two " + big + "\"\n  three"};
+    tok.read(in, back_inserter(output));
+    REQUIRE(output == vector<string>{"one", "two " + big, "three"});
+
+    output.clear();
+    std::istringstream empty;
+    tok.read(empty, back_inserter(output));
+    REQUIRE(output.empty());
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  SECTION("file descriptors") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    const string text{"alpha 'beta gamma' delta\\ epsilon"};
+    REQUIRE(write(fds[1], text.data(), text.size())
+            == static_cast<ssize_t>(text.size()));
+    close(fds[1]);
+    tok.read_fd(fds[0], back_inserter(output));
+    close(fds[0]);
+    REQUIRE(output == vector<string>{"alpha", "beta gamma", "delta epsilon"});
+
+    REQUIRE_THROWS_AS(tok.read_fd(-1, back_inserter(output)),
+                      optionpp::file_error);
+  }
+#endif
+}
+
+namespace {
+
+  struct conformance_case {
+    string input;
+    vector<string> expected;
+  };
+
+  vector<string> split_dialect(shell_dialect dialect, const string& str) {
+    vector<string> output;
+    tokenizer tok{dialect};
+    tok.finish(tok.feed(str, back_inserter(output)));
+    return output;
+  }
+
+  // Feed the input in two pieces, split at every possible position
+  void check_dialect(shell_dialect dialect, const conformance_case& c) {
+    INFO("input: " << c.input);
+    REQUIRE(split_dialect(dialect, c.input) == c.expected);
+
+    tokenizer tok{dialect};
+    for (std::size_t i = 0; i <= c.input.size(); ++i) {
+      vector<string> output;
+      auto it = tok.feed(token_view{c.input.data(), i}, back_inserter(output));
+      it = tok.feed(token_view{c.input.data() + i, c.input.size() - i}, it);
+      tok.finish(it);
+      REQUIRE(output == c.expected);
+    }
+  }
+
+}
+
+TEST_CASE("utility::tokenizer (dialects)") {
+  SECTION("posix") {
+    const vector<conformance_case> cases{
+      {"", {}},
+      {" \t\n ", {}},
+      {"a b\tc\nd", {"a", "b", "c", "d"}},
+      {"'a b' \"c d\"", {"a b", "c d"}},
+      {"'a\\b' 'it'\\''s'", {"a\\b", "it's"}},
+      {"\"a\\b\" \"c\\\"d\" \"\\$x \\`y\\` \\\\\"", {"a\\b", "c\"d", "$x `y` \\"}},
+      {"a\\ b \\'c\\' \\\\", {"a b", "'c'", "\\"}},
+      {"'' \"\" x''", {"", "", "x"}},
+      {"ab\\\ncd \\\n ef", {"abcd", "ef"}},
+      {"\"ab\\\ncd\"", {"abcd"}},
+      {"'a\nb'", {"a\nb"}},
+      {"x'y'\"z\"w", {"xyzw"}},
+      {"a\\", {"a\\"}},
+      {"'unterminated quote", {"unterminated quote"}},
+      {"\"$HOME\" ~ * #", {"$HOME", "~", "*", "#"}}
+    };
+    for (const auto& c : cases)
+      check_dialect(shell_dialect::posix, c);
+  }
+
+  SECTION("windows") {
+    // Includes the examples from the CommandLineToArgvW documentation
+    const vector<conformance_case> cases{
+      {"", {}},
+      {"\"a b c\" d e", {"a b c", "d", "e"}},
+      {"\"ab\\\"c\" \"\\\\\" d", {"ab\"c", "\\", "d"}},
+      {"a\\\\\\b d\"e f\"g h", {"a\\\\\\b", "de fg", "h"}},
+      {"a\\\\\\\"b c d", {"a\\\"b", "c", "d"}},
+      {"a\\\\\\\\\"b c\" d e", {"a\\\\b c", "d", "e"}},
+      {"a\"b\"\" c d", {"ab\"", "c", "d"}},
+      {"\"\" \"\"\"\" x", {"", "\" x"}},
+      {"\"\"\" y", {"\"", "y"}},
+      {"C:\\dir\\ \"C:\\Program Files\\\\\"", {"C:\\dir\\", "C:\\Program Files\\"}},
+      {"'a b'\tc\nd", {"'a", "b'", "c\nd"}},
+      {"trailing\\\\", {"trailing\\\\"}},
+      {"\"unterminated quote", {"unterminated quote"}}
+    };
+    for (const auto& c : cases)
+      check_dialect(shell_dialect::windows, c);
+  }
+
+  SECTION("generic") {
+    REQUIRE(split_dialect(shell_dialect::generic, "a 'b c' \"\" d\\ e")
+            == vector<string>{"a", "b c", "d e"});
+  }
+
+  SECTION("streams") {
+    string big(tokenizer::buffer_size + 100, 'x');
+    std::istringstream in{"one 'two " + big + "'\\\n  three"};
+    vector<string> output;
+    tokenizer tok{shell_dialect::posix};
+    tok.read(in, back_inserter(output));
+    REQUIRE(output == vector<string>{"one", "two " + big, "three"});
+  }
+
+  SECTION("reset") {
+    vector<string> output;
+    tokenizer tok{shell_dialect::windows};
+    tok.feed("\"partial \\\\", back_inserter(output));
+    tok.reset();
+    tok.finish(tok.feed("new input", back_inserter(output)));
+    REQUIRE(output == vector<string>{"new", "input"});
+  }
+}
+
+TEST_CASE("utility::find_first_of") {
+  string str(200, 'a');
+  const char* first = str.data();
+  const char* last = first + str.size();
+
+  REQUIRE(find_first_of(first, last, "xyz", 3) == last);
+  REQUIRE(find_first_of(first, last, "", 0) == last);
+  REQUIRE(find_first_of(first, first, "a", 1) == first);
+
+  // Check every position and alignment
+  for (std::size_t start = 0; start < 40; ++start) {
+    for (std::size_t pos = start; pos < str.size(); ++pos) {
+      str[pos] = 'z';
+      REQUIRE(find_first_of(first + start, last, "xyz", 3) == first + pos);
+      REQUIRE(find_first_of(first + start, last, "z", 1) == first + pos);
+      str[pos] = 'a';
+    }
+  }
+
+  // Large character sets
+  const string many = "0123456789ABCDEFGHIJ";
+  str[150] = 'J';
+  REQUIRE(find_first_of(first, last, many.data(), many.size()) == first + 150);
+  str[0] = '0';
+  REQUIRE(find_first_of(first, last, many.data(), many.size()) == first);
+
+  // Null and high-bit characters
+  string bin{"abc\0def\xff", 8};
+  REQUIRE(find_first_of(bin.data(), bin.data() + bin.size(), "\0", 1)
+          == bin.data() + 3);
+  REQUIRE(find_first_of(bin.data(), bin.data() + bin.size(), "\xff", 1)
+          == bin.data() + 7);
+}
+
+TEST_CASE("utility::is_ascii") {
+  string str(100, 'a');
+  const char* first = str.data();
+  const char* last = first + str.size();
+
+  REQUIRE(is_ascii(first, last));
+  REQUIRE(is_ascii(first, first));
+
+  // Check every position and alignment
+  for (std::size_t start = 0; start < 40; ++start) {
+    for (std::size_t pos = start; pos < str.size(); ++pos) {
+      str[pos] = '\x80';
+      REQUIRE_FALSE(is_ascii(first + start, last));
+      REQUIRE(is_ascii(first + start, first + pos));
+      str[pos] = '\x7f';
+      REQUIRE(is_ascii(first + start, last));
+      str[pos] = 'a';
+    }
+  }
+}
+
+TEST_CASE("utility::display_width") {
+  SECTION("characters") {
+    REQUIRE(char_width(U'a') == 1);
+    REQUIRE(char_width(U'\t') == 1);
+    REQUIRE(char_width(0xE9) == 1); // e with acute
+    REQUIRE(char_width(0x0301) == 0); // Combining acute
+    REQUIRE(char_width(0x0E31) == 0); // Thai vowel sign
+    REQUIRE(char_width(0x200D) == 0); // Zero-width joiner
+    REQUIRE(char_width(0xFE0F) == 0); // Variation selector
+    REQUIRE(char_width(0x0416) == 1); // Cyrillic
+    REQUIRE(char_width(0x1100) == 2); // Hangul choseong
+    REQUIRE(char_width(0x1160) == 0); // Hangul jungseong
+    REQUIRE(char_width(0x3000) == 2); // Ideographic space
+    REQUIRE(char_width(0x3099) == 0); // Combining kana mark
+    REQUIRE(char_width(0x4E2D) == 2); // CJK ideograph
+    REQUIRE(char_width(0xAC00) == 2); // Hangul syllable
+    REQUIRE(char_width(0xFF21) == 2); // Fullwidth A
+    REQUIRE(char_width(0xFF61) == 1); // Halfwidth ideographic full stop
+    REQUIRE(char_width(0x1F600) == 2); // Emoji
+    REQUIRE(char_width(0x20000) == 2); // CJK extension B
+    REQUIRE(char_width(0xE0100) == 0); // Variation selector supplement
+    REQUIRE(char_width(0xFFFD) == 1);
+    REQUIRE(char_width(0x10FFFF) == 1);
+  }
+
+  SECTION("strings") {
+    REQUIRE(display_width("") == 0);
+    REQUIRE(display_width("plain text") == 10);
+    REQUIRE(display_width("caf\xc3\xa9") == 4);
+    REQUIRE(display_width("cafe\xcc\x81") == 4);
+    REQUIRE(display_width("\xe4\xb8\xad\xe6\x96\x87") == 4);
+    REQUIRE(display_width("\xf0\x9f\x98\x80!") == 3);
+    REQUIRE(display_width(string(40, 'x') + "\xe4\xb8\xad") == 42);
+  }
+
+  SECTION("invalid sequences") {
+    REQUIRE(display_width("\xa0") == 1); // Stray continuation byte
+    REQUIRE(display_width("\xff\xfe") == 2);
+    REQUIRE(display_width("\xe4\xb8") == 2); // Truncated
+    REQUIRE(display_width("\xe4\xb8x") == 3);
+    REQUIRE(display_width("\xc0\x80") == 2); // Overlong
+    REQUIRE(display_width("\xe0\x80\xaf") == 3); // Overlong
+    REQUIRE(display_width("\xed\xa0\x80") == 3); // Surrogate
+    REQUIRE(display_width("\xf4\x90\x80\x80") == 4); // Too large
+  }
+}
+
 TEST_CASE("utility::wrap_text") {
   std::string text{"I am the very model of a modern Major-General, I've information vegetable, animal, and mineral, I know the kings of England, and I quote the fights historical, from Marathon to Waterloo, in order categorical."};
 
@@ -183,6 +709,77 @@ To tell one's name - the livelong June -
 To an admiring Bog!
     - Emily Dickinson)"};
 
+  SECTION("other whitespace") {
+    REQUIRE(wrap_text("one\ttwo\vthree\ffour\rfive", 10)
+            == "one\ttwo\nthree\ffour\nfive");
+    REQUIRE(wrap_text("caf\xc3\xa9\xa0noir", 6) == "caf\xc3\xa9\xa0n\noir");
+  }
+
+  SECTION("wide and combining characters") {
+    // Eight wide characters without spaces
+    const string japanese{"\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e"
+                          "\xe3\x81\xae\xe3\x83\x86\xe3\x82\xad"
+                          "\xe3\x82\xb9\xe3\x83\x88"};
+    REQUIRE(wrap_text(japanese, 6) == japanese.substr(0, 9) + "\n"
+            + japanese.substr(9, 9) + "\n" + japanese.substr(18));
+    REQUIRE(wrap_text(japanese, 7) == japanese.substr(0, 9) + "\n"
+            + japanese.substr(9, 9) + "\n" + japanese.substr(18));
+
+    const string hello{"\xe4\xbd\xa0\xe5\xa5\xbd"};
+    const string world{"\xe4\xb8\x96\xe7\x95\x8c"};
+    REQUIRE(wrap_text(hello + " " + world, 9) == hello + " " + world);
+    REQUIRE(wrap_text(hello + " " + world, 8) == hello + "\n" + world);
+    REQUIRE(wrap_text(hello + " " + world, 9, 2)
+            == "  " + hello + "\n  " + world);
+
+    // Combining marks stay with their base character
+    REQUIRE(wrap_text("cafe\xcc\x81 noir", 9) == "cafe\xcc\x81 noir");
+    REQUIRE(wrap_text("cafe\xcc\x81 noir", 8) == "cafe\xcc\x81\nnoir");
+    REQUIRE(wrap_text("e\xcc\x81" "e\xcc\x81" "e\xcc\x81", 2)
+            == "e\xcc\x81" "e\xcc\x81\n" "e\xcc\x81");
+
+    // A character wider than the line still makes progress
+    REQUIRE(wrap_text(hello, 1) == hello.substr(0, 3) + "\n" + hello.substr(3));
+    REQUIRE(wrap_text(hello, 3, 2) == "  " + hello.substr(0, 3) + "\n  "
+            + hello.substr(3));
+  }
+
+  SECTION("UTF-8 sequences are not split") {
+    const vector<string> pieces{"a", "bc", "\xc3\xa9", "\xe4\xb8\xad",
+                                "e\xcc\x81", "\xf0\x9f\x98\x80", " ",
+                                " ", "\t"};
+    std::mt19937 rng{1357};
+    for (int trial = 0; trial < 1000; ++trial) {
+      string str;
+      int count = static_cast<int>(rng() % 40);
+      for (int i = 0; i < count; ++i)
+        str += pieces[rng() % pieces.size()];
+      int line_len = static_cast<int>(rng() % 12) + 2;
+
+      INFO("input: " << str << ", " << line_len);
+      string wrapped = wrap_text(str, line_len);
+
+      string lines_text;
+      std::istringstream lines{wrapped};
+      string line;
+      while (std::getline(lines, line)) {
+        REQUIRE(line.size() > 0);
+        REQUIRE((static_cast<unsigned char>(line[0]) & 0xC0) != 0x80);
+        REQUIRE(line.compare(0, 2, "\xcc\x81") != 0);
+        REQUIRE(display_width(line) <= static_cast<std::size_t>(line_len));
+        lines_text += line;
+      }
+
+      auto remove_space = [](string s) {
+        s.erase(std::remove_if(s.begin(), s.end(),
+                               [](char c) { return c == ' ' || c == '\t'; }),
+                s.end());
+        return s;
+      };
+      REQUIRE(remove_space(lines_text) == remove_space(str));
+    }
+  }
+
   SECTION("unlimited length") {
     REQUIRE(text == wrap_text(text, -1));
     REQUIRE(multiline == wrap_text(multiline, 0));
@@ -388,6 +985,127 @@ son)"};
   }
 }
 
+// The original string-building implementation of wrap_text, used as a
+// reference for the streaming version
+string reference_wrap_line(const string& str, int line_len, int indent,
+                           int first_line_indent) {
+  if (line_len <= 0)
+    return string(first_line_indent, ' ') + str;
+
+  indent = std::max(0, std::min(indent, line_len - 1));
+  first_line_indent = std::max(0, std::min(first_line_indent, line_len - 1));
+
+  auto is_space = [](char c) {
+    return string{" \t\n\v\f\r"}.find(c) != string::npos;
+  };
+  string result;
+  string::size_type pos{0};
+  while (pos < str.size()) {
+    int cur_indent = result.empty() ? first_line_indent : indent;
+    auto start = pos;
+    if (!result.empty()) {
+      while (start < str.size() && is_space(str[start]))
+        ++start;
+    }
+
+    auto end = start + line_len - cur_indent;
+    if (end > str.size())
+      end = str.size();
+    if (end < str.size()) {
+      auto word_start = end;
+      while (word_start > start && !is_space(str[word_start]))
+        --word_start;
+      if (word_start > start)
+        end = word_start;
+    }
+
+    pos = end;
+    while (end > start && is_space(str[end - 1]))
+      --end;
+    if (end > start) {
+      if (!result.empty())
+        result.push_back('\n');
+      result += string(cur_indent, ' ') + str.substr(start, end - start);
+    }
+  }
+  return result;
+}
+
+string reference_wrap(const string& str, int line_len, int indent,
+                      int first_line_indent) {
+  vector<string> lines;
+  reference_split(str, lines, "\n", "", '\0', true);
+
+  string result;
+  for (const auto& line : lines) {
+    if (!result.empty())
+      result.push_back('\n');
+    result += reference_wrap_line(line, line_len, indent, first_line_indent);
+    first_line_indent = indent;
+  }
+  return result;
+}
+
+TEST_CASE("utility::wrap_text (differential)") {
+  std::mt19937 rng{2468};
+  const string alphabet = "abc  \t\n\v";
+
+  for (int trial = 0; trial < 2000; ++trial) {
+    auto len = std::uniform_int_distribution<int>{0, trial % 10 == 0 ? 400 : 60}(rng);
+    string str;
+    for (int i = 0; i < len; ++i) {
+      if (rng() % 8 == 0)
+        str.append(rng() % 30, 'w');
+      else
+        str.push_back(alphabet[rng() % alphabet.size()]);
+    }
+    int line_len = static_cast<int>(rng() % 50) - 5;
+    int indent = static_cast<int>(rng() % 60);
+    int first_indent = static_cast<int>(rng() % 60);
+
+    string expected = reference_wrap(str, line_len, indent, first_indent);
+    INFO("input: " << str << ", " << line_len << ", " << indent << ", "
+         << first_indent);
+    REQUIRE(wrap_text(str, line_len, indent, first_indent) == expected);
+
+    std::ostringstream oss;
+    write_wrapped(oss, str, line_len, indent, first_indent);
+    REQUIRE(oss.str() == expected);
+
+    // Exact, larger and truncated buffers
+    vector<char> buffer(expected.size() + 8, '#');
+    REQUIRE(write_wrapped(buffer.data(), buffer.size(), str, line_len,
+                          indent, first_indent) == expected.size());
+    REQUIRE(string(buffer.data(), expected.size()) == expected);
+    REQUIRE(buffer[expected.size()] == '#');
+    std::size_t small = expected.size() / 2;
+    std::fill(buffer.begin(), buffer.end(), '#');
+    REQUIRE(write_wrapped(buffer.data(), small, str, line_len, indent,
+                          first_indent) == expected.size());
+    REQUIRE(string(buffer.data(), small) == expected.substr(0, small));
+    REQUIRE(buffer[small] == '#');
+  }
+
+  // Empty lines are dropped until something has been written
+  REQUIRE(wrap_text("\nLL", 57, 5, 11) == "     LL");
+  REQUIRE(wrap_text("\n \nLL\n\nMM", 10, 2) == "  LL\n\n  MM");
+  REQUIRE(wrap_text("\n\n", 10, 2).empty());
+
+  std::ostringstream oss;
+  write_wrapped(oss, "one two three", 8, 2);
+  REQUIRE(oss.str() == wrap_text("one two three", 8, 2));
+
+  std::FILE* file = std::tmpfile();
+  REQUIRE(file);
+  const string text = "The quick brown fox jumps over the lazy dog\nagain";
+  write_wrapped(file, text, 20, 4, 0);
+  std::rewind(file);
+  char contents[128] = {};
+  std::size_t count = std::fread(contents, 1, sizeof(contents), file);
+  std::fclose(file);
+  REQUIRE(string(contents, count) == wrap_text(text, 20, 4, 0));
+}
+
 TEST_CASE("utility::is_substr_at_pos") {
   REQUIRE(is_substr_at_pos("Hello world", "wor", 6));
   REQUIRE_FALSE(is_substr_at_pos("Hello world", "wor", 5));
@@ -412,3 +1130,212 @@ TEST_CASE("utility::is_substr_at_pos") {
   REQUIRE_FALSE(is_substr_at_pos("small", "really really big", 2));
   REQUIRE(is_substr_at_pos("small", "small", 0));
 }
+
+TEST_CASE("utility::parse_duration") {
+  using std::chrono::nanoseconds;
+
+  SECTION("single units") {
+    REQUIRE(parse_duration("250ms") == std::chrono::milliseconds{250});
+    REQUIRE(parse_duration("12ns") == nanoseconds{12});
+    REQUIRE(parse_duration("7us") == std::chrono::microseconds{7});
+    REQUIRE(parse_duration("30s") == std::chrono::seconds{30});
+    REQUIRE(parse_duration("5m") == std::chrono::minutes{5});
+    REQUIRE(parse_duration("5min") == std::chrono::minutes{5});
+    REQUIRE(parse_duration("2h") == std::chrono::hours{2});
+    REQUIRE(parse_duration("1d") == std::chrono::hours{24});
+    REQUIRE(parse_duration("0s") == nanoseconds{0});
+  }
+
+  SECTION("plain numbers are seconds") {
+    REQUIRE(parse_duration("15") == std::chrono::seconds{15});
+    REQUIRE(parse_duration("0.25") == std::chrono::milliseconds{250});
+  }
+
+  SECTION("fractions and compound durations") {
+    REQUIRE(parse_duration("1.5s") == std::chrono::milliseconds{1500});
+    REQUIRE(parse_duration(".5ms") == std::chrono::microseconds{500});
+    REQUIRE(parse_duration("2.ms") == std::chrono::milliseconds{2});
+    REQUIRE(parse_duration("0.1234567891s") == nanoseconds{123456789});
+    REQUIRE(parse_duration("1h30m") == std::chrono::minutes{90});
+    REQUIRE(parse_duration("1m0.5s") == std::chrono::milliseconds{60500});
+  }
+
+  SECTION("invalid durations") {
+    REQUIRE_THROWS_AS(parse_duration(""), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_duration("ms"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_duration("."), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_duration("-5s"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_duration("5 s"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_duration("5sec"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_duration("1h30"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_duration("1.2.3s"), std::invalid_argument);
+  }
+
+  SECTION("overflow") {
+    REQUIRE(parse_duration("9223372036854775807ns")
+            == nanoseconds{9223372036854775807LL});
+    REQUIRE_THROWS_AS(parse_duration("9223372036854775808ns"), std::out_of_range);
+    REQUIRE_THROWS_AS(parse_duration("106752d"), std::out_of_range);
+    REQUIRE_THROWS_AS(parse_duration("99999999999999999999s"), std::out_of_range);
+    REQUIRE_THROWS_AS(parse_duration("106751d23h59m"), std::out_of_range);
+  }
+}
+
+TEST_CASE("utility::parse_size") {
+  SECTION("plain numbers") {
+    REQUIRE(parse_size("0") == 0);
+    REQUIRE(parse_size("512") == 512);
+    REQUIRE(parse_size("512B") == 512);
+    REQUIRE(parse_size("18446744073709551615") == 18446744073709551615ULL);
+  }
+
+  SECTION("units") {
+    REQUIRE(parse_size("1k") == 1024);
+    REQUIRE(parse_size("1K") == 1024);
+    REQUIRE(parse_size("1KiB") == 1024);
+    REQUIRE(parse_size("1kB") == 1000);
+    REQUIRE(parse_size("1KB") == 1000);
+    REQUIRE(parse_size("4GiB") == 4ULL << 30);
+    REQUIRE(parse_size("4G") == 4ULL << 30);
+    REQUIRE(parse_size("4GB") == 4000000000ULL);
+    REQUIRE(parse_size("3MiB") == 3ULL << 20);
+    REQUIRE(parse_size("2TiB") == 2ULL << 40);
+    REQUIRE(parse_size("1PB") == 1000000000000000ULL);
+    REQUIRE(parse_size("15EiB") == 15ULL << 60);
+  }
+
+  SECTION("fractions") {
+    REQUIRE(parse_size("1.5KiB") == 1536);
+    REQUIRE(parse_size("1.5MB") == 1500000);
+    REQUIRE(parse_size("0.5") == 0);
+    REQUIRE(parse_size("1.0000000001KiB") == 1024);
+  }
+
+  SECTION("invalid sizes") {
+    REQUIRE_THROWS_AS(parse_size(""), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_size("MiB"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_size("-1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_size("1Ki"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_size("1Kb"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_size("1X"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_size("1 MB"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parse_size("1MBB"), std::invalid_argument);
+  }
+
+  SECTION("overflow") {
+    REQUIRE_THROWS_AS(parse_size("18446744073709551616"), std::out_of_range);
+    REQUIRE_THROWS_AS(parse_size("16EiB"), std::out_of_range);
+    REQUIRE_THROWS_AS(parse_size("16.5EiB"), std::out_of_range);
+    REQUIRE(parse_size("15.5EiB") == 31ULL << 59);
+  }
+}
+
+TEST_CASE("utility::edit_distance") {
+  SECTION("basic edits") {
+    REQUIRE(edit_distance("", "") == 0);
+    REQUIRE(edit_distance("abc", "") == 3);
+    REQUIRE(edit_distance("", "abc") == 3);
+    REQUIRE(edit_distance("verbose", "verbose") == 0);
+    REQUIRE(edit_distance("verbose", "verbse") == 1);
+    REQUIRE(edit_distance("verbose", "verbosse") == 1);
+    REQUIRE(edit_distance("verbose", "verbase") == 1);
+    REQUIRE(edit_distance("kitten", "sitting") == 3);
+  }
+
+  SECTION("transpositions") {
+    REQUIRE(edit_distance("verbsoe", "verbose") == 1);
+    REQUIRE(edit_distance("ab", "ba") == 1);
+    REQUIRE(edit_distance("abcd", "badc") == 2);
+    // Unrestricted: the transposed pair may also be edited
+    REQUIRE(edit_distance("ca", "abc") == 2);
+    REQUIRE(edit_distance("abc", "ca") == 2);
+  }
+
+  SECTION("bound") {
+    REQUIRE(edit_distance("kitten", "sitting", 1) == 2);
+    REQUIRE(edit_distance("kitten", "sitting", 3) == 3);
+    REQUIRE(edit_distance("a", "abcdef", 2) == 3);
+    REQUIRE(edit_distance("abc", "xyz", 0) == 1);
+  }
+
+  SECTION("long strings") {
+    std::string a(100, 'x');
+    std::string b = a;
+    b[10] = 'y';
+    std::swap(b[50], b[51]);
+    b[51] = 'z';
+    b += "tail";
+    REQUIRE(edit_distance(a, b) == 6);
+    REQUIRE(edit_distance(b, a) == 6);
+    REQUIRE(edit_distance(a, b, 4) == 5);
+  }
+}
+
+TEST_CASE("utility::string_pool") {
+  string_pool pool;
+
+  SECTION("interning") {
+    REQUIRE(pool.intern("").empty());
+    REQUIRE(pool.stats().allocated_bytes == 0);
+
+    std::string text = "hello";
+    token_view first = pool.intern(text);
+    REQUIRE(first == "hello");
+    REQUIRE(first.data() != text.data());
+    text = "world";
+    REQUIRE(first == "hello");
+
+    REQUIRE(pool.intern("hello").data() == first.data());
+    token_view second = pool.intern(text);
+    REQUIRE(second == "world");
+    REQUIRE(second.data() != first.data());
+    REQUIRE(pool.intern("hell") == "hell");
+
+    auto stats = pool.stats();
+    REQUIRE(stats.strings == 3);
+    REQUIRE(stats.bytes == 14);
+    REQUIRE(stats.references == 4);
+    REQUIRE(stats.referenced_bytes == 19);
+    REQUIRE(stats.string_bytes == 0);
+    pool.intern("a string too long for a std::string to hold");
+    REQUIRE(pool.stats().string_bytes == 44);
+    REQUIRE(stats.allocated_bytes >= token_arena::block_size);
+  }
+
+  SECTION("many strings") {
+    vector<token_view> views;
+    for (int i = 0; i < 5000; ++i)
+      views.push_back(pool.intern("a long option description number "
+                                  + std::to_string(i)));
+    for (int i = 0; i < 5000; ++i) {
+      REQUIRE(views[i] == "a long option description number "
+              + std::to_string(i));
+      REQUIRE(pool.intern(views[i].str()).data() == views[i].data());
+    }
+
+    auto stats = pool.stats();
+    REQUIRE(stats.strings == 5000);
+    REQUIRE(stats.references == 10000);
+    REQUIRE(stats.saved_bytes() > 0);
+    REQUIRE(stats.saved_bytes() < stats.string_bytes);
+  }
+
+  SECTION("threads") {
+    vector<vector<token_view>> results(4);
+    vector<std::thread> threads;
+    for (std::size_t t = 0; t < results.size(); ++t) {
+      threads.emplace_back([&pool, &results, t] {
+        for (int i = 0; i < 1000; ++i)
+          results[t].push_back(pool.intern("name-" + std::to_string(i)));
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    REQUIRE(pool.stats().strings == 1000);
+    for (std::size_t t = 1; t < results.size(); ++t) {
+      for (int i = 0; i < 1000; ++i)
+        REQUIRE(results[t][i].data() == results[0][i].data());
+    }
+  }
+}
@@ -0,0 +1,264 @@
+/* Option++ -- read command-line program options
+ * Copyright (C) 2017-2020 Greg Kikola.
+ *
+ * This file is part of Option++.
+ *
+ * Option++ is free software: you can redistribute it and/or modify
+ * it under the terms of the Boost Software License version 1.0.
+ *
+ * Option++ is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Boost Software License for more details.
+ *
+ * You should have received a copy of the Boost Software License
+ * along with Option++.  If not, see
+ * <https://www.boost.org/LICENSE_1_0.txt>.
+ */
+/* Written by Greg Kikola <gkikola@gmail.com>. */
+
+/**
+ * @file
+ * @brief Generator for pre-rendered help text.
+ *
+ * This program is not built on its own. The `optionpp_add_static_help`
+ * CMake function (see cmake/optionpp_static_help.cmake) compiles it
+ * together with a source file that defines the program's options,
+ * naming the defining function in the `OPTIONPP_HELP_DEFINITION`
+ * macro. The generator then calls that function on an empty parser,
+ * renders the help text with `parser::print_help`, and writes it to a
+ * header file as a `constexpr` character array.
+ */
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <optionpp/parser.hpp>
+
+#ifndef OPTIONPP_HELP_DEFINITION
+#error "OPTIONPP_HELP_DEFINITION must name the option-defining function"
+#endif
+
+#define OPTIONPP_STRINGIFY_(x) #x
+#define OPTIONPP_STRINGIFY(x) OPTIONPP_STRINGIFY_(x)
+
+/**
+ * @brief Option-defining function supplied by the program.
+ * @param p Empty parser to which the program's options are added.
+ */
+void OPTIONPP_HELP_DEFINITION(optionpp::parser& p);
+
+namespace {
+
+  /**
+   * @brief Settings read from the generator's command line.
+   */
+  struct settings {
+    bool show_help = false; //< Whether to show usage information.
+    std::string output; //< Path of the header to write.
+    std::string name; //< Name of the generated constant.
+    int width = 78; //< Maximum line length.
+    int group_indent = 0; //< Indentation of group names.
+    int option_indent = 2; //< Indentation of option names.
+    int desc_indent = 30; //< Indentation of descriptions.
+    int desc_multiline_indent = 32; //< Indentation of continued lines.
+  };
+
+  /**
+   * @brief Check whether a string is a valid C++ identifier.
+   * @param name String to check.
+   * @return True if `name` is a valid identifier.
+   */
+  bool is_identifier(const std::string& name) {
+    if (name.empty()
+        || std::isdigit(static_cast<unsigned char>(name.front())))
+      return false;
+    for (char c : name) {
+      if (c != '_' && !std::isalnum(static_cast<unsigned char>(c)))
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Write text as a sequence of C++ string literals.
+   *
+   * Each line of the text is written as a separate literal, so the
+   * generated header can be read and diffed. Characters that cannot
+   * appear literally are written as three-digit octal escapes, which
+   * cannot run into a following digit the way hex escapes can.
+   *
+   * @param os Output stream.
+   * @param text Text to write.
+   */
+  void write_literal(std::ostream& os, const std::string& text) {
+    static const char digits[] = "01234567";
+
+    if (text.empty()) {
+      os << "  \"\"";
+      return;
+    }
+
+    bool first_line = true;
+    bool line_open = false;
+    for (char c : text) {
+      if (!line_open) {
+        if (!first_line)
+          os << "\n";
+        os << "  \"";
+        first_line = false;
+        line_open = true;
+      }
+
+      auto uc = static_cast<unsigned char>(c);
+      switch (c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '?':
+        os << "\\?"; // Avoid trigraphs
+        break;
+      case '\n':
+        os << "\\n\"";
+        line_open = false;
+        break;
+      default:
+        if (uc >= 0x20 && uc < 0x7f)
+          os << c;
+        else
+          os << '\\' << digits[uc >> 6] << digits[(uc >> 3) & 7]
+             << digits[uc & 7];
+        break;
+      }
+    }
+
+    if (line_open)
+      os << "\"";
+  }
+
+  /**
+   * @brief Write the generated header.
+   * @param os Output stream.
+   * @param s Generator settings.
+   * @param help Rendered help text.
+   */
+  void write_header(std::ostream& os, const settings& s,
+                    const std::string& help) {
+    std::string guard = "OPTIONPP_HELP_";
+    for (char c : s.name)
+      guard += static_cast<char>(
+        std::toupper(static_cast<unsigned char>(c)));
+    guard += "_HPP";
+
+    os << "/* Generated by optionpp_gen_help from "
+       << OPTIONPP_STRINGIFY(OPTIONPP_HELP_DEFINITION)
+       << "(). Do not edit. */\n\n"
+       << "#ifndef " << guard << "\n"
+       << "#define " << guard << "\n\n"
+       << "#include <cstddef>\n\n"
+       << "/* Help text rendered with max_line_length = " << s.width
+       << ", group_indent = " << s.group_indent
+       << ",\n   option_indent = " << s.option_indent
+       << ", desc_first_line_indent = " << s.desc_indent
+       << ",\n   desc_multiline_indent = " << s.desc_multiline_indent
+       << ". */\n"
+       << "constexpr char " << s.name << "[] =\n";
+    write_literal(os, help);
+    os << ";\n\n"
+       << "/* Length of " << s.name << ", not counting the null. */\n"
+       << "constexpr std::size_t " << s.name << "_length = "
+       << help.size() << ";\n\n"
+       << "#endif\n";
+  }
+
+} // End namespace
+
+int main(int argc, char* argv[]) {
+  using optionpp::parser;
+
+  settings s;
+  parser opt_parser;
+  opt_parser["help"].short_name('?')
+    .description("Show help information")
+    .bind_bool(&s.show_help);
+  opt_parser["output"].short_name('o')
+    .argument("FILE")
+    .description("Header file to write")
+    .bind_string(&s.output);
+  opt_parser["name"].short_name('n')
+    .argument("IDENTIFIER")
+    .description("Name of the generated constant")
+    .bind_string(&s.name);
+  opt_parser["width"].short_name('w')
+    .argument("N")
+    .description("Maximum line length")
+    .bind_int(&s.width);
+  opt_parser["group-indent"]
+    .argument("N")
+    .description("Indentation of group names")
+    .bind_int(&s.group_indent);
+  opt_parser["option-indent"]
+    .argument("N")
+    .description("Indentation of option names")
+    .bind_int(&s.option_indent);
+  opt_parser["desc-indent"]
+    .argument("N")
+    .description("Indentation of the first line of descriptions")
+    .bind_int(&s.desc_indent);
+  opt_parser["desc-multiline-indent"]
+    .argument("N")
+    .description("Indentation of later lines of descriptions")
+    .bind_int(&s.desc_multiline_indent);
+
+  try {
+    opt_parser.parse(argc, argv);
+  } catch (const optionpp::error& e) {
+    std::cerr << "optionpp_gen_help: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (s.show_help) {
+    std::cout << "Usage: optionpp_gen_help [OPTION]...\n"
+              << "Write the help text of "
+              << OPTIONPP_STRINGIFY(OPTIONPP_HELP_DEFINITION)
+              << "() to a C++ header.\n\n"
+              << opt_parser << std::endl;
+    return 0;
+  }
+
+  if (s.output.empty() || !is_identifier(s.name)) {
+    std::cerr << "optionpp_gen_help: an output file and a valid "
+              << "constant name are required" << std::endl;
+    return 1;
+  }
+
+  std::string help;
+  try {
+    parser program;
+    OPTIONPP_HELP_DEFINITION(program);
+
+    std::ostringstream text;
+    program.print_help(text, s.width, s.group_indent, s.option_indent,
+                       s.desc_indent, s.desc_multiline_indent);
+    help = text.str();
+  } catch (const optionpp::error& e) {
+    std::cerr << "optionpp_gen_help: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::ofstream file{s.output, std::ios_base::binary};
+  write_header(file, s, help);
+  file.close();
+  if (!file) {
+    std::cerr << "optionpp_gen_help: could not write '"
+              << s.output << "'" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}